@@ -557,6 +557,8 @@ bool ConvertADT(char* filename, char* filename2, int cell_y, int cell_x, uint32
                 for (int x = 0; x <= ADT_GRID_SIZE; x++)
                     uint8_V9[y][x] = uint8((V9[y][x] - minHeight) * step + 0.5f);
             map.heightMapSize += sizeof(uint8_V9) + sizeof(uint8_V8);
+            // the server maps the file and uses the arrays in place, keep the next sections 4 byte aligned
+            map.heightMapSize += (4 - map.heightMapSize % 4) % 4;
         }
         else if (heightHeader.flags & MAP_HEIGHT_AS_INT16)
         {
@@ -840,6 +842,9 @@ bool ConvertADT(char* filename, char* filename2, int cell_y, int cell_x, uint32
         {
             fwrite(uint8_V9, sizeof(uint8_V9), 1, output);
             fwrite(uint8_V8, sizeof(uint8_V8), 1, output);
+
+            uint8 const padding[4] = { 0, 0, 0, 0 };
+            fwrite(padding, 1, (4 - (sizeof(uint8_V9) + sizeof(uint8_V8)) % 4) % 4, output);
         }
         else
         {
@@ -0,0 +1,5 @@
+ALTER TABLE db_version CHANGE COLUMN required_14080_01_mangos_pursuit required_14081_01_mangos_server_profile bit;
+
+DELETE FROM command WHERE name = 'server profile';
+REPLACE INTO `command` VALUES
+('server profile',3,'Syntax: .server profile [reset|#mapid]\r\n\r\nShow count, p50, p99 and max duration of the world and map update phases and of the slowest opcode handlers recorded by the tick profiler. With #mapid only the phases of that map are shown, reset clears all histograms.');
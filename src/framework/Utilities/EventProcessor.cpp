@@ -18,9 +18,45 @@
 
 #include "EventProcessor.h"
 
+#include <algorithm>
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace
+{
+    inline uint32 LowestBit(uint64 mask)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, mask);
+        return uint32(index);
+#else
+        return uint32(__builtin_ctzll(mask));
+#endif
+    }
+
+    // the first event goes first, events due at the same time in the order they were added
+    inline bool IsBefore(uint64 firstTime, uint64 firstSequence, uint64 secondTime, uint64 secondSequence)
+    {
+        return firstTime < secondTime || (firstTime == secondTime && firstSequence < secondSequence);
+    }
+}
+
+EventProcessor::EventWheel::EventWheel(uint64 time) : wheelTime(time)
+{
+    for (uint64& mask : masks)
+        mask = 0;
+}
+
 EventProcessor::EventProcessor()
 {
     m_time = 0;
+    m_wheel = nullptr;
+    m_sequence = 0;
+    m_eventCount = 0;
     m_aborting = false;
 }
 
@@ -35,27 +71,294 @@ void EventProcessor::Update(uint32 p_time)
     m_time += p_time;
 
     // main event loop
-    EventList::iterator i;
-    while (((i = m_events.begin()) != m_events.end()) && i->first <= m_time)
+    while (true)
     {
-        // get and remove event from queue
-        BasicEvent* Event = i->second;
-        m_events.erase(i);
+        while (BasicEvent* event = GetNextReadyEvent())
+        {
+            Unlink(event);
+            ExecuteEvent(event, p_time);
+        }
+
+        if (!m_wheel)
+            break;
+
+        bool exact;
+        uint64 nextTime = GetNextWheelTime(exact);
+        if (nextTime > m_time)
+            break;
 
-        if (!Event->to_Abort)
+        if (!exact)
         {
-            if (Event->Execute(m_time, p_time))
-            {
-                // completely destroy event if it is not re-added
-                delete Event;
-            }
+            // moves the events of the reached slot down the wheel
+            AdvanceWheel(nextTime);
+            continue;
         }
-        else
+
+        // the slot is emptied before the wheel moves on, otherwise it could be refilled by the next lap
+        EventSlot& slot = m_wheel->slots[0][nextTime & (WHEEL_SLOTS - 1)];
+        for (BasicEvent* event = slot.head; event; event = event->m_nextEvent)
+            event->m_slot = &m_wheel->runEvents;
+        m_wheel->runEvents = slot;
+        slot = EventSlot();
+        SetSlotMask(slot, false);
+
+        AdvanceWheel(nextTime + 1);
+    }
+
+    if (m_wheel)
+    {
+        if (m_wheel->wheelTime <= m_time)
+            AdvanceWheel(m_time + 1);
+
+        if (m_eventCount < LIST_MAX_EVENTS)
+            RemoveWheel();
+    }
+}
+
+void EventProcessor::ExecuteEvent(BasicEvent* event, uint32 p_time)
+{
+    if (!event->to_Abort)
+    {
+        if (event->Execute(m_time, p_time))
         {
-            Event->Abort(m_time);
-            delete Event;
+            // completely destroy event if it is not re-added
+            delete event;
         }
     }
+    else
+    {
+        event->Abort(m_time);
+        delete event;
+    }
+}
+
+BasicEvent* EventProcessor::GetNextReadyEvent() const
+{
+    BasicEvent* run = m_wheel ? m_wheel->runEvents.head : nullptr;
+    BasicEvent* listed = m_events.head;
+    if (listed && listed->m_execTime > m_time)
+        listed = nullptr;
+
+    if (!run || !listed)
+        return run ? run : listed;
+
+    return IsBefore(listed->m_execTime, listed->m_sequence, run->m_execTime, run->m_sequence) ? listed : run;
+}
+
+uint64 EventProcessor::GetNextWheelTime(bool& exact) const
+{
+    uint64 wheelTime = m_wheel->wheelTime;
+
+    exact = true;
+    uint64 mask = m_wheel->masks[0] & (~uint64(0) << (wheelTime & (WHEEL_SLOTS - 1)));
+    if (mask)
+        return (wheelTime & ~uint64(WHEEL_SLOTS - 1)) | LowestBit(mask);
+
+    // the slot of the current time is always empty on the higher levels
+    exact = false;
+    for (uint32 level = 1; level < WHEEL_LEVELS; ++level)
+    {
+        uint32 shift = level * WHEEL_SLOT_BITS;
+        uint32 index = (wheelTime >> shift) & (WHEEL_SLOTS - 1);
+        if (index == WHEEL_SLOTS - 1)
+            continue;
+
+        mask = m_wheel->masks[level] & (~uint64(0) << (index + 1));
+        if (mask)
+            return (wheelTime >> (shift + WHEEL_SLOT_BITS) << (shift + WHEEL_SLOT_BITS)) | (uint64(LowestBit(mask)) << shift);
+    }
+
+    if (!m_wheel->farEvents.head)
+        return UINT64_MAX;
+
+    uint64 nextTime = UINT64_MAX;
+    for (BasicEvent* event = m_wheel->farEvents.head; event; event = event->m_nextEvent)
+        nextTime = std::min(nextTime, event->m_execTime);
+
+    uint32 shift = WHEEL_LEVELS * WHEEL_SLOT_BITS;
+    return nextTime >> shift << shift;
+}
+
+void EventProcessor::AdvanceWheel(uint64 time)
+{
+    uint64 oldTime = m_wheel->wheelTime;
+    m_wheel->wheelTime = time;
+
+    // entering the range of a higher slot moves its events down, from the top so they can move further
+    if ((time >> (WHEEL_LEVELS * WHEEL_SLOT_BITS)) != (oldTime >> (WHEEL_LEVELS * WHEEL_SLOT_BITS)) && m_wheel->farEvents.head)
+        Cascade(m_wheel->farEvents);
+
+    for (uint32 level = WHEEL_LEVELS - 1; level > 0; --level)
+    {
+        uint32 shift = level * WHEEL_SLOT_BITS;
+        if ((time >> shift) == (oldTime >> shift))
+            continue;
+
+        uint32 index = (time >> shift) & (WHEEL_SLOTS - 1);
+        if (m_wheel->masks[level] & (uint64(1) << index))
+            Cascade(m_wheel->slots[level][index]);
+    }
+}
+
+void EventProcessor::Cascade(EventSlot& slot)
+{
+    BasicEvent* event = slot.head;
+    slot = EventSlot();
+    SetSlotMask(slot, false);
+
+    while (event)
+    {
+        BasicEvent* next = event->m_nextEvent;
+        event->m_processor = nullptr;
+        --m_eventCount;
+        Schedule(event);
+        event = next;
+    }
+}
+
+void EventProcessor::CreateWheel()
+{
+    m_wheel = new EventWheel(m_time + 1);
+
+    // the events already due stay in the list
+    BasicEvent* event = m_events.head;
+    while (event && event->m_execTime <= m_time)
+        event = event->m_nextEvent;
+
+    while (event)
+    {
+        BasicEvent* next = event->m_nextEvent;
+        Unlink(event);
+        Schedule(event);
+        event = next;
+    }
+}
+
+void EventProcessor::RemoveWheel()
+{
+    std::vector<BasicEvent*> events;
+    events.reserve(m_eventCount);
+    for (auto& level : m_wheel->slots)
+        for (EventSlot& slot : level)
+            for (BasicEvent* event = slot.head; event; event = event->m_nextEvent)
+                events.push_back(event);
+    for (BasicEvent* event = m_wheel->farEvents.head; event; event = event->m_nextEvent)
+        events.push_back(event);
+
+    for (BasicEvent* event : events)
+        Unlink(event);
+
+    delete m_wheel;
+    m_wheel = nullptr;
+
+    std::sort(events.begin(), events.end(), [](BasicEvent const* first, BasicEvent const* second)
+    {
+        return IsBefore(first->m_execTime, first->m_sequence, second->m_execTime, second->m_sequence);
+    });
+
+    for (BasicEvent* event : events)
+        Link(m_events, event, true);
+}
+
+void EventProcessor::Schedule(BasicEvent* event)
+{
+    uint64 time = event->m_execTime;
+    if (!m_wheel || time < m_wheel->wheelTime)
+    {
+        Link(m_events, event, true);
+        return;
+    }
+
+    for (uint32 level = 0; level < WHEEL_LEVELS; ++level)
+    {
+        uint32 shift = level * WHEEL_SLOT_BITS;
+        if ((time >> (shift + WHEEL_SLOT_BITS)) == (m_wheel->wheelTime >> (shift + WHEEL_SLOT_BITS)))
+        {
+            // only the lowest level executes, the higher ones are sorted when they move down
+            Link(m_wheel->slots[level][(time >> shift) & (WHEEL_SLOTS - 1)], event, level == 0);
+            return;
+        }
+    }
+
+    Link(m_wheel->farEvents, event, false);
+}
+
+void EventProcessor::Link(EventSlot& slot, BasicEvent* event, bool ordered)
+{
+    BasicEvent* prev = slot.tail;
+    if (ordered)
+        while (prev && IsBefore(event->m_execTime, event->m_sequence, prev->m_execTime, prev->m_sequence))
+            prev = prev->m_prevEvent;
+
+    BasicEvent* next = prev ? prev->m_nextEvent : slot.head;
+    event->m_prevEvent = prev;
+    event->m_nextEvent = next;
+    (prev ? prev->m_nextEvent : slot.head) = event;
+    (next ? next->m_prevEvent : slot.tail) = event;
+
+    if (!prev && !next)
+        SetSlotMask(slot, true);
+
+    event->m_processor = this;
+    event->m_slot = &slot;
+    ++m_eventCount;
+}
+
+void EventProcessor::Unlink(BasicEvent* event)
+{
+    EventSlot& slot = *event->m_slot;
+    (event->m_prevEvent ? event->m_prevEvent->m_nextEvent : slot.head) = event->m_nextEvent;
+    (event->m_nextEvent ? event->m_nextEvent->m_prevEvent : slot.tail) = event->m_prevEvent;
+
+    if (!slot.head)
+        SetSlotMask(slot, false);
+
+    event->m_processor = nullptr;
+    event->m_slot = nullptr;
+    event->m_prevEvent = nullptr;
+    event->m_nextEvent = nullptr;
+    --m_eventCount;
+}
+
+void EventProcessor::SetSlotMask(EventSlot const& slot, bool used)
+{
+    if (!m_wheel)
+        return;
+
+    for (uint32 level = 0; level < WHEEL_LEVELS; ++level)
+    {
+        EventSlot const* slots = m_wheel->slots[level];
+        if (&slot < slots || &slot >= slots + WHEEL_SLOTS)
+            continue;
+
+        uint64 bit = uint64(1) << (&slot - slots);
+        if (used)
+            m_wheel->masks[level] |= bit;
+        else
+            m_wheel->masks[level] &= ~bit;
+        return;
+    }
+}
+
+void EventProcessor::GetEvents(std::vector<BasicEvent*>& events) const
+{
+    events.reserve(events.size() + m_eventCount);
+
+    auto addSlot = [&events](EventSlot const& slot)
+    {
+        for (BasicEvent* event = slot.head; event; event = event->m_nextEvent)
+            events.push_back(event);
+    };
+
+    addSlot(m_events);
+    if (!m_wheel)
+        return;
+
+    addSlot(m_wheel->runEvents);
+    for (auto const& level : m_wheel->slots)
+        for (EventSlot const& slot : level)
+            addSlot(slot);
+    addSlot(m_wheel->farEvents);
 }
 
 void EventProcessor::KillAllEvents(bool force)
@@ -63,39 +366,40 @@ void EventProcessor::KillAllEvents(bool force)
     // prevent event insertions
     m_aborting = true;
 
+    std::vector<BasicEvent*> events;
+    GetEvents(events);
+
     // first, abort all existing events
-    for (EventList::iterator i = m_events.begin(); i != m_events.end();)
+    for (BasicEvent* event : events)
     {
-        EventList::iterator i_old = i;
-        ++i;
-
-        i_old->second->to_Abort = true;
-        i_old->second->Abort(m_time);
-        if (force || i_old->second->IsDeletable())
+        event->to_Abort = true;
+        event->Abort(m_time);
+        if (force || event->IsDeletable())
         {
-            delete i_old->second;
-
             if (!force)                                     // need per-element cleanup
-                m_events.erase(i_old);
+                Unlink(event);
+
+            delete event;
         }
     }
 
     // fast clear event list (in force case)
     if (force)
-        m_events.clear();
+    {
+        m_events = EventSlot();
+        delete m_wheel;
+        m_wheel = nullptr;
+        m_eventCount = 0;
+    }
 }
 
 void EventProcessor::KillEvent(BasicEvent* event)
 {
-    for (EventList::iterator iter = m_events.begin(); iter != m_events.end();)
-    {
-        if (iter->second == event)
-        {
-            delete iter->second;
-            iter = m_events.erase(iter);
-        }
-        else ++iter;
-    }
+    if (event->m_processor != this)
+        return;
+
+    Unlink(event);
+    delete event;
 }
 
 void EventProcessor::AddEvent(BasicEvent* Event, uint64 e_time, bool set_addtime)
@@ -103,22 +407,28 @@ void EventProcessor::AddEvent(BasicEvent* Event, uint64 e_time, bool set_addtime
     if (set_addtime)
         Event->m_addTime = m_time;
 
+    // adding a waiting event again moves it
+    if (Event->m_processor)
+        Event->m_processor->Unlink(Event);
+
     Event->m_execTime = e_time;
-    m_events.insert(std::pair<uint64, BasicEvent*>(e_time, Event));
+    Event->m_sequence = m_sequence++;
+    Schedule(Event);
+
+    if (!m_wheel && m_eventCount > WHEEL_MIN_EVENTS)
+        CreateWheel();
 }
 
-void EventProcessor::ModifyEventTime(BasicEvent* Event, uint64 msTime)
+bool EventProcessor::ModifyEventTime(BasicEvent* Event, uint64 msTime)
 {
-    for (auto itr = m_events.begin(); itr != m_events.end(); ++itr)
-    {
-        if (itr->second != Event)
-            continue;
+    if (Event->m_processor != this)
+        return false;
 
-        Event->m_execTime = msTime;
-        m_events.erase(itr);
-        m_events.insert(std::pair<uint64, BasicEvent*>(msTime, Event));
-        break;
-    }
+    Unlink(Event);
+    Event->m_execTime = msTime;
+    Event->m_sequence = m_sequence++;
+    Schedule(Event);
+    return true;
 }
 
 uint64 EventProcessor::CalculateTime(uint64 t_offset) const
@@ -21,16 +21,19 @@
 
 #include "Platform/Define.h"
 
-#include <map>
+#include <vector>
 
 // Note. All times are in milliseconds here.
 
+class EventProcessor;
+struct EventSlot;
+
 class BasicEvent
 {
     public:
 
         BasicEvent()
-            : to_Abort(false)
+            : to_Abort(false), m_addTime(0), m_execTime(0), m_processor(nullptr), m_slot(nullptr), m_prevEvent(nullptr), m_nextEvent(nullptr), m_sequence(0)
         {
         }
 
@@ -47,16 +50,42 @@ class BasicEvent
 
         virtual void Abort(uint64 /*e_time*/) {}            // this method executes when the event is aborted
 
+        bool IsScheduled() const { return m_processor != nullptr; }
+
         bool to_Abort;                                      // set by externals when the event is aborted, aborted events don't execute
         // and get Abort call when deleted
 
         // these can be used for time offset control
         uint64 m_addTime;                                   // time when the event was added to queue, filled by event handler
         uint64 m_execTime;                                  // planned time of next execution, filled by event handler
+
+    private:
+        friend class EventProcessor;
+
+        // links of the slot the event waits in, owned by the event processor
+        EventProcessor* m_processor;
+        EventSlot* m_slot;
+        BasicEvent* m_prevEvent;
+        BasicEvent* m_nextEvent;
+        uint64 m_sequence;                                  // events due at the same time execute in the order they were added
 };
 
-typedef std::multimap<uint64, BasicEvent*> EventList;
+struct EventSlot
+{
+    EventSlot() : head(nullptr), tail(nullptr) {}
+
+    BasicEvent* head;
+    BasicEvent* tail;
+};
 
+/**
+ * Events of one object, linked in through BasicEvent itself so adding, killing and rescheduling an
+ * event never allocates and never searches.
+ * A few events are kept in a list in time order. Once an object has many of them they are moved into a
+ * hierarchical timing wheel: each level has 64 slots, a slot of the lowest level covers one millisecond
+ * and a slot of each further level as much as the whole level below. A higher slot is moved down when
+ * time reaches it and empty slots are skipped using a bit mask per level.
+ */
 class EventProcessor
 {
     public:
@@ -64,18 +93,60 @@ class EventProcessor
         EventProcessor();
         ~EventProcessor();
 
+        // the events link back to the processor
+        EventProcessor(EventProcessor const&) = delete;
+        EventProcessor& operator=(EventProcessor const&) = delete;
+
         void Update(uint32 p_time);
         void KillAllEvents(bool force);
         void KillEvent(BasicEvent* Event);
         void AddEvent(BasicEvent* Event, uint64 e_time, bool set_addtime = true);
-        void ModifyEventTime(BasicEvent* event, uint64 msTime);
+        // returns false if the event is not waiting in this processor, it is executing for example
+        bool ModifyEventTime(BasicEvent* event, uint64 msTime);
         uint64 CalculateTime(uint64 t_offset) const;
-        EventList& GetEvents() { return m_events; }
+
+        bool HasEvents() const { return m_eventCount != 0; }
+        uint32 GetEventCount() const { return m_eventCount; }
+        bool HasWheel() const { return m_wheel != nullptr; }
+        // copies the waiting events, so the caller may kill or add events while going through them
+        void GetEvents(std::vector<BasicEvent*>& events) const;
 
     protected:
 
+        static uint32 const WHEEL_LEVELS = 4;
+        static uint32 const WHEEL_SLOT_BITS = 6;
+        static uint32 const WHEEL_SLOTS = 1 << WHEEL_SLOT_BITS;
+        static uint32 const WHEEL_MIN_EVENTS = 64;          // the list is turned into a wheel above this many events
+        static uint32 const LIST_MAX_EVENTS = 16;           // and back below this many
+
+        struct EventWheel
+        {
+            EventWheel(uint64 time);
+
+            uint64 wheelTime;                               // every event with an earlier time has been executed
+            EventSlot slots[WHEEL_LEVELS][WHEEL_SLOTS];
+            uint64 masks[WHEEL_LEVELS];                     // bit per slot with events
+            EventSlot runEvents;                            // events of the millisecond being executed
+            EventSlot farEvents;                            // beyond the highest level, unordered
+        };
+
+        void Schedule(BasicEvent* event);
+        void Link(EventSlot& slot, BasicEvent* event, bool ordered);
+        void Unlink(BasicEvent* event);
+        void SetSlotMask(EventSlot const& slot, bool used);
+        void Cascade(EventSlot& slot);
+        void AdvanceWheel(uint64 time);
+        uint64 GetNextWheelTime(bool& exact) const;
+        BasicEvent* GetNextReadyEvent() const;
+        void ExecuteEvent(BasicEvent* event, uint32 p_time);
+        void CreateWheel();
+        void RemoveWheel();
+
         uint64 m_time;
-        EventList m_events;
+        EventSlot m_events;                                 // in time order, all events without wheel, else the ones the wheel has passed
+        EventWheel* m_wheel;
+        uint64 m_sequence;
+        uint32 m_eventCount;
         bool m_aborting;
 };
 
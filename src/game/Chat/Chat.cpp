@@ -246,6 +246,19 @@ ChatCommand* ChatHandler::getCommandTable()
     {
         { "tempspawn",      SEC_ADMINISTRATOR,  false, &ChatHandler::HandleShowTemporarySpawnList,          "", nullptr },
         { "gridsloaded",    SEC_ADMINISTRATOR,  false, &ChatHandler::HandleGridsLoadedCount,                "", nullptr },
+        { "broadcast",      SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugBroadcastBenchmark,         "", nullptr },
+        { "dbquery",        SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugDatabaseQueryBenchmark,     "", nullptr },
+        { "visibility",     SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugVisibilityBenchmark,        "", nullptr },
+        { "terrain",        SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugTerrainBenchmark,           "", nullptr },
+        { "los",            SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugLosBenchmark,               "", nullptr },
+        { "losrecord",      SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugLosRecordCommand,           "", nullptr },
+        { "lossave",        SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugLosSaveCommand,             "", nullptr },
+        { "loscache",       SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugLosCacheCommand,            "", nullptr },
+        { "events",         SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugEventsBenchmark,            "", nullptr },
+        { "procs",          SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugProcsBenchmark,             "", nullptr },
+        { "auras",          SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugAurasBenchmark,             "", nullptr },
+        { "aoe",            SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugAoeBenchmark,               "", nullptr },
+        { "stats",          SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugStatsBenchmark,             "", nullptr },
         { nullptr,          0,                  false, nullptr,                                             "", nullptr }
     };
 
@@ -841,6 +854,7 @@ ChatCommand* ChatHandler::getCommandTable()
         { "log",            SEC_CONSOLE,        true,  nullptr,                                           "", serverLogCommandTable },
         { "motd",           SEC_PLAYER,         true,  &ChatHandler::HandleServerMotdCommand,          "", nullptr },
         { "plimit",         SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleServerPLimitCommand,        "", nullptr },
+        { "profile",        SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleServerProfileCommand,       "", nullptr },
         { "resetallraid",   SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleServerResetAllRaidCommand,  "", nullptr },
         { "restart",        SEC_ADMINISTRATOR,  true,  nullptr,                                           "", serverRestartCommandTable },
         { "shutdown",       SEC_ADMINISTRATOR,  true,  nullptr,                                           "", serverShutdownCommandTable },
@@ -297,6 +297,19 @@ class ChatHandler
 
         bool HandleShowTemporarySpawnList(char* args);
         bool HandleGridsLoadedCount(char* args);
+        bool HandleDebugBroadcastBenchmark(char* args);
+        bool HandleDebugDatabaseQueryBenchmark(char* args);
+        bool HandleDebugVisibilityBenchmark(char* args);
+        bool HandleDebugTerrainBenchmark(char* args);
+        bool HandleDebugLosRecordCommand(char* args);
+        bool HandleDebugLosSaveCommand(char* args);
+        bool HandleDebugLosBenchmark(char* args);
+        bool HandleDebugLosCacheCommand(char* args);
+        bool HandleDebugEventsBenchmark(char* args);
+        bool HandleDebugProcsBenchmark(char* args);
+        bool HandleDebugAurasBenchmark(char* args);
+        bool HandleDebugAoeBenchmark(char* args);
+        bool HandleDebugStatsBenchmark(char* args);
 
         bool HandleDebugPlayCinematicCommand(char* args);
         bool HandleDebugPlayMovieCommand(char* args);
@@ -670,6 +683,7 @@ class ChatHandler
         bool HandleServerLogLevelCommand(char* args);
         bool HandleServerMotdCommand(char* args);
         bool HandleServerPLimitCommand(char* args);
+        bool HandleServerProfileCommand(char* args);
         bool HandleServerResetAllRaidCommand(char* args);
         bool HandleServerRestartCommand(char* args);
         bool HandleServerSetMotdCommand(char* args);
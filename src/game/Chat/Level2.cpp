@@ -49,6 +49,7 @@
 #include "MotionGenerators/TargetedMovementGenerator.h"     // for HandleNpcUnFollowCommand
 #include "MotionGenerators/MoveMap.h"                       // for mmap manager
 #include "MotionGenerators/PathFinder.h"                    // for mmap commands
+#include "MotionGenerators/PathCorridorCache.h"             // for mmap stats
 #include "Movement/MoveSplineInit.h"
 #include "Anticheat/Anticheat.hpp"
 #include "Entities/Transports.h"
@@ -5424,6 +5425,11 @@ bool ChatHandler::HandleMmapStatsCommand(char* /*args*/)
     MMAP::MMapManager* manager = MMAP::MMapFactory::createOrGetMMapManager();
     PSendSysMessage(" %u maps loaded with %u tiles overall", manager->getLoadedMapsCount(), manager->getLoadedTilesCount());
 
+    PathCorridorCacheStats cacheStats = sPathCorridorCache.GetStats();
+    PSendSysMessage(" path cache: %u corridors, " UI64FMTD " of " UI64FMTD " lookups hit (%.1f%%), " UI64FMTD " corridors extended after a target move",
+                    sPathCorridorCache.GetSize(), cacheStats.hits, cacheStats.lookups,
+                    cacheStats.lookups ? 100.0 * cacheStats.hits / cacheStats.lookups : 0.0, cacheStats.patches);
+
     const dtNavMesh* navmesh = manager->GetNavMesh(m_session->GetPlayer()->GetMapId(), m_session->GetPlayer()->GetInstanceId());
     if (!navmesh)
     {
@@ -61,6 +61,7 @@
 #include "Metric/Metric.h"
 #endif
 #include "Server/PacketLog.h"
+#include "World/TickProfiler.h"
 
 #include "Globals/UnitCondition.h"
 #include "Globals/CombatCondition.h"
@@ -6445,6 +6446,66 @@ bool ChatHandler::HandleServerPLimitCommand(char* args)
     return true;
 }
 
+bool ChatHandler::HandleServerProfileCommand(char* args)
+{
+    if (ExtractLiteralArg(&args, "reset"))
+    {
+        sTickProfiler.Reset();
+        SendSysMessage("Tick profiler histograms reset.");
+        return true;
+    }
+
+    uint32 mapFilter = TICK_PROFILER_WORLD_ID;
+    bool filtered = ExtractUInt32(&args, mapFilter);
+
+    if (!sTickProfiler.IsEnabled())
+        SendSysMessage("Tick profiler is disabled (TickProfiler.Enable), showing old samples.");
+
+    TickProfileSnapshot snapshot = sTickProfiler.GetSnapshot();
+    for (auto& map : snapshot.phases)
+    {
+        if (filtered && map.first != mapFilter)
+            continue;
+
+        if (map.first == TICK_PROFILER_WORLD_ID)
+            SendSysMessage("World:");
+        else
+            PSendSysMessage("Map %u:", map.first);
+
+        for (uint32 i = 0; i < MAX_TICK_PHASES; ++i)
+        {
+            TickHistogramSnapshot const& phase = map.second[i];
+            if (!phase.count)
+                continue;
+
+            PSendSysMessage("  %-12s count " UI64FMTD " p50 %uus p99 %uus max %uus", TickProfiler::GetPhaseName(TickPhase(i)),
+                phase.count, phase.Percentile(50.0), phase.Percentile(99.0), phase.max);
+        }
+    }
+
+    if (filtered)
+        return true;
+
+    // opcode handlers with the highest total time
+    std::vector<std::pair<uint32, TickHistogramSnapshot const*>> opcodes;
+    for (auto& opcode : snapshot.opcodes)
+        if (opcode.second.count)
+            opcodes.push_back({ opcode.first, &opcode.second });
+
+    std::sort(opcodes.begin(), opcodes.end(), [](auto const& left, auto const& right) { return left.second->total > right.second->total; });
+    if (opcodes.size() > 10)
+        opcodes.resize(10);
+
+    if (!opcodes.empty())
+        SendSysMessage("Opcode handlers:");
+
+    for (auto& opcode : opcodes)
+        PSendSysMessage("  %s count " UI64FMTD " p50 %uus p99 %uus max %uus", LookupOpcodeName(opcode.first),
+            opcode.second->count, opcode.second->Percentile(50.0), opcode.second->Percentile(99.0), opcode.second->max);
+
+    return true;
+}
+
 bool ChatHandler::HandleCastCommand(char* args)
 {
     if (!*args)
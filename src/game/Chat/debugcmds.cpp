@@ -20,6 +20,9 @@
 #include "Server/WorldPacket.h"
 #include "Entities/Player.h"
 #include "Server/Opcodes.h"
+#include "Server/WorldSession.h"
+#include "Server/WorldSocket.h"
+#include "Server/BroadcastPacket.h"
 #include "Chat/Chat.h"
 #include "Log.h"
 #include "Entities/Unit.h"
@@ -27,15 +30,25 @@
 #include "Tools/Language.h"
 #include "BattleGround/BattleGroundMgr.h"
 #include <fstream>
+#include <chrono>
+#include <map>
+#include <random>
+#include <thread>
 #include "Maps/MapManager.h"
 #include "Globals/ObjectMgr.h"
 #include "Entities/ObjectGuid.h"
 #include "Spells/SpellMgr.h"
+#include "Spells/SpellAuras.h"
+#include "Grids/GridNotifiers.h"
+#include "Grids/GridNotifiersImpl.h"
+#include "Grids/CellImpl.h"
 #include "AI/ScriptDevAI/ScriptDevAIMgr.h"
 #include "Maps/InstanceData.h"
 #include "Models/M2Stores.h"
 #include "Entities/Transports.h"
 #include "World/World.h"
+#include "Vmap/VMapFactory.h"
+#include "Vmap/VMapManager2.h"
 
 bool ChatHandler::HandleDebugSendSpellFailCommand(char* args)
 {
@@ -1465,6 +1478,914 @@ bool ChatHandler::HandleGridsLoadedCount(char* /*args*/)
     return true;
 }
 
+// Fan-out of one packet to real sessions whose sockets are connected over loopback, a copy per receiver
+// through the unicast send against the shared buffer queued by BroadcastPacket. The producer time is what
+// the sending map thread pays, the delivery time lasts until every client read everything and includes
+// the network thread writing it out after up to OutBufferTimeout
+bool ChatHandler::HandleDebugBroadcastBenchmark(char* args)
+{
+    uint32 packetSize;
+    if (!ExtractOptUInt32(&args, packetSize, 200) || packetSize > 0x7FFF - 2)
+        return false;
+
+    typedef std::chrono::steady_clock Clock;
+    using boost::asio::ip::tcp;
+
+    uint32 const receiverCounts[] = { 1, 10, 40, 100, 250 };
+    uint32 const broadcasts = 100;
+    size_t const bytesPerClient = (packetSize + 4) * broadcasts;   // small packets have a 4 byte header
+
+    WorldPacket packet(SMSG_MESSAGECHAT, packetSize);
+    packet.resize(packetSize);
+
+    // stands in for the network thread, the sockets write from it
+    boost::asio::io_service service;
+    std::unique_ptr<boost::asio::io_service::work> work = std::make_unique<boost::asio::io_service::work>(service);
+    std::thread networkThread([&service]() { service.run(); });
+
+    PSendSysMessage("Broadcast of %u packets of %u bytes, producer ns per packet and delivery ms:", broadcasts, packetSize);
+    try
+    {
+        tcp::acceptor acceptor(service, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+        std::vector<uint8> readBuffer(bytesPerClient);
+
+        for (uint32 receivers : receiverCounts)
+        {
+            std::vector<std::unique_ptr<tcp::socket>> clients;
+            std::vector<std::unique_ptr<WorldSession>> sessions;
+            for (uint32 i = 0; i < receivers; ++i)
+            {
+                std::shared_ptr<WorldSocket> socket = std::make_shared<WorldSocket>(service, [](MaNGOS::Socket*) {});
+                clients.push_back(std::make_unique<tcp::socket>(service));
+                clients.back()->connect(acceptor.local_endpoint());
+                acceptor.accept(socket->GetAsioSocket());
+                sessions.push_back(std::make_unique<WorldSession>(0, socket.get(), SEC_PLAYER, sWorld.getConfig(CONFIG_UINT32_EXPANSION), 0,
+                                   LOCALE_enUS, "", 0, 0, false));
+            }
+
+            // blocks until every client got all packets of the run
+            auto deliver = [&clients, &readBuffer]()
+            {
+                for (auto& client : clients)
+                    boost::asio::read(*client, boost::asio::buffer(readBuffer));
+            };
+
+            Clock::time_point start = Clock::now();
+            for (uint32 n = 0; n < broadcasts; ++n)
+                for (auto& session : sessions)
+                    session->SendPacket(packet);
+            auto copyTime = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+            deliver();
+            auto copyDelivery = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count();
+
+            start = Clock::now();
+            for (uint32 n = 0; n < broadcasts; ++n)
+            {
+                BroadcastPacket broadcast(packet);
+                for (auto& session : sessions)
+                    broadcast.AddReceiver(session.get());
+            }
+            auto sharedTime = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+            deliver();
+            auto sharedDelivery = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count();
+
+            PSendSysMessage("receivers %3u: copy %8u ns %4u ms, shared %8u ns %4u ms", receivers,
+                            uint32(copyTime / broadcasts), uint32(copyDelivery), uint32(sharedTime / broadcasts), uint32(sharedDelivery));
+        }
+    }
+    catch (boost::system::system_error const& e)
+    {
+        PSendSysMessage("Loopback sockets failed: %s", e.what());
+        SetSentErrorMessage(true);
+    }
+
+    // the sessions closed their sockets, nothing is left for the network thread
+    work.reset();
+    networkThread.join();
+    return !HasSentErrorMessage();
+}
+
+// Load time of a whole world table through the text protocol against native typed results,
+// every field is read the way the loaders do it
+bool ChatHandler::HandleDebugDatabaseQueryBenchmark(char* args)
+{
+    char* table = ExtractLiteralArg(&args);
+    if (!table)
+        return false;
+
+    for (char const* c = table; *c; ++c)
+    {
+        if (!isalnum(*c) && *c != '_')
+        {
+            PSendSysMessage("Invalid table name %s", table);
+            SetSentErrorMessage(true);
+            return false;
+        }
+    }
+
+    auto readAll = [](std::unique_ptr<QueryResult> result, uint64& checksum) -> uint64
+    {
+        uint64 rows = 0;
+        if (!result)
+            return rows;
+
+        do
+        {
+            Field* fields = result->Fetch();
+            for (uint32 i = 0; i < result->GetFieldCount(); ++i)
+            {
+                switch (fields[i].GetType())
+                {
+                    case Field::DB_TYPE_INTEGER: checksum += fields[i].GetUInt32(); break;
+                    case Field::DB_TYPE_FLOAT:   checksum += uint64(fields[i].GetFloat()); break;
+                    default:                     checksum += strlen(fields[i].GetString()); break;
+                }
+            }
+            ++rows;
+        }
+        while (result->NextRow());
+
+        return rows;
+    };
+
+    uint64 textChecksum = 0, binaryChecksum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    uint64 textRows = readAll(WorldDatabase.PQuery("SELECT * FROM %s", table), textChecksum);
+    auto textTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    uint64 binaryRows = readAll(WorldDatabase.PQueryBinary("SELECT * FROM %s", table), binaryChecksum);
+    auto binaryTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    PSendSysMessage("%s: " UI64FMTD " rows, text %u ms, binary %u ms%s", table, textRows, uint32(textTime), uint32(binaryTime),
+                    textRows != binaryRows || textChecksum != binaryChecksum ? " - RESULTS DIFFER" : "");
+    if (!WorldDatabase.IsBinaryResultsEnabled())
+        SendSysMessage("DatabaseBinaryResults is disabled, both runs used the text protocol");
+
+    return true;
+}
+
+// Replays a random walk through a snapshot of the objects around the own position, the player itself does not move
+// and nothing is sent. Every step computes the visible set with a full scan and with the interest band Camera uses
+// for small moves, the sets are compared at every step. The snapshot is static, moving objects and the ones Camera
+// always rechecks (passengers, stealthed gameobjects) are left out
+bool ChatHandler::HandleDebugVisibilityBenchmark(char* args)
+{
+    uint32 steps;
+    if (!ExtractOptUInt32(&args, steps, 1000))
+        return false;
+
+    if (World::GetVisibilityIncrementalDistance() <= 0.0f)
+    {
+        SendSysMessage("Visibility.IncrementalDistance is 0, small moves always use full updates");
+        SetSentErrorMessage(true);
+        return false;
+    }
+
+    struct SnapshotObject
+    {
+        ObjectGuid guid;
+        float x, y;
+        float edge;                                         // same distance as Camera::AddInterest
+    };
+
+    Player* player = m_session->GetPlayer();
+    float const radius = player->GetVisibilityData().GetVisibilityDistance();
+    float const walkRadius = 60.0f;
+
+    std::vector<SnapshotObject> objects;
+    auto collect = [&](WorldObject* object)
+    {
+        if (object == player || object->GetTransport() || (object->GetTypeId() == TYPEID_GAMEOBJECT && object->GetVisibilityData().GetStealthMask()))
+            return;
+
+        float const edge = object->GetVisibilityData().GetVisibilityDistance() + object->GetCombatReach() + player->GetCombatReach();
+        objects.push_back({ object->GetObjectGuid(), object->GetPositionX(), object->GetPositionY(), edge });
+    };
+    MaNGOS::WorldObjectWorker<decltype(collect)> worker(player, collect);
+    Cell::VisitAllObjects(player, worker, radius + walkRadius + World::GetVisibilityIncrementalDistance());
+
+    // random walk with a bit more than the relocation limit per step, kept near the start
+    std::vector<std::pair<float, float>> trace;
+    float const stepLength = VisibilityInterestBand::GetSlack() + 2.0f;
+    float const startX = player->GetPositionX(), startY = player->GetPositionY();
+    float x = startX, y = startY, orientation = player->GetOrientation();
+    for (uint32 i = 0; i < steps; ++i)
+    {
+        if ((x - startX) * (x - startX) + (y - startY) * (y - startY) > walkRadius * walkRadius)
+            orientation = atan2(startY - y, startX - x);
+        else
+            orientation += frand(-M_PI_F / 4, M_PI_F / 4);
+
+        x += stepLength * cos(orientation);
+        y += stepLength * sin(orientation);
+        trace.emplace_back(x, y);
+    }
+
+    std::unordered_map<ObjectGuid, SnapshotObject const*> byGuid;
+    for (SnapshotObject const& object : objects)
+        byGuid[object.guid] = &object;
+
+    auto distance = [](SnapshotObject const& object, float px, float py)
+    {
+        return sqrt((object.x - px) * (object.x - px) + (object.y - py) * (object.y - py));
+    };
+
+    // the full scan of Camera::UpdateVisibilityForOwner with the distance check the band is built on,
+    // optionally recording the band like it does
+    auto fullScan = [&](float px, float py, GuidHashSet& visible, VisibilityInterestBand* band)
+    {
+        visible.clear();
+        if (band)
+            band->Clear();
+
+        for (SnapshotObject const& object : objects)
+        {
+            float const dist = distance(object, px, py);
+            if (dist <= object.edge)
+                visible.insert(object.guid);
+            if (band)
+                band->Add(object.guid, dist, object.edge);
+        }
+
+        if (band)
+            band->Finish(px, py, radius);
+    };
+
+    typedef std::chrono::steady_clock Clock;
+    std::vector<GuidHashSet> fullSets(trace.size());
+
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < trace.size(); ++i)
+        fullScan(trace[i].first, trace[i].second, fullSets[i], nullptr);
+    auto fullTime = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+
+    uint32 fullUpdates = 0, mismatchedSteps = 0, mismatchedObjects = 0;
+
+    // Camera::UpdateVisibilityOnRelocation, the set is kept from step to step
+    auto replay = [&](bool verify)
+    {
+        VisibilityInterestBand band;
+        GuidHashSet visible;
+        for (size_t i = 0; i < trace.size(); ++i)
+        {
+            float const px = trace[i].first, py = trace[i].second;
+            float moved;
+            if (!band.CanUpdate(px, py, radius, moved))
+            {
+                fullScan(px, py, visible, &band);
+                if (!verify)
+                    ++fullUpdates;
+            }
+            else
+            {
+                band.VisitCandidates(moved, [&](ObjectGuid const& guid)
+                {
+                    SnapshotObject const& object = *byGuid[guid];
+                    if (distance(object, px, py) <= object.edge)
+                        visible.insert(guid);
+                    else
+                        visible.erase(guid);
+                });
+            }
+
+            if (!verify)
+                continue;
+
+            uint32 differences = 0;
+            for (ObjectGuid const& guid : fullSets[i])
+                if (!visible.count(guid))
+                    ++differences;
+            for (ObjectGuid const& guid : visible)
+                if (!fullSets[i].count(guid))
+                    ++differences;
+
+            if (differences)
+            {
+                ++mismatchedSteps;
+                mismatchedObjects += differences;
+            }
+        }
+    };
+
+    start = Clock::now();
+    replay(false);
+    auto incrementalTime = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+    replay(true);
+
+    PSendSysMessage("Visibility replay of %u steps over %u objects: full scan %u us, interest band %u us with %u full updates",
+                    steps, uint32(objects.size()), uint32(fullTime), uint32(incrementalTime), fullUpdates);
+    PSendSysMessage("%u steps differ from the full scan, %u objects in total", mismatchedSteps, mismatchedObjects);
+    return true;
+}
+
+// Terrain queries along random paths around the own position, one point at a time against the batched
+// calls. The raw .map heights show the batching itself, the water levels include the vmap lookups
+bool ChatHandler::HandleDebugTerrainBenchmark(char* args)
+{
+    uint32 paths;
+    if (!ExtractOptUInt32(&args, paths, 64))
+        return false;
+
+    Player* player = m_session->GetPlayer();
+    TerrainInfo const* terrain = player->GetTerrain();
+
+    // paths of 2 yard steps as the path finder produces them
+    uint32 const pathLength = 64;
+    uint32 const count = paths * pathLength;
+    std::vector<float> x, y, z(count, player->GetPositionZ());
+    for (uint32 i = 0; i < paths; ++i)
+    {
+        float px = player->GetPositionX() + frand(-100.0f, 100.0f);
+        float py = player->GetPositionY() + frand(-100.0f, 100.0f);
+        float orientation = frand(0.0f, 2 * M_PI_F);
+        for (uint32 j = 0; j < pathLength; ++j)
+        {
+            orientation += frand(-M_PI_F / 8, M_PI_F / 8);
+            px += 2.0f * cos(orientation);
+            py += 2.0f * sin(orientation);
+            x.push_back(px);
+            y.push_back(py);
+        }
+    }
+
+    uint32 const rounds = 10;
+    std::vector<float> scalar(count), batch(count);
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32 n = 0; n < rounds; ++n)
+        for (uint32 i = 0; i < count; ++i)
+            scalar[i] = terrain->GetHeightStatic(x[i], y[i], z[i], false);
+    auto scalarTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (uint32 n = 0; n < rounds; ++n)
+        terrain->GetHeightsStatic(x.data(), y.data(), z.data(), batch.data(), count, false);
+    auto batchTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    uint32 differences = 0;
+    for (uint32 i = 0; i < count; ++i)
+        if (scalar[i] != batch[i])
+            ++differences;
+
+    PSendSysMessage("Map heights of %u points, ns per point: scalar %u batch %u, %u differ", count,
+                    uint32(scalarTime / (rounds * count)), uint32(batchTime / (rounds * count)), differences);
+
+    start = std::chrono::steady_clock::now();
+    for (uint32 i = 0; i < count; ++i)
+        scalar[i] = terrain->GetWaterLevel(x[i], y[i], z[i]);
+    scalarTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    terrain->GetWaterLevels(x.data(), y.data(), z.data(), batch.data(), count);
+    batchTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    differences = 0;
+    for (uint32 i = 0; i < count; ++i)
+        if (scalar[i] != batch[i])
+            ++differences;
+
+    PSendSysMessage("Water levels of %u points, ns per point: scalar %u batch %u, %u differ", count,
+                    uint32(scalarTime / count), uint32(batchTime / count), differences);
+
+    return true;
+}
+
+// Starts recording the static line of sight queries of all maps, 0 stops it
+bool ChatHandler::HandleDebugLosRecordCommand(char* args)
+{
+    uint32 count;
+    if (!ExtractUInt32(&args, count))
+        return false;
+
+    count = std::min(count, 1000000u);
+    VMAP::VMapManager2* vmgr = static_cast<VMAP::VMapManager2*>(VMAP::VMapFactory::createOrGetVMapManager());
+    vmgr->startQueryLog(count);
+    if (count)
+        PSendSysMessage("Recording the next %u line of sight queries", count);
+    else
+        SendSysMessage("Line of sight query recording stopped");
+    return true;
+}
+
+bool ChatHandler::HandleDebugLosSaveCommand(char* args)
+{
+    char* fileName = ExtractQuotedOrLiteralArg(&args);
+    if (!fileName)
+        return false;
+
+    std::vector<VMAP::RecordedLineOfSightQuery> queries;
+    static_cast<VMAP::VMapManager2*>(VMAP::VMapFactory::createOrGetVMapManager())->getQueryLog(queries);
+
+    std::ofstream file(fileName);
+    if (!file)
+    {
+        PSendSysMessage("Could not open %s", fileName);
+        SetSentErrorMessage(true);
+        return false;
+    }
+
+    file.precision(9);
+    for (VMAP::RecordedLineOfSightQuery const& query : queries)
+        file << query.mapId << " " << query.ignoreM2Model << " " << query.query.x1 << " " << query.query.y1 << " " << query.query.z1
+             << " " << query.query.x2 << " " << query.query.y2 << " " << query.query.z2 << "\n";
+
+    PSendSysMessage("%u line of sight queries written to %s", uint32(queries.size()), fileName);
+    return true;
+}
+
+// Replays recorded line of sight queries one by one and in batches of consecutive queries of the same map.
+// Only maps with loaded vmap tiles give meaningful numbers, queries of others are answered without a tree
+bool ChatHandler::HandleDebugLosBenchmark(char* args)
+{
+    VMAP::VMapManager2* vmgr = static_cast<VMAP::VMapManager2*>(VMAP::VMapFactory::createOrGetVMapManager());
+
+    std::vector<VMAP::RecordedLineOfSightQuery> queries;
+    uint32 rounds;
+    if (!ExtractOptUInt32(&args, rounds, 10))
+    {
+        char* fileName = ExtractQuotedOrLiteralArg(&args);
+        if (!fileName || !ExtractOptUInt32(&args, rounds, 10))
+            return false;
+
+        std::ifstream file(fileName);
+        if (!file)
+        {
+            PSendSysMessage("Could not open %s", fileName);
+            SetSentErrorMessage(true);
+            return false;
+        }
+
+        VMAP::RecordedLineOfSightQuery query;
+        while (file >> query.mapId >> query.ignoreM2Model >> query.query.x1 >> query.query.y1 >> query.query.z1 >> query.query.x2 >> query.query.y2 >> query.query.z2)
+            queries.push_back(query);
+    }
+    else
+        vmgr->getQueryLog(queries);
+
+    if (queries.empty() || !rounds)
+    {
+        SendSysMessage("No line of sight queries to replay, record some with .debug perf losrecord");
+        SetSentErrorMessage(true);
+        return false;
+    }
+
+    uint32 const count = queries.size();
+    std::vector<VMAP::LineOfSightQuery> lineQueries;
+    for (VMAP::RecordedLineOfSightQuery const& query : queries)
+        lineQueries.push_back(query.query);
+
+    std::unique_ptr<bool[]> scalar(new bool[count]);
+    std::unique_ptr<bool[]> batch(new bool[count]);
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32 n = 0; n < rounds; ++n)
+    {
+        for (uint32 i = 0; i < count; ++i)
+        {
+            VMAP::LineOfSightQuery const& query = lineQueries[i];
+            scalar[i] = vmgr->isInLineOfSight(queries[i].mapId, query.x1, query.y1, query.z1, query.x2, query.y2, query.z2, queries[i].ignoreM2Model);
+        }
+    }
+    auto scalarTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    uint32 batches = 0;
+    start = std::chrono::steady_clock::now();
+    for (uint32 n = 0; n < rounds; ++n)
+    {
+        batches = 0;
+        for (uint32 first = 0; first < count;)
+        {
+            uint32 end = first + 1;
+            while (end < count && queries[end].mapId == queries[first].mapId && queries[end].ignoreM2Model == queries[first].ignoreM2Model)
+                ++end;
+
+            vmgr->isInLineOfSight(queries[first].mapId, &lineQueries[first], &batch[first], end - first, queries[first].ignoreM2Model);
+            ++batches;
+            first = end;
+        }
+    }
+    auto batchTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    uint32 blocked = 0;
+    uint32 differences = 0;
+    for (uint32 i = 0; i < count; ++i)
+    {
+        if (!scalar[i])
+            ++blocked;
+        if (scalar[i] != batch[i])
+            ++differences;
+    }
+
+    PSendSysMessage("Line of sight of %u queries in %u batches, ns per query: scalar %u batch %u, %u blocked, %u differ", count, batches,
+                    uint32(scalarTime / (rounds * count)), uint32(batchTime / (rounds * count)), blocked, differences);
+    return true;
+}
+
+bool ChatHandler::HandleDebugLosCacheCommand(char* /*args*/)
+{
+    LineOfSightCache& cache = m_session->GetPlayer()->GetMap()->GetLineOfSightCache();
+    LineOfSightCacheStats stats = cache.GetStats();
+
+    PSendSysMessage("Line of sight cache of this map: %u entries, " UI64FMTD " lookups, %.1f%% hits, " UI64FMTD " invalidations%s",
+                    cache.GetSize(), stats.lookups, stats.lookups ? 100.0f * stats.hits / stats.lookups : 0.0f, stats.invalidations,
+                    sWorld.getConfig(CONFIG_BOOL_VMAP_LOS_CACHE) ? "" : " (disabled)");
+    if (stats.verified)
+        PSendSysMessage("Verified hits: " UI64FMTD ", " UI64FMTD " differ from the trees (%.3f%%)%s", stats.verified, stats.mismatches,
+                        100.0f * stats.mismatches / stats.verified, sWorld.getConfig(CONFIG_BOOL_VMAP_LOS_CACHE_VERIFY) ? "" : " (verify disabled)");
+    return true;
+}
+
+namespace
+{
+    struct EventCheckRecord
+    {
+        EventCheckRecord() : event(nullptr), dueTime(0), order(0), runTime(0), runStep(0), killed(false), runs(0) {}
+
+        BasicEvent* event;
+        uint64 dueTime;
+        uint64 order;                                       // events due at the same time run in this order
+        uint64 runTime;
+        uint32 runStep;
+        bool killed;
+        uint32 runs;
+    };
+
+    class CheckedEvent : public BasicEvent
+    {
+        public:
+            CheckedEvent(std::vector<EventCheckRecord>& records, std::vector<uint32>& runOrder, uint32 id) : m_records(records), m_runOrder(runOrder), m_id(id) {}
+
+            bool Execute(uint64 e_time, uint32 p_time) override
+            {
+                EventCheckRecord& record = m_records[m_id];
+                record.runTime = e_time;
+                record.runStep = p_time;
+                ++record.runs;
+                m_runOrder.push_back(m_id);
+                return true;
+            }
+
+        private:
+            std::vector<EventCheckRecord>& m_records;
+            std::vector<uint32>& m_runOrder;
+            uint32 m_id;
+    };
+}
+
+// Runs events through an event processor and checks that they ran once, in time and in order, and that
+// killed ones did not run. Due times reach past all wheel levels, [events] [seed]
+bool ChatHandler::HandleDebugEventsBenchmark(char* args)
+{
+    uint32 eventCount, seed;
+    if (!ExtractOptUInt32(&args, eventCount, 2000) || !ExtractOptUInt32(&args, seed, 1))
+        return false;
+
+    if (!eventCount)
+        return false;
+
+    std::mt19937 random(seed);
+    // mostly near, like spell and script events, some on each higher wheel level and some beyond all of them
+    auto randomDelay = [&random]() -> uint64
+    {
+        uint32 const roll = random() % 100;
+        uint64 const range = roll < 50 ? 4096 : roll < 75 ? 262144 : roll < 90 ? 16777216 : 50000000;
+        return 1 + random() % range;
+    };
+
+    std::vector<EventCheckRecord> records(eventCount);
+    std::vector<uint32> runOrder;
+    runOrder.reserve(eventCount);
+    uint64 order = 0;
+
+    EventProcessor processor;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32 i = 0; i < eventCount; ++i)
+    {
+        EventCheckRecord& record = records[i];
+        record.event = new CheckedEvent(records, runOrder, i);
+        record.dueTime = processor.CalculateTime(randomDelay());
+        record.order = order++;
+        processor.AddEvent(record.event, record.dueTime);
+    }
+    auto addTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    bool const wheel = processor.HasWheel();
+
+    // rescheduled and killed before the first update
+    for (uint32 i = 0; i < eventCount; i += 5)
+    {
+        EventCheckRecord& record = records[i];
+        record.dueTime = processor.CalculateTime(randomDelay());
+        record.order = order++;
+        processor.ModifyEventTime(record.event, record.dueTime);
+    }
+    for (uint32 i = 3; i < eventCount; i += 7)
+    {
+        records[i].killed = true;
+        processor.KillEvent(records[i].event);
+    }
+
+    uint32 updates = 0;
+    bool killedRunning = false;
+    start = std::chrono::steady_clock::now();
+    while (processor.HasEvents())
+    {
+        processor.Update(1 + random() % 2000);
+        ++updates;
+
+        // and some while the wheel is running
+        if (!killedRunning && processor.GetEventCount() < eventCount / 2)
+        {
+            killedRunning = true;
+            for (uint32 i = 1; i < eventCount; i += 11)
+            {
+                EventCheckRecord& record = records[i];
+                if (record.killed || record.runs)
+                    continue;
+
+                record.killed = true;
+                processor.KillEvent(record.event);
+            }
+        }
+    }
+    auto updateTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    uint32 killed = 0, lost = 0, killedRun = 0, mistimed = 0, misordered = 0;
+    for (EventCheckRecord const& record : records)
+    {
+        if (record.killed)
+        {
+            ++killed;
+            if (record.runs)
+                ++killedRun;
+            continue;
+        }
+
+        if (record.runs != 1)
+            ++lost;
+        // must run in the update that reached its time
+        else if (record.runTime < record.dueTime || record.runTime - record.runStep >= record.dueTime)
+            ++mistimed;
+    }
+
+    for (uint32 i = 1; i < runOrder.size(); ++i)
+    {
+        EventCheckRecord const& prev = records[runOrder[i - 1]];
+        EventCheckRecord const& next = records[runOrder[i]];
+        if (next.dueTime < prev.dueTime || (next.dueTime == prev.dueTime && next.order < prev.order))
+            ++misordered;
+    }
+
+    PSendSysMessage("%u events (%s), %u killed, %u ran in %u updates: add %u us, updates %u us",
+                    eventCount, wheel ? "timing wheel" : "list", killed, uint32(runOrder.size()), updates, uint32(addTime), uint32(updateTime));
+    if (lost || killedRun || mistimed || misordered)
+        PSendSysMessage("FAILED: %u did not run once, %u ran after being killed, %u ran at the wrong time, %u ran out of order",
+                        lost, killedRun, mistimed, misordered);
+    else
+        SendSysMessage("Order and cancellation are correct");
+
+    return true;
+}
+
+// A fight of the own character against the selected unit, best a raid training dummy, [rounds]
+// every round sends swings, crits, a melee ability, a spell hit and a dot tick through Unit::ProcDamageAndSpell for both
+// sides, alternating between the proc flag index and looking at every holder like before it. The procs really happen
+// on both units, they are timed together with the lookup since that is what a fight pays
+bool ChatHandler::HandleDebugProcsBenchmark(char* args)
+{
+    uint32 rounds;
+    if (!ExtractOptUInt32(&args, rounds, 1000) || !rounds)
+        return false;
+
+    Player* player = m_session->GetPlayer();
+    Unit* target = getSelectedUnit();
+    if (!target || target == player)
+    {
+        SendSysMessage(LANG_SELECT_CHAR_OR_CREATURE);
+        SetSentErrorMessage(true);
+        return false;
+    }
+
+    SpellEntry const* ability = sSpellTemplate.LookupEntry<SpellEntry>(78);     // Heroic Strike
+    SpellEntry const* nuke = sSpellTemplate.LookupEntry<SpellEntry>(133);       // Fireball
+    SpellEntry const* dot = sSpellTemplate.LookupEntry<SpellEntry>(172);        // Corruption
+
+    auto fight = [&]()
+    {
+        Unit::ProcDamageAndSpell(ProcSystemArguments(player, target, PROC_FLAG_DEAL_MELEE_SWING | PROC_FLAG_MAIN_HAND_WEAPON_SWING,
+                                 PROC_FLAG_TAKE_MELEE_SWING | PROC_FLAG_TAKE_ANY_DAMAGE, PROC_EX_NORMAL_HIT, 1000, 0));
+        Unit::ProcDamageAndSpell(ProcSystemArguments(player, target, PROC_FLAG_DEAL_MELEE_SWING | PROC_FLAG_MAIN_HAND_WEAPON_SWING,
+                                 PROC_FLAG_TAKE_MELEE_SWING | PROC_FLAG_TAKE_ANY_DAMAGE, PROC_EX_CRITICAL_HIT, 2000, 0));
+        Unit::ProcDamageAndSpell(ProcSystemArguments(player, target, PROC_FLAG_DEAL_MELEE_ABILITY, PROC_FLAG_TAKE_MELEE_ABILITY | PROC_FLAG_TAKE_ANY_DAMAGE,
+                                 PROC_EX_NORMAL_HIT, 1500, 0, BASE_ATTACK, ability));
+        Unit::ProcDamageAndSpell(ProcSystemArguments(player, target, PROC_FLAG_DEAL_HARMFUL_SPELL, PROC_FLAG_TAKE_HARMFUL_SPELL | PROC_FLAG_TAKE_ANY_DAMAGE,
+                                 PROC_EX_NORMAL_HIT, 1200, 0, BASE_ATTACK, nuke));
+        Unit::ProcDamageAndSpell(ProcSystemArguments(player, target, PROC_FLAG_DEAL_HARMFUL_PERIODIC, PROC_FLAG_TAKE_HARMFUL_PERIODIC | PROC_FLAG_TAKE_ANY_DAMAGE,
+                                 PROC_EX_NORMAL_HIT, 300, 0, BASE_ATTACK, dot));
+    };
+    uint32 const eventsPerRound = 5;
+
+    typedef std::chrono::steady_clock Clock;
+    uint64 indexTime = 0, walkTime = 0;
+    uint32 indexEvents = 0, walkEvents = 0;
+    for (uint32 round = 0; round < rounds && target->IsInWorld(); ++round)
+    {
+        // procs put cooldowns on and use up charges, both ways get every other round
+        bool const bypass = round % 2 != 0;
+        player->SetSpellAuraProcIndexBypass(bypass);
+        target->SetSpellAuraProcIndexBypass(bypass);
+
+        Clock::time_point start = Clock::now();
+        fight();
+        (bypass ? walkTime : indexTime) += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        (bypass ? walkEvents : indexEvents) += eventsPerRound;
+    }
+
+    player->SetSpellAuraProcIndexBypass(false);
+    if (target->IsInWorld())
+        target->SetSpellAuraProcIndexBypass(false);
+
+    PSendSysMessage("%s against %s: %u and %u auras, ns per proc event: index %u, all holders %u", player->GetName(), target->GetName(),
+                    uint32(player->GetSpellAuraHolderMap().size()), uint32(target->GetSpellAuraHolderMap().size()),
+                    uint32(indexTime / std::max(1u, indexEvents)), uint32(walkTime / std::max(1u, walkEvents)));
+    return true;
+}
+
+// Sums up the modifiers of every aura type of the selected unit like stat updates do, [rounds]
+// walks the aura lists of the unit directly and through the modifier getters, and checks every listed aura belongs there
+bool ChatHandler::HandleDebugAurasBenchmark(char* args)
+{
+    uint32 rounds;
+    if (!ExtractOptUInt32(&args, rounds, 10000) || !rounds)
+        return false;
+
+    Unit* unit = getSelectedUnit();
+    if (!unit)
+    {
+        SendSysMessage(LANG_SELECT_CHAR_OR_CREATURE);
+        SetSentErrorMessage(true);
+        return false;
+    }
+
+    uint32 auraCount = 0, listsWithHoles = 0, misplaced = 0;
+    for (uint32 type = 0; type < TOTAL_AURAS; ++type)
+    {
+        Unit::AuraList const& auras = unit->GetAurasByType(AuraType(type));
+        uint32 walked = 0;
+        for (Aura* aura : auras)
+        {
+            ++walked;
+            if (aura->GetModifier()->m_auraname != type)
+                ++misplaced;
+        }
+
+        if (walked != auras.size())
+            ++misplaced;
+        if (auras.HasHoles())
+            ++listsWithHoles;
+        auraCount += walked;
+    }
+
+    int64 walkResult = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32 round = 0; round < rounds; ++round)
+    {
+        for (uint32 type = 0; type < TOTAL_AURAS; ++type)
+        {
+            int32 total = 0;
+            for (Aura* aura : unit->GetAurasByType(AuraType(type)))
+                total += aura->GetModifier()->m_amount;
+            walkResult += total;
+        }
+    }
+    uint64 walkTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    int64 totalResult = 0, maxResult = 0;
+    start = std::chrono::steady_clock::now();
+    for (uint32 round = 0; round < rounds; ++round)
+    {
+        for (uint32 type = 0; type < TOTAL_AURAS; ++type)
+        {
+            totalResult += unit->GetTotalAuraModifier(AuraType(type));
+            maxResult += unit->GetMaxPositiveAuraModifier(AuraType(type));
+        }
+    }
+    uint64 getterTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    uint32 lookups = rounds * TOTAL_AURAS;
+    PSendSysMessage("%s: %u auras in %u holders, %u aura lists with empty slots, %u lookups of every aura type", unit->GetName(), auraCount,
+                    uint32(unit->GetSpellAuraHolderMap().size()), listsWithHoles, lookups);
+    PSendSysMessage("ns per aura type: list walk %.1f total and max positive modifier %.1f%s%s", double(walkTime) / lookups, double(getterTime) / lookups,
+                    walkResult == totalResult ? "" : " (totals differ!)", misplaced ? " (aura lists inconsistent!)" : "");
+    return true;
+}
+
+// Searches the living units around the selected unit like area spells do, [radius] [rounds]
+// compares the visit of the grid cells in range against the unit spatial index of the map
+bool ChatHandler::HandleDebugAoeBenchmark(char* args)
+{
+    uint32 radius;
+    if (!ExtractOptUInt32(&args, radius, 10) || !radius)
+        return false;
+
+    uint32 rounds;
+    if (!ExtractOptUInt32(&args, rounds, 10000) || !rounds)
+        return false;
+
+    Unit* unit = getSelectedUnit();
+    if (!unit)
+    {
+        SendSysMessage(LANG_SELECT_CHAR_OR_CREATURE);
+        SetSentErrorMessage(true);
+        return false;
+    }
+
+    MaNGOS::AnyUnitInObjectRangeCheck check(unit, float(radius));
+
+    uint64 gridTargets = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32 round = 0; round < rounds; ++round)
+    {
+        UnitList targets;
+        MaNGOS::UnitListSearcher<MaNGOS::AnyUnitInObjectRangeCheck> searcher(targets, check);
+        Cell::VisitAllObjects(unit, searcher, float(radius));
+        gridTargets += targets.size();
+    }
+    uint64 gridTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    UnitSpatialIndex& unitIndex = unit->GetMap()->GetUnitSpatialIndex();
+    float range = float(radius) + unit->GetCombatReach();
+    uint64 indexTargets = 0;
+    start = std::chrono::steady_clock::now();
+    for (uint32 round = 0; round < rounds; ++round)
+    {
+        UnitList targets;
+        unitIndex.VisitUnitsInSquare(unit->GetPositionX(), unit->GetPositionY(), range, [&](Unit* target)
+        {
+            if (check(target))
+                targets.push_back(target);
+        });
+        indexTargets += targets.size();
+    }
+    uint64 indexTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    PSendSysMessage("%s: %u units within %u yards, %u index cells on the map, %u rounds", unit->GetName(), uint32(indexTargets / rounds),
+                    radius, unitIndex.GetCellCount(), rounds);
+    PSendSysMessage("us per search: grid cells %.2f unit index %.2f%s", double(gridTime) / rounds / 1000, double(indexTime) / rounds / 1000,
+                    gridTargets == indexTargets ? "" : " (targets differ!)");
+    return true;
+}
+
+bool ChatHandler::HandleDebugStatsBenchmark(char* args)
+{
+    uint32 rounds;
+    if (!ExtractOptUInt32(&args, rounds, 1000) || !rounds)
+        return false;
+
+    Unit* unit = getSelectedUnit();
+    if (!unit)
+    {
+        SendSysMessage(LANG_SELECT_CHAR_OR_CREATURE);
+        SetSentErrorMessage(true);
+        return false;
+    }
+
+    if (!unit->CanModifyStats())
+        return false;
+
+    // an all stats buff gained and lost, like a Mark of the Wild wave
+    auto applyAllStats = [unit](bool apply)
+    {
+        for (int32 i = STAT_STRENGTH; i < MAX_STATS; ++i)
+            unit->HandleStatModifier(UnitMods(UNIT_MOD_STAT_START + i), TOTAL_VALUE, 1.0f, apply);
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32 round = 0; round < rounds; ++round)
+    {
+        applyAllStats(true);
+        applyAllStats(false);
+    }
+    uint64 singleTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (uint32 round = 0; round < rounds; ++round)
+    {
+        {
+            UnitStatNodeBatch batch(unit);
+            applyAllStats(true);
+        }
+        UnitStatNodeBatch batch(unit);
+        applyAllStats(false);
+    }
+    uint64 batchTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    PSendSysMessage("%s: %u rounds of gaining and losing 5 stats", unit->GetName(), rounds);
+    PSendSysMessage("us per round: every modifier %.2f batched %.2f", double(singleTime) / rounds / 1000, double(batchTime) / rounds / 1000);
+    return true;
+}
+
 bool ChatHandler::HandleDebugWaypoint(char* args)
 {
     Creature* target = getSelectedCreature();
@@ -22,8 +22,45 @@
 #include "Log.h"
 #include "Util/Errors.h"
 #include "Entities/Player.h"
+#include "World/World.h"
 
-Camera::Camera(Player* pl) : m_owner(*pl), m_source(pl)
+float VisibilityInterestBand::GetSlack()
+{
+    return sqrt(World::GetRelocationLowerLimitSq());
+}
+
+void VisibilityInterestBand::Add(ObjectGuid const& guid, float distance, float edge)
+{
+    float const margin = fabs(distance - edge);
+    if (margin <= World::GetVisibilityIncrementalDistance() + GetSlack())
+        m_entries.push_back({ margin, guid });
+}
+
+void VisibilityInterestBand::Finish(float x, float y, float radius)
+{
+    std::sort(m_entries.begin(), m_entries.end());
+    m_x = x;
+    m_y = y;
+    m_radius = radius;
+    m_valid = true;
+}
+
+void VisibilityInterestBand::Clear()
+{
+    m_entries.clear();
+    m_valid = false;
+}
+
+bool VisibilityInterestBand::CanUpdate(float x, float y, float radius, float& moved) const
+{
+    float const dx = x - m_x;
+    float const dy = y - m_y;
+    moved = sqrt(dx * dx + dy * dy);
+
+    return m_valid && moved <= World::GetVisibilityIncrementalDistance() && m_radius == radius;
+}
+
+Camera::Camera(Player* pl) : m_owner(*pl), m_source(pl), m_recordInterest(false)
 {
     m_source->GetViewPoint().Attach(this);
 }
@@ -111,6 +148,8 @@ void Camera::Event_AddedToWorld()
 
 void Camera::Event_RemovedFromWorld()
 {
+    ClearInterest();
+
     if (m_source == &m_owner)
     {
         m_gridRef.unlink();
@@ -145,9 +184,92 @@ template void Camera::UpdateVisibilityOf(DynamicObject*, UpdateData&, WorldObjec
 
 void Camera::UpdateVisibilityForOwner(bool addToWorld)
 {
+    ClearInterest();
+
+    float radius = addToWorld ? MAX_VISIBILITY_DISTANCE : m_source->GetVisibilityData().GetVisibilityDistance();
+    float const incrementalDistance = World::GetVisibilityIncrementalDistance();
+
+    // objects up to the incremental distance outside the range may come into view before the next full update
+    m_recordInterest = !addToWorld && incrementalDistance > 0.0f && !m_source->GetTransport();
+
     MaNGOS::VisibleNotifier notifier(*this);
-    Cell::VisitAllObjects(m_source, notifier, addToWorld ? MAX_VISIBILITY_DISTANCE : m_source->GetVisibilityData().GetVisibilityDistance(), false);
+    Cell::VisitAllObjects(m_source, notifier, m_recordInterest ? radius + incrementalDistance + VisibilityInterestBand::GetSlack() : radius, false);
     notifier.Notify();
+
+    if (m_recordInterest)
+    {
+        m_interestBand.Finish(m_source->GetPositionX(), m_source->GetPositionY(), radius);
+        m_recordInterest = false;
+    }
+}
+
+void Camera::UpdateVisibilityOnRelocation()
+{
+    float moved;
+    if (!m_source->IsInWorld() ||
+            !m_interestBand.CanUpdate(m_source->GetPositionX(), m_source->GetPositionY(), m_source->GetVisibilityData().GetVisibilityDistance(), moved))
+    {
+        UpdateVisibilityForOwner();
+        return;
+    }
+
+    Map* map = m_owner.GetMap();
+    UpdateData data;
+    WorldObjectSet visibleNow;
+
+    m_interestBand.VisitCandidates(moved, [&](ObjectGuid const& guid)
+    {
+        if (WorldObject* target = map->GetWorldObject(guid))
+            UpdateVisibilityOfAny(target, data, visibleNow);
+    });
+
+    for (ObjectGuid const& guid : m_interestWatched)
+        if (WorldObject* target = map->GetWorldObject(guid))
+            UpdateVisibilityOfAny(target, data, visibleNow);
+
+    MaNGOS::VisibleNotifier::SendVisibilityChanges(m_owner, data, visibleNow);
+}
+
+void Camera::UpdateVisibilityOfAny(WorldObject* target, UpdateData& data, WorldObjectSet& vis)
+{
+    switch (target->GetTypeId())
+    {
+        case TYPEID_UNIT:           UpdateVisibilityOf(static_cast<Creature*>(target), data, vis); break;
+        case TYPEID_PLAYER:         UpdateVisibilityOf(static_cast<Player*>(target), data, vis); break;
+        case TYPEID_GAMEOBJECT:     UpdateVisibilityOf(static_cast<GameObject*>(target), data, vis); break;
+        case TYPEID_DYNAMICOBJECT:  UpdateVisibilityOf(static_cast<DynamicObject*>(target), data, vis); break;
+        case TYPEID_CORPSE:         UpdateVisibilityOf(static_cast<Corpse*>(target), data, vis); break;
+        default: break;
+    }
+}
+
+void Camera::AddInterest(WorldObject* target)
+{
+    if (target == m_source || target == &m_owner)
+        return;
+
+    // not only bound by distance, always rechecked
+    if (target->GetTransport() || (target->GetTypeId() == TYPEID_GAMEOBJECT && target->GetVisibilityData().GetStealthMask()))
+    {
+        m_interestWatched.insert(target->GetObjectGuid());
+        return;
+    }
+
+    // same distance as in WorldObject::_IsWithinDist used by the visibility checks
+    float const edge = target->GetVisibilityData().GetVisibilityDistance() + target->GetCombatReach() + m_source->GetCombatReach();
+    m_interestBand.Add(target->GetObjectGuid(), sqrt(target->GetDistance(m_source, false, DIST_CALC_NONE)), edge);
+}
+
+void Camera::AddWatched(WorldObject const* target)
+{
+    if (m_interestBand.IsValid() && target != m_source)
+        m_interestWatched.insert(target->GetObjectGuid());
+}
+
+void Camera::ClearInterest()
+{
+    m_interestBand.Clear();
+    m_interestWatched.clear();
 }
 
 //////////////////
@@ -27,6 +27,57 @@ class ViewPoint;
 class UpdateData;
 class WorldPacket;
 
+/// Objects near their visibility edge at the last full visibility update of a viewpoint, only they can change
+/// their state while the viewpoint stays within the incremental distance of where that update happened
+class VisibilityInterestBand
+{
+    public:
+        VisibilityInterestBand() : m_x(0.0f), m_y(0.0f), m_radius(0.0f), m_valid(false) {}
+
+        // objects move up to the relocation limit without updating visibility, the band covers that on top of the own movement
+        static float GetSlack();
+
+        // distance is the 2d distance between viewpoint and object, edge the distance at which the object changes its state
+        void Add(ObjectGuid const& guid, float distance, float edge);
+        // the full update at x, y with the given visibility distance is done
+        void Finish(float x, float y, float radius);
+        void Clear();
+        bool IsValid() const { return m_valid; }
+
+        // false when the viewpoint at x, y needs a full update, otherwise moved is the distance since the last one
+        bool CanUpdate(float x, float y, float radius, float& moved) const;
+
+        // visibility is a 2d distance check, an object can only have changed state if the viewpoint
+        // moved at least as far as the object was from its visibility edge
+        template<class Visit>
+        void VisitCandidates(float moved, Visit const& visit) const
+        {
+            float const reach = moved + GetSlack();
+            for (Entry const& entry : m_entries)
+            {
+                if (entry.margin > reach)
+                    break;
+
+                visit(entry.guid);
+            }
+        }
+
+    private:
+        struct Entry
+        {
+            float margin;                                   // distance to the visibility edge at the last full update
+            ObjectGuid guid;
+
+            bool operator<(Entry const& other) const { return margin < other.margin; }
+        };
+
+        std::vector<Entry> m_entries;                       // sorted by margin
+        float m_x;
+        float m_y;
+        float m_radius;
+        bool m_valid;
+};
+
 /// Camera - object-receiver. Receives broadcast packets from nearby worldobjects, object visibility changes and sends them to client
 class Camera
 {
@@ -50,6 +101,7 @@ class Camera
         template<class T>
         void UpdateVisibilityOf(T* target, UpdateData& data, WorldObjectSet& vis);
         void UpdateVisibilityOf(WorldObject* target) const;
+        void UpdateVisibilityOfAny(WorldObject* target, UpdateData& data, WorldObjectSet& vis);
 
         void ReceivePacket(WorldPacket const& data) const;
 
@@ -57,6 +109,13 @@ class Camera
         void UpdateVisibilityForOwner() { UpdateVisibilityForOwner(false); }
         void UpdateVisibilityForOwner(bool addToWorld);
 
+        // viewpoint moved, only rechecks objects near their visibility edge unless it moved too far since the last full update
+        void UpdateVisibilityOnRelocation();
+
+        // interest of the last full update, filled by MaNGOS::VisibleNotifier and MaNGOS::VisibleChangesNotifier
+        void RecordInterest(WorldObject* target) { if (m_recordInterest) AddInterest(target); }
+        void AddWatched(WorldObject const* target);
+
     private:
         // called when viewpoint changes visibility state
         void Event_AddedToWorld();
@@ -69,6 +128,13 @@ class Camera
 
         void UpdateForCurrentViewPoint();
 
+        void AddInterest(WorldObject* target);
+        void ClearInterest();
+
+        VisibilityInterestBand m_interestBand;
+        GuidHashSet m_interestWatched;                      // moved objects and objects not bound by distance only
+        bool m_recordInterest;
+
     public:
         GridReference<Camera>& GetGridRef() { return m_gridRef; }
         bool isActiveObject() const { return false; }
@@ -136,6 +202,11 @@ class ViewPoint
         {
             CameraCall(&Camera::UpdateVisibilityForOwner);
         }
+
+        void Call_UpdateVisibilityOnRelocation()
+        {
+            CameraCall(&Camera::UpdateVisibilityOnRelocation);
+        }
 };
 
 #endif
@@ -613,7 +613,7 @@ void GameObject::Update(const uint32 diff)
             switch (GetGoType())
             {
                 case GAMEOBJECT_TYPE_TRAP:
-                    if (m_events.GetEvents().size() > 0)
+                    if (m_events.HasEvents())
                     {
                         preventDespawn = true;
                         break;
@@ -2171,7 +2171,7 @@ void GameObject::UpdateCollisionState() const
     if (!m_model || !IsInWorld())
         return;
 
-    m_model->enable(IsCollisionEnabled() ? GetPhaseMask() : 0);
+    GetMap()->EnableGameObjectModel(*m_model, IsCollisionEnabled() ? GetPhaseMask() : 0);
 }
 
 void GameObject::UpdateModel()
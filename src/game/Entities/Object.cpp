@@ -124,8 +124,7 @@ void Object::SendForcedObjectUpdate()
     {
         for (size_t i = 0; i < update_player.second.GetPacketCount(); ++i)
         {
-            WorldPacket packet = update_player.second.BuildPacket(i);
-            update_player.first->GetSession()->SendPacket(packet);
+            update_player.first->GetSession()->SendPacket(update_player.second.BuildPacket(i));
         }
     }
 }
@@ -202,8 +201,7 @@ void Object::SendCreateUpdateToPlayer(Player* player) const
 
     for (size_t i = 0; i < updateData.GetPacketCount(); ++i)
     {
-        WorldPacket packet = updateData.BuildPacket(i);
-        player->GetSession()->SendPacket(packet);
+        player->GetSession()->SendPacket(updateData.BuildPacket(i));
     }
 }
 
@@ -237,6 +235,44 @@ void Object::BuildValuesUpdateBlockForPlayer(UpdateData& data, UpdateMask& updat
     data.AddUpdateBlock(buf);
 }
 
+void Object::BuildValuesUpdateBlockForPlayer(UpdateData& data, Player* target, ValuesUpdateCache& cache) const
+{
+    uint32 viewClass;
+    if (!GetValuesViewClass(target, viewClass))
+    {
+        BuildValuesUpdateBlockForPlayer(data, target);
+        return;
+    }
+
+    for (ValuesUpdateCache::Entry const& entry : cache.entries)
+    {
+        if (entry.viewClass == viewClass)
+        {
+            if (entry.block.size())
+                data.AddUpdateBlock(entry.block);
+            return;
+        }
+    }
+
+    if (cache.entries.empty())
+        cache.entries.reserve(4);
+    cache.entries.emplace_back(viewClass);
+    ByteBuffer& block = cache.entries.back().block;
+
+    UpdateMask updateMask;
+    updateMask.SetCount(m_valuesCount);
+
+    _SetUpdateBits(updateMask, target);
+    if (!updateMask.HasData())
+        return;
+
+    block << uint8(UPDATETYPE_VALUES);
+    block << GetPackGUID();
+
+    BuildValuesUpdate(UPDATETYPE_VALUES, &block, &updateMask, target);
+    data.AddUpdateBlock(block);
+}
+
 void Object::BuildForcedValuesUpdateBlockForPlayer(UpdateData* data, Player* target) const
 {
     ByteBuffer buf(500);
@@ -985,6 +1021,47 @@ void Object::_SetUpdateBits(UpdateMask& updateMask, Player* target) const
             updateMask.SetBit(index);
 }
 
+// Observers of the same view class get the same values update. False when a changed field
+// is built differently for each observer, see BuildValuesUpdate
+bool Object::GetValuesViewClass(Player const* target, uint32& viewClass) const
+{
+    if (target == this)
+        return false;
+
+    uint16 const* flags = nullptr;
+    viewClass = GetUpdateFieldFlagsForTarget(target, flags);
+
+    switch (GetTypeId())
+    {
+        case TYPEID_UNIT:
+        case TYPEID_PLAYER:
+        {
+            Unit const* unit = static_cast<Unit const*>(this);
+            if (unit->HasAuraState(AURA_STATE_CONFLAGRATE) || m_changedValues[UNIT_DYNAMIC_FLAGS] ||
+                    (GetTypeId() == TYPEID_UNIT && m_changedValues[UNIT_NPC_FLAGS]) ||
+                    (GetTypeId() == TYPEID_PLAYER && m_changedValues[UNIT_FIELD_FACTIONTEMPLATE]))
+                return false;
+
+            // fog of war health is either exact or in percent
+            if (m_changedValues[UNIT_FIELD_HEALTH] || m_changedValues[UNIT_FIELD_MAXHEALTH])
+                if (unit->IsFogOfWarVisibleHealth(target) || target->CanSeeSpecialInfoOf(unit))
+                    viewClass |= 0x10000;
+
+            if (m_changedValues[UNIT_FIELD_FLAGS] && target->IsGameMaster())
+                viewClass |= 0x20000;
+
+            return true;
+        }
+        case TYPEID_CORPSE:
+            return !m_changedValues[CORPSE_FIELD_BYTES_1];
+        case TYPEID_GAMEOBJECT:
+            // dynamic field is part of every values update and depends on the observer's quests
+            return static_cast<GameObject const*>(this)->IsDynTransport();
+        default:
+            return true;
+    }
+}
+
 void Object::_SetCreateBits(UpdateMask& updateMask, Player* target) const
 {
     uint16 const* flags = nullptr;
@@ -1235,7 +1312,7 @@ bool Object::PrintEntryError(char const* descr) const
     return false;
 }
 
-void Object::BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_players) const
+void Object::BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_players, ValuesUpdateCache* cache /*= nullptr*/) const
 {
     UpdateDataMapType::iterator iter = update_players.find(pl);
 
@@ -1246,7 +1323,10 @@ void Object::BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_play
         iter = p.first;
     }
 
-    BuildValuesUpdateBlockForPlayer(iter->second, iter->first);
+    if (cache)
+        BuildValuesUpdateBlockForPlayer(iter->second, iter->first, *cache);
+    else
+        BuildValuesUpdateBlockForPlayer(iter->second, iter->first);
 }
 
 void Object::AddToClientUpdateList()
@@ -1361,6 +1441,9 @@ void WorldObject::_Create(uint32 guidlow, HighGuid guidhigh, uint32 phaseMask)
 
 void WorldObject::Relocate(float x, float y, float z, float orientation)
 {
+    if (isType(TYPEMASK_UNIT) && IsInWorld())
+        GetMap()->GetUnitSpatialIndex().Relocate(static_cast<Unit*>(this), m_position.x, m_position.y, x, y);
+
     m_position.x = x;
     m_position.y = y;
     m_position.z = z;
@@ -1372,6 +1455,9 @@ void WorldObject::Relocate(float x, float y, float z, float orientation)
 
 void WorldObject::Relocate(float x, float y, float z)
 {
+    if (isType(TYPEMASK_UNIT) && IsInWorld())
+        GetMap()->GetUnitSpatialIndex().Relocate(static_cast<Unit*>(this), m_position.x, m_position.y, x, y);
+
     m_position.x = x;
     m_position.y = y;
     m_position.z = z;
@@ -2097,9 +2183,12 @@ void WorldObject::SendMessageToSetExcept(WorldPacket const& data, Player const*
 void WorldObject::SendMessageToAllWhoSeeMe(WorldPacket const& data, bool /*self*/) const
 {
     if (IsInWorld())
+    {
+        BroadcastPacket broadcast(data);
         for (ObjectGuid guid : m_clientGUIDsIAmAt)
             if (Player* player = GetMap()->GetPlayer(guid))
-                player->GetSession()->SendPacket(data);
+                broadcast.AddReceiver(player->GetSession());
+    }
 }
 
 void WorldObject::SendObjectDeSpawnAnim(ObjectGuid guid) const
@@ -2661,6 +2750,7 @@ struct WorldObjectChangeAccumulator
 {
     UpdateDataMapType& i_updateDatas;
     WorldObject& i_object;
+    ValuesUpdateCache i_cache;
     WorldObjectChangeAccumulator(WorldObject& obj, UpdateDataMapType& d) : i_updateDatas(d), i_object(obj)
     {
         // send self fields changes in another way, otherwise
@@ -2675,7 +2765,7 @@ struct WorldObjectChangeAccumulator
         {
             Player* owner = iter.getSource()->GetOwner();
             if (owner != &i_object && owner->HasAtClient(&i_object))
-                i_object.BuildUpdateDataForPlayer(owner, i_updateDatas);
+                i_object.BuildUpdateDataForPlayer(owner, i_updateDatas, &i_cache);
         }
     }
 
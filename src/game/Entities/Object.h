@@ -122,6 +122,20 @@ class GenericTransport;
 
 typedef std::unordered_map<Player*, UpdateData> UpdateDataMapType;
 
+// values update blocks of one object built for one client update, shared by the observers of the same view class
+struct ValuesUpdateCache
+{
+    struct Entry
+    {
+        Entry(uint32 _viewClass) : viewClass(_viewClass), block(500) {}
+
+        uint32 viewClass;
+        ByteBuffer block;                                   // empty when nothing changed for this class
+    };
+
+    std::vector<Entry> entries;
+};
+
 // Spell cooldown flags sent in SMSG_SPELL_COOLDOWN
 enum SpellCooldownFlags
 {
@@ -440,6 +454,7 @@ class Object
         void BuildValuesUpdateBlockForPlayer(UpdateData& data, Player* target) const;
         void BuildValuesUpdateBlockForPlayerWithFlags(UpdateData& data, Player* target, UpdateFieldFlags flags) const;
         void BuildValuesUpdateBlockForPlayer(UpdateData& data, UpdateMask& updateMask, Player* target) const;
+        void BuildValuesUpdateBlockForPlayer(UpdateData& data, Player* target, ValuesUpdateCache& cache) const;
         void BuildForcedValuesUpdateBlockForPlayer(UpdateData* data, Player* target) const;
         void BuildOutOfRangeUpdateBlock(UpdateData* data) const;
         void BuildMovementUpdateBlock(UpdateData* data, uint16 flags = 0) const;
@@ -649,10 +664,11 @@ class Object
         uint16 GetUpdateFieldFlagsForTarget(Player const* target, uint16 const*& flags) const;
         void _SetUpdateBits(UpdateMask& updateMask, Player* target) const;
         void _SetCreateBits(UpdateMask& updateMask, Player* target) const;
+        bool GetValuesViewClass(Player const* target, uint32& viewClass) const;
 
         void BuildMovementUpdate(ByteBuffer* data, uint16 updateFlags) const;
         void BuildValuesUpdate(uint8 updatetype, ByteBuffer* data, UpdateMask* updateMask, Player* target) const;
-        void BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_players) const;
+        void BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_players, ValuesUpdateCache* cache = nullptr) const;
 
         uint16 m_objectType;
 
@@ -210,6 +210,166 @@ typedef std::set<ObjectGuid> GuidSet;
 typedef std::list<ObjectGuid> GuidList;
 typedef std::vector<ObjectGuid> GuidVector;
 
+/**
+ * Open addressing hash set of guids for the hot per player visibility lookups.
+ * Linear probing over a power of two table, erased slots are marked and reused at insert,
+ * so erasing while iterating keeps the iterator valid like for GuidSet. Iteration order is unspecified.
+ */
+class GuidHashSet
+{
+    private:
+        static uint64 const EMPTY_SLOT = 0;                 // the empty guid is never stored
+        static uint64 const ERASED_SLOT = ~uint64(0);
+
+    public:
+        class const_iterator
+        {
+                friend class GuidHashSet;
+            public:
+                typedef std::forward_iterator_tag iterator_category;
+                typedef ObjectGuid value_type;
+                typedef std::ptrdiff_t difference_type;
+                typedef ObjectGuid const* pointer;
+                typedef ObjectGuid const& reference;
+
+                const_iterator() : m_slot(nullptr), m_end(nullptr) {}
+
+                reference operator*() const { return *m_slot; }
+                pointer operator->() const { return m_slot; }
+                const_iterator& operator++() { ++m_slot; Skip(); return *this; }
+                const_iterator operator++(int) { const_iterator old = *this; ++*this; return old; }
+                bool operator==(const_iterator const& other) const { return m_slot == other.m_slot; }
+                bool operator!=(const_iterator const& other) const { return m_slot != other.m_slot; }
+
+            private:
+                const_iterator(ObjectGuid const* slot, ObjectGuid const* end) : m_slot(slot), m_end(end) { Skip(); }
+                void Skip()
+                {
+                    while (m_slot != m_end && IsFree(*m_slot))
+                        ++m_slot;
+                }
+
+                ObjectGuid const* m_slot;
+                ObjectGuid const* m_end;
+        };
+        typedef const_iterator iterator;
+
+        GuidHashSet() : m_size(0), m_used(0) {}
+
+        const_iterator begin() const { return const_iterator(m_slots.data(), m_slots.data() + m_slots.size()); }
+        const_iterator end() const { return const_iterator(m_slots.data() + m_slots.size(), m_slots.data() + m_slots.size()); }
+
+        bool empty() const { return !m_size; }
+        size_t size() const { return m_size; }
+
+        void clear()
+        {
+            m_slots.clear();
+            m_size = 0;
+            m_used = 0;
+        }
+
+        const_iterator find(ObjectGuid const& guid) const
+        {
+            if (m_slots.empty())
+                return end();
+
+            size_t const mask = m_slots.size() - 1;
+            for (size_t slot = Hash(guid) & mask;; slot = (slot + 1) & mask)
+            {
+                uint64 const raw = m_slots[slot].GetRawValue();
+                if (raw == guid.GetRawValue())
+                    return const_iterator(&m_slots[slot], m_slots.data() + m_slots.size());
+                if (raw == EMPTY_SLOT)
+                    return end();
+            }
+        }
+
+        size_t count(ObjectGuid const& guid) const { return find(guid) != end() ? 1 : 0; }
+
+        std::pair<const_iterator, bool> insert(ObjectGuid const& guid)
+        {
+            // keep at least half of the slots never used, probes stay short
+            if ((m_used + 1) * 2 > m_slots.size())
+                Rehash(m_size + 1);
+
+            size_t const mask = m_slots.size() - 1;
+            size_t reuse = m_slots.size();
+            size_t slot = Hash(guid) & mask;
+            for (;; slot = (slot + 1) & mask)
+            {
+                uint64 const raw = m_slots[slot].GetRawValue();
+                if (raw == guid.GetRawValue())
+                    return { const_iterator(&m_slots[slot], m_slots.data() + m_slots.size()), false };
+                if (raw == EMPTY_SLOT)
+                    break;
+                if (raw == ERASED_SLOT && reuse == m_slots.size())
+                    reuse = slot;
+            }
+
+            if (reuse != m_slots.size())
+                slot = reuse;
+            else
+                ++m_used;
+
+            m_slots[slot] = guid;
+            ++m_size;
+            return { const_iterator(&m_slots[slot], m_slots.data() + m_slots.size()), true };
+        }
+
+        template<class InputIterator>
+        void insert(InputIterator first, InputIterator last)
+        {
+            for (; first != last; ++first)
+                insert(*first);
+        }
+
+        // returns the iterator following the erased element
+        const_iterator erase(const_iterator itr)
+        {
+            const_cast<ObjectGuid&>(*itr.m_slot) = ObjectGuid(ERASED_SLOT);
+            --m_size;
+            return ++itr;
+        }
+
+        size_t erase(ObjectGuid const& guid)
+        {
+            const_iterator itr = find(guid);
+            if (itr == end())
+                return 0;
+
+            erase(itr);
+            return 1;
+        }
+
+    private:
+        static bool IsFree(ObjectGuid const& guid) { return guid.GetRawValue() == EMPTY_SLOT || guid.GetRawValue() == ERASED_SLOT; }
+
+        // guids differ mostly in the low counter bits, fibonacci hashing spreads them over the table
+        static size_t Hash(ObjectGuid const& guid) { return size_t((guid.GetRawValue() * UINT64_C(0x9E3779B97F4A7C15)) >> 32); }
+
+        void Rehash(size_t minimumSize)
+        {
+            size_t capacity = 16;
+            while (capacity < minimumSize * 4)
+                capacity <<= 1;
+
+            std::vector<ObjectGuid> old;
+            old.swap(m_slots);
+            m_slots.resize(capacity);
+            m_size = 0;
+            m_used = 0;
+
+            for (ObjectGuid const& guid : old)
+                if (!IsFree(guid))
+                    insert(guid);
+        }
+
+        std::vector<ObjectGuid> m_slots;
+        size_t m_size;                                      // stored guids
+        size_t m_used;                                      // stored plus erased slots
+};
+
 // minimum buffer size for packed guid is 9 bytes
 #define PACKED_GUID_MIN_BUFFER_SIZE 9
 
@@ -654,6 +654,7 @@ Player::Player(WorldSession* session): Unit(), m_taxiTracker(*this), m_mover(thi
     m_baseSpellPower = 0;
     m_baseFeralAP = 0;
     m_baseManaRegen = 0;
+    m_checkingStatNodes = false;
     m_armorPenetrationPct = 0.0f;
     m_spellPenetrationItemMod = 0;
 
@@ -1636,9 +1637,15 @@ void Player::Update(const uint32 diff)
     {
         if (diff >= m_nextSave)
         {
-            // m_nextSave reseted in SaveToDB call
-            SaveToDB();
-            DETAIL_LOG("Player '%s' (GUID: %u) saved", GetName(), GetGUIDLow());
+            // character database is behind, retry a bit later instead of growing its queue
+            if (sWorld.IsAutosaveThrottled())
+                m_nextSave = urand(5 * IN_MILLISECONDS, 15 * IN_MILLISECONDS);
+            else
+            {
+                // m_nextSave reseted in SaveToDB call
+                SaveToDB();
+                DETAIL_LOG("Player '%s' (GUID: %u) saved", GetName(), GetGUIDLow());
+            }
         }
         else
             m_nextSave -= diff;
@@ -7796,6 +7803,9 @@ void Player::_ApplyItemBonuses(ItemPrototype const* proto, uint8 slot, bool appl
     if (only_level_scale && !ssv)
         return;
 
+    // nothing below reads the stats, the dependent values are recomputed once for the whole item
+    UnitStatNodeBatch statBatch(this);
+
     for (uint32 i = 0; i < MAX_ITEM_PROTO_STATS; ++i)
     {
         uint32 statType;
@@ -8106,7 +8116,7 @@ void Player::_ApplyItemBonuses(ItemPrototype const* proto, uint8 slot, bool appl
         }
 
         if (CanModifyStats() && proto->Delay)
-            UpdateDamagePhysical(attType);
+            MarkStatNodesDirty(STAT_NODE_MASK(STAT_NODE_DAMAGE_MAINHAND + attType));
     }
 }
 
@@ -18160,6 +18170,9 @@ void Player::SaveToDB()
     DEBUG_FILTER_LOG(LOG_FILTER_PLAYER_STATS, "The value of player %s at save: ", m_name.c_str());
     outDebugStatsValues();
 
+    // saves of different characters may be executed in parallel, see SqlDelayPool
+    SqlAsyncKey asyncKey(GetGUIDLow());
+
     CharacterDatabase.BeginTransaction();
 
     static SqlStatementID delChar ;
@@ -18362,6 +18375,9 @@ void Player::SaveToDB()
 // fast save function for item/money cheating preventing - save only inventory and money state
 void Player::SaveInventoryAndGoldToDB()
 {
+    // items moved between characters are saved here, these writes are ordered with the saves of both, see SqlDelayPool
+    SqlAsyncKey unkeyed(0);
+
     _SaveInventory();
     SaveGoldToDB();
 }
@@ -21858,8 +21874,7 @@ void Player::UpdateForQuestWorldObjects()
     }
     for (size_t i = 0; i < updateData.GetPacketCount(); ++i)
     {
-        WorldPacket packet = updateData.BuildPacket(i);
-        GetSession()->SendPacket(packet);
+        GetSession()->SendPacket(updateData.BuildPacket(i));
     }
 }
 
@@ -22,6 +22,8 @@
 #include "Entities/Creature.h"
 #include "Globals/SharedDefines.h"
 #include "Spells/SpellAuras.h"
+#include "World/World.h"
+#include "Log.h"
 
 /*#######################################
 ########                         ########
@@ -45,21 +47,23 @@ bool Player::UpdateStats(Stats stat)
             if (Pet* pet = GetPet())
                 pet->UpdateScalingAuras();
 
+    // Need update (exist AP from stat auras)
+    uint32 nodes = STAT_NODE_MASK(STAT_NODE_ATTACK_POWER) | STAT_NODE_MASK(STAT_NODE_RANGED_ATTACK_POWER) |
+                   STAT_NODE_MASK(STAT_NODE_SPELL_BONUS) | STAT_NODE_MASK(STAT_NODE_MANA_REGEN);
+
     switch (stat)
     {
         case STAT_STRENGTH:
-            UpdateShieldBlockValue();
+            nodes |= STAT_NODE_MASK(STAT_NODE_SHIELD_BLOCK);
             break;
         case STAT_AGILITY:
-            UpdateArmor();
-            UpdateAllCritPercentages();
-            UpdateDodgePercentage();
+            nodes |= STAT_NODE_MASK(STAT_NODE_ARMOR) | STAT_NODE_MASK(STAT_NODE_CRIT) | STAT_NODE_MASK(STAT_NODE_DODGE);
+            break;
+        case STAT_STAMINA:
+            nodes |= STAT_NODE_MASK(STAT_NODE_MAX_HEALTH);
             break;
-        case STAT_STAMINA:   UpdateMaxHealth(); break;
         case STAT_INTELLECT:
-            UpdateMaxPower(POWER_MANA);
-            UpdateAllSpellCritChances();
-            UpdateArmor();                                  // SPELL_AURA_MOD_RESISTANCE_OF_INTELLECT_PERCENT, only armor currently
+            nodes |= STAT_NODE_MASK(STAT_NODE_MAX_POWER_START + POWER_MANA) | STAT_NODE_MASK(STAT_NODE_SPELL_CRIT);
             break;
 
         case STAT_SPIRIT:
@@ -68,13 +72,12 @@ bool Player::UpdateStats(Stats stat)
         default:
             break;
     }
-    // Need update (exist AP from stat auras)
-    UpdateAttackPowerAndDamage();
-    UpdateAttackPowerAndDamage(true);
 
-    UpdateSpellHealingBonus();
-    UpdateSpellDamageBonus();
-    UpdateManaRegen();
+    // SPELL_AURA_MOD_RESISTANCE_OF_STAT_PERCENT, only armor currently
+    if (HasAuraType(SPELL_AURA_MOD_RESISTANCE_OF_STAT_PERCENT))
+        nodes |= STAT_NODE_MASK(STAT_NODE_ARMOR);
+
+    MarkStatNodesDirty(nodes);
 
     // Update ratings in exist SPELL_AURA_MOD_RATING_FROM_STAT and only depends from stat
     uint32 mask = 0;
@@ -123,37 +126,99 @@ void Player::UpdateSpellDamageBonus()
 
 bool Player::UpdateAllStats()
 {
+    // every node is recomputed once when the batch ends, after the ratings the crit chances depend on
+    UnitStatNodeBatch batch(this);
+
     for (int i = STAT_STRENGTH; i < MAX_STATS; ++i)
     {
         float value = GetTotalStatValue(Stats(i));
         SetStat(Stats(i), (int32)value);
     }
 
-    UpdateArmor();
-    // calls UpdateAttackPowerAndDamage() in UpdateArmor for SPELL_AURA_MOD_ATTACK_POWER_OF_ARMOR
-    UpdateAttackPowerAndDamage(true);
-    UpdateMaxHealth();
-
-    for (int i = POWER_MANA; i < MAX_POWERS; ++i)
-        UpdateMaxPower(Powers(i));
+    // the stats are set above, their nodes would only mark the others again
+    MarkStatNodesDirty(STAT_NODE_MASK_ALL & ~(STAT_NODE_MASK(STAT_NODE_RESISTANCE_START) - 1));
 
     UpdateAllRatings();
-    UpdateAllCritPercentages();
-    UpdateAllSpellCritChances();
     UpdateDefenseBonusesMod();
-    UpdateShieldBlockValue();
     UpdateArmorPenetration();
-    UpdateSpellHealingBonus();
-    UpdateSpellDamageBonus();
-    UpdateManaRegen();
     UpdateExpertise(BASE_ATTACK);
     UpdateExpertise(OFF_ATTACK);
-    for (int i = SPELL_SCHOOL_NORMAL; i < MAX_SPELL_SCHOOL; ++i)
-        UpdateResistances(i);
 
     return true;
 }
 
+void Player::UpdateStatNode(UnitStatNode node)
+{
+    switch (node)
+    {
+        case STAT_NODE_CRIT:         UpdateAllCritPercentages();  break;
+        case STAT_NODE_DODGE:        UpdateDodgePercentage();     break;
+        case STAT_NODE_SPELL_CRIT:   UpdateAllSpellCritChances(); break;
+        case STAT_NODE_SHIELD_BLOCK: UpdateShieldBlockValue();    break;
+        case STAT_NODE_SPELL_BONUS:
+            UpdateSpellHealingBonus();
+            UpdateSpellDamageBonus();
+            break;
+        case STAT_NODE_MANA_REGEN:   UpdateManaRegen();           break;
+        default:
+            Unit::UpdateStatNode(node);
+            break;
+    }
+}
+
+void Player::CheckStatNodes()
+{
+    // the full recompute below flushes the nodes again
+    if (m_checkingStatNodes)
+        return;
+
+    // fields written by the stat nodes
+    static uint16 const checkedFields[][2] =
+    {
+        { UNIT_FIELD_STAT0,                     MAX_STATS },
+        { UNIT_FIELD_RESISTANCES,               MAX_SPELL_SCHOOL },
+        { UNIT_FIELD_MAXHEALTH,                 1 },
+        { UNIT_FIELD_MAXPOWER1,                 MAX_POWERS },
+        { UNIT_FIELD_ATTACK_POWER,              6 },        // attack power, mods and multiplier of melee and ranged
+        { UNIT_FIELD_MINDAMAGE,                 4 },        // main hand and off hand
+        { UNIT_FIELD_MINRANGEDDAMAGE,           2 },
+        { UNIT_FIELD_POWER_REGEN_FLAT_MODIFIER, 1 },
+        { PLAYER_DODGE_PERCENTAGE,              1 },
+        { PLAYER_CRIT_PERCENTAGE,               3 },        // melee, ranged and off hand
+        { PLAYER_SPELL_CRIT_PERCENTAGE1,        MAX_SPELL_SCHOOL },
+        { PLAYER_SHIELD_BLOCK,                  1 },
+        { PLAYER_FIELD_MOD_DAMAGE_DONE_POS,     MAX_SPELL_SCHOOL },
+        { PLAYER_FIELD_MOD_HEALING_DONE_POS,    1 },
+    };
+
+    std::vector<uint32> incremental;
+    for (auto const& fields : checkedFields)
+        for (uint16 i = 0; i < fields[1]; ++i)
+            incremental.push_back(GetUInt32Value(fields[0] + i));
+
+    m_checkingStatNodes = true;
+    UpdateAllStats();
+    m_checkingStatNodes = false;
+
+    bool differs = false;
+    uint32 index = 0;
+    for (auto const& fields : checkedFields)
+    {
+        for (uint16 i = 0; i < fields[1]; ++i, ++index)
+        {
+            uint32 value = GetUInt32Value(fields[0] + i);
+            if (value == incremental[index])
+                continue;
+
+            sLog.outError("Player::CheckStatNodes: %s field %u is 0x%08X after the incremental stat update, 0x%08X after a full recompute",
+                          GetGuidStr().c_str(), uint32(fields[0] + i), incremental[index], value);
+            differs = true;
+        }
+    }
+
+    MANGOS_ASSERT(!differs || sWorld.getConfig(CONFIG_UINT32_STAT_SYSTEM_CHECK) < 2);
+}
+
 void Player::UpdateResistances(uint32 school)
 {
     if (school > SPELL_SCHOOL_NORMAL)
@@ -167,7 +232,7 @@ void Player::UpdateResistances(uint32 school)
                 pet->UpdateScalingAuras();
     }
     else
-        UpdateArmor();
+        MarkStatNodesDirty(STAT_NODE_MASK(STAT_NODE_ARMOR));
 }
 
 void Player::UpdateArmor()
@@ -194,7 +259,7 @@ void Player::UpdateArmor()
         if (Pet* pet = GetPet())
             pet->UpdateScalingAuras();
     
-    UpdateAttackPowerAndDamage();                           // armor dependent auras update for SPELL_AURA_MOD_ATTACK_POWER_OF_ARMOR
+    MarkStatNodesDirty(STAT_NODE_MASK(STAT_NODE_ATTACK_POWER)); // armor dependent auras update for SPELL_AURA_MOD_ATTACK_POWER_OF_ARMOR
 }
 
 float Player::GetHealthBonusFromStamina() const
@@ -249,7 +314,7 @@ void Player::UpdateMaxPower(Powers power)
 void Player::ApplyFeralAPBonus(int32 amount, bool apply)
 {
     m_baseFeralAP += apply ? amount : -amount;
-    UpdateAttackPowerAndDamage();
+    MarkStatNodesDirty(STAT_NODE_MASK(STAT_NODE_ATTACK_POWER));
 }
 
 void Player::UpdateAttackPowerAndDamage(bool ranged)
@@ -371,16 +436,17 @@ void Player::UpdateAttackPowerAndDamage(bool ranged)
     // automatically update weapon damage after attack power modification
     if (ranged)
     {
-        UpdateDamagePhysical(RANGED_ATTACK);
+        MarkStatNodesDirty(STAT_NODE_MASK(STAT_NODE_DAMAGE_RANGED));
 
         if (Pet* pet = GetPet()) // update pet's AP
             pet->UpdateScalingAuras();
     }
     else
     {
-        UpdateDamagePhysical(BASE_ATTACK);
+        uint32 nodes = STAT_NODE_MASK(STAT_NODE_DAMAGE_MAINHAND);
         if (CanDualWield() && hasOffhandWeaponForAttack())          // allow update offhand damage only if player knows DualWield Spec and has equipped offhand weapon
-            UpdateDamagePhysical(OFF_ATTACK);
+            nodes |= STAT_NODE_MASK(STAT_NODE_DAMAGE_OFFHAND);
+        MarkStatNodesDirty(nodes);
     }
 }
 
@@ -727,7 +793,7 @@ void Player::UpdateArmorPenetration()
 void Player::ApplyManaRegenBonus(int32 amount, bool apply)
 {
     m_baseManaRegen += apply ? amount : -amount;
-    UpdateManaRegen();
+    MarkStatNodesDirty(STAT_NODE_MASK(STAT_NODE_MANA_REGEN));
 }
 
 void Player::UpdateManaRegen()
@@ -261,7 +261,8 @@ Unit::Unit() :
     m_guardianPetsIterator(m_guardianPets.end()),
     m_spellUpdateHappening(false),
     m_spellProcsHappening(false),
-    m_hasHeartbeatProcCounter(0),
+    m_spellAuraProcFlags(0),
+    m_spellAuraProcGeneration(sSpellMgr.GetSpellProcEventGeneration()),
     m_ignoreRangedTargets(false),
     m_auraUpdateMask(0),
     m_combatManager(this),
@@ -298,6 +299,9 @@ Unit::Unit() :
 
     m_transform = 0;
     m_canModifyStats = false;
+    m_dirtyStatNodes = 0;
+    m_statNodeBatchDepth = 0;
+    m_updatingStatNodes = false;
 
     for (auto& i : m_spellImmune)
         i.clear();
@@ -402,11 +406,11 @@ void Unit::Update(const uint32 diff)
         return;
 #ifdef BUILD_METRICS
     metric::duration<std::chrono::microseconds> meas("unit.update", {
-        { "entry", std::to_string(GetEntry()) },
-        { "guid", std::to_string(GetGUIDLow()) },
-        { "unit_type", std::to_string(GetGUIDHigh()) },
-        { "map_id", std::to_string(GetMapId()) },
-        { "instance_id", std::to_string(GetInstanceId()) }
+        { "entry", GetEntry() },
+        { "guid", GetGUIDLow() },
+        { "unit_type", GetGUIDHigh() },
+        { "map_id", GetMapId() },
+        { "instance_id", GetInstanceId() }
     }, 1000);
 #endif
 
@@ -470,11 +474,11 @@ void Unit::Update(const uint32 diff)
     {
 #ifdef BUILD_METRICS
         metric::duration<std::chrono::microseconds> meas_ai("unit.update.ai", {
-            { "entry", std::to_string(GetEntry()) },
-            { "guid", std::to_string(GetGUIDLow()) },
-            { "unit_type", std::to_string(GetGUIDHigh()) },
-            { "map_id", std::to_string(GetMapId()) },
-            { "instance_id", std::to_string(GetInstanceId()) }
+            { "entry", GetEntry() },
+            { "guid", GetGUIDLow() },
+            { "unit_type", GetGUIDHigh() },
+            { "map_id", GetMapId() },
+            { "instance_id", GetInstanceId() }
         }, 1000);
 #endif
 
@@ -506,7 +510,8 @@ void Unit::Heartbeat()
                 aura->OnHeartbeat();
     }
 
-    if (m_hasHeartbeatProcCounter)
+    UpdateSpellAuraProcHolders();
+    if (m_spellAuraProcFlags & PROC_FLAG_HEARTBEAT)
         ProcDamageAndSpell(ProcSystemArguments(this, nullptr, PROC_FLAG_HEARTBEAT, PROC_FLAG_NONE, PROC_EX_NONE, 0, 0));
 
     if (AI())
@@ -4610,11 +4615,11 @@ void Unit::_UpdateSpells(uint32 time)
 {
 #ifdef BUILD_METRICS
     metric::duration<std::chrono::microseconds> meas("unit.update.spells", {
-        { "entry", std::to_string(GetEntry()) },
-        { "guid", std::to_string(GetGUIDLow()) },
-        { "unit_type", std::to_string(GetGUIDHigh()) },
-        { "map_id", std::to_string(GetMapId()) },
-        { "instance_id", std::to_string(GetInstanceId()) }
+        { "entry", GetEntry() },
+        { "guid", GetGUIDLow() },
+        { "unit_type", GetGUIDHigh() },
+        { "map_id", GetMapId() },
+        { "instance_id", GetInstanceId() }
         }, 1000);
 
     std::vector<uint32> updatedSpellIds;
@@ -5447,6 +5452,7 @@ bool Unit::AddSpellAuraHolder(SpellAuraHolder* holder)
     holder->_AddSpellAuraHolder();
     holder->SetCreationDelayFlag();
     m_spellAuraHolders.insert(SpellAuraHolderMap::value_type(holder->GetId(), holder));
+    AddSpellAuraProcHolder(holder);
 
     for (int32 i = 0; i < MAX_EFFECT_INDEX; ++i)
         if (Aura* aur = holder->GetAuraByEffectIndex(SpellEffectIndex(i)))
@@ -5458,22 +5464,121 @@ bool Unit::AddSpellAuraHolder(SpellAuraHolder* holder)
     // if aura deleted before boosts apply ignore
     // this can be possible it it removed indirectly by triggered spell effect at ApplyModifier
     if (!holder->IsDeleted())
-    {
         holder->HandleSpellSpecificBoosts(true);
-        SpellProcEventEntry const* procEntry = sSpellMgr.GetSpellProcEvent(aurSpellInfo->Id);
-        if (aurSpellInfo->procFlags & PROC_FLAG_HEARTBEAT || (procEntry && procEntry->procFlags & PROC_FLAG_HEARTBEAT))
-            ++m_hasHeartbeatProcCounter;
-    }
 
     return true;
 }
 
+void Unit::AddSpellAuraProcHolder(SpellAuraHolder* holder)
+{
+    uint32 procFlags = sSpellMgr.GetSpellRuntimeInfo(holder->GetSpellProto()).procFlags;
+    if (!procFlags)
+        return;
+
+    // behind holders of the same spell, like the multimap keeps them
+    auto itr = std::upper_bound(m_spellAuraProcHolders.begin(), m_spellAuraProcHolders.end(), holder->GetId(),
+                                [](uint32 spellId, SpellAuraProcHolder const& procHolder) { return spellId < procHolder.holder->GetId(); });
+    m_spellAuraProcHolders.insert(itr, SpellAuraProcHolder{ holder, procFlags });
+    m_spellAuraProcFlags |= procFlags;
+}
+
+void Unit::RemoveSpellAuraProcHolder(SpellAuraHolder* holder)
+{
+    auto itr = std::find_if(m_spellAuraProcHolders.begin(), m_spellAuraProcHolders.end(),
+                            [holder](SpellAuraProcHolder const& procHolder) { return procHolder.holder == holder; });
+    if (itr == m_spellAuraProcHolders.end())
+        return;
+
+    m_spellAuraProcHolders.erase(itr);
+    m_spellAuraProcFlags = 0;
+    for (SpellAuraProcHolder const& procHolder : m_spellAuraProcHolders)
+        m_spellAuraProcFlags |= procHolder.procFlags;
+}
+
+void Unit::UpdateSpellAuraProcHolders()
+{
+    if (m_spellAuraProcGeneration == sSpellMgr.GetSpellProcEventGeneration())
+        return;
+
+    // spell_proc_event was reloaded
+    m_spellAuraProcGeneration = sSpellMgr.GetSpellProcEventGeneration();
+    RebuildSpellAuraProcHolders(false);
+}
+
+void Unit::SetSpellAuraProcIndexBypass(bool bypass)
+{
+    RebuildSpellAuraProcHolders(bypass);
+}
+
+void Unit::RebuildSpellAuraProcHolders(bool indexAll)
+{
+    m_spellAuraProcHolders.clear();
+    m_spellAuraProcFlags = 0;
+    for (auto& data : m_spellAuraHolders)
+    {
+        // IsTriggeredAtSpellProcEvent checks the real flags of each holder
+        if (indexAll)
+            m_spellAuraProcHolders.push_back(SpellAuraProcHolder{ data.second, UINT32_MAX });
+        else
+            AddSpellAuraProcHolder(data.second);
+    }
+
+    if (indexAll)
+        m_spellAuraProcFlags = UINT32_MAX;
+}
+
 void Unit::AddAuraToModList(Aura* aura)
 {
     if (aura->GetModifier()->m_auraname < TOTAL_AURAS)
         m_modAuras[aura->GetModifier()->m_auraname].push_back(aura);
 }
 
+void Unit::RemoveAuraFromModList(AuraType type, Aura* aura)
+{
+    AuraList& auras = m_modAuras[type];
+    bool hadHoles = auras.HasHoles();
+    if (auras.remove(aura) && !hadHoles && auras.HasHoles())
+        m_modAurasToCompact.push_back(type);
+}
+
+uint32 Unit::GetVisibleAura(uint8 slot) const
+{
+    auto itr = std::lower_bound(m_visibleAuras.begin(), m_visibleAuras.end(), slot,
+                                [](VisibleAuraMap::value_type const& visibleAura, uint8 slot) { return visibleAura.first < slot; });
+    if (itr != m_visibleAuras.end() && itr->first == slot)
+        return itr->second;
+    return 0;
+}
+
+void Unit::SetVisibleAura(uint8 slot, uint32 spellid)
+{
+    auto itr = std::lower_bound(m_visibleAuras.begin(), m_visibleAuras.end(), slot,
+                                [](VisibleAuraMap::value_type const& visibleAura, uint8 slot) { return visibleAura.first < slot; });
+    bool found = itr != m_visibleAuras.end() && itr->first == slot;
+    if (spellid == 0)
+    {
+        if (found)
+            m_visibleAuras.erase(itr);
+    }
+    else if (found)
+        itr->second = spellid;
+    else
+        m_visibleAuras.insert(itr, VisibleAuraMap::value_type(slot, spellid));
+}
+
+uint8 Unit::GetFreeVisibleAuraSlot() const
+{
+    // slots are sorted, the first one not matching its position follows a gap
+    uint8 slot = 0;
+    for (auto const& visibleAura : m_visibleAuras)
+    {
+        if (visibleAura.first != slot)
+            break;
+        ++slot;
+    }
+    return slot < MAX_AURAS ? slot : MAX_AURAS;
+}
+
 void Unit::RemoveRankAurasDueToSpell(uint32 spellId)
 {
     SpellEntry const* spellInfo = sSpellTemplate.LookupEntry<SpellEntry>(spellId);
@@ -6083,6 +6188,7 @@ void Unit::RemoveSpellAuraHolder(SpellAuraHolder* holder, AuraRemoveMode mode)
         if (itr->second == holder)
         {
             m_spellAuraHolders.erase(itr);
+            RemoveSpellAuraProcHolder(holder);
             break;
         }
     }
@@ -6112,13 +6218,6 @@ void Unit::RemoveSpellAuraHolder(SpellAuraHolder* holder, AuraRemoveMode mode)
     holder->SetDeleted();
     m_deletedHolders.push_back(holder);
 
-    if (m_hasHeartbeatProcCounter)
-    {
-        SpellProcEventEntry const* procEntry = sSpellMgr.GetSpellProcEvent(aurSpellInfo->Id);
-        if (aurSpellInfo->procFlags & PROC_FLAG_HEARTBEAT || (procEntry && procEntry->procFlags & PROC_FLAG_HEARTBEAT))
-            --m_hasHeartbeatProcCounter;
-    }
-
     if (mode != AURA_REMOVE_BY_EXPIRE && IsChanneledSpell(aurSpellInfo) && !IsAreaOfEffectSpell(aurSpellInfo) &&
             caster && caster->GetChannelObjectGuid() == GetObjectGuid())
     {
@@ -6148,7 +6247,7 @@ void Unit::RemoveAura(Aura* Aur, AuraRemoveMode mode)
     // remove from list before mods removing (prevent cyclic calls, mods added before including to aura list - use reverse order)
     if (Aur->GetModifier()->m_auraname < TOTAL_AURAS)
     {
-        m_modAuras[Aur->GetModifier()->m_auraname].remove(Aur);
+        RemoveAuraFromModList(AuraType(Aur->GetModifier()->m_auraname), Aur);
     }
 
     // Set remove mode
@@ -9336,7 +9435,6 @@ void Unit::UpdateVisibilityAndView()
 
             if (!owner || !IsVisibleForOrDetect(owner, this, false))
             {
-                alist.erase(it);
                 RemoveAura(aura);
                 it = alist.begin();
             }
@@ -10156,16 +10254,17 @@ bool Unit::HandleStatModifier(UnitMods unitMod, UnitModifierType modifierType, f
     if (!CanModifyStats())
         return false;
 
+    uint32 node;
     switch (unitMod)
     {
         case UNIT_MOD_STAT_STRENGTH:
         case UNIT_MOD_STAT_AGILITY:
         case UNIT_MOD_STAT_STAMINA:
         case UNIT_MOD_STAT_INTELLECT:
-        case UNIT_MOD_STAT_SPIRIT:         UpdateStats(GetStatByAuraGroup(unitMod));  break;
+        case UNIT_MOD_STAT_SPIRIT:         node = STAT_NODE_STAT_START + GetStatByAuraGroup(unitMod); break;
 
-        case UNIT_MOD_ARMOR:               UpdateArmor();           break;
-        case UNIT_MOD_HEALTH:              UpdateMaxHealth();       break;
+        case UNIT_MOD_ARMOR:               node = STAT_NODE_ARMOR;       break;
+        case UNIT_MOD_HEALTH:              node = STAT_NODE_MAX_HEALTH;  break;
 
         case UNIT_MOD_MANA:
         case UNIT_MOD_RAGE:
@@ -10173,29 +10272,92 @@ bool Unit::HandleStatModifier(UnitMods unitMod, UnitModifierType modifierType, f
         case UNIT_MOD_ENERGY:
         case UNIT_MOD_HAPPINESS:
         case UNIT_MOD_RUNE:
-        case UNIT_MOD_RUNIC_POWER:         UpdateMaxPower(GetPowerTypeByAuraGroup(unitMod)); break;
+        case UNIT_MOD_RUNIC_POWER:         node = STAT_NODE_MAX_POWER_START + GetPowerTypeByAuraGroup(unitMod); break;
 
         case UNIT_MOD_RESISTANCE_HOLY:
         case UNIT_MOD_RESISTANCE_FIRE:
         case UNIT_MOD_RESISTANCE_NATURE:
         case UNIT_MOD_RESISTANCE_FROST:
         case UNIT_MOD_RESISTANCE_SHADOW:
-        case UNIT_MOD_RESISTANCE_ARCANE:   UpdateResistances(GetSpellSchoolByAuraGroup(unitMod)); break;
+        case UNIT_MOD_RESISTANCE_ARCANE:   node = STAT_NODE_RESISTANCE_START + GetSpellSchoolByAuraGroup(unitMod) - SPELL_SCHOOL_HOLY; break;
 
-        case UNIT_MOD_ATTACK_POWER:        UpdateAttackPowerAndDamage();         break;
-        case UNIT_MOD_ATTACK_POWER_RANGED: UpdateAttackPowerAndDamage(true);     break;
+        case UNIT_MOD_ATTACK_POWER:        node = STAT_NODE_ATTACK_POWER;        break;
+        case UNIT_MOD_ATTACK_POWER_RANGED: node = STAT_NODE_RANGED_ATTACK_POWER; break;
 
-        case UNIT_MOD_DAMAGE_MAINHAND:     UpdateDamagePhysical(BASE_ATTACK);    break;
-        case UNIT_MOD_DAMAGE_OFFHAND:      UpdateDamagePhysical(OFF_ATTACK);     break;
-        case UNIT_MOD_DAMAGE_RANGED:       UpdateDamagePhysical(RANGED_ATTACK);  break;
+        case UNIT_MOD_DAMAGE_MAINHAND:     node = STAT_NODE_DAMAGE_MAINHAND;     break;
+        case UNIT_MOD_DAMAGE_OFFHAND:      node = STAT_NODE_DAMAGE_OFFHAND;      break;
+        case UNIT_MOD_DAMAGE_RANGED:       node = STAT_NODE_DAMAGE_RANGED;       break;
 
         default:
-            break;
+            return true;
     }
 
+    MarkStatNodesDirty(STAT_NODE_MASK(node));
     return true;
 }
 
+void Unit::MarkStatNodesDirty(uint32 nodeMask)
+{
+    m_dirtyStatNodes |= nodeMask;
+
+    // nodes marked by a node update are picked up by the running pass
+    if (!m_statNodeBatchDepth && !m_updatingStatNodes)
+        UpdateDirtyStatNodes();
+}
+
+void Unit::UpdateDirtyStatNodes()
+{
+    if (m_updatingStatNodes || !m_dirtyStatNodes)
+        return;
+
+    m_updatingStatNodes = true;
+
+    // nodes only mark nodes after them dirty, the outer loop is a safety net for an update marking backwards
+    while (m_dirtyStatNodes)
+    {
+        for (uint32 node = 0; node < MAX_STAT_NODES; ++node)
+        {
+            if (!(m_dirtyStatNodes & STAT_NODE_MASK(node)))
+                continue;
+
+            m_dirtyStatNodes &= ~STAT_NODE_MASK(node);
+            UpdateStatNode(UnitStatNode(node));
+        }
+    }
+
+    m_updatingStatNodes = false;
+
+    if (GetTypeId() == TYPEID_PLAYER && sWorld.getConfig(CONFIG_UINT32_STAT_SYSTEM_CHECK))
+        static_cast<Player*>(this)->CheckStatNodes();
+}
+
+void Unit::UpdateStatNode(UnitStatNode node)
+{
+    if (node < STAT_NODE_RESISTANCE_START)
+        UpdateStats(Stats(node - STAT_NODE_STAT_START));
+    else if (node < STAT_NODE_ARMOR)
+        UpdateResistances(SPELL_SCHOOL_HOLY + node - STAT_NODE_RESISTANCE_START);
+    else if (node == STAT_NODE_ARMOR)
+        UpdateArmor();
+    else if (node == STAT_NODE_MAX_HEALTH)
+        UpdateMaxHealth();
+    else if (node < STAT_NODE_ATTACK_POWER)
+        UpdateMaxPower(Powers(node - STAT_NODE_MAX_POWER_START));
+    else
+    {
+        switch (node)
+        {
+            case STAT_NODE_ATTACK_POWER:        UpdateAttackPowerAndDamage();         break;
+            case STAT_NODE_RANGED_ATTACK_POWER: UpdateAttackPowerAndDamage(true);     break;
+            case STAT_NODE_DAMAGE_MAINHAND:     UpdateDamagePhysical(BASE_ATTACK);    break;
+            case STAT_NODE_DAMAGE_OFFHAND:      UpdateDamagePhysical(OFF_ATTACK);     break;
+            case STAT_NODE_DAMAGE_RANGED:       UpdateDamagePhysical(RANGED_ATTACK);  break;
+            default:
+                break;
+        }
+    }
+}
+
 float Unit::GetModifierValue(UnitMods unitMod, UnitModifierType modifierType) const
 {
     if (unitMod >= UNIT_MOD_END || modifierType >= MODIFIER_TYPE_END)
@@ -10525,11 +10687,10 @@ void Unit::ApplyMaxPowerMod(Powers power, uint32 val, bool apply)
 
 void Unit::ApplyAuraProcTriggerDamage(Aura* aura, bool apply)
 {
-    AuraList& tAuraProcTriggerDamage = m_modAuras[SPELL_AURA_PROC_TRIGGER_DAMAGE];
     if (apply)
-        tAuraProcTriggerDamage.push_back(aura);
+        m_modAuras[SPELL_AURA_PROC_TRIGGER_DAMAGE].push_back(aura);
     else
-        tAuraProcTriggerDamage.remove(aura);
+        RemoveAuraFromModList(SPELL_AURA_PROC_TRIGGER_DAMAGE, aura);
 }
 
 uint32 Unit::GetCreatePowers(Powers power) const
@@ -10551,6 +10712,9 @@ uint32 Unit::GetCreatePowers(Powers power) const
 
 void Unit::AddToWorld()
 {
+    if (!IsInWorld())
+        GetMap()->GetUnitSpatialIndex().Insert(this);
+
     WorldObject::AddToWorld();
     uint32 delay = 0;
     if (IsCreature() && !IsPlayerControlled())
@@ -10584,6 +10748,8 @@ void Unit::RemoveFromWorld()
                 transport->RemovePassenger(this);
 
         m_FollowingRefManager.clearReferences();
+
+        GetMap()->GetUnitSpatialIndex().Remove(this);
     }
 
     WorldObject::RemoveFromWorld();
@@ -11395,18 +11561,16 @@ void Unit::RestoreDisplayId()
     AuraList const& transforms = GetAurasByType(SPELL_AURA_TRANSFORM);
     if (!transforms.empty())
     {
-        // iterate over already applied transform auras - from newest to oldest
-        for (auto i = transforms.rbegin(); i != transforms.rend(); ++i)
+        // newest of the applied transform auras, prefer negative auras
+        Aura const* negativeAura = nullptr;
+        for (Aura const* aura : transforms)
         {
-            if (!handledAura)
-                handledAura = (*i);
-            // prefer negative auras
-            if (!(*i)->IsPositive())
-            {
-                handledAura = (*i);
-                break;
-            }
+            handledAura = aura;
+            if (!aura->IsPositive())
+                negativeAura = aura;
         }
+        if (negativeAura)
+            handledAura = negativeAura;
     }
 
     // transform aura was found
@@ -11438,6 +11602,8 @@ void Unit::UpdateModelData()
         SetFloatValue(UNIT_FIELD_BOUNDINGRADIUS, GetObjectScale() * modelInfo->bounding_radius);
 
         SetFloatValue(UNIT_FIELD_COMBATREACH, GetObjectScale() * modelInfo->combat_reach);
+        if (IsInWorld())
+            GetMap()->GetUnitSpatialIndex().UpdateCombatReach(this);
 
         SetBaseWalkSpeed(modelInfo->SpeedWalk);
         SetBaseRunSpeed(modelInfo->SpeedRun, false);
@@ -12182,6 +12348,11 @@ void Unit::CleanupDeletedAuras()
     for (AuraList::const_iterator itr = m_deletedAuras.begin(); itr != m_deletedAuras.end(); ++itr)
         delete *itr;
     m_deletedAuras.clear();
+
+    // nothing iterates the aura lists here
+    for (AuraType type : m_modAurasToCompact)
+        m_modAuras[type].Compact();
+    m_modAurasToCompact.clear();
 }
 
 bool Unit::IsShapeShifted() const
@@ -12306,7 +12477,10 @@ void Unit::ScheduleAINotify(uint32 delay, bool forced)
     }
     else if (forced)
     {
-        m_events.KillEvent(m_AINotifyEvent);
+        // the waiting event is moved, only one that is executing right now has to be replaced
+        if (m_events.ModifyEventTime(m_AINotifyEvent, m_events.CalculateTime(delay)))
+            return;
+
         m_AINotifyEvent = new UnitVisitObjectsInRangeNotifyEvent(*this);
         m_events.AddEvent(m_AINotifyEvent, m_events.CalculateTime(delay));
     }
@@ -12335,7 +12509,7 @@ void Unit::OnRelocated()
         m_last_notified_position.z = GetPositionZ();
         if (!IsBoarded() && IsVehicle()) // must update passengers for visibility reasons
             m_vehicleInfo->UpdateGlobalPositions();
-        GetViewPoint().Call_UpdateVisibilityForOwner();
+        GetViewPoint().Call_UpdateVisibilityOnRelocation();
         UpdateObjectVisibility();
     }
     ScheduleAINotify(World::GetRelocationAINotifyDelay());
@@ -12419,11 +12593,11 @@ void Unit::UpdateSplineMovement(uint32 t_diff)
         return;
 #ifdef BUILD_METRICS
     metric::duration<std::chrono::microseconds> meas("unit.updatesplinemovement", {
-        { "entry", std::to_string(GetEntry()) },
-        { "guid", std::to_string(GetGUIDLow()) },
-        { "unit_type", std::to_string(GetGUIDHigh()) },
-        { "map_id", std::to_string(GetMapId()) },
-        { "instance_id", std::to_string(GetInstanceId()) }
+        { "entry", GetEntry() },
+        { "guid", GetGUIDLow() },
+        { "unit_type", GetGUIDHigh() },
+        { "map_id", GetMapId() },
+        { "instance_id", GetInstanceId() }
     }, 1000);
 #endif
     movespline->updateState(t_diff);
@@ -13237,8 +13411,10 @@ void Unit::InterruptSpellsCastedOnMe(bool killDelayed)
         if (!killDelayed)
             continue;
         // 2/ Interrupt spells that are not referenced but that still have an event (like delayed spell)
-        for (auto i_events = target->m_events.GetEvents().begin(); i_events != target->m_events.GetEvents().end(); ++i_events)
-            if (SpellEvent* event = dynamic_cast<SpellEvent*>(i_events->second))
+        std::vector<BasicEvent*> events;
+        target->m_events.GetEvents(events);
+        for (BasicEvent* basicEvent : events)
+            if (SpellEvent* event = dynamic_cast<SpellEvent*>(basicEvent))
                 if (event && event->GetSpell()->m_targets.getUnitTargetGuid() == GetObjectGuid())
                     if (event->GetSpell()->getState() != SPELL_STATE_FINISHED)
                         event->GetSpell()->cancel();
@@ -13276,6 +13452,41 @@ void Unit::UpdateAllowedPositionZ(float x, float y, float& z, Map* atMap /*=null
     }
 }
 
+void Unit::UpdateAllowedPositionZ(float const* x, float const* y, float* z, uint32 count, Map* atMap /*=nullptr*/) const
+{
+    if (!atMap)
+        atMap = GetMap();
+
+    std::vector<float> groundZ(count);
+    if (!CanFly())
+    {
+        bool canSwim = CanSwim();
+        GetMap()->GetHeights(GetPhaseMask(), x, y, z, groundZ.data(), count, canSwim);
+        for (uint32 i = 0; i < count; ++i)
+        {
+            float maxZ;
+            if (canSwim)
+                maxZ = atMap->GetTerrain()->GetWaterOrGroundLevel(x[i], y[i], z[i], groundZ[i], !HasAuraType(SPELL_AURA_WATER_WALK), GetCollisionHeight());
+            else
+                maxZ = groundZ[i];
+            if (maxZ > INVALID_HEIGHT)
+            {
+                if (z[i] > maxZ)
+                    z[i] = maxZ;
+                else if (z[i] < groundZ[i])
+                    z[i] = groundZ[i];
+            }
+        }
+    }
+    else
+    {
+        atMap->GetHeights(GetPhaseMask(), x, y, z, groundZ.data(), count);
+        for (uint32 i = 0; i < count; ++i)
+            if (z[i] < groundZ[i])
+                z[i] = groundZ[i];
+    }
+}
+
 void Unit::AdjustZForCollision(float x, float y, float& z, float halfHeight) const
 {
     if (CanFly())
@@ -30,6 +30,7 @@
 #include "Entities/Object.h"
 #include "Server/Opcodes.h"
 #include "Spells/SpellAuraDefines.h"
+#include "Spells/AuraList.h"
 #include "Entities/UpdateFields.h"
 #include "Globals/SharedDefines.h"
 #include "Combat/ThreatManager.h"
@@ -333,6 +334,35 @@ enum UnitMods
     UNIT_MOD_POWER_END = UNIT_MOD_RUNIC_POWER + 1
 };
 
+// Values computed by the stat system, in dependency order: a node only depends on nodes before it,
+// so one pass from the lowest dirty node recomputes every node at most once.
+enum UnitStatNode
+{
+    STAT_NODE_STAT_START,                                   // STAT_NODE_STAT_START + Stats
+    STAT_NODE_RESISTANCE_START = STAT_NODE_STAT_START + MAX_STATS, // STAT_NODE_RESISTANCE_START + SpellSchools - SPELL_SCHOOL_HOLY
+    STAT_NODE_ARMOR = STAT_NODE_RESISTANCE_START + MAX_SPELL_SCHOOL - 1,
+    STAT_NODE_MAX_HEALTH,
+    STAT_NODE_MAX_POWER_START,                              // STAT_NODE_MAX_POWER_START + Powers
+    STAT_NODE_ATTACK_POWER = STAT_NODE_MAX_POWER_START + MAX_POWERS,
+    STAT_NODE_RANGED_ATTACK_POWER,
+    STAT_NODE_DAMAGE_MAINHAND,
+    STAT_NODE_DAMAGE_OFFHAND,
+    STAT_NODE_DAMAGE_RANGED,
+    // player only
+    STAT_NODE_CRIT,
+    STAT_NODE_DODGE,
+    STAT_NODE_SPELL_CRIT,
+    STAT_NODE_SHIELD_BLOCK,
+    STAT_NODE_SPELL_BONUS,
+    STAT_NODE_MANA_REGEN,
+    MAX_STAT_NODES
+};
+
+static_assert(MAX_STAT_NODES < 32, "UnitStatNode must fit into the dirty mask");
+
+#define STAT_NODE_MASK(node)    (1u << (node))
+#define STAT_NODE_MASK_ALL      (STAT_NODE_MASK(MAX_STAT_NODES) - 1)
+
 enum BaseModGroup
 {
     CRIT_PERCENTAGE,
@@ -1155,10 +1185,16 @@ class Unit : public WorldObject
         typedef std::pair<SpellAuraHolderMap::iterator, SpellAuraHolderMap::iterator> SpellAuraHolderBounds;
         typedef std::pair<SpellAuraHolderMap::const_iterator, SpellAuraHolderMap::const_iterator> SpellAuraHolderConstBounds;
         typedef std::list<SpellAuraHolder*> SpellAuraHolderList;
-        typedef std::list<Aura*> AuraList;
+        struct SpellAuraProcHolder
+        {
+            SpellAuraHolder* holder;
+            uint32 procFlags;                               // events the holder can proc from
+        };
+        typedef std::vector<SpellAuraProcHolder> SpellAuraProcHolderList;
+        typedef AuraSlotList AuraList;
         typedef std::list<DiminishingReturn> Diminishing;
         typedef std::set<uint32 /*playerGuidLow*/> ComboPointHolderSet;
-        typedef std::map<uint8 /*slot*/, uint32 /*spellId*/> VisibleAuraMap;
+        typedef std::vector<std::pair<uint8 /*slot*/, uint32 /*spellId*/>> VisibleAuraMap; // sorted by slot
         typedef std::map<SpellEntry const*, ObjectGuid /*targetGuid*/> TrackedAuraTargetMap;
 
         virtual ~Unit();
@@ -1551,6 +1587,8 @@ class Unit : public WorldObject
 
         static void ProcDamageAndSpell(ProcSystemArguments&& data);
         void ProcDamageAndSpellFor(ProcSystemArguments& data, bool isVictim);
+        // procs look at every holder like before the proc flag index while set, for comparing both
+        void SetSpellAuraProcIndexBypass(bool bypass);
         void ProcSkillsAndReactives(bool isVictim, Unit* target, uint32 procFlags, uint32 procEx, WeaponAttackType attType);
 
         void HandleEmote(uint32 emote_id);                  // auto-select command/state
@@ -1984,6 +2022,7 @@ class Unit : public WorldObject
 
         bool AddSpellAuraHolder(SpellAuraHolder* holder);
         void AddAuraToModList(Aura* aura);
+        void RemoveAuraFromModList(AuraType type, Aura* aura);
 
         // removing specific aura stack
         void RemoveAura(Aura* Aur, AuraRemoveMode mode = AURA_REMOVE_BY_DEFAULT);
@@ -2131,6 +2170,10 @@ class Unit : public WorldObject
         virtual void UpdateMaxPower(Powers power) = 0;
         virtual void UpdateAttackPowerAndDamage(bool ranged = false) = 0;
         virtual void UpdateDamagePhysical(WeaponAttackType attType) = 0;
+        // recomputes the nodes right away, or when the outermost UnitStatNodeBatch ends
+        void MarkStatNodesDirty(uint32 nodeMask);
+        void UpdateDirtyStatNodes();
+        virtual void UpdateStatNode(UnitStatNode node);
         float GetTotalAttackPowerValue(WeaponAttackType attType) const;
 
         float GetBaseWeaponDamage(WeaponAttackType attType, WeaponDamageRange damageRange, uint8 index = 0) const;
@@ -2201,22 +2244,12 @@ class Unit : public WorldObject
         void TriggerHomeEvents();
         void EvadeTimerExpired();
 
-        uint32 GetVisibleAura(uint8 slot) const
-        {
-            VisibleAuraMap::const_iterator itr = m_visibleAuras.find(slot);
-            if (itr != m_visibleAuras.end())
-                return itr->second;
-            return 0;
-        }
-        void SetVisibleAura(uint8 slot, uint32 spellid)
-        {
-            if (spellid == 0)
-                m_visibleAuras.erase(slot);
-            else
-                m_visibleAuras[slot] = spellid;
-        }
+        uint32 GetVisibleAura(uint8 slot) const;
+        void SetVisibleAura(uint8 slot, uint32 spellid);
         VisibleAuraMap const& GetVisibleAuras() const { return m_visibleAuras; }
         uint8 GetVisibleAurasCount() const { return m_visibleAuras.size(); }
+        // lowest slot without aura, MAX_AURAS if all are taken
+        uint8 GetFreeVisibleAuraSlot() const;
 
         Aura* GetAura(uint32 spellId, SpellEffectIndex effindex);
         Aura* GetAura(AuraType type, SpellFamily family, uint64 familyFlag, uint32 familyFlag2 = 0, ObjectGuid casterGuid = ObjectGuid()) const;
@@ -2551,6 +2584,8 @@ class Unit : public WorldObject
 
         // WorldObject overrides
         void UpdateAllowedPositionZ(float x, float y, float& z, Map* atMap = nullptr) const override;
+        // same for a whole set of points, the terrain heights are queried in one batch
+        void UpdateAllowedPositionZ(float const* x, float const* y, float* z, uint32 count, Map* atMap = nullptr) const;
         void AdjustZForCollision(float x, float y, float& z, float halfHeight) const override;
 
         virtual uint32 GetSpellRank(SpellEntry const* spellInfo);
@@ -2660,11 +2695,16 @@ class Unit : public WorldObject
         std::map<uint32, Creature*> m_creatures;
 
         AuraList m_modAuras[TOTAL_AURAS];
+        std::vector<AuraType> m_modAurasToCompact;          // lists with slots of removed auras, closed in CleanupDeletedAuras
         float m_auraModifiersGroup[UNIT_MOD_END][MODIFIER_TYPE_END];
 
         WeaponDamageInfo m_weaponDamageInfo;
 
         bool m_canModifyStats;
+        uint32 m_dirtyStatNodes;
+        uint8 m_statNodeBatchDepth;
+        bool m_updatingStatNodes;
+        friend class UnitStatNodeBatch;
         // std::list< spellEffectPair > AuraSpells[TOTAL_AURAS];  // TODO: use this if ok for mem
         VisibleAuraMap m_visibleAuras;
 
@@ -2727,6 +2767,10 @@ class Unit : public WorldObject
 
     private:
         void CleanupDeletedAuras();
+        void AddSpellAuraProcHolder(SpellAuraHolder* holder);
+        void RemoveSpellAuraProcHolder(SpellAuraHolder* holder);
+        void UpdateSpellAuraProcHolders();
+        void RebuildSpellAuraProcHolders(bool indexAll);
         void UpdateSplineMovement(uint32 t_diff);
 
         // player or player's pet
@@ -2772,7 +2816,10 @@ class Unit : public WorldObject
         // Need to safeguard aura proccing in Unit::ProcDamageAndSpell
         bool m_spellProcsHappening;
         std::vector<SpellAuraHolder*> m_delayedSpellAuraHolders;
-        uint32 m_hasHeartbeatProcCounter;
+        // index of m_spellAuraHolders, spares procs from looking at holders that never react to the event
+        SpellAuraProcHolderList m_spellAuraProcHolders;
+        uint32 m_spellAuraProcFlags;                        // proc flags of all indexed holders
+        uint32 m_spellAuraProcGeneration;                   // spell_proc_event load the indexed flags stem from
 
         bool m_alwaysHit;
         bool m_noThreat;
@@ -2814,6 +2861,27 @@ class Unit : public WorldObject
         void CastSpell(float x, float y, float z, SpellEntry const* spell, TR triggered);
 };
 
+/**
+ * Holds back the stat nodes marked dirty by the modifiers changed while it exists, they are recomputed
+ * once when the outermost batch of the unit ends. Only for code which does not read the stats meanwhile.
+ */
+class UnitStatNodeBatch
+{
+    public:
+        explicit UnitStatNodeBatch(Unit* unit) : m_unit(unit) { ++m_unit->m_statNodeBatchDepth; }
+        ~UnitStatNodeBatch()
+        {
+            if (--m_unit->m_statNodeBatchDepth == 0)
+                m_unit->UpdateDirtyStatNodes();
+        }
+
+        UnitStatNodeBatch(UnitStatNodeBatch const&) = delete;
+        UnitStatNodeBatch& operator=(UnitStatNodeBatch const&) = delete;
+
+    private:
+        Unit* m_unit;
+};
+
 template<typename Func>
 void Unit::CallForAllControlledUnits(Func const& func, uint32 controlledMask)
 {
@@ -18,13 +18,15 @@
 
 #include <zlib.h>
 
+#include <array>
+#include <cstring>
+
 #include "Common.h"
 #include "Entities/UpdateData.h"
 #include "Util/ByteBuffer.h"
 #include "Server/WorldPacket.h"
 #include "Log.h"
 #include "Server/Opcodes.h"
-#include "World/World.h"
 #include "Entities/ObjectGuid.h"
 #include "Server/WorldSession.h"
 
@@ -32,7 +34,7 @@ UpdateData::UpdateData() : m_data(1, {ByteBuffer(0), 0}), m_currentIndex(0)
 {
 }
 
-void UpdateData::AddOutOfRangeGUID(GuidSet& guids)
+void UpdateData::AddOutOfRangeGUID(GuidHashSet& guids)
 {
     m_outOfRangeGUIDs.insert(guids.begin(), guids.end());
 }
@@ -60,44 +62,138 @@ void UpdateData::AddUpdateBlock(const ByteBuffer& block)
     }
 }
 
-void UpdateData::Compress(void* dst, uint32* dst_size, void* src, int src_size)
+namespace
 {
-    z_stream c_stream;
+    // deflate state is allocated once per thread and only reset between packets
+    class DeflateStream
+    {
+        public:
+            DeflateStream() : m_level(-1) {}
+            ~DeflateStream()
+            {
+                if (m_level >= 0)
+                    deflateEnd(&m_stream);
+            }
 
-    c_stream.zalloc = (alloc_func)nullptr;
-    c_stream.zfree = (free_func)nullptr;
-    c_stream.opaque = (voidpf)nullptr;
+            z_stream* Get(int level)
+            {
+                if (m_level == level)
+                {
+                    int z_res = deflateReset(&m_stream);
+                    if (z_res == Z_OK)
+                        return &m_stream;
 
-    // default Z_BEST_SPEED (1)
-    int z_res = deflateInit(&c_stream, sWorld.getConfig(CONFIG_UINT32_COMPRESSION));
-    if (z_res != Z_OK)
-    {
-        sLog.outError("Can't compress update packet (zlib: deflateInit) Error code: %i (%s)", z_res, zError(z_res));
-        *dst_size = 0;
-        return;
-    }
+                    sLog.outError("Can't compress update packet (zlib: deflateReset) Error code: %i (%s)", z_res, zError(z_res));
+                }
+
+                // first use on this thread or the compression level was changed by a config reload
+                if (m_level >= 0)
+                    deflateEnd(&m_stream);
+                m_level = -1;
+
+                m_stream.zalloc = (alloc_func)nullptr;
+                m_stream.zfree = (free_func)nullptr;
+                m_stream.opaque = (voidpf)nullptr;
+
+                int z_res = deflateInit(&m_stream, level);
+                if (z_res != Z_OK)
+                {
+                    sLog.outError("Can't compress update packet (zlib: deflateInit) Error code: %i (%s)", z_res, zError(z_res));
+                    return nullptr;
+                }
+
+                m_level = level;
+                return &m_stream;
+            }
+
+        private:
+            z_stream m_stream;
+            int m_level;
+    };
 
-    c_stream.next_out = (Bytef*)dst;
-    c_stream.avail_out = *dst_size;
-    c_stream.next_in = (Bytef*)src;
-    c_stream.avail_in = (uInt)src_size;
+    thread_local DeflateStream t_deflateStream;
 
-    z_res = deflate(&c_stream, Z_NO_FLUSH);
-    if (z_res != Z_OK)
+    // Packets recently compressed by this thread. The create block of a player entering a crowded
+    // area is sent to every observer, usually as the same payload, and is only compressed once.
+    // Entries do not keep packets alive, both are freed as soon as no socket queues or writes them anymore.
+    class CompressedPacketCache
     {
-        sLog.outError("Can't compress update packet (zlib: deflate) Error code: %i (%s)", z_res, zError(z_res));
-        *dst_size = 0;
-        return;
-    }
+        public:
+            CompressedPacketCache() : m_next(0) {}
+
+            // a packet shared by several sockets, needs no checksum
+            std::shared_ptr<WorldPacket const> FindSame(std::shared_ptr<WorldPacket const> const& source) const
+            {
+                for (auto const& entry : m_entries)
+                    if (!entry.source.owner_before(source) && !source.owner_before(entry.source))
+                        return entry.compressed.lock();
+
+                return nullptr;
+            }
+
+            // a packet built separately for each observer with the same content
+            std::shared_ptr<WorldPacket const> FindEqual(std::shared_ptr<WorldPacket const> const& source, uint32 checksum) const
+            {
+                for (auto const& entry : m_entries)
+                {
+                    if (entry.checksum != checksum || entry.size != source->size())
+                        continue;
+
+                    std::shared_ptr<WorldPacket const> cachedSource = entry.source.lock();
+                    if (cachedSource && memcmp(cachedSource->contents(), source->contents(), source->size()) == 0)
+                        return entry.compressed.lock();
+                }
+
+                return nullptr;
+            }
+
+            void Add(std::shared_ptr<WorldPacket const> const& source, uint32 checksum, std::shared_ptr<WorldPacket const> const& compressed)
+            {
+                Entry& entry = m_entries[m_next];
+                entry.checksum = checksum;
+                entry.size = source->size();
+                entry.source = source;
+                entry.compressed = compressed;
+                m_next = (m_next + 1) % m_entries.size();
+            }
+
+        private:
+            struct Entry
+            {
+                Entry() : checksum(0), size(0) {}
+
+                uint32 checksum;
+                size_t size;
+                std::weak_ptr<WorldPacket const> source;
+                std::weak_ptr<WorldPacket const> compressed;
+            };
+
+            std::array<Entry, 32> m_entries;
+            size_t m_next;
+    };
+
+    thread_local CompressedPacketCache t_compressedPacketCache;
+}
+
+std::atomic<int> UpdateData::s_compressionLevel(1);
 
-    if (c_stream.avail_in != 0)
+void UpdateData::Compress(void* dst, uint32* dst_size, void* src, int src_size)
+{
+    // default Z_BEST_SPEED (1)
+    z_stream* c_stream = t_deflateStream.Get(s_compressionLevel.load(std::memory_order_relaxed));
+    if (!c_stream)
     {
-        sLog.outError("Can't compress update packet (zlib: deflate not greedy)");
         *dst_size = 0;
         return;
     }
 
-    z_res = deflate(&c_stream, Z_FINISH);
+    c_stream->next_out = (Bytef*)dst;
+    c_stream->avail_out = *dst_size;
+    c_stream->next_in = (Bytef*)src;
+    c_stream->avail_in = (uInt)src_size;
+
+    // dst is sized by compressBound, a single call always finishes the stream
+    int z_res = deflate(c_stream, Z_FINISH);
     if (z_res != Z_STREAM_END)
     {
         sLog.outError("Can't compress update packet (zlib: deflate should report Z_STREAM_END instead %i (%s)", z_res, zError(z_res));
@@ -105,15 +201,37 @@ void UpdateData::Compress(void* dst, uint32* dst_size, void* src, int src_size)
         return;
     }
 
-    z_res = deflateEnd(&c_stream);
-    if (z_res != Z_OK)
-    {
-        sLog.outError("Can't compress update packet (zlib: deflateEnd) Error code: %i (%s)", z_res, zError(z_res));
-        *dst_size = 0;
-        return;
-    }
+    *dst_size = c_stream->total_out;
+}
+
+bool UpdateData::NeedsCompression(WorldPacket const& packet)
+{
+    return packet.GetOpcode() == SMSG_UPDATE_OBJECT && packet.size() > UPDATE_DATA_COMPRESSION_THRESHOLD;
+}
+
+std::shared_ptr<WorldPacket const> UpdateData::CompressPacket(std::shared_ptr<WorldPacket const> const& packet)
+{
+    if (std::shared_ptr<WorldPacket const> cached = t_compressedPacketCache.FindSame(packet))
+        return cached;
+
+    // only packets passing NeedsCompression get here, the checksum costs a fraction of the deflate it may save
+    uint32 checksum = crc32(0L, packet->contents(), packet->size());
+    if (std::shared_ptr<WorldPacket const> cached = t_compressedPacketCache.FindEqual(packet, checksum))
+        return cached;
 
-    *dst_size = c_stream.total_out;
+    size_t pSize = packet->size();
+    uint32 destsize = compressBound(pSize);
+
+    std::shared_ptr<WorldPacket> compressed = std::make_shared<WorldPacket>(SMSG_COMPRESSED_UPDATE_OBJECT, destsize + sizeof(uint32));
+    compressed->resize(destsize + sizeof(uint32));
+    compressed->put<uint32>(0, pSize);
+    Compress(const_cast<uint8*>(compressed->contents()) + sizeof(uint32), &destsize, (void*)packet->contents(), pSize);
+    if (destsize == 0)
+        return packet;                                      // still valid, only larger
+
+    compressed->resize(destsize + sizeof(uint32));
+    t_compressedPacketCache.Add(packet, checksum, compressed);
+    return compressed;
 }
 
 WorldPacket UpdateData::BuildPacket(size_t index)
@@ -136,26 +254,9 @@ WorldPacket UpdateData::BuildPacket(size_t index)
 
     buf.append(m_data[index].m_buffer);
 
-    size_t pSize = buf.wpos();                              // use real used data size
-
-    if (pSize > 100)                                        // compress large packets
-    {
-        uint32 destsize = compressBound(pSize);
-        packet.resize(destsize + sizeof(uint32));
-
-        packet.put<uint32>(0, pSize);
-        Compress(const_cast<uint8*>(packet.contents()) + sizeof(uint32), &destsize, (void*)buf.contents(), pSize);
-        if (destsize == 0)
-            return packet;
-
-        packet.resize(destsize + sizeof(uint32));
-        packet.SetOpcode(SMSG_COMPRESSED_UPDATE_OBJECT);
-    }
-    else                                                    // send small packets without compression
-    {
-        packet.append(buf);
-        packet.SetOpcode(SMSG_UPDATE_OBJECT);
-    }
+    // compressed on the network thread right before the write, see CompressPacket
+    packet.append(buf);
+    packet.SetOpcode(SMSG_UPDATE_OBJECT);
 
     return packet;
 }
@@ -170,7 +271,6 @@ void UpdateData::SendData(WorldSession& session)
 {
     for (size_t i = 0; i < GetPacketCount(); ++i)
     {
-        WorldPacket packet = BuildPacket(i);
-        session.SendPacket(packet);
+        session.SendPacket(BuildPacket(i));
     }
 }
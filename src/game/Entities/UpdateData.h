@@ -22,6 +22,9 @@
 #include "Util/ByteBuffer.h"
 #include "Entities/ObjectGuid.h"
 
+#include <atomic>
+#include <memory>
+
 class WorldPacket;
 class WorldSession;
 
@@ -50,6 +53,9 @@ enum ObjectUpdateFlags
     UPDATEFLAG_ROTATION             = 0x0200
 };
 
+// SMSG_UPDATE_OBJECT packets above this size are sent as SMSG_COMPRESSED_UPDATE_OBJECT
+#define UPDATE_DATA_COMPRESSION_THRESHOLD 100
+
 struct BufferPair
 {
     ByteBuffer m_buffer;
@@ -61,7 +67,7 @@ class UpdateData
     public:
         UpdateData();
 
-        void AddOutOfRangeGUID(GuidSet& guids);
+        void AddOutOfRangeGUID(GuidHashSet& guids);
         void AddOutOfRangeGUID(ObjectGuid const& guid);
         void AddUpdateBlock(const ByteBuffer& block);
         WorldPacket BuildPacket(size_t index); // Copy Elision is a thing
@@ -73,11 +79,20 @@ class UpdateData
 
         void SendData(WorldSession& session);
 
+        // the packets are built uncompressed, the network thread compresses them while sending
+        static bool NeedsCompression(WorldPacket const& packet);
+        // returns the compressed copy, reused when the same payload was compressed recently on this thread
+        static std::shared_ptr<WorldPacket const> CompressPacket(std::shared_ptr<WorldPacket const> const& packet);
+        // snapshot of the Compression setting, taken by the world thread for the network threads
+        static void SetCompressionLevel(int level) { s_compressionLevel.store(level, std::memory_order_relaxed); }
+
     protected:
         GuidSet m_outOfRangeGUIDs;
         std::vector<BufferPair> m_data;
         uint32 m_currentIndex;
 
         static void Compress(void* dst, uint32* dst_size, void* src, int src_size);
+
+        static std::atomic<int> s_compressionLevel;
 };
 #endif
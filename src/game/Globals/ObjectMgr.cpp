@@ -1996,7 +1996,7 @@ void ObjectMgr::LoadCreatureSpawnEntry()
 {
     m_creatureSpawnEntryMap.clear();
 
-    auto queryResult = WorldDatabase.Query("SELECT guid, entry FROM creature_spawn_entry");
+    auto queryResult = WorldDatabase.QueryBinary("SELECT guid, entry FROM creature_spawn_entry");
 
     if (!queryResult)
     {
@@ -2040,8 +2040,8 @@ void ObjectMgr::LoadCreatureSpawnEntry()
 void ObjectMgr::LoadCreatures()
 {
     uint32 count = 0;
-    //                                             0                       1   2
-    auto queryResult = WorldDatabase.Query("SELECT creature.guid, creature.id, map,"
+    //                                                   0                       1   2
+    auto queryResult = WorldDatabase.QueryBinary("SELECT creature.guid, creature.id, map,"
                           //        3           4           5            6                 7                 8          9
                           "position_x, position_y, position_z, orientation, spawntimesecsmin, spawntimesecsmax, spawndist,"
                           //   10         11        12         13
@@ -2284,8 +2284,8 @@ void ObjectMgr::LoadGameObjects()
 {
     uint32 count = 0;
 
-    //                                             0                           1   2    3                      4                      5                      6
-    auto queryResult = WorldDatabase.Query("SELECT gameobject.guid, gameobject.id, map, round(position_x, 20), round(position_y, 20), round(position_z, 20), round(orientation, 20),"
+    //                                                   0                           1   2    3                      4                      5                      6
+    auto queryResult = WorldDatabase.QueryBinary("SELECT gameobject.guid, gameobject.id, map, round(position_x, 20), round(position_y, 20), round(position_z, 20), round(orientation, 20),"
                           // 7                   8                     9                     10                    11                12                13         14         15
                           "round(rotation0, 20), round(rotation1, 20), round(rotation2, 20), round(rotation3, 20), spawntimesecsmin, spawntimesecsmax, spawnMask, phaseMask, event,"
                           //   16                          17
@@ -2519,7 +2519,7 @@ void ObjectMgr::LoadGameObjectSpawnEntry()
 {
     m_gameobjectSpawnEntryMap.clear();
 
-    auto queryResult = WorldDatabase.Query("SELECT guid, entry FROM gameobject_spawn_entry");
+    auto queryResult = WorldDatabase.QueryBinary("SELECT guid, entry FROM gameobject_spawn_entry");
 
     if (!queryResult)
     {
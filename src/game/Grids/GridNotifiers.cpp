@@ -34,6 +34,7 @@ void VisibleChangesNotifier::Visit(CameraMapType& m)
     for (auto& iter : m)
     {
         iter.getSource()->UpdateVisibilityOf(&i_object);
+        iter.getSource()->AddWatched(&i_object);
         m_unvisitedGuids.erase(iter.getSource()->GetOwner()->GetObjectGuid());
     }
 }
@@ -59,20 +60,21 @@ void VisibleNotifier::Notify()
     }
 
     // Far objects update on player notify
-    for (GuidSet::iterator itr = i_clientGUIDs.begin(); itr != i_clientGUIDs.end();)
+    for (auto itr = i_clientGUIDs.begin(); itr != i_clientGUIDs.end();)
     {
-        GuidSet::iterator current = itr++;
+        auto current = itr++;
         if (WorldObject* obj = player.GetMap()->GetWorldObject(*current))
         {
             if (!obj->GetVisibilityData().IsVisibilityOverridden())
                 continue;
 
             player.UpdateVisibilityOf(&player, obj);
+            i_camera.RecordInterest(obj);
             i_clientGUIDs.erase(current);
         }
     }
 
-    for (GuidSet::iterator itr = i_clientGUIDs.begin(); itr != i_clientGUIDs.end();)
+    for (auto itr = i_clientGUIDs.begin(); itr != i_clientGUIDs.end();)
     {
         if ((*itr).IsMOTransport())
         {
@@ -84,7 +86,7 @@ void VisibleNotifier::Notify()
 
     // generate outOfRange for not iterate objects
     i_data.AddOutOfRangeGUID(i_clientGUIDs);
-    for (GuidSet::iterator itr = i_clientGUIDs.begin(); itr != i_clientGUIDs.end(); ++itr)
+    for (auto itr = i_clientGUIDs.begin(); itr != i_clientGUIDs.end(); ++itr)
     {
         if (WorldObject* target = player.GetMap()->GetWorldObject(*itr))
         {
@@ -100,17 +102,21 @@ void VisibleNotifier::Notify()
                          itr->GetString().c_str(), player.GetGuidStr().c_str());
     }
 
-    if (i_data.HasData())
+    SendVisibilityChanges(player, i_data, i_visibleNow);
+}
+
+void VisibleNotifier::SendVisibilityChanges(Player& player, UpdateData& data, WorldObjectSet const& visibleNow)
+{
+    if (data.HasData())
     {
         // send create/outofrange packet to player (except player create updates that already sent using SendUpdateToPlayer)
-        for (size_t i = 0; i < i_data.GetPacketCount(); ++i)
+        for (size_t i = 0; i < data.GetPacketCount(); ++i)
         {
-            WorldPacket packet = i_data.BuildPacket(i);
-            player.GetSession()->SendPacket(packet);
+            player.GetSession()->SendPacket(data.BuildPacket(i));
         }
 
         // send out of range to other players if need
-        GuidSet const& oor = i_data.GetOutOfRangeGUIDs();
+        GuidSet const& oor = data.GetOutOfRangeGUIDs();
         for (auto iter : oor)
         {
             if (!iter.IsPlayer())
@@ -124,7 +130,7 @@ void VisibleNotifier::Notify()
     // Now do operations that required done at object visibility change to visible
 
     // send data at target visibility change (adding to client)
-    for (auto vItr : i_visibleNow)
+    for (auto vItr : visibleNow)
     {
         // target aura duration for caster show only if target exist at caster client
         if (vItr != &player && vItr->isType(TYPEMASK_UNIT))
@@ -144,7 +150,7 @@ void MessageDeliverer::Visit(CameraMapType& m)
                 continue;
 
             if (WorldSession* session = owner->GetSession())
-                session->SendPacket(i_message);
+                i_message.AddReceiver(session);
         }
     }
 }
@@ -159,7 +165,7 @@ void MessageDelivererExcept::Visit(CameraMapType& m)
             continue;
 
         if (WorldSession* session = owner->GetSession())
-            session->SendPacket(i_message);
+            i_message.AddReceiver(session);
     }
 }
 
@@ -171,7 +177,7 @@ void ObjectMessageDeliverer::Visit(CameraMapType& m)
             continue;
 
         if (WorldSession* session = iter.getSource()->GetOwner()->GetSession())
-            session->SendPacket(i_message);
+            i_message.AddReceiver(session);
     }
 }
 
@@ -189,7 +195,7 @@ void MessageDistDeliverer::Visit(CameraMapType& m)
                 continue;
 
             if (WorldSession* session = owner->GetSession())
-                session->SendPacket(i_message);
+                i_message.AddReceiver(session);
         }
     }
 }
@@ -204,7 +210,7 @@ void ObjectMessageDistDeliverer::Visit(CameraMapType& m)
                 continue;
 
             if (WorldSession* session = iter.getSource()->GetOwner()->GetSession())
-                session->SendPacket(i_message);
+                i_message.AddReceiver(session);
         }
     }
 }
@@ -222,7 +228,7 @@ void SpellMessageDestLocDeliverer::Visit(CameraMapType& m)
 
         if (WorldSession* session = player->GetSession())
         {
-            session->SendPacket(i_message);
+            i_message.AddReceiver(session);
             if (i_accumulate)
                 i_guids.insert(player->GetObjectGuid());
         }
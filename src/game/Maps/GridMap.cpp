@@ -31,6 +31,18 @@
 
 #include <mutex>
 
+#if defined(__SSE2__) || defined(_M_X64)
+#define GRIDMAP_SSE2
+#include <emmintrin.h>
+#endif
+
+#if PLATFORM != PLATFORM_WINDOWS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 char const* MAP_MAGIC         = "MAPS";
 char const* MAP_VERSION_MAGIC = "v1.4";
 char const* MAP_AREA_MAGIC    = "AREA";
@@ -69,6 +81,10 @@ GridMap::GridMap() : m_gridIntHeightMultiplier(0.0f)
     // Holes
     m_holes = nullptr;
 
+    m_fileData = nullptr;
+    m_fileSize = 0;
+    m_fileMapped = false;
+
     m_fullyLoaded = false;
 }
 
@@ -82,143 +98,250 @@ bool GridMap::loadData(char const* filename)
     // Unload old data if exist
     unloadData();
 
-    GridMapFileHeader header;
     // Not return error if file not found
-    FILE* in = fopen(filename, "rb");
-    if (!in)
+    if (!loadFile(filename))
     {
         DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "Failled to found %s", filename);
         // its a valid error only in case of no vmap files are available too
         return true;
     }
 
-    if (fread(&header, sizeof(header), 1, in) != 1)
+    if (m_fileSize < sizeof(GridMapFileHeader))
     {
         sLog.outError("Error loading GridMapFileHeader\n");
-        fclose(in);
+        unloadData();
         return false;
     }
 
+    GridMapFileHeader header;
+    memcpy(&header, m_fileData, sizeof(header));
+
     if (header.mapMagic == *((uint32 const*)(MAP_MAGIC)) &&
             header.versionMagic == *((uint32 const*)(MAP_VERSION_MAGIC)) &&
             IsAcceptableClientBuild(header.buildMagic))
     {
         // loadup area data
-        if (header.areaMapOffset && !loadAreaData(in, header.areaMapOffset, header.areaMapSize))
+        if (header.areaMapOffset && !loadAreaData(header.areaMapOffset, header.areaMapSize))
         {
             sLog.outError("Error loading map area data\n");
-            fclose(in);
+            unloadData();
             return false;
         }
 
         // loadup height data
-        if (header.heightMapOffset && !loadHeightData(in, header.heightMapOffset, header.heightMapSize))
+        if (header.heightMapOffset && !loadHeightData(header.heightMapOffset, header.heightMapSize))
         {
             sLog.outError("Error loading map height data\n");
-            fclose(in);
+            unloadData();
             return false;
         }
 
         // loadup liquid data
-        if (header.liquidMapOffset && !loadGridMapLiquidData(in, header.liquidMapOffset, header.liquidMapSize))
+        if (header.liquidMapOffset && !loadGridMapLiquidData(header.liquidMapOffset, header.liquidMapSize))
         {
             sLog.outError("Error loading map liquids data\n");
-            fclose(in);
+            unloadData();
             return false;
         }
 
         // loadup holes data (if any. check header.holesOffset)
-        if (header.holesOffset && !loadHolesData(in, header.holesOffset, header.holesSize))
+        if (header.holesOffset && !loadHolesData(header.holesOffset, header.holesSize))
         {
             sLog.outError("Error loading map holes data\n");
-            fclose(in);
+            unloadData();
             return false;
         }
 
-        fclose(in);
         return true;
     }
 
     sLog.outError("Map file '%s' has the wrong version. Please extract the mapfiles again with the latest extractors.", filename);
-    fclose(in);
+    unloadData();
     return false;
 }
 
 void GridMap::unloadData()
 {
-    if (m_area_map)    { delete[] m_area_map;    m_area_map = nullptr; }
-    if (m_V9)          { delete[] m_V9;          m_V9 = nullptr; }
-    if (m_V8)          { delete[] m_V8;          m_V8 = nullptr; }
-    if (m_liquidEntry) { delete[] m_liquidEntry; m_liquidEntry = nullptr; }
-    if (m_liquidFlags) { delete[] m_liquidFlags; m_liquidFlags = nullptr; }
-    if (m_liquid_map)  { delete[] m_liquid_map;  m_liquid_map = nullptr; }
-    if (m_holes)       { delete[] m_holes;       m_holes = nullptr; }
+    unloadArray(m_area_map);
+    // copies were allocated with the element type of the height format
+    if (m_gridGetHeight == &GridMap::getHeightFromFloat)
+    {
+        unloadArray(m_V9);
+        unloadArray(m_V8);
+    }
+    else if (m_gridGetHeight == &GridMap::getHeightFromUint16)
+    {
+        unloadArray(m_uint16_V9);
+        unloadArray(m_uint16_V8);
+    }
+    else
+    {
+        unloadArray(m_uint8_V9);
+        unloadArray(m_uint8_V8);
+    }
+    unloadArray(m_liquidEntry);
+    unloadArray(m_liquidFlags);
+    unloadArray(m_liquid_map);
+    unloadArray(m_holes);
+    unloadFile();
 
     m_gridGetHeight = &GridMap::getHeightFromFlat;
 }
 
-bool GridMap::loadAreaData(FILE* in, uint32 offset, uint32 /*size*/)
+bool GridMap::loadFile(char const* filename)
 {
-    GridMapAreaHeader header;
-    if (fseek(in, offset, SEEK_SET) != 0)
+#if PLATFORM != PLATFORM_WINDOWS
+    if (sWorld.getConfig(CONFIG_BOOL_TERRAIN_MEMORY_MAPPED))
+    {
+        int fd = open(filename, O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat fileStat;
+        if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0)
+        {
+            // shared mapping, all map instances and all processes on the host use the same pages
+            // reading pages past the end of a file truncated afterwards raises SIGBUS, see Terrain.MemoryMapped
+            void* data = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+            if (data != MAP_FAILED)
+            {
+                m_fileData = static_cast<uint8*>(data);
+                m_fileSize = fileStat.st_size;
+                m_fileMapped = true;
+            }
+        }
+
+        close(fd);
+        if (m_fileMapped)
+            return true;
+    }
+#endif
+
+    FILE* in = fopen(filename, "rb");
+    if (!in)
+        return false;
+
+    fseek(in, 0, SEEK_END);
+    long size = ftell(in);
+    fseek(in, 0, SEEK_SET);
+
+    if (size > 0)
+    {
+        m_fileData = new uint8[size];
+        m_fileSize = size;
+        if (fread(m_fileData, 1, m_fileSize, in) != m_fileSize)
+            m_fileSize = 0;                                 // header check fails
+    }
+
+    fclose(in);
+    return m_fileData != nullptr;
+}
+
+void GridMap::unloadFile()
+{
+    if (!m_fileData)
+        return;
+
+#if PLATFORM != PLATFORM_WINDOWS
+    if (m_fileMapped)
+        munmap(m_fileData, m_fileSize);
+    else
+#endif
+        delete[] m_fileData;
+
+    m_fileData = nullptr;
+    m_fileSize = 0;
+    m_fileMapped = false;
+}
+
+void GridMap::Prefetch() const
+{
+#if PLATFORM != PLATFORM_WINDOWS
+    if (m_fileMapped)
+        madvise(m_fileData, m_fileSize, MADV_WILLNEED);
+#endif
+}
+
+template<typename T>
+bool GridMap::loadArray(T*& array, uint32 offset, uint32 count)
+{
+    if (uint64(offset) + uint64(count) * sizeof(T) > m_fileSize)
         return false;
-    if (fread(&header, sizeof(header), 1, in) != 1)
+
+    // files from older extractors may have misaligned sections
+    uint8* data = m_fileData + offset;
+    if (reinterpret_cast<uintptr_t>(data) % alignof(T) == 0)
+        array = reinterpret_cast<T*>(data);
+    else
+    {
+        array = new T[count];
+        memcpy(array, data, count * sizeof(T));
+    }
+
+    return true;
+}
+
+template<typename T>
+void GridMap::unloadArray(T*& array)
+{
+    if (array && (reinterpret_cast<uint8*>(array) < m_fileData || reinterpret_cast<uint8*>(array) >= m_fileData + m_fileSize))
+        delete[] array;
+
+    array = nullptr;
+}
+
+bool GridMap::loadAreaData(uint32 offset, uint32 /*size*/)
+{
+    GridMapAreaHeader header;
+    if (uint64(offset) + sizeof(header) > m_fileSize)
         return false;
+    memcpy(&header, m_fileData + offset, sizeof(header));
     if (header.fourcc != *((uint32 const*)(MAP_AREA_MAGIC)))
         return false;
 
     m_gridArea = header.gridArea;
     if (!(header.flags & MAP_AREA_NO_AREA))
-    {
-        m_area_map = new uint16 [16 * 16];
-        if (fread(m_area_map, sizeof(uint16), 16 * 16, in) != 16 * 16)
-            return false;
-    }
+        return loadArray(m_area_map, offset + sizeof(header), 16 * 16);
 
     return true;
 }
 
-bool GridMap::loadHeightData(FILE* in, uint32 offset, uint32 /*size*/)
+bool GridMap::loadHeightData(uint32 offset, uint32 /*size*/)
 {
     GridMapHeightHeader header;
-    if (fseek(in, offset, SEEK_SET) != 0)
-        return false;
-    if (fread(&header, sizeof(header), 1, in) != 1)
+    if (uint64(offset) + sizeof(header) > m_fileSize)
         return false;
+    memcpy(&header, m_fileData + offset, sizeof(header));
     if (header.fourcc != *((uint32 const*)(MAP_HEIGHT_MAGIC)))
         return false;
 
+    offset += sizeof(header);
     m_gridHeight = header.gridHeight;
     if (!(header.flags & MAP_HEIGHT_NO_HEIGHT))
     {
         if ((header.flags & MAP_HEIGHT_AS_INT16))
         {
-            m_uint16_V9 = new uint16[129 * 129];
-            m_uint16_V8 = new uint16[128 * 128];
-            if (fread(m_uint16_V9, sizeof(uint16), 129 * 129, in) != 129 * 129 ||
-                    fread(m_uint16_V8, sizeof(uint16), 128 * 128, in) != 128 * 128)
+            // set first, it tells unloadData how to free a partial load
+            m_gridGetHeight = &GridMap::getHeightFromUint16;
+            if (!loadArray(m_uint16_V9, offset, 129 * 129) ||
+                    !loadArray(m_uint16_V8, offset + sizeof(uint16) * 129 * 129, 128 * 128))
                 return false;
             m_gridIntHeightMultiplier = (header.gridMaxHeight - header.gridHeight) / 65535;
-            m_gridGetHeight = &GridMap::getHeightFromUint16;
         }
         else if ((header.flags & MAP_HEIGHT_AS_INT8))
         {
-            m_uint8_V9 = new uint8[129 * 129];
-            m_uint8_V8 = new uint8[128 * 128];
-            if (fread(m_uint8_V9, sizeof(uint8), 129 * 129, in) != 129 * 129 ||
-                    fread(m_uint8_V8, sizeof(uint8), 128 * 128, in) != 128 * 128)
+            m_gridGetHeight = &GridMap::getHeightFromUint8;
+            if (!loadArray(m_uint8_V9, offset, 129 * 129) ||
+                    !loadArray(m_uint8_V8, offset + sizeof(uint8) * 129 * 129, 128 * 128))
                 return false;
             m_gridIntHeightMultiplier = (header.gridMaxHeight - header.gridHeight) / 255;
-            m_gridGetHeight = &GridMap::getHeightFromUint8;
         }
         else
         {
-            m_V9 = new float[129 * 129];
-            m_V8 = new float[128 * 128];
-            if (fread(m_V9, sizeof(float), 129 * 129, in) != 129 * 129 ||
-                    fread(m_V8, sizeof(float), 128 * 128, in) != 128 * 128)
-                return false;
             m_gridGetHeight = &GridMap::getHeightFromFloat;
+            if (!loadArray(m_V9, offset, 129 * 129) ||
+                    !loadArray(m_V8, offset + sizeof(float) * 129 * 129, 128 * 128))
+                return false;
         }
     }
     else
@@ -227,21 +350,17 @@ bool GridMap::loadHeightData(FILE* in, uint32 offset, uint32 /*size*/)
     return true;
 }
 
-bool GridMap::loadHolesData(FILE* in, uint32 offset, uint32 /*size*/)
+bool GridMap::loadHolesData(uint32 offset, uint32 /*size*/)
 {
-    if (fseek(in, offset, SEEK_SET) != 0)
-        return false;
-    m_holes = new uint16[16 * 16];
-    return fread(m_holes, sizeof(uint16), 16 * 16, in) == 16 * 16;
+    return loadArray(m_holes, offset, 16 * 16);
 }
 
-bool GridMap::loadGridMapLiquidData(FILE* in, uint32 offset, uint32 /*size*/)
+bool GridMap::loadGridMapLiquidData(uint32 offset, uint32 /*size*/)
 {
     GridMapLiquidHeader header;
-    if (fseek(in, offset, SEEK_SET) != 0)
-        return false;
-    if (fread(&header, sizeof(header), 1, in) != 1)
+    if (uint64(offset) + sizeof(header) > m_fileSize)
         return false;
+    memcpy(&header, m_fileData + offset, sizeof(header));
     if (header.fourcc != *((uint32 const*)(MAP_LIQUID_MAGIC)))
         return false;
 
@@ -253,23 +372,17 @@ bool GridMap::loadGridMapLiquidData(FILE* in, uint32 offset, uint32 /*size*/)
     m_liquid_height = header.height;
     m_liquidLevel   = header.liquidLevel;
 
+    offset += sizeof(header);
     if (!(header.flags & MAP_LIQUID_NO_TYPE))
     {
-        m_liquidEntry = new uint16[16 * 16];
-        if (fread(m_liquidEntry, sizeof(uint16), 16 * 16, in) != 16 * 16)
-            return false;
-
-        m_liquidFlags = new uint8[16 * 16];
-        if (fread(m_liquidFlags, sizeof(uint8), 16 * 16, in) != 16 * 16)
+        if (!loadArray(m_liquidEntry, offset, 16 * 16) ||
+                !loadArray(m_liquidFlags, offset + sizeof(uint16) * 16 * 16, 16 * 16))
             return false;
+        offset += sizeof(uint16) * 16 * 16 + sizeof(uint8) * 16 * 16;
     }
 
     if (!(header.flags & MAP_LIQUID_NO_HEIGHT))
-    {
-        m_liquid_map = new float[m_liquid_width * m_liquid_height];
-        if (fread(m_liquid_map, sizeof(float), m_liquid_width * m_liquid_height, in) != size_t(m_liquid_width * m_liquid_height))
-            return false;
-    }
+        return loadArray(m_liquid_map, offset, m_liquid_width * m_liquid_height);
 
     return true;
 }
@@ -527,6 +640,151 @@ float GridMap::getHeightFromUint16(float x, float y) const
     return (float)((a * x) + (b * y) + c) * m_gridIntHeightMultiplier + m_gridHeight;
 }
 
+#ifdef GRIDMAP_SSE2
+namespace
+{
+    // cell coordinates of four points the way the scalar getHeightFrom* compute them
+    inline void LoadHeightCells(float const* x, float const* y, __m128& fx, __m128& fy, int32* xInt, int32* yInt)
+    {
+        __m128 const resolution = _mm_set1_ps(float(MAP_RESOLUTION));
+        __m128 const center = _mm_set1_ps(32.0f);
+        __m128 const gridSize = _mm_set1_ps(SIZE_OF_GRIDS);
+        __m128i const mask = _mm_set1_epi32(MAP_RESOLUTION - 1);
+
+        fx = _mm_mul_ps(resolution, _mm_sub_ps(center, _mm_div_ps(_mm_loadu_ps(x), gridSize)));
+        fy = _mm_mul_ps(resolution, _mm_sub_ps(center, _mm_div_ps(_mm_loadu_ps(y), gridSize)));
+
+        __m128i xi = _mm_cvttps_epi32(fx);
+        __m128i yi = _mm_cvttps_epi32(fy);
+        fx = _mm_sub_ps(fx, _mm_cvtepi32_ps(xi));
+        fy = _mm_sub_ps(fy, _mm_cvtepi32_ps(yi));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(xInt), _mm_and_si128(xi, mask));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(yInt), _mm_and_si128(yi, mask));
+    }
+
+    inline __m128 Select(__m128 mask, __m128 a, __m128 b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+    inline __m128i Select(__m128i mask, __m128i a, __m128i b) { return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b)); }
+}
+
+// Same triangles as getHeightFromFloat, all four coefficient sets are computed and the right one
+// is picked per point instead of branching. The operations are done in the same order so the
+// results are bit identical to the scalar ones
+uint32 GridMap::getHeightsFromFloat(float const* x, float const* y, float* heights, uint32 count) const
+{
+    __m128 const one = _mm_set1_ps(1.0f);
+    __m128 const two = _mm_set1_ps(2.0f);
+
+    uint32 i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 fx, fy;
+        int32 xInt[4], yInt[4];
+        LoadHeightCells(x + i, y + i, fx, fy, xInt, yInt);
+
+        float v1[4], v2[4], v3[4], v4[4], v5[4];
+        for (uint32 k = 0; k < 4; ++k)
+        {
+            float const* h1 = &m_V9[xInt[k] * 129 + yInt[k]];
+            v1[k] = h1[0];
+            v2[k] = h1[129];
+            v3[k] = h1[1];
+            v4[k] = h1[130];
+            v5[k] = m_V8[xInt[k] * 128 + yInt[k]];
+        }
+
+        __m128 h1 = _mm_loadu_ps(v1), h2 = _mm_loadu_ps(v2), h3 = _mm_loadu_ps(v3), h4 = _mm_loadu_ps(v4);
+        __m128 h5 = _mm_mul_ps(two, _mm_loadu_ps(v5));
+
+        __m128 lower = _mm_cmplt_ps(_mm_add_ps(fx, fy), one);
+        __m128 right = _mm_cmpgt_ps(fx, fy);
+
+        __m128 a = Select(lower,
+            Select(right, _mm_sub_ps(h2, h1), _mm_sub_ps(_mm_sub_ps(h5, h1), h3)),
+            Select(right, _mm_sub_ps(_mm_add_ps(h2, h4), h5), _mm_sub_ps(h4, h3)));
+        __m128 b = Select(lower,
+            Select(right, _mm_sub_ps(_mm_sub_ps(h5, h1), h2), _mm_sub_ps(h3, h1)),
+            Select(right, _mm_sub_ps(h4, h2), _mm_sub_ps(_mm_add_ps(h3, h4), h5)));
+        __m128 c = Select(lower, h1, _mm_sub_ps(h5, h4));
+
+        _mm_storeu_ps(heights + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, fx), _mm_mul_ps(b, fy)), c));
+
+        if (m_holes)
+            for (uint32 k = 0; k < 4; ++k)
+                if (isHole(xInt[k], yInt[k]))
+                    heights[i + k] = INVALID_HEIGHT_VALUE;
+    }
+
+    return i;
+}
+
+// Same as getHeightsFromFloat for the integer height formats of getHeightFromUint8/Uint16
+template<typename T>
+uint32 GridMap::getHeightsFromInt(T const* V9, T const* V8, float const* x, float const* y, float* heights, uint32 count) const
+{
+    __m128 const one = _mm_set1_ps(1.0f);
+    __m128 const multiplier = _mm_set1_ps(m_gridIntHeightMultiplier);
+    __m128 const base = _mm_set1_ps(m_gridHeight);
+
+    uint32 i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 fx, fy;
+        int32 xInt[4], yInt[4];
+        LoadHeightCells(x + i, y + i, fx, fy, xInt, yInt);
+
+        int32 v1[4], v2[4], v3[4], v4[4], v5[4];
+        for (uint32 k = 0; k < 4; ++k)
+        {
+            T const* h1 = &V9[xInt[k] * 129 + yInt[k]];
+            v1[k] = h1[0];
+            v2[k] = h1[129];
+            v3[k] = h1[1];
+            v4[k] = h1[130];
+            v5[k] = V8[xInt[k] * 128 + yInt[k]];
+        }
+
+        __m128i h1 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(v1));
+        __m128i h2 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(v2));
+        __m128i h3 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(v3));
+        __m128i h4 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(v4));
+        __m128i h5 = _mm_slli_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(v5)), 1);
+
+        __m128i lower = _mm_castps_si128(_mm_cmplt_ps(_mm_add_ps(fx, fy), one));
+        __m128i right = _mm_castps_si128(_mm_cmpgt_ps(fx, fy));
+
+        __m128i a = Select(lower,
+            Select(right, _mm_sub_epi32(h2, h1), _mm_sub_epi32(_mm_sub_epi32(h5, h1), h3)),
+            Select(right, _mm_sub_epi32(_mm_add_epi32(h2, h4), h5), _mm_sub_epi32(h4, h3)));
+        __m128i b = Select(lower,
+            Select(right, _mm_sub_epi32(_mm_sub_epi32(h5, h1), h2), _mm_sub_epi32(h3, h1)),
+            Select(right, _mm_sub_epi32(h4, h2), _mm_sub_epi32(_mm_add_epi32(h3, h4), h5)));
+        __m128i c = Select(lower, h1, _mm_sub_epi32(h5, h4));
+
+        __m128 height = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(a), fx), _mm_mul_ps(_mm_cvtepi32_ps(b), fy)), _mm_cvtepi32_ps(c));
+        _mm_storeu_ps(heights + i, _mm_add_ps(_mm_mul_ps(height, multiplier), base));
+    }
+
+    return i;
+}
+#endif
+
+void GridMap::getHeights(float const* x, float const* y, float* heights, uint32 count) const
+{
+    uint32 done = 0;
+#ifdef GRIDMAP_SSE2
+    if (m_gridGetHeight == &GridMap::getHeightFromFloat && m_V8 && m_V9)
+        done = getHeightsFromFloat(x, y, heights, count);
+    else if (m_gridGetHeight == &GridMap::getHeightFromUint16 && m_uint16_V8 && m_uint16_V9)
+        done = getHeightsFromInt(m_uint16_V9, m_uint16_V8, x, y, heights, count);
+    else if (m_gridGetHeight == &GridMap::getHeightFromUint8 && m_uint8_V8 && m_uint8_V9)
+        done = getHeightsFromInt(m_uint8_V9, m_uint8_V8, x, y, heights, count);
+#endif
+
+    // the remainder, flat grids and grids without height data
+    for (uint32 i = done; i < count; ++i)
+        heights[i] = getHeight(x[i], y[i]);
+}
+
 float GridMap::getLiquidLevel(float x, float y) const
 {
     if (!m_liquid_map)
@@ -751,9 +1009,9 @@ GridMap* TerrainInfo::Load(const uint32 x, const uint32 y, bool mapOnly /*= fals
     // reference grid as a first step
     RefGrid(x, y);
 
-    // quick check if GridMap already loaded
+    // quick check if GridMap already loaded, a prefetched one may still lack its vmap
     GridMap* pMap = m_GridMaps[x][y];
-    if (!pMap)
+    if (!pMap || (!mapOnly && !pMap->IsFullyLoaded()))
     {
         pMap = LoadMapAndVMap(x, y, mapOnly);
         m_GridMapsLoadAttempted[x][y] = true;
@@ -790,6 +1048,8 @@ void TerrainInfo::CleanUpGrids(const uint32 diff)
     {
         for (int x = 0; x < MAX_NUMBER_OF_GRIDS; ++x)
         {
+            // the grid prefetcher references a grid while it loads it
+            LOCK_GUARD _lock(m_refMutex);
             const int16& iRef = m_GridRef[x][y];
             GridMap* pMap = m_GridMaps[x][y];
 
@@ -804,6 +1064,8 @@ void TerrainInfo::CleanUpGrids(const uint32 diff)
 
                 // unload VMAPS...
                 m_vmgr->unloadMap(m_mapId, x, y);
+                // the stamps are indexed like GridPair, mirrored to the terrain tiles
+                m_vmapTileStamps.Bump(MAX_NUMBER_OF_GRIDS - 1 - x, MAX_NUMBER_OF_GRIDS - 1 - y, MAX_NUMBER_OF_GRIDS - 1 - x, MAX_NUMBER_OF_GRIDS - 1 - y);
 
                 // unload mmap... - not possible like this - mmaps are per-map
                 // MMAP::MMapFactory::createOrGetMMapManager()->unloadMap(m_mapId, x, y);
@@ -822,6 +1084,49 @@ bool TerrainInfo::CanCheckLiquidLevel(float x, float y) const
     return const_cast<TerrainInfo*>(this)->GetGrid(x, y);
 }
 
+void TerrainInfo::PrefetchAround(uint32 x, uint32 y)
+{
+    // without mapping the whole tile would be read here, which is the stall this avoids
+    if (!sWorld.getConfig(CONFIG_BOOL_TERRAIN_MEMORY_MAPPED))
+        return;
+
+    for (uint32 i = std::max(x, 1u) - 1; i <= std::min(x + 1, uint32(MAX_NUMBER_OF_GRIDS - 1)); ++i)
+    {
+        for (uint32 j = std::max(y, 1u) - 1; j <= std::min(y + 1, uint32(MAX_NUMBER_OF_GRIDS - 1)); ++j)
+        {
+            GridMap* map = m_GridMaps[i][j];
+            if (!map)
+            {
+                if (m_GridMapsLoadAttempted[i][j])
+                    continue;
+
+                // mapping only reads the header, not referenced tiles are released by CleanUpGrids
+                map = LoadMapAndVMap(i, j, true);
+                m_GridMapsLoadAttempted[i][j] = true;
+            }
+
+            if (map)
+                map->Prefetch();
+        }
+    }
+}
+
+void TerrainInfo::PreloadGrid(uint32 x, uint32 y)
+{
+    MANGOS_ASSERT(x < MAX_NUMBER_OF_GRIDS);
+    MANGOS_ASSERT(y < MAX_NUMBER_OF_GRIDS);
+
+    // keeps CleanUpGrids away until the map claims the grid or the prefetcher drops it
+    RefGrid(x, y);
+
+    GridMap* map = m_GridMaps[x][y];
+    if (!map || !map->IsFullyLoaded())
+        map = LoadMapAndVMap(x, y);
+
+    if (map && sWorld.getConfig(CONFIG_BOOL_TERRAIN_MEMORY_MAPPED))
+        map->Prefetch();
+}
+
 int TerrainInfo::RefGrid(const uint32& x, const uint32& y)
 {
     MANGOS_ASSERT(x < MAX_NUMBER_OF_GRIDS);
@@ -848,12 +1153,42 @@ int TerrainInfo::UnrefGrid(const uint32& x, const uint32& y)
 float TerrainInfo::GetHeightStatic(float x, float y, float z, bool useVmaps/*=true*/, float maxSearchDist/*=DEFAULT_HEIGHT_SEARCH*/) const
 {
     float mapHeight = VMAP_INVALID_HEIGHT_VALUE;            // Store Height obtained by maps
-    float vmapHeight = VMAP_INVALID_HEIGHT_VALUE;           // Store Height obtained by vmaps (in "corridor" of z (or slightly above z)
 
     // find raw .map surface under Z coordinates (or well-defined above)
     if (GridMap* gmap = const_cast<TerrainInfo*>(this)->GetGrid(x, y))
         mapHeight = gmap->getHeight(x, y);
 
+    return SelectHeightStatic(x, y, z, mapHeight, useVmaps, maxSearchDist);
+}
+
+void TerrainInfo::GetHeightsStatic(float const* x, float const* y, float const* z, float* heights, uint32 count, bool useVmaps/*=true*/, float maxSearchDist/*=DEFAULT_HEIGHT_SEARCH*/) const
+{
+    // raw .map surface, one batch per run of points on the same grid
+    for (uint32 begin = 0; begin < count;)
+    {
+        int gx = (int)(32 - x[begin] / SIZE_OF_GRIDS);
+        int gy = (int)(32 - y[begin] / SIZE_OF_GRIDS);
+
+        uint32 end = begin + 1;
+        while (end < count && (int)(32 - x[end] / SIZE_OF_GRIDS) == gx && (int)(32 - y[end] / SIZE_OF_GRIDS) == gy)
+            ++end;
+
+        if (GridMap* gmap = const_cast<TerrainInfo*>(this)->GetGrid(x[begin], y[begin]))
+            gmap->getHeights(x + begin, y + begin, heights + begin, end - begin);
+        else
+            std::fill(heights + begin, heights + end, VMAP_INVALID_HEIGHT_VALUE);
+
+        begin = end;
+    }
+
+    for (uint32 i = 0; i < count; ++i)
+        heights[i] = SelectHeightStatic(x[i], y[i], z[i], heights[i], useVmaps, maxSearchDist);
+}
+
+float TerrainInfo::SelectHeightStatic(float x, float y, float z, float mapHeight, bool useVmaps, float maxSearchDist) const
+{
+    float vmapHeight = VMAP_INVALID_HEIGHT_VALUE;           // Store Height obtained by vmaps (in "corridor" of z (or slightly above z)
+
     if (useVmaps)
     {
         if (m_vmgr->isHeightCalcEnabled())
@@ -1371,6 +1706,7 @@ GridMap* TerrainInfo::LoadMapAndVMap(const uint32 x, const uint32 y, bool mapOnl
         {
             case VMAP::VMAP_LOAD_RESULT_OK:
                 DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "VMAP loaded name:%s, id:%d, x:%d, y:%d (vmap rep.: x:%d, y:%d)", mapName, m_mapId, x, y, x, y);
+                m_vmapTileStamps.Bump(MAX_NUMBER_OF_GRIDS - 1 - x, MAX_NUMBER_OF_GRIDS - 1 - y, MAX_NUMBER_OF_GRIDS - 1 - x, MAX_NUMBER_OF_GRIDS - 1 - y);
                 break;
             case VMAP::VMAP_LOAD_RESULT_ERROR:
                 DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "Could not load VMAP name:%s, id:%d, x:%d, y:%d (vmap rep.: x:%d, y:%d)", mapName, m_mapId, x, y, x, y);
@@ -1408,6 +1744,39 @@ float TerrainInfo::GetWaterLevel(float x, float y, float z, float* pGround /*= n
     return VMAP_INVALID_HEIGHT_VALUE;
 }
 
+void TerrainInfo::GetWaterLevels(float const* x, float const* y, float const* z, float* levels, uint32 count, float* grounds /*= nullptr*/) const
+{
+    // ground levels only where the liquid level is checked at all, as GetWaterLevel does
+    std::vector<uint32> checked;
+    std::vector<float> xs, ys, zs;
+    for (uint32 i = 0; i < count; ++i)
+    {
+        levels[i] = VMAP_INVALID_HEIGHT_VALUE;
+        if (CanCheckLiquidLevel(x[i], y[i]))
+        {
+            checked.push_back(i);
+            xs.push_back(x[i]);
+            ys.push_back(y[i]);
+            zs.push_back(z[i]);
+        }
+    }
+
+    std::vector<float> groundZ(checked.size());
+    GetHeightsStatic(xs.data(), ys.data(), zs.data(), groundZ.data(), uint32(checked.size()), true, DEFAULT_WATER_SEARCH);
+
+    // liquid types and area overrides are table lookups, that part stays per point
+    for (uint32 n = 0; n < checked.size(); ++n)
+    {
+        uint32 i = checked[n];
+        if (grounds)
+            grounds[i] = groundZ[n];
+
+        GridMapLiquidData liquid_status;
+        if (getLiquidStatus(x[i], y[i], groundZ[n], MAP_ALL_LIQUIDS, &liquid_status))
+            levels[i] = liquid_status.level;
+    }
+}
+
 //////////////////////////////////////////////////////////////////////////
 
 #define CLASS_LOCK MaNGOS::ClassLevelLockable<TerrainManager, std::mutex>
@@ -22,6 +22,7 @@
 #include "Platform/Define.h"
 #include "Policies/Singleton.h"
 #include "Maps/GridDefines.h"
+#include "Maps/LineOfSightCache.h"
 #include "Entities/ObjectDefines.h"
 
 #include "Maps/GridMapDefines.h"
@@ -82,12 +83,23 @@ class GridMap
         uint16* m_holes;
 
         // For fast check
-        bool m_fullyLoaded;
-
-        bool loadAreaData(FILE* in, uint32 offset, uint32 size);
-        bool loadHeightData(FILE* in, uint32 offset, uint32 size);
-        bool loadGridMapLiquidData(FILE* in, uint32 offset, uint32 size);
-        bool loadHolesData(FILE* in, uint32 offset, uint32 size);
+        std::atomic<bool> m_fullyLoaded;                    // also set by the grid prefetcher thread
+
+        // whole map file, mapped read only and shared through the page cache or read into memory
+        // the data arrays point into it, only misaligned ones are copied
+        uint8* m_fileData;
+        size_t m_fileSize;
+        bool m_fileMapped;
+
+        bool loadFile(char const* filename);
+        void unloadFile();
+        template<typename T> bool loadArray(T*& array, uint32 offset, uint32 count);
+        template<typename T> void unloadArray(T*& array);
+
+        bool loadAreaData(uint32 offset, uint32 size);
+        bool loadHeightData(uint32 offset, uint32 size);
+        bool loadGridMapLiquidData(uint32 offset, uint32 size);
+        bool loadHolesData(uint32 offset, uint32 size);
         bool isHole(int row, int col) const;
 
         // Get height functions and pointers
@@ -98,6 +110,10 @@ class GridMap
         float getHeightFromUint8(float x, float y) const;
         float getHeightFromFlat(float x, float y) const;
 
+        // batched variants of the above for whole groups of four points, return how many were done
+        uint32 getHeightsFromFloat(float const* x, float const* y, float* heights, uint32 count) const;
+        template<typename T> uint32 getHeightsFromInt(T const* V9, T const* V8, float const* x, float const* y, float* heights, uint32 count) const;
+
     public:
 
         GridMap();
@@ -108,11 +124,16 @@ class GridMap
         bool IsFullyLoaded() const { return m_fullyLoaded; }
         void SetFullyLoaded() { m_fullyLoaded = true; }
 
+        // asks the kernel to read the mapped file ahead of the first queries
+        void Prefetch() const;
+
         static bool ExistMap(uint32 mapid, int gx, int gy);
         static bool ExistVMap(uint32 mapid, int gx, int gy);
 
         uint16 getArea(float x, float y) const;
         inline float getHeight(float x, float y) const { return (this->*m_gridGetHeight)(x, y); }
+        // same results as getHeight for each point, all points must be on this grid
+        void getHeights(float const* x, float const* y, float* heights, uint32 count) const;
         float getLiquidLevel(float x, float y) const;
         uint8 getTerrainType(float x, float y) const;
         GridMapLiquidStatus getLiquidStatus(float x, float y, float z, uint8 ReqLiquidType, GridMapLiquidData* data = nullptr, float collisionHeight = 2.03128f);
@@ -148,6 +169,9 @@ class TerrainInfo : public Referencable<std::atomic_long>
         // from 'Map' class into this class
         float GetHeightStatic(float x, float y, float z, bool useVmaps = true, float maxSearchDist = DEFAULT_HEIGHT_SEARCH) const;
         float GetWaterLevel(float x, float y, float z, float* pGround = nullptr) const;
+        // batched GetHeightStatic and GetWaterLevel, the output arrays must not overlap the input ones
+        void GetHeightsStatic(float const* x, float const* y, float const* z, float* heights, uint32 count, bool useVmaps = true, float maxSearchDist = DEFAULT_HEIGHT_SEARCH) const;
+        void GetWaterLevels(float const* x, float const* y, float const* z, float* levels, uint32 count, float* grounds = nullptr) const;
         float GetWaterOrGroundLevel(float x, float y, float z, float& groundZ, bool swim = false, float minWaterDeep = DEFAULT_COLLISION_HEIGHT) const;
         bool IsInWater(float x, float y, float z, GridMapLiquidData* data = nullptr, float min_depth = 2.0f) const;
         bool IsSwimmable(float x, float y, float z, float radius = 1.5f, GridMapLiquidData* data = nullptr) const;
@@ -175,6 +199,16 @@ class TerrainInfo : public Referencable<std::atomic_long>
 
         bool CanCheckLiquidLevel(float x, float y) const;
 
+        // maps the terrain tiles around a grid before they are needed, only with memory mapped terrain
+        void PrefetchAround(uint32 x, uint32 y);
+        // loads terrain and vmap of a grid ahead of the map, called by the grid prefetcher thread
+        // the grid stays referenced so CleanUpGrids keeps it until ReleasePreloadedGrid
+        void PreloadGrid(uint32 x, uint32 y);
+        void ReleasePreloadedGrid(uint32 x, uint32 y) { UnrefGrid(x, y); }
+
+        // bumped when a vmap tile is loaded or unloaded, read by the line of sight caches of the maps
+        LineOfSightGridStamps const& GetVMapTileStamps() const { return m_vmapTileStamps; }
+
     protected:
         friend class Map;
         friend class ObjectMgr;
@@ -187,6 +221,8 @@ class TerrainInfo : public Referencable<std::atomic_long>
         TerrainInfo& operator=(const TerrainInfo&);
 
         GridMap* GetGrid(const float x, const float y, bool loadOnlyMap = false);
+        // vmap part of GetHeightStatic, mapHeight is the raw .map height at the point
+        float SelectHeightStatic(float x, float y, float z, float mapHeight, bool useVmaps, float maxSearchDist) const;
         GridMap* LoadMapAndVMap(const uint32 x, const uint32 y, bool mapOnly = false);
 
         int RefGrid(const uint32& x, const uint32& y);
@@ -202,6 +238,7 @@ class TerrainInfo : public Referencable<std::atomic_long>
         ShortIntervalTimer i_timer;
 
         VMAP::IVMapManager* m_vmgr;
+        LineOfSightGridStamps m_vmapTileStamps;
 
         typedef std::mutex LOCK_TYPE;
         typedef std::lock_guard<LOCK_TYPE> LOCK_GUARD;
@@ -0,0 +1,276 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "Maps/GridPrefetcher.h"
+#include "Maps/GridMap.h"
+#include "Util/Timer.h"
+#include "Log.h"
+
+#ifdef BUILD_METRICS
+ #include "Metric/Metric.h"
+#endif
+
+#include <algorithm>
+#include <chrono>
+
+INSTANTIATE_SINGLETON_1(GridPrefetcher);
+
+GridPrefetcher::~GridPrefetcher()
+{
+    Stop();
+}
+
+void GridPrefetcher::Start()
+{
+    if (IsEnabled())
+        return;
+
+    m_stopping = false;
+    m_thread = std::thread(&GridPrefetcher::WorkerThread, this);
+
+    m_enabled = true;
+    sLog.outString("Grid prefetcher started");
+}
+
+void GridPrefetcher::Stop()
+{
+    if (!IsEnabled())
+        return;
+
+    m_enabled = false;
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_stopping = true;
+    }
+    m_queueCondition.notify_all();
+    m_thread.join();
+
+    m_queue.clear();
+    for (auto& itr : m_entries)
+        Release(itr.first, itr.second);
+    m_entries.clear();
+}
+
+void GridPrefetcher::Request(Map const* map, TerrainInfo* terrain, uint32 gx, uint32 gy)
+{
+    Key key(map, gx << 16 | gy);
+
+    std::lock_guard<std::mutex> guard(m_lock);
+    if (m_entries.find(key) != m_entries.end())
+        return;
+
+    if (m_entries.size() >= MAX_ENTRIES)
+    {
+        DropExpired();
+        if (m_entries.size() >= MAX_ENTRIES)
+        {
+            ++m_stats.dropped;
+            return;
+        }
+    }
+
+    Entry& entry = m_entries[key];
+    entry.terrain = terrain;
+    m_queue.push_back(key);
+    ++m_stats.requests;
+
+    m_queueCondition.notify_one();
+}
+
+bool GridPrefetcher::Claim(Map const* map, uint32 gx, uint32 gy, MMAP::MMapTileData& tile)
+{
+    Key key(map, gx << 16 | gy);
+
+    std::unique_lock<std::mutex> lock(m_lock);
+    auto itr = m_entries.find(key);
+    if (itr == m_entries.end())
+    {
+        ++m_stats.misses;
+        return false;
+    }
+
+    if (itr->second.state == GRID_PREFETCH_QUEUED)
+    {
+        // not started yet, reading it here is not slower than waiting for the loader
+        m_queue.erase(std::find(m_queue.begin(), m_queue.end(), key));
+        m_entries.erase(itr);
+        ++m_stats.misses;
+        return false;
+    }
+
+    // most of the work is done already, the map would only compete with the loader for the same files
+    m_doneCondition.wait(lock, [this, &key]()
+    {
+        auto found = m_entries.find(key);
+        return found == m_entries.end() || found->second.state == GRID_PREFETCH_READY;
+    });
+
+    itr = m_entries.find(key);
+    if (itr == m_entries.end())
+    {
+        ++m_stats.misses;
+        return false;
+    }
+
+    tile = std::move(itr->second.tile);
+    m_entries.erase(itr);
+    ++m_stats.hits;
+    return true;
+}
+
+void GridPrefetcher::CancelRequests(Map const* map)
+{
+    if (!IsEnabled())
+        return;
+
+    std::unique_lock<std::mutex> lock(m_lock);
+    m_queue.erase(std::remove_if(m_queue.begin(), m_queue.end(), [map](Key const& key) { return key.first == map; }), m_queue.end());
+
+    m_doneCondition.wait(lock, [this, map]()
+    {
+        auto itr = m_entries.lower_bound(Key(map, 0));
+        for (; itr != m_entries.end() && itr->first.first == map; ++itr)
+            if (itr->second.state == GRID_PREFETCH_LOADING)
+                return false;
+        return true;
+    });
+
+    auto end = m_entries.upper_bound(Key(map, UINT32_MAX));
+    for (auto itr = m_entries.lower_bound(Key(map, 0)); itr != end;)
+    {
+        Release(itr->first, itr->second);
+        itr = m_entries.erase(itr);
+    }
+}
+
+void GridPrefetcher::DropExpired()
+{
+    uint32 now = WorldTimer::getMSTime();
+    for (auto itr = m_entries.begin(); itr != m_entries.end();)
+    {
+        if (itr->second.state == GRID_PREFETCH_READY && WorldTimer::getMSTimeDiff(itr->second.readyTime, now) >= READY_TTL)
+        {
+            Release(itr->first, itr->second);
+            itr = m_entries.erase(itr);
+        }
+        else
+            ++itr;
+    }
+}
+
+void GridPrefetcher::Release(Key const& key, Entry const& entry)
+{
+    // only loaded grids hold a terrain reference
+    if (entry.state == GRID_PREFETCH_READY)
+        entry.terrain->ReleasePreloadedGrid(key.second >> 16, key.second & 0xFFFF);
+}
+
+void GridPrefetcher::WorkerThread()
+{
+    typedef std::chrono::steady_clock Clock;
+
+    std::unique_lock<std::mutex> lock(m_lock);
+    while (true)
+    {
+        // wake up now and then even when nothing is requested, prepared grids nobody claims must not stay referenced
+        m_queueCondition.wait_for(lock, std::chrono::milliseconds(EXPIRE_INTERVAL), [this]() { return m_stopping || !m_queue.empty(); });
+        if (m_stopping)
+            break;
+
+        DropExpired();
+        if (m_queue.empty())
+            continue;
+
+        Key key = m_queue.front();
+        m_queue.pop_front();
+
+        Entry& entry = m_entries[key];
+        entry.state = GRID_PREFETCH_LOADING;
+        TerrainInfo* terrain = entry.terrain;
+        lock.unlock();
+
+        Clock::time_point loadStart = Clock::now();
+
+        uint32 gx = key.second >> 16;
+        uint32 gy = key.second & 0xFFFF;
+        terrain->PreloadGrid(gx, gy);
+
+        // a missing tile is normal for maps without navmesh, the map finds out again when it loads the grid
+        MMAP::MMapTileData tile;
+        MMAP::MMapManager::readTile(terrain->GetMapId(), gx, gy, 0, tile);
+
+        uint64 loadTime = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - loadStart).count();
+
+        lock.lock();
+        // entries being loaded are neither claimed nor cancelled, both wait for them
+        entry.tile = std::move(tile);
+        entry.state = GRID_PREFETCH_READY;
+        entry.readyTime = WorldTimer::getMSTime();
+        ++m_stats.loaded;
+        m_stats.loadTime += loadTime;
+        m_doneCondition.notify_all();
+    }
+}
+
+void GridPrefetcher::AddStall(uint64 stallTime)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_stats.stallTime += stallTime;
+    m_stats.maxStall = std::max(m_stats.maxStall, stallTime);
+}
+
+void GridPrefetcher::ResetStats(GridPrefetchStats& stats)
+{
+    stats.requests = 0;
+    stats.loaded = 0;
+    stats.dropped = 0;
+    stats.hits = 0;
+    stats.misses = 0;
+    stats.stallTime = 0;
+    stats.maxStall = 0;
+    stats.loadTime = 0;
+}
+
+GridPrefetchStats GridPrefetcher::ConsumeStats()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    GridPrefetchStats stats = m_stats;
+    ResetStats(m_stats);
+    return stats;
+}
+
+#ifdef BUILD_METRICS
+void GridPrefetcher::ReportMetrics()
+{
+    if (!IsEnabled())
+        return;
+
+    GridPrefetchStats stats = ConsumeStats();
+    uint64 gridLoads = stats.hits + stats.misses;
+
+    metric::measurement meas("map.prefetch");
+    meas.add_field("requests", static_cast<int64>(stats.requests));
+    meas.add_field("loaded", static_cast<int64>(stats.loaded));
+    meas.add_field("dropped", static_cast<int64>(stats.dropped));
+    meas.add_field("hits", static_cast<int64>(stats.hits));
+    meas.add_field("misses", static_cast<int64>(stats.misses));
+    meas.add_field("stall_avg", static_cast<int64>(gridLoads ? stats.stallTime / gridLoads : 0));
+    meas.add_field("stall_max", static_cast<int64>(stats.maxStall));
+    meas.add_field("load_avg", static_cast<int64>(stats.loaded ? stats.loadTime / stats.loaded : 0));
+}
+#endif
@@ -0,0 +1,127 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_GRID_PREFETCHER_H
+#define MANGOS_GRID_PREFETCHER_H
+
+#include "Common.h"
+#include "Policies/Singleton.h"
+#include "MotionGenerators/MoveMap.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+
+class Map;
+class TerrainInfo;
+
+struct GridPrefetchStats
+{
+    uint64 requests;
+    uint64 loaded;                                          // grids finished by the loader thread
+    uint64 dropped;                                         // requests given up because too many tiles were waiting
+    uint64 hits;                                            // grid loads of the map that found the grid prepared or in progress
+    uint64 misses;                                          // grid loads of the map that read everything themselves
+    uint64 stallTime;                                       // microseconds maps spent loading grids, summed
+    uint64 maxStall;                                        // longest single grid load of a map, microseconds
+    uint64 loadTime;                                        // microseconds the loader spent on grids, summed
+};
+
+/**
+ * Loads grids on its own thread before the players moving towards them get there.
+ * Terrain and vmap tiles are loaded into the shared TerrainInfo and VMapManager right away, both
+ * are safe to load from any thread. Navmesh tiles are only read into memory since the navmesh is
+ * queried by the map without a lock; they are added when the map loads the grid itself, which
+ * then costs no file access.
+ */
+class GridPrefetcher
+{
+    public:
+        GridPrefetcher() : m_enabled(false), m_stopping(false) { ResetStats(m_stats); }
+        ~GridPrefetcher();
+
+        void Start();
+        void Stop();
+        bool IsEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+        // queues a grid in terrain coordinates unless it is already waiting, the map checks it is not loaded yet
+        void Request(Map const* map, TerrainInfo* terrain, uint32 gx, uint32 gy);
+        // called by the map before it loads a grid, takes over a read ahead navmesh tile
+        // a grid still being loaded is waited for, returns false when the map has to load everything
+        // on success the caller also takes over the terrain reference of the grid and releases it once it holds its own
+        bool Claim(Map const* map, uint32 gx, uint32 gy, MMAP::MMapTileData& tile);
+        // drops everything prepared for the map and waits for the grid being loaded, the map is about to be deleted
+        void CancelRequests(Map const* map);
+
+        void AddStall(uint64 stallTime);
+
+        // returns statistics accumulated since the previous call
+        GridPrefetchStats ConsumeStats();
+
+#ifdef BUILD_METRICS
+        void ReportMetrics();
+#endif
+
+    private:
+        enum GridState
+        {
+            GRID_PREFETCH_QUEUED,
+            GRID_PREFETCH_LOADING,
+            GRID_PREFETCH_READY,
+        };
+
+        typedef std::pair<Map const*, uint32> Key;          // map and packed terrain grid coordinates
+
+        struct Entry
+        {
+            Entry() : terrain(nullptr), state(GRID_PREFETCH_QUEUED), readyTime(0) {}
+
+            TerrainInfo* terrain;
+            GridState state;
+            MMAP::MMapTileData tile;
+            uint32 readyTime;
+        };
+
+        static uint32 const MAX_ENTRIES = 256;
+        static uint32 const READY_TTL = 60 * IN_MILLISECONDS; // prepared tiles not claimed meanwhile are dropped
+        static uint32 const EXPIRE_INTERVAL = 5 * IN_MILLISECONDS;
+
+        void WorkerThread();
+        void DropExpired();
+        static void Release(Key const& key, Entry const& entry);
+        static void ResetStats(GridPrefetchStats& stats);
+
+        std::thread m_thread;
+        std::map<Key, Entry> m_entries;
+        std::deque<Key> m_queue;                            // queued entries, oldest first
+        std::atomic<bool> m_enabled;
+        bool m_stopping;
+
+        std::mutex m_lock;
+        std::condition_variable m_queueCondition;
+        std::condition_variable m_doneCondition;
+
+        GridPrefetchStats m_stats;                          // guarded by m_lock
+};
+
+#define sGridPrefetcher MaNGOS::Singleton<GridPrefetcher>::Instance()
+
+#endif
@@ -0,0 +1,192 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "Maps/LineOfSightCache.h"
+#include "Util/Timer.h"
+
+#include <cmath>
+
+// endpoint rounding in yards, results may differ from the exact query for endpoints this close to an edge
+#define LOS_CACHE_QUANTUM   0.5f
+// entries live this long in ms, geometry changes drop them earlier through the grid stamps
+#define LOS_CACHE_TTL       5000
+
+std::atomic<uint64> LineOfSightGridStamps::s_stamp(0);
+
+LineOfSightGridStamps::LineOfSightGridStamps()
+{
+    for (auto& stamp : m_stamps)
+        stamp.store(0, std::memory_order_relaxed);
+}
+
+void LineOfSightGridStamps::Bump(uint32 lowX, uint32 lowY, uint32 highX, uint32 highY)
+{
+    uint64 stamp = s_stamp.fetch_add(1) + 1;
+    for (uint32 x = lowX; x <= highX; ++x)
+        for (uint32 y = lowY; y <= highY; ++y)
+            m_stamps[x * MAX_NUMBER_OF_GRIDS + y].store(stamp);
+}
+
+LineOfSightCache::LineOfSightCache(LineOfSightGridStamps const& staticStamps) : m_staticStamps(staticStamps),
+    m_lookups(0), m_hits(0), m_invalidations(0), m_verified(0), m_mismatches(0)
+{
+}
+
+std::size_t LineOfSightCache::KeyHash::operator()(Key const& key) const
+{
+    uint64 hash = key.phasemask;
+    for (int32 coord : key.src)
+        hash = hash * 0x9E3779B97F4A7C15ULL ^ uint32(coord);
+    for (int32 coord : key.dest)
+        hash = hash * 0x9E3779B97F4A7C15ULL ^ uint32(coord);
+    hash = hash * 0x9E3779B97F4A7C15ULL ^ uint64(key.ignoreM2Model);
+    return std::size_t(hash ^ (hash >> 29));
+}
+
+LineOfSightCache::Key LineOfSightCache::MakeKey(float srcX, float srcY, float srcZ, float destX, float destY, float destZ, uint32 phasemask, bool ignoreM2Model)
+{
+    auto quantize = [](float coord) { return int32(std::floor(coord / LOS_CACHE_QUANTUM + 0.5f)); };
+
+    Key key;
+    key.src[0] = quantize(srcX);
+    key.src[1] = quantize(srcY);
+    key.src[2] = quantize(srcZ);
+    key.dest[0] = quantize(destX);
+    key.dest[1] = quantize(destY);
+    key.dest[2] = quantize(destZ);
+    key.phasemask = phasemask;
+    key.ignoreM2Model = ignoreM2Model;
+    return key;
+}
+
+void LineOfSightCache::GetGridRange(float minX, float minY, float maxX, float maxY, GridPair& low, GridPair& high)
+{
+    // points off the map count to the border grids
+    auto clamp = [](uint32 coord) { return uint32(std::max(0, std::min(int32(coord), MAX_NUMBER_OF_GRIDS - 1))); };
+    GridPair first = MaNGOS::ComputeGridPair(minX, minY);
+    GridPair second = MaNGOS::ComputeGridPair(maxX, maxY);
+    low.x_coord = clamp(first.x_coord);
+    low.y_coord = clamp(first.y_coord);
+    high.x_coord = clamp(second.x_coord);
+    high.y_coord = clamp(second.y_coord);
+}
+
+bool LineOfSightCache::IsValid(Entry const& entry, float srcX, float srcY, float destX, float destY, uint32 now) const
+{
+    if (int32(entry.expireTime - now) <= 0)
+        return false;
+
+    GridPair low, high;
+    GetGridRange(std::min(srcX, destX), std::min(srcY, destY), std::max(srcX, destX), std::max(srcY, destY), low, high);
+    for (uint32 x = low.x_coord; x <= high.x_coord; ++x)
+        for (uint32 y = low.y_coord; y <= high.y_coord; ++y)
+            if (m_dynamicStamps.Get(x, y) > entry.stamp || m_staticStamps.Get(x, y) > entry.stamp)
+                return false;
+
+    return true;
+}
+
+bool LineOfSightCache::Find(float srcX, float srcY, float srcZ, float destX, float destY, float destZ, uint32 phasemask, bool ignoreM2Model, bool& result)
+{
+    m_lookups.fetch_add(1, std::memory_order_relaxed);
+
+    Key key = MakeKey(srcX, srcY, srcZ, destX, destY, destZ, phasemask, ignoreM2Model);
+    Shard& shard = GetShard(key);
+    uint32 now = WorldTimer::getMSTime();
+
+    std::lock_guard<std::mutex> guard(shard.lock);
+    auto itr = shard.entries.find(key);
+    if (itr == shard.entries.end())
+        return false;
+
+    if (!IsValid(itr->second, srcX, srcY, destX, destY, now))
+    {
+        shard.entries.erase(itr);
+        return false;
+    }
+
+    result = itr->second.result;
+    m_hits.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void LineOfSightCache::Store(float srcX, float srcY, float srcZ, float destX, float destY, float destZ, uint32 phasemask, bool ignoreM2Model, bool result, uint64 stamp)
+{
+    Key key = MakeKey(srcX, srcY, srcZ, destX, destY, destZ, phasemask, ignoreM2Model);
+    Shard& shard = GetShard(key);
+    uint32 now = WorldTimer::getMSTime();
+
+    std::lock_guard<std::mutex> guard(shard.lock);
+    if (shard.entries.size() >= MAX_SHARD_ENTRIES)
+    {
+        for (auto itr = shard.entries.begin(); itr != shard.entries.end();)
+        {
+            if (int32(itr->second.expireTime - now) <= 0)
+                itr = shard.entries.erase(itr);
+            else
+                ++itr;
+        }
+
+        // everything is still fresh, the cache is too small for the load and starts over
+        if (shard.entries.size() >= MAX_SHARD_ENTRIES)
+            shard.entries.clear();
+    }
+
+    Entry& entry = shard.entries[key];
+    entry.result = result;
+    entry.stamp = stamp;
+    entry.expireTime = now + LOS_CACHE_TTL;
+}
+
+void LineOfSightCache::Invalidate(float minX, float minY, float maxX, float maxY)
+{
+    m_invalidations.fetch_add(1, std::memory_order_relaxed);
+
+    GridPair low, high;
+    GetGridRange(minX, minY, maxX, maxY, low, high);
+    m_dynamicStamps.Bump(low.x_coord, low.y_coord, high.x_coord, high.y_coord);
+}
+
+void LineOfSightCache::CountVerified(bool matches)
+{
+    m_verified.fetch_add(1, std::memory_order_relaxed);
+    if (!matches)
+        m_mismatches.fetch_add(1, std::memory_order_relaxed);
+}
+
+LineOfSightCacheStats LineOfSightCache::GetStats() const
+{
+    LineOfSightCacheStats stats;
+    stats.lookups = m_lookups.load(std::memory_order_relaxed);
+    stats.hits = m_hits.load(std::memory_order_relaxed);
+    stats.invalidations = m_invalidations.load(std::memory_order_relaxed);
+    stats.verified = m_verified.load(std::memory_order_relaxed);
+    stats.mismatches = m_mismatches.load(std::memory_order_relaxed);
+    return stats;
+}
+
+uint32 LineOfSightCache::GetSize()
+{
+    uint32 size = 0;
+    for (Shard& shard : m_shards)
+    {
+        std::lock_guard<std::mutex> guard(shard.lock);
+        size += uint32(shard.entries.size());
+    }
+    return size;
+}
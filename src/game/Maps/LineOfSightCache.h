@@ -0,0 +1,138 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_LINE_OF_SIGHT_CACHE_H
+#define MANGOS_LINE_OF_SIGHT_CACHE_H
+
+#include "Common.h"
+#include "Maps/GridDefines.h"
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+struct LineOfSightCacheStats
+{
+    uint64 lookups;
+    uint64 hits;
+    uint64 invalidations;                                   // dynamic tree changes that dropped entries
+    uint64 verified;                                        // hits compared against the trees, see vmap.verifyLOSCache
+    uint64 mismatches;                                      // verified hits which differed from the trees
+};
+
+/**
+ * Last change of the geometry in every grid of a map, indexed like GridPair.
+ * All stamps come from one counter, so the vmap tiles of a terrain and the dynamic trees of its maps
+ * compare against the same stamp of a cache entry.
+ */
+class LineOfSightGridStamps
+{
+    public:
+        LineOfSightGridStamps();
+
+        static uint64 GetStamp() { return s_stamp.load(); }
+
+        uint64 Get(uint32 x, uint32 y) const { return m_stamps[x * MAX_NUMBER_OF_GRIDS + y].load(std::memory_order_relaxed); }
+        void Bump(uint32 lowX, uint32 lowY, uint32 highX, uint32 highY);
+
+    private:
+        static std::atomic<uint64> s_stamp;
+
+        std::array<std::atomic<uint64>, MAX_NUMBER_OF_GRIDS * MAX_NUMBER_OF_GRIDS> m_stamps;
+};
+
+/**
+ * Line of sight results of one map, static and dynamic geometry combined.
+ * The endpoints are rounded to LOS_CACHE_QUANTUM so units standing around the same spots share the entries.
+ * A change of the dynamic tree only drops the entries touching the grids of the changed model, transports
+ * moving every update would empty the whole cache otherwise. Loading or unloading a vmap tile drops the
+ * entries touching its grid through the stamps of the terrain.
+ */
+class LineOfSightCache
+{
+    public:
+        explicit LineOfSightCache(LineOfSightGridStamps const& staticStamps);
+
+        // stamp to pass to Store, taken before the result is computed
+        uint64 GetStamp() const { return LineOfSightGridStamps::GetStamp(); }
+
+        bool Find(float srcX, float srcY, float srcZ, float destX, float destY, float destZ, uint32 phasemask, bool ignoreM2Model, bool& result);
+        void Store(float srcX, float srcY, float srcZ, float destX, float destY, float destZ, uint32 phasemask, bool ignoreM2Model, bool result, uint64 stamp);
+        // drops the entries of the grids overlapping the given area
+        void Invalidate(float minX, float minY, float maxX, float maxY);
+        // result of the trees for a hit, in verify mode
+        void CountVerified(bool matches);
+
+        LineOfSightCacheStats GetStats() const;
+        uint32 GetSize();
+
+    private:
+        struct Key
+        {
+            int32 src[3];
+            int32 dest[3];
+            uint32 phasemask;
+            bool ignoreM2Model;
+
+            bool operator==(Key const& other) const
+            {
+                return std::equal(src, src + 3, other.src) && std::equal(dest, dest + 3, other.dest)
+                       && phasemask == other.phasemask && ignoreM2Model == other.ignoreM2Model;
+            }
+        };
+
+        struct KeyHash
+        {
+            std::size_t operator()(Key const& key) const;
+        };
+
+        struct Entry
+        {
+            bool result;
+            uint64 stamp;
+            uint32 expireTime;
+        };
+
+        struct Shard
+        {
+            std::mutex lock;
+            std::unordered_map<Key, Entry, KeyHash> entries;
+        };
+
+        static uint32 const SHARD_COUNT = 16;
+        static uint32 const MAX_SHARD_ENTRIES = 1024;
+
+        static Key MakeKey(float srcX, float srcY, float srcZ, float destX, float destY, float destZ, uint32 phasemask, bool ignoreM2Model);
+        static void GetGridRange(float minX, float minY, float maxX, float maxY, GridPair& low, GridPair& high);
+        bool IsValid(Entry const& entry, float srcX, float srcY, float destX, float destY, uint32 now) const;
+
+        Shard& GetShard(Key const& key) { return m_shards[KeyHash()(key) % SHARD_COUNT]; }
+
+        std::array<Shard, SHARD_COUNT> m_shards;
+        LineOfSightGridStamps const& m_staticStamps;        // vmap tiles, shared by the maps of the terrain
+        LineOfSightGridStamps m_dynamicStamps;              // dynamic tree of this map
+
+        std::atomic<uint64> m_lookups;
+        std::atomic<uint64> m_hits;
+        std::atomic<uint64> m_invalidations;
+        std::atomic<uint64> m_verified;
+        std::atomic<uint64> m_mismatches;
+};
+
+#endif
@@ -37,12 +37,17 @@
 #include "Maps/MapPersistentStateMgr.h"
 #include "Vmap/VMapFactory.h"
 #include "MotionGenerators/MoveMap.h"
+#include "MotionGenerators/PathRequestQueue.h"
+#include "Maps/GridPrefetcher.h"
+#include "Movement/MoveSpline.h"
 #include "Calendar/Calendar.h"
 #include "Chat/Chat.h"
 #include "Weather/Weather.h"
 #include "Grids/ObjectGridLoader.h"
 #include "Vmap/GameObjectModel.h"
 #include "LFG/LFGMgr.h"
+#include "Maps/MapWorkers.h"
+#include "World/TickProfiler.h"
 
 #ifdef BUILD_METRICS
  #include "Metric/Metric.h"
@@ -61,6 +66,8 @@ Map::~Map()
     i_data = nullptr;
 
     // unload instance specific navigation data
+    sPathRequestQueue.CancelRequests(this);
+    sGridPrefetcher.CancelRequests(this);
     MMAP::MMapFactory::createOrGetMMapManager()->unloadMapInstance(m_TerrainData->GetMapId(), GetInstanceId());
 
     // release reference count
@@ -206,11 +213,116 @@ void Map::LoadMapAndVMap(int gx, int gy)
     if (m_bLoadedGrids[gx][gy])
         return;
 
+    // a prefetched grid has its terrain and vmap loaded already and brings the navmesh tile along
+    bool prefetch = sGridPrefetcher.IsEnabled();
+    std::chrono::steady_clock::time_point loadStart = std::chrono::steady_clock::now();
+    MMAP::MMapTileData tile;
+    bool claimed = prefetch && sGridPrefetcher.Claim(this, gx, gy, tile);
+
     if (m_TerrainData->Load(gx, gy)) // fails also on maps which have no tiles for everything except mmaps
         m_bLoadedGrids[gx][gy] = true;
 
+    if (claimed)
+        m_TerrainData->ReleasePreloadedGrid(gx, gy);
+
     if (!MMAP::MMapFactory::createOrGetMMapManager()->IsMMapTileLoaded(GetId(), GetInstanceId(), gx, gy))
-        MMAP::MMapFactory::createOrGetMMapManager()->loadMap(GetId(), GetInstanceId(), gx, gy, 0);
+        MMAP::MMapFactory::createOrGetMMapManager()->loadMap(GetId(), GetInstanceId(), gx, gy, 0, tile.data ? &tile : nullptr);
+
+    if (prefetch)
+        sGridPrefetcher.AddStall(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - loadStart).count());
+}
+
+void Map::PrefetchGridsAhead(uint32 diff)
+{
+    if (!sGridPrefetcher.IsEnabled())
+        return;
+
+    m_gridPrefetchTimer.Update(diff);
+    if (!m_gridPrefetchTimer.Passed())
+        return;
+
+    uint32 elapsed = m_gridPrefetchTimer.GetCurrent();
+    m_gridPrefetchTimer.SetCurrent(0);
+
+    uint32 lookahead = sWorld.getConfig(CONFIG_UINT32_GRID_PREFETCH_LOOKAHEAD);
+    std::unordered_map<ObjectGuid, GridPrefetchTrack> tracks;
+
+    for (auto& ref : m_mapRefManager)
+    {
+        Player* player = ref.getSource();
+        if (!player || !player->IsInWorld() || !player->IsPositionValid())
+            continue;
+
+        float x = player->GetPositionX();
+        float y = player->GetPositionY();
+        tracks[player->GetObjectGuid()] = { x, y };
+
+        // taxi flights and scripted movement know where they go, passenger splines are in transport space
+        Movement::MoveSpline const* spline = player->movespline;
+        if (!player->GetTransport() && spline->Initialized() && !spline->Finalized())
+        {
+            Movement::MoveSpline::MySpline const& path = spline->_Spline();
+            for (int32 i = spline->_currentSplineIdx() + 1; i <= path.last(); ++i)
+            {
+                Vector3 const& point = path.getPoint(i);
+                PrefetchGridsAlong(x, y, point.x, point.y);
+                x = point.x;
+                y = point.y;
+
+                if (spline->ComputeTimeToIndex(i) >= int32(lookahead))
+                    break;
+            }
+            continue;
+        }
+
+        // everything else, transports included, is expected to keep moving the way it moved since the last pass
+        auto last = m_gridPrefetchTracks.find(player->GetObjectGuid());
+        if (last == m_gridPrefetchTracks.end())
+            continue;
+
+        float dx = x - last->second.x;
+        float dy = y - last->second.y;
+        float dist = sqrt(dx * dx + dy * dy);
+        // standing or teleported
+        if (dist < 1.0f || dist > GRID_PREFETCH_MAX_SPEED * elapsed / IN_MILLISECONDS)
+            continue;
+
+        float scale = float(lookahead) / elapsed;
+        PrefetchGridsAlong(x, y, x + dx * scale, y + dy * scale);
+    }
+
+    m_gridPrefetchTracks.swap(tracks);
+}
+
+void Map::PrefetchGridsAlong(float x, float y, float destX, float destY)
+{
+    float dx = destX - x;
+    float dy = destY - y;
+    uint32 steps = uint32(sqrt(dx * dx + dy * dy) / (SIZE_OF_GRIDS / 2)) + 1;
+    // grids are loaded as soon as the visibility range reaches into them
+    float range = GetVisibilityDistance();
+
+    for (uint32 step = 1; step <= steps; ++step)
+    {
+        float px = x + dx * step / steps;
+        float py = y + dy * step / steps;
+        if (!MaNGOS::IsValidMapCoord(px - range, py - range) || !MaNGOS::IsValidMapCoord(px + range, py + range))
+            continue;
+
+        GridPair low = MaNGOS::ComputeGridPair(px - range, py - range);
+        GridPair high = MaNGOS::ComputeGridPair(px + range, py + range);
+        for (uint32 gridX = low.x_coord; gridX <= high.x_coord; ++gridX)
+        {
+            for (uint32 gridY = low.y_coord; gridY <= high.y_coord; ++gridY)
+            {
+                // the map has loaded the grid already
+                if (gridX >= MAX_NUMBER_OF_GRIDS || gridY >= MAX_NUMBER_OF_GRIDS || getNGrid(gridX, gridY))
+                    continue;
+
+                sGridPrefetcher.Request(this, m_TerrainData, (MAX_NUMBER_OF_GRIDS - 1) - gridX, (MAX_NUMBER_OF_GRIDS - 1) - gridY);
+            }
+        }
+    }
 }
 
 Map::Map(uint32 id, time_t expiry, uint32 InstanceId, uint8 SpawnMode)
@@ -219,10 +331,13 @@ Map::Map(uint32 id, time_t expiry, uint32 InstanceId, uint8 SpawnMode)
       m_VisibleDistance(DEFAULT_VISIBILITY_DISTANCE), m_persistentState(nullptr),
       m_activeNonPlayersIter(m_activeNonPlayers.end()), m_onEventNotifiedIter(m_onEventNotifiedObjects.end()),
       i_gridExpiry(expiry), m_TerrainData(sTerrainMgr.LoadTerrain(id)),
-      i_data(nullptr), i_script_id(0), m_transportsIterator(m_transports.begin()), m_defaultLight(GetDefaultMapLight(id)), m_spawnManager(*this),
+      m_regionUpdate(false), m_updatingRegions(false), m_regionCounter(0),
+      m_gridCrawlers(std::make_unique<WorkerPool<GridCrawler>>()), m_objectUpdateWorkers(std::make_unique<WorkerPool<ObjectUpdateWorker>>()),
+      i_data(nullptr), i_script_id(0), m_losCache(m_TerrainData->GetVMapTileStamps()), m_transportsIterator(m_transports.begin()), m_defaultLight(GetDefaultMapLight(id)), m_spawnManager(*this),
       m_variableManager(this)
 {
     m_weatherSystem = new WeatherSystem(this);
+    m_gridPrefetchTimer.SetInterval(GRID_PREFETCH_INTERVAL);
 }
 
 void Map::Initialize(bool loadInstanceData /*= true*/)
@@ -374,6 +489,7 @@ void Map::DeleteFromWorld(Player* pl)
 
 void Map::EnsureGridCreated(const GridPair& p)
 {
+    auto guard = LockRegions();
     if (!getNGrid(p.x_coord, p.y_coord))
     {
         setNGrid(new NGridType(p.x_coord * MAX_NUMBER_OF_GRIDS + p.y_coord, p.x_coord, p.y_coord, i_gridExpiry, sWorld.getConfig(CONFIG_BOOL_GRID_UNLOAD)),
@@ -417,11 +533,17 @@ void Map::EnsureGridLoadedAtEnter(const Cell& cell, Player* player)
         grid = getNGrid(cell.GridX(), cell.GridY());
 
     if (player)
+    {
         AddToGrid(player, grid, cell);
+
+        // players keep moving, have the terrain they are heading to in memory before they get there
+        m_TerrainData->PrefetchAround((MAX_NUMBER_OF_GRIDS - 1) - cell.GridX(), (MAX_NUMBER_OF_GRIDS - 1) - cell.GridY());
+    }
 }
 
 bool Map::EnsureGridLoaded(const Cell& cell)
 {
+    auto guard = LockRegions();
     EnsureGridCreated(GridPair(cell.GridX(), cell.GridY()));
     NGridType* grid = getNGrid(cell.GridX(), cell.GridY());
 
@@ -521,6 +643,11 @@ void Map::Add(T* obj)
         return;
     }
 
+    // summons may be added from any region, grids and object stores are shared between them
+    std::unique_lock<std::recursive_mutex> guard(m_regionLock, std::defer_lock);
+    if (m_updatingRegions)
+        guard.lock();
+
     obj->SetMap(this);
 
     Cell cell(p);
@@ -634,25 +761,28 @@ void Map::MessageDistBroadcast(WorldObject const* obj, WorldPacket const& msg, f
 
 void Map::MessageMapBroadcast(WorldObject const* /*obj*/, WorldPacket const& msg)
 {
+    BroadcastPacket broadcast(msg);
     Map::PlayerList const& pList = GetPlayers();
     for (const auto& itr : pList)
-        itr.getSource()->SendDirectMessage(msg);
+        broadcast.AddReceiver(itr.getSource()->GetSession());
 }
 
 void Map::MessageMapBroadcastZone(WorldObject const* /*obj*/, WorldPacket const& msg, uint32 zoneId)
 {
+    BroadcastPacket broadcast(msg);
     Map::PlayerList const& pList = GetPlayers();
     for (const auto& itr : pList)
         if (itr.getSource()->GetZoneId() == zoneId)
-            itr.getSource()->SendDirectMessage(msg);
+            broadcast.AddReceiver(itr.getSource()->GetSession());
 }
 
 void Map::MessageMapBroadcastArea(WorldObject const* /*obj*/, WorldPacket const& msg, uint32 areaId)
 {
+    BroadcastPacket broadcast(msg);
     Map::PlayerList const& pList = GetPlayers();
     for (const auto& itr : pList)
         if (itr.getSource()->GetAreaId() == areaId)
-            itr.getSource()->SendDirectMessage(msg);
+            broadcast.AddReceiver(itr.getSource()->GetSession());
 }
 
 void Map::ExecuteDistWorker(WorldObject const* obj, float dist, std::function<void(Player*)> const& worker)
@@ -724,11 +854,93 @@ void Map::VisitNearbyCellsOf(WorldObject* obj, TypeContainerVisitor<MaNGOS::Obje
                 CellPair pair(x, y);
                 Cell cell(pair);
                 cell.SetNoCreate();
-                Visit(cell, gridVisitor);
-                Visit(cell, worldVisitor);
+                if (m_regionUpdate)
+                    QueueCellForUpdate(cell);
+                else
+                {
+                    Visit(cell, gridVisitor);
+                    Visit(cell, worldVisitor);
+                }
+            }
+        }
+    }
+}
+
+void Map::QueueCellForUpdate(Cell const& cell)
+{
+    uint32 gridId = cell.GridY() * MAX_NUMBER_OF_GRIDS + cell.GridX();
+    m_cellRegions[gridId].cells.push_back(cell);
+}
+
+uint64 Map::UpdateCellRegions(uint32 diff, bool checkRegions)
+{
+    MapUpdater& updater = *sMapMgr.GetMapUpdater();
+
+    // collecting only reads the grid containers, all regions can be crawled at once
+    for (auto& region : m_cellRegions)
+        if (!region.second.cells.empty())
+            updater.schedule_update(m_gridCrawlers->Acquire(*this, region.second, diff, updater), m_regionCounter);
+    updater.wait(m_regionCounter);
+    m_gridCrawlers->Reset();
+
+    // grids of one colour of a 2x2 checkerboard are never adjacent, so each region running in a phase
+    // is surrounded by a halo of at least one grid which no other thread modifies during that phase
+    uint64 count = 0;
+    for (uint32 phase = 0; phase < 4; ++phase)
+    {
+        m_updatingRegions = true;
+        for (auto& region : m_cellRegions)
+        {
+            uint32 gridX = region.first % MAX_NUMBER_OF_GRIDS;
+            uint32 gridY = region.first / MAX_NUMBER_OF_GRIDS;
+            if ((gridX & 1) + ((gridY & 1) << 1) != phase || region.second.objects.empty())
+                continue;
+
+            count += region.second.objects.size();
+            updater.schedule_update(m_objectUpdateWorkers->Acquire(region.second.objects, diff, updater), m_regionCounter);
+        }
+        updater.wait(m_regionCounter);
+        m_objectUpdateWorkers->Reset();
+        m_updatingRegions = false;
+
+        if (checkRegions)
+        {
+            for (auto& region : m_cellRegions)
+            {
+                uint32 gridX = region.first % MAX_NUMBER_OF_GRIDS;
+                uint32 gridY = region.first / MAX_NUMBER_OF_GRIDS;
+                if ((gridX & 1) + ((gridY & 1) << 1) != phase)
+                    continue;
+
+                bool leftRegion = false;
+                for (WorldObject* obj : region.second.objects)
+                {
+                    if (!obj->IsInWorld())
+                        continue;
+
+                    GridPair gridPair = MaNGOS::ComputeGridPair(obj->GetPositionX(), obj->GetPositionY());
+                    if (gridPair.x_coord != gridX || gridPair.y_coord != gridY)
+                    {
+                        sLog.outError("Map::UpdateCellRegions: %s left region grid[%u,%u] for grid[%u,%u] while regions were updated (map %u)",
+                            obj->GetGuidStr().c_str(), gridX, gridY, gridPair.x_coord, gridPair.y_coord, i_id);
+                        leftRegion = true;
+                    }
+                }
+                MANGOS_ASSERT(!leftRegion);
             }
         }
+
+        // cross region side effects are applied in queue order before the next colour starts
+        m_regionMessager.Execute(this);
+    }
+
+    for (auto& region : m_cellRegions)
+    {
+        region.second.cells.clear();
+        region.second.objects.clear();
     }
+
+    return count;
 }
 
 void Map::Update(const uint32& t_diff)
@@ -736,10 +948,11 @@ void Map::Update(const uint32& t_diff)
 
 #ifdef BUILD_METRICS
     metric::duration<std::chrono::milliseconds> meas("map.update", {
-        { "map_id", std::to_string(i_id) },
-        { "instance_id", std::to_string(i_InstanceId) }
+        { "map_id", i_id },
+        { "instance_id", i_InstanceId }
 });
 #endif
+    TickPhaseTimer mapTimer(TICK_PHASE_MAP_UPDATE, i_id);
 
     m_curTime = time(nullptr);
 
@@ -759,6 +972,11 @@ void Map::Update(const uint32& t_diff)
     /// update active cells around players and active objects
     resetMarkedCells();
 
+    uint32 cellUpdateMode = sWorld.getConfig(CONFIG_UINT32_MAP_CELL_UPDATE_MODE);
+    MapUpdater* updater = sMapMgr.GetMapUpdater();
+    // instance scripts keep map wide state which their creatures change from every region
+    m_regionUpdate = cellUpdateMode != MAP_CELL_UPDATE_SERIAL && updater && updater->GetWorkerCount() > 1 && !i_data;
+
     WorldObjectUnSet objToUpdate;
     MaNGOS::ObjectUpdater obj_updater(objToUpdate, t_diff);
     TypeContainerVisitor<MaNGOS::ObjectUpdater, GridTypeMapContainer  > grid_object_update(obj_updater);    // For creature
@@ -774,11 +992,12 @@ void Map::Update(const uint32& t_diff)
     // the player iterator is stored in the map object
     // to make sure calls to Map::Remove don't invalidate it
     {
+        TickPhaseTimer sessionTimer(TICK_PHASE_SESSION_UPDATE, i_id);
 #ifdef BUILD_METRICS
         uint32 updatedSessions = 0;
         metric::duration<std::chrono::milliseconds> sessions_meas("map.update.session", {
-            { "map_id", std::to_string(i_id) },
-            { "instance_id", std::to_string(i_InstanceId) },
+            { "map_id", i_id },
+            { "instance_id", i_InstanceId },
             });
 #endif
 
@@ -801,13 +1020,19 @@ void Map::Update(const uint32& t_diff)
     }
 
     /// update players at tick
-    for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
     {
-        Player* plr = m_mapRefIter->getSource();
-        if (plr && plr->IsInWorld())
-            plr->Update(t_diff);
+        TickPhaseTimer playerTimer(TICK_PHASE_PLAYER_UPDATE, i_id);
+        for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
+        {
+            Player* plr = m_mapRefIter->getSource();
+            if (plr && plr->IsInWorld())
+                plr->Update(t_diff);
+        }
     }
 
+    PrefetchGridsAhead(t_diff);
+
+    TickPhaseTimer cellVisitTimer(TICK_PHASE_CELL_VISIT, i_id);
     for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
     {
         Player* player = m_mapRefIter->getSource();
@@ -836,7 +1061,9 @@ void Map::Update(const uint32& t_diff)
             if (!obj->IsInWorld() || !obj->IsPositionValid())
                 continue;
 
-            objToUpdate.insert(obj);
+            // in region mode the object is collected from its own cell, which is always marked below
+            if (!m_regionUpdate)
+                objToUpdate.insert(obj);
 
             // lets update mobs/objects in ALL visible cells around player!
             CellArea area = Cell::CalculateCellArea(obj->GetPositionX(), obj->GetPositionY(), GetVisibilityDistance());
@@ -854,32 +1081,54 @@ void Map::Update(const uint32& t_diff)
                         CellPair pair(x, y);
                         Cell cell(pair);
                         cell.SetNoCreate();
-                        Visit(cell, grid_object_update);
-                        Visit(cell, world_object_update);
+                        if (m_regionUpdate)
+                            QueueCellForUpdate(cell);
+                        else
+                        {
+                            Visit(cell, grid_object_update);
+                            Visit(cell, world_object_update);
+                        }
                     }
                 }
             }
         }
     }
 
+    cellVisitTimer.Stop();
+
     // update all objects
-    for (auto wObj : objToUpdate)
+    TickPhaseTimer objectTimer(TICK_PHASE_OBJECT_UPDATE, i_id);
+    if (m_regionUpdate)
+        count = UpdateCellRegions(t_diff, cellUpdateMode == MAP_CELL_UPDATE_PARALLEL_CHECK);
+    else
     {
-        wObj->Update(t_diff);
-        ++count;
+        for (auto wObj : objToUpdate)
+        {
+            wObj->Update(t_diff);
+            ++count;
+        }
     }
+    objectTimer.Stop();
 
 #ifdef BUILD_METRICS
     meas.add_field("count", std::to_string(static_cast<int32>(count)));
+    LineOfSightCacheStats losCacheStats = m_losCache.GetStats();
+    meas.add_field("los_cache_lookups", std::to_string(static_cast<int64>(losCacheStats.lookups)));
+    meas.add_field("los_cache_hits", std::to_string(static_cast<int64>(losCacheStats.hits)));
+    meas.add_field("los_cache_mismatches", std::to_string(static_cast<int64>(losCacheStats.mismatches)));
 #endif
 
     // Send world objects and item update field changes
-    SendObjectUpdates();
+    {
+        TickPhaseTimer sendTimer(TICK_PHASE_SEND_OBJECT_UPDATES, i_id);
+        SendObjectUpdates();
+    }
 
     // Don't unload grids if it's battleground, since we may have manually added GOs,creatures, those doesn't load from DB at grid re-load !
     // This isn't really bother us, since as soon as we have instanced BG-s, the whole map unloads as the BG gets ended
     if (!IsBattleGroundOrArena())
     {
+        TickPhaseTimer gridTimer(TICK_PHASE_GRID_UNLOAD, i_id);
         for (GridRefManager<NGridType>::iterator i = GridRefManager<NGridType>::begin(); i != GridRefManager<NGridType>::end();)
         {
             NGridType* grid = i->getSource();
@@ -970,6 +1219,9 @@ void Map::Remove(T* obj, bool remove)
     if (!loaded(GridPair(cell.data.Part.grid_x, cell.data.Part.grid_y)))
         return;
 
+    // the object stores and temp summon counts are shared with the other regions
+    auto guard = LockRegions();
+
     DEBUG_FILTER_LOG(LOG_FILTER_CREATURE_MOVES, "Remove %s from grid[%u,%u]", obj->GetGuidStr().c_str(), cell.data.Part.grid_x, cell.data.Part.grid_y);
     NGridType* grid = getNGrid(cell.GridX(), cell.GridY());
     MANGOS_ASSERT(grid != nullptr);
@@ -1002,6 +1254,18 @@ void Map::PlayerRelocation(Player* player, float x, float y, float z, float orie
 {
     MANGOS_ASSERT(player);
 
+    // knockbacks, pulls and teleports cast from a region move the player into cells of other regions
+    if (m_updatingRegions)
+    {
+        ObjectGuid guid = player->GetObjectGuid();
+        DeferRegionAction([guid, x, y, z, orientation](Map* map)
+        {
+            if (Player* deferred = map->GetPlayer(guid))
+                map->PlayerRelocation(deferred, x, y, z, orientation);
+        });
+        return;
+    }
+
     CellPair old_val = MaNGOS::ComputeCellPair(player->GetPositionX(), player->GetPositionY());
     CellPair new_val = MaNGOS::ComputeCellPair(x, y);
 
@@ -1040,6 +1304,18 @@ void Map::CreatureRelocation(Creature* creature, float x, float y, float z, floa
 {
     Cell new_cell(MaNGOS::ComputeCellPair(x, y));
 
+    // grid change touches a neighbouring region, finish it once the current phase is done
+    if (m_updatingRegions && creature->GetCurrentCell().DiffGrid(new_cell))
+    {
+        ObjectGuid guid = creature->GetObjectGuid();
+        DeferRegionAction([guid, x, y, z, ang](Map* map)
+        {
+            if (Creature* deferred = map->GetAnyTypeCreature(guid))
+                map->CreatureRelocation(deferred, x, y, z, ang);
+        });
+        return;
+    }
+
     // do move or do move to respawn or remove creature if previous all fail
     if (CreatureCellRelocation(creature, new_cell))
     {
@@ -1061,6 +1337,17 @@ void Map::GameObjectRelocation(GameObject* go, float x, float y, float z, float
     Cell new_cell(MaNGOS::ComputeCellPair(x, y));
     Cell old_cell = go->GetCurrentCell();
 
+    if (m_updatingRegions && old_cell.DiffGrid(new_cell))
+    {
+        ObjectGuid guid = go->GetObjectGuid();
+        DeferRegionAction([guid, x, y, z, orientation, respawnRelocationOnFail](Map* map)
+        {
+            if (GameObject* deferred = map->GetGameObject(guid))
+                map->GameObjectRelocation(deferred, x, y, z, orientation, respawnRelocationOnFail);
+        });
+        return;
+    }
+
     if (!respawnRelocationOnFail && !getNGrid(new_cell.GridX(), new_cell.GridY()))
         return;
 
@@ -1094,6 +1381,17 @@ void Map::DynamicObjectRelocation(DynamicObject* dynObj, float x, float y, float
     Cell new_cell(MaNGOS::ComputeCellPair(x, y));
     Cell old_cell = dynObj->GetCurrentCell();
 
+    if (m_updatingRegions && old_cell.DiffGrid(new_cell))
+    {
+        ObjectGuid guid = dynObj->GetObjectGuid();
+        DeferRegionAction([guid, x, y, z, orientation](Map* map)
+        {
+            if (DynamicObject* deferred = map->GetDynamicObject(guid))
+                map->DynamicObjectRelocation(deferred, x, y, z, orientation);
+        });
+        return;
+    }
+
     if (!getNGrid(new_cell.GridX(), new_cell.GridY()))
         return;
 
@@ -1290,7 +1588,9 @@ void Map::UpdateObjectVisibility(WorldObject* obj, Cell cell, const CellPair& ce
     cell.SetNoCreate();
     MaNGOS::VisibleChangesNotifier notifier(*obj);
     TypeContainerVisitor<MaNGOS::VisibleChangesNotifier, WorldTypeMapContainer > player_notifier(notifier);
-    cell.Visit(cellpair, player_notifier, *this, *obj, obj->GetVisibilityData().GetVisibilityDistance());
+    // cameras which may move into range before their next full update keep watching the object
+    float radius = obj->GetVisibilityData().GetVisibilityDistance() + 2 * World::GetVisibilityIncrementalDistance();
+    cell.Visit(cellpair, player_notifier, *this, *obj, radius);
     for (auto guid : notifier.GetUnvisitedGuids())
         if (Player* player = GetPlayer(guid))
             player->UpdateVisibilityOf(player->GetCamera().GetBody(), obj);
@@ -1330,8 +1630,7 @@ void Map::SendInitSelf(Player* player) const
 
     for (size_t i = 0; i < updateData.GetPacketCount(); ++i)
     {
-        WorldPacket packet = updateData.BuildPacket(i);
-        player->GetSession()->SendPacket(packet);
+        player->GetSession()->SendPacket(updateData.BuildPacket(i));
     }
 }
 
@@ -1356,8 +1655,7 @@ void Map::SendInitTransports(Player* player) const
 
     for (size_t i = 0; i < updateData.GetPacketCount(); ++i)
     {
-        WorldPacket packet = updateData.BuildPacket(i);
-        player->GetSession()->SendPacket(packet);
+        player->GetSession()->SendPacket(updateData.BuildPacket(i));
     }
 }
 
@@ -1382,8 +1680,7 @@ void Map::SendRemoveTransports(Player* player) const
 
     for (size_t i = 0; i < updateData.GetPacketCount(); ++i)
     {
-        WorldPacket packet = updateData.BuildPacket(i);
-        player->GetSession()->SendPacket(packet);
+        player->GetSession()->SendPacket(updateData.BuildPacket(i));
     }
 }
 
@@ -1413,6 +1710,13 @@ void Map::AddObjectToRemoveList(WorldObject* obj)
 {
     MANGOS_ASSERT(obj->GetMapId() == GetId() && obj->GetInstanceId() == GetInstanceId());
 
+    // cleanup breaks links to objects of other regions
+    if (m_updatingRegions)
+    {
+        DeferRegionAction([obj](Map* map) { map->AddObjectToRemoveList(obj); });
+        return;
+    }
+
     obj->CleanupsBeforeDelete();                            // remove or simplify at least cross referenced links
 
     i_objectsToRemove.insert(obj);
@@ -2231,6 +2535,7 @@ Player* Map::GetPlayer(ObjectGuid guid)
  */
 Creature* Map::GetCreature(ObjectGuid guid)
 {
+    auto guard = LockRegions();
     return m_objectsStore.find<Creature>(guid, (Creature*)nullptr);
 }
 
@@ -2241,6 +2546,7 @@ Creature* Map::GetCreature(ObjectGuid guid)
  */
 Pet* Map::GetPet(ObjectGuid guid)
 {
+    auto guard = LockRegions();
     return m_objectsStore.find<Pet>(guid, (Pet*)nullptr);
 }
 
@@ -2282,6 +2588,7 @@ Creature* Map::GetAnyTypeCreature(ObjectGuid guid)
  */
 GameObject* Map::GetGameObject(ObjectGuid guid)
 {
+    auto guard = LockRegions();
     return m_objectsStore.find<GameObject>(guid, (GameObject*)nullptr);
 }
 
@@ -2292,6 +2599,7 @@ GameObject* Map::GetGameObject(ObjectGuid guid)
  */
 DynamicObject* Map::GetDynamicObject(ObjectGuid guid)
 {
+    auto guard = LockRegions();
     return m_objectsStore.find<DynamicObject>(guid, (DynamicObject*)nullptr);
 }
 
@@ -2353,14 +2661,14 @@ void Map::SendObjectUpdates()
     {
         for (size_t i = 0; i < update_player.second.GetPacketCount(); ++i)
         {
-            WorldPacket packet = update_player.second.BuildPacket(i);
-            update_player.first->GetSession()->SendPacket(packet);
+            update_player.first->GetSession()->SendPacket(update_player.second.BuildPacket(i));
         }
     }
 }
 
 Creature* Map::GetCreature(uint32 dbguid) const
 {
+    auto guard = LockRegions();
     auto itr = m_dbGuidObjects.find(std::make_pair(HIGHGUID_UNIT, dbguid));
     if (itr == m_dbGuidObjects.end())
         return nullptr;
@@ -2378,6 +2686,7 @@ Creature* Map::GetCreature(uint32 dbguid) const
 
 GameObject* Map::GetGameObject(uint32 dbguid) const
 {
+    auto guard = LockRegions();
     auto itr = m_dbGuidObjects.find(std::make_pair(HIGHGUID_GAMEOBJECT, dbguid));
     if (itr == m_dbGuidObjects.end())
         return nullptr;
@@ -2405,29 +2714,32 @@ std::vector<GameObject*> const* Map::GetGameObjects(std::string stringId) const
 
 std::vector<WorldObject*> const* Map::GetWorldObjects(uint32 stringId) const
 {
+    auto guard = LockRegions();
     auto itr = m_objectsPerStringId.find(stringId);
     if (itr == m_objectsPerStringId.end())
         return nullptr;
 
-    return &(itr->second.worldObjects);
+    return GetStringIdObjects(itr->second.worldObjects);
 }
 
 std::vector<Creature*> const* Map::GetCreatures(uint32 stringId) const
 {
+    auto guard = LockRegions();
     auto itr = m_objectsPerStringId.find(stringId);
     if (itr == m_objectsPerStringId.end())
         return nullptr;
 
-    return &(itr->second.creatures);
+    return GetStringIdObjects(itr->second.creatures);
 }
 
 std::vector<GameObject*> const* Map::GetGameObjects(uint32 stringId) const
 {
+    auto guard = LockRegions();
     auto itr = m_objectsPerStringId.find(stringId);
     if (itr == m_objectsPerStringId.end())
         return nullptr;
 
-    return &(itr->second.gameobjects);
+    return GetStringIdObjects(itr->second.gameobjects);
 }
 
 WorldObject* Map::GetWorldObject(std::string stringId) const
@@ -2450,17 +2762,20 @@ GameObject* Map::GetGameObject(std::string stringId) const
 
 void Map::AddDbGuidObject(WorldObject* obj)
 {
+    auto guard = LockRegions();
     m_dbGuidObjects[std::make_pair(HighGuid(obj->GetParentHigh()), obj->GetDbGuid())].push_back(obj);
 }
 
 void Map::RemoveDbGuidObject(WorldObject* obj)
 {
+    auto guard = LockRegions();
     auto& vec = m_dbGuidObjects[std::make_pair(HighGuid(obj->GetParentHigh()), obj->GetDbGuid())];
     vec.erase(std::remove(vec.begin(), vec.end(), obj), vec.end());
 }
 
 void Map::AddStringIdObject(uint32 stringId, WorldObject* obj)
 {
+    auto guard = LockRegions();
     auto& data = m_objectsPerStringId[stringId];
     data.worldObjects.push_back(obj);
     if (obj->IsCreature())
@@ -2471,6 +2786,7 @@ void Map::AddStringIdObject(uint32 stringId, WorldObject* obj)
 
 void Map::RemoveStringIdObject(uint32 stringId, WorldObject* obj)
 {
+    auto guard = LockRegions();
     auto& data = m_objectsPerStringId[stringId];
     data.worldObjects.erase(std::remove(data.worldObjects.begin(), data.worldObjects.end(), obj), data.worldObjects.end());
     if (obj->IsCreature())
@@ -2603,8 +2919,84 @@ void Map::PlayDirectSoundToMap(uint32 soundId, uint32 zoneId /*=0*/) const
  */
 bool Map::IsInLineOfSight(float srcX, float srcY, float srcZ, float destX, float destY, float destZ, uint32 phasemask, bool ignoreM2Model) const
 {
-    return VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), srcX, srcY, srcZ, destX, destY, destZ, ignoreM2Model)
-           && m_dyn_tree.isInLineOfSight(srcX, srcY, srcZ, destX, destY, destZ, phasemask, ignoreM2Model);
+    bool const useCache = sWorld.getConfig(CONFIG_BOOL_VMAP_LOS_CACHE);
+    bool result;
+    if (useCache && m_losCache.Find(srcX, srcY, srcZ, destX, destY, destZ, phasemask, ignoreM2Model, result))
+    {
+        if (!sWorld.getConfig(CONFIG_BOOL_VMAP_LOS_CACHE_VERIFY))
+            return result;
+
+        bool cached = result;
+        result = TestLineOfSight(srcX, srcY, srcZ, destX, destY, destZ, phasemask, ignoreM2Model);
+        m_losCache.CountVerified(cached == result);
+        return result;
+    }
+
+    uint64 stamp = m_losCache.GetStamp();
+    result = TestLineOfSight(srcX, srcY, srcZ, destX, destY, destZ, phasemask, ignoreM2Model);
+
+    if (useCache)
+        m_losCache.Store(srcX, srcY, srcZ, destX, destY, destZ, phasemask, ignoreM2Model, result, stamp);
+    return result;
+}
+
+bool Map::TestLineOfSight(float srcX, float srcY, float srcZ, float destX, float destY, float destZ, uint32 phasemask, bool ignoreM2Model) const
+{
+    if (!VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), srcX, srcY, srcZ, destX, destY, destZ, ignoreM2Model))
+        return false;
+
+    auto dynTreeGuard = ReadDynamicTree();
+    return m_dyn_tree.isInLineOfSight(srcX, srcY, srcZ, destX, destY, destZ, phasemask, ignoreM2Model);
+}
+
+void Map::IsInLineOfSight(VMAP::LineOfSightQuery const* queries, bool* results, uint32 count, uint32 phasemask, bool ignoreM2Model) const
+{
+    bool const useCache = sWorld.getConfig(CONFIG_BOOL_VMAP_LOS_CACHE);
+    bool const verify = useCache && sWorld.getConfig(CONFIG_BOOL_VMAP_LOS_CACHE_VERIFY);
+    uint64 stamp = m_losCache.GetStamp();
+
+    // only the queries missing in the cache go to the trees
+    std::vector<VMAP::LineOfSightQuery> missed;
+    std::vector<uint32> missedIndices;
+    if (useCache)
+    {
+        for (uint32 i = 0; i < count; ++i)
+        {
+            VMAP::LineOfSightQuery const& query = queries[i];
+            if (!m_losCache.Find(query.x1, query.y1, query.z1, query.x2, query.y2, query.z2, phasemask, ignoreM2Model, results[i]))
+            {
+                missed.push_back(query);
+                missedIndices.push_back(i);
+            }
+            else if (verify)
+            {
+                bool result = TestLineOfSight(query.x1, query.y1, query.z1, query.x2, query.y2, query.z2, phasemask, ignoreM2Model);
+                m_losCache.CountVerified(results[i] == result);
+                results[i] = result;
+            }
+        }
+
+        if (missed.empty())
+            return;
+    }
+
+    VMAP::LineOfSightQuery const* toTest = useCache ? missed.data() : queries;
+    uint32 const testCount = useCache ? uint32(missed.size()) : count;
+    std::unique_ptr<bool[]> tested(new bool[testCount]);
+    VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), toTest, tested.get(), testCount, ignoreM2Model);
+    auto dynTreeGuard = ReadDynamicTree();
+    for (uint32 i = 0; i < testCount; ++i)
+    {
+        VMAP::LineOfSightQuery const& query = toTest[i];
+        bool result = tested[i] && m_dyn_tree.isInLineOfSight(query.x1, query.y1, query.z1, query.x2, query.y2, query.z2, phasemask, ignoreM2Model);
+        if (useCache)
+        {
+            results[missedIndices[i]] = result;
+            m_losCache.Store(query.x1, query.y1, query.z1, query.x2, query.y2, query.z2, phasemask, ignoreM2Model, result, stamp);
+        }
+        else
+            results[i] = result;
+    }
 }
 
 /**
@@ -2624,6 +3016,7 @@ bool Map::GetHitPosition(float srcX, float srcY, float srcZ, float& destX, float
         destZ = tempZ;
     }
     // at second all dynamic objects, if static check has an hit, then we can calculate only to this closer point
+    auto dynTreeGuard = ReadDynamicTree();
     bool result1 = m_dyn_tree.getObjectHitPos(phasemask, srcX, srcY, srcZ, destX, destY, destZ, tempX, tempY, tempZ, modifyDist);
     if (result1)
     {
@@ -2687,6 +3080,7 @@ bool Map::GetHeightInRange(uint32 phasemask, float x, float y, float& z, float m
             return false;
     }
 
+    auto dynTreeGuard = ReadDynamicTree();
     z = std::max<float>(height, m_dyn_tree.getHeight(x, y, height + 1.0f, maxSearchDist, phasemask));
     return true;
 }
@@ -2697,21 +3091,58 @@ float Map::GetHeight(uint32 phasemask, float x, float y, float z, bool swim) con
 
     // Get Dynamic Height around static Height (if valid)
     float dynSearchHeight = 2.0f + (z < staticHeight ? staticHeight : z);
+    auto dynTreeGuard = ReadDynamicTree();
     return std::max<float>(staticHeight, m_dyn_tree.getHeight(x, y, dynSearchHeight, dynSearchHeight - staticHeight, phasemask));
 }
 
+void Map::GetHeights(uint32 phasemask, float const* x, float const* y, float const* z, float* heights, uint32 count, bool swim) const
+{
+    m_TerrainData->GetHeightsStatic(x, y, z, heights, count, true, (swim ? DEFAULT_WATER_SEARCH : DEFAULT_HEIGHT_SEARCH));
+
+    auto dynTreeGuard = ReadDynamicTree();
+    for (uint32 i = 0; i < count; ++i)
+    {
+        float dynSearchHeight = 2.0f + (z[i] < heights[i] ? heights[i] : z[i]);
+        heights[i] = std::max<float>(heights[i], m_dyn_tree.getHeight(x[i], y[i], dynSearchHeight, dynSearchHeight - heights[i], phasemask));
+    }
+}
+
 void Map::InsertGameObjectModel(const GameObjectModel& mdl)
 {
-    m_dyn_tree.insert(mdl);
+    {
+        auto dynTreeGuard = WriteDynamicTree();
+        m_dyn_tree.insert(mdl);
+    }
+    InvalidateLineOfSight(mdl);
 }
 
 void Map::RemoveGameObjectModel(const GameObjectModel& mdl)
 {
-    m_dyn_tree.remove(mdl);
+    {
+        auto dynTreeGuard = WriteDynamicTree();
+        m_dyn_tree.remove(mdl);
+    }
+    InvalidateLineOfSight(mdl);
+}
+
+void Map::EnableGameObjectModel(GameObjectModel& mdl, uint32 phaseMask)
+{
+    {
+        auto dynTreeGuard = WriteDynamicTree();
+        mdl.enable(phaseMask);
+    }
+    InvalidateLineOfSight(mdl);
+}
+
+void Map::InvalidateLineOfSight(const GameObjectModel& mdl)
+{
+    G3D::AABox const& bounds = mdl.getBounds();
+    m_losCache.Invalidate(bounds.low().x, bounds.low().y, bounds.high().x, bounds.high().y);
 }
 
 bool Map::ContainsGameObjectModel(const GameObjectModel& mdl) const
 {
+    auto dynTreeGuard = ReadDynamicTree();
     return m_dyn_tree.contains(mdl);
 }
 
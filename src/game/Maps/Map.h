@@ -34,15 +34,21 @@
 #include "DBScripts/ScriptMgr.h"
 #include "Entities/CreatureLinkingMgr.h"
 #include "Vmap/DynamicTree.h"
+#include "Maps/LineOfSightCache.h"
+#include "Maps/UnitSpatialIndex.h"
 #include "Multithreading/Messager.h"
 #include "Globals/GraveyardManager.h"
 #include "Maps/SpawnManager.h"
 #include "Maps/MapDataContainer.h"
 #include "World/WorldStateVariableManager.h"
 
+#include <atomic>
 #include <bitset>
 #include <functional>
 #include <list>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 
 struct CreatureInfo;
 class Creature;
@@ -61,7 +67,11 @@ class GameObjectModel;
 class WeatherSystem;
 class GenericTransport;
 namespace MaNGOS { struct ObjectUpdater; }
+namespace VMAP { struct LineOfSightQuery; }
 class Transport;
+class GridCrawler;
+class ObjectUpdateWorker;
+template <class T> class WorkerPool;
 
 // GCC have alternative #pragma pack(N) syntax and old gcc version not support pack(push,N), also any gcc version not support it at some platform
 #if defined( __GNUC__ )
@@ -112,8 +122,25 @@ struct ZoneDynamicInfo
 
 #define MIN_UNLOAD_DELAY      1                             // immediate unload
 
+#define GRID_PREFETCH_INTERVAL  1000                        // ms between the predictions of the grids players move to
+#define GRID_PREFETCH_MAX_SPEED 100.0f                      // yards per second, faster moves are taken for teleports
+
 typedef std::unordered_map<uint32 /*zoneId*/, ZoneDynamicInfo> ZoneDynamicInfoMap;
 
+enum MapCellUpdateMode
+{
+    MAP_CELL_UPDATE_SERIAL          = 0,
+    MAP_CELL_UPDATE_PARALLEL        = 1,
+    MAP_CELL_UPDATE_PARALLEL_CHECK  = 2,                    // parallel, additionally verifies that no object left its region during a phase
+};
+
+// Marked cells of one grid, updated as a unit when grids are updated in parallel
+struct MapCellRegion
+{
+    std::vector<Cell> cells;
+    WorldObjectUnSet objects;
+};
+
 class Map : public GridRefManager<NGridType>
 {
         friend class MapReference;
@@ -243,6 +270,11 @@ class Map : public GridRefManager<NGridType>
 
         void UpdateObjectVisibility(WorldObject* obj, Cell cell, const CellPair& cellpair);
 
+        // true while grid regions of this map are updated by several threads
+        bool IsUpdatingRegions() const { return m_updatingRegions; }
+        // actions which may touch another region are executed on the map thread once the current phase finished
+        void DeferRegionAction(std::function<void(Map*)> const& action) { m_regionMessager.AddMessage(action); }
+
         void resetMarkedCells() { marked_cells.reset(); }
         bool isCellMarked(uint32 pCellId) const { return marked_cells.test(pCellId); }
         void markCell(uint32 pCellId) { marked_cells.set(pCellId); }
@@ -316,11 +348,17 @@ class Map : public GridRefManager<NGridType>
 
         void AddUpdateObject(Object* obj)
         {
+            std::unique_lock<std::recursive_mutex> guard(m_regionLock, std::defer_lock);
+            if (m_updatingRegions)
+                guard.lock();
             i_objectsToClientUpdate.insert(obj);
         }
 
         void RemoveUpdateObject(Object* obj)
         {
+            std::unique_lock<std::recursive_mutex> guard(m_regionLock, std::defer_lock);
+            if (m_updatingRegions)
+                guard.lock();
             i_objectsToClientUpdate.erase(obj);
         }
 
@@ -340,14 +378,25 @@ class Map : public GridRefManager<NGridType>
 
         // Dynamic VMaps
         float GetHeight(uint32 phasemask, float x, float y, float z, bool swim = false) const;
+        // batched GetHeight, heights must not overlap the input arrays
+        void GetHeights(uint32 phasemask, float const* x, float const* y, float const* z, float* heights, uint32 count, bool swim = false) const;
         bool GetHeightInRange(uint32 phasemask, float x, float y, float& z, float maxSearchDist = 4.0f) const;
         bool IsInLineOfSight(float srcX, float srcY, float srcZ, float destX, float destY, float destZ, uint32 phasemask, bool ignoreM2Model) const;
+        // batched IsInLineOfSight, the static rays of the whole batch are tested together
+        void IsInLineOfSight(VMAP::LineOfSightQuery const* queries, bool* results, uint32 count, uint32 phasemask, bool ignoreM2Model) const;
         bool GetHitPosition(float srcX, float srcY, float srcZ, float& destX, float& destY, float& destZ, uint32 phasemask, float modifyDist) const;
 
         // Object Model insertion/remove/test for dynamic vmaps use
         void InsertGameObjectModel(const GameObjectModel& mdl);
         void RemoveGameObjectModel(const GameObjectModel& mdl);
         bool ContainsGameObjectModel(const GameObjectModel& mdl) const;
+        // changes the phases a model collides in, 0 disables its collision
+        void EnableGameObjectModel(GameObjectModel& mdl, uint32 phaseMask);
+        // the collision of a model in the dynamic tree changed, drops the cached line of sight around it
+        void InvalidateLineOfSight(const GameObjectModel& mdl);
+        LineOfSightCache& GetLineOfSightCache() const { return m_losCache; }
+        // units in world by position, area searches of units read it instead of the grid cells
+        UnitSpatialIndex& GetUnitSpatialIndex() { return m_unitSpatialIndex; }
 
         // Get Holder for Creature Linking
         CreatureLinkingHolder* GetCreatureLinkingHolder() { return &m_creatureLinkingHolder; }
@@ -428,6 +477,9 @@ class Map : public GridRefManager<NGridType>
 
     private:
         void LoadMapAndVMap(int gx, int gy);
+        // queues the grids players are heading to for the grid prefetcher
+        void PrefetchGridsAhead(uint32 diff);
+        void PrefetchGridsAlong(float x, float y, float destX, float destY);
 
         void SetTimer(uint32 t) { i_gridExpiry = t < MIN_GRID_DELAY ? MIN_GRID_DELAY : t; }
 
@@ -501,6 +553,55 @@ class Map : public GridRefManager<NGridType>
 
         std::bitset<TOTAL_NUMBER_OF_CELLS_PER_MAP* TOTAL_NUMBER_OF_CELLS_PER_MAP> marked_cells;
 
+        // parallel cell update, see MapUpdate.CellMode
+        void QueueCellForUpdate(Cell const& cell);
+        uint64 UpdateCellRegions(uint32 diff, bool checkRegions);
+
+        bool m_regionUpdate;                                // marked cells are queued into m_cellRegions instead of being visited
+        bool m_updatingRegions;
+        std::unordered_map<uint32 /*grid id*/, MapCellRegion> m_cellRegions;
+        Messager<Map> m_regionMessager;
+        mutable std::recursive_mutex m_regionLock;          // guards map wide containers while regions are updated
+        mutable std::shared_mutex m_dynTreeLock;            // guards m_dyn_tree while regions are updated
+
+        // the serial update needs no locks, they are only taken while regions are updated
+        std::unique_lock<std::recursive_mutex> LockRegions() const
+        {
+            std::unique_lock<std::recursive_mutex> guard(m_regionLock, std::defer_lock);
+            if (m_updatingRegions)
+                guard.lock();
+            return guard;
+        }
+        std::shared_lock<std::shared_mutex> ReadDynamicTree() const
+        {
+            std::shared_lock<std::shared_mutex> guard(m_dynTreeLock, std::defer_lock);
+            if (m_updatingRegions)
+                guard.lock();
+            return guard;
+        }
+        std::unique_lock<std::shared_mutex> WriteDynamicTree()
+        {
+            std::unique_lock<std::shared_mutex> guard(m_dynTreeLock, std::defer_lock);
+            if (m_updatingRegions)
+                guard.lock();
+            return guard;
+        }
+        // summons of other regions may grow the vector while the caller walks it, so regions get a copy
+        // which stays valid until the thread asks for the objects of another string id
+        template<class T>
+        std::vector<T*> const* GetStringIdObjects(std::vector<T*> const& objects) const
+        {
+            if (!m_updatingRegions)
+                return &objects;
+
+            thread_local std::vector<T*> copy;
+            copy = objects;
+            return &copy;
+        }
+        std::atomic<uint32> m_regionCounter;
+        std::unique_ptr<WorkerPool<GridCrawler>> m_gridCrawlers;
+        std::unique_ptr<WorkerPool<ObjectUpdateWorker>> m_objectUpdateWorkers;
+
         WorldObjectSet i_objectsToRemove;
 
         typedef std::multimap<TimePoint, ScriptAction> ScriptScheduleMap;
@@ -528,6 +629,18 @@ class Map : public GridRefManager<NGridType>
 
         // Dynamic Map tree object
         DynamicMapTree m_dyn_tree;
+        mutable LineOfSightCache m_losCache;
+        // static and dynamic trees without the cache
+        bool TestLineOfSight(float srcX, float srcY, float srcZ, float destX, float destY, float destZ, uint32 phasemask, bool ignoreM2Model) const;
+        UnitSpatialIndex m_unitSpatialIndex;
+
+        // player positions at the previous prefetch pass, their difference is the velocity of players not on a spline
+        struct GridPrefetchTrack
+        {
+            float x, y;
+        };
+        std::unordered_map<ObjectGuid, GridPrefetchTrack> m_gridPrefetchTracks;
+        ShortIntervalTimer m_gridPrefetchTimer;
 
         // WeatherSystem
         WeatherSystem* m_weatherSystem;
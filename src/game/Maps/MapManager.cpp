@@ -29,12 +29,16 @@
 #include "Maps/MapWorkers.h"
 #include <future>
 
+#ifdef BUILD_METRICS
+ #include "Metric/Metric.h"
+#endif
+
 #define CLASS_LOCK MaNGOS::ClassLevelLockable<MapManager, std::recursive_mutex>
 INSTANTIATE_SINGLETON_2(MapManager, CLASS_LOCK);
 INSTANTIATE_CLASS_MUTEX(MapManager, std::recursive_mutex);
 
 MapManager::MapManager()
-    : i_gridCleanUpDelay(sWorld.getConfig(CONFIG_UINT32_INTERVAL_GRIDCLEAN))
+    : i_gridCleanUpDelay(sWorld.getConfig(CONFIG_UINT32_INTERVAL_GRIDCLEAN)), m_mapUpdateWorkers(std::make_unique<WorkerPool<MapUpdateWorker>>())
 {
     i_timer.SetInterval(sWorld.getConfig(CONFIG_UINT32_INTERVAL_MAPUPDATE));
 }
@@ -198,13 +202,28 @@ void MapManager::Update(uint32 diff)
     for (auto& map : i_maps)
     {
         if (m_updater.activated())
-            m_updater.schedule_update(new MapUpdateWorker(*map.second, (uint32)i_timer.GetCurrent(), m_updater));
+            m_updater.schedule_update(m_mapUpdateWorkers->Acquire(*map.second, (uint32)i_timer.GetCurrent(), m_updater));
         else
             map.second->Update((uint32)i_timer.GetCurrent());
     }
 
     if (m_updater.activated())
+    {
         m_updater.wait();
+        m_mapUpdateWorkers->Reset();
+
+#ifdef BUILD_METRICS
+        std::vector<MapUpdaterWorkerStats> stats = m_updater.ConsumeWorkerStats();
+        for (size_t i = 0; i < stats.size(); ++i)
+        {
+            metric::measurement meas("map_updater.worker", { { "worker", std::to_string(i) } });
+            meas.add_field("busy", static_cast<int64>(stats[i].busyTime));
+            meas.add_field("idle", static_cast<int64>(stats[i].idleTime));
+            meas.add_field("executed", static_cast<int64>(stats[i].executed));
+            meas.add_field("stolen", static_cast<int64>(stats[i].stolen));
+        }
+#endif
+    }
 
     // remove all maps which can be unloaded
     MapMapType::iterator iter = i_maps.begin();
@@ -31,6 +31,8 @@
 
 class Transport;
 class BattleGround;
+class MapUpdateWorker;
+template <class T> class WorkerPool;
 struct TransportTemplate;
 
 struct MapID
@@ -143,6 +145,9 @@ class MapManager : public MaNGOS::Singleton<MapManager, MaNGOS::ClassLevelLockab
 
         void InitializeVisibilityDistanceInfo();
         /* statistics */
+        // null when maps are updated on the world thread
+        MapUpdater* GetMapUpdater() { return m_updater.activated() ? &m_updater : nullptr; }
+
         uint32 GetNumInstances();
         uint32 GetNumPlayersInInstances();
 
@@ -188,6 +193,7 @@ class MapManager : public MaNGOS::Singleton<MapManager, MaNGOS::ClassLevelLockab
         IntervalTimer i_timer;
 
         MapUpdater m_updater;
+        std::unique_ptr<WorkerPool<MapUpdateWorker>> m_mapUpdateWorkers;
 };
 
 template<typename Do>
@@ -19,10 +19,32 @@
 #include "MapUpdater.h"
 #include "MapWorkers.h"
 
-MapUpdater::MapUpdater(size_t num_threads) : _cancelationToken(false), pending_requests(0)
+#include <chrono>
+
+namespace
 {
-    for (size_t i = 0; i < num_threads; ++i)
-        _workerThreads.push_back(std::thread(&MapUpdater::WorkerThread, this));
+    // pool and worker slot the current thread belongs to, null for non worker threads
+    thread_local MapUpdater const* t_updater = nullptr;
+    thread_local size_t t_workerIndex = 0;
+
+    // failed take() rounds before a worker goes to sleep
+    uint32 const SPIN_BEFORE_SLEEP = 64;
+
+    uint64 ElapsedMicroseconds(std::chrono::steady_clock::time_point start)
+    {
+        return uint64(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+}
+
+MapUpdater::MapUpdater(size_t num_threads) : MapUpdater()
+{
+    activate(num_threads);
+}
+
+MapUpdater::~MapUpdater()
+{
+    if (activated())
+        deactivate();
 }
 
 void MapUpdater::activate(size_t num_threads)
@@ -30,26 +52,69 @@ void MapUpdater::activate(size_t num_threads)
     if (activated())
         return;
 
+    _cancelationToken = false;
+
+    // contexts must all exist before the first thread starts stealing
     for (size_t i = 0; i < num_threads; ++i)
-        _workerThreads.push_back(std::thread(&MapUpdater::WorkerThread, this));
+        _workers.push_back(std::make_unique<WorkerContext>());
+
+    for (size_t i = 0; i < num_threads; ++i)
+        _workerThreads.push_back(std::thread(&MapUpdater::WorkerThread, this, i));
 }
 
 void MapUpdater::deactivate()
 {
-    _cancelationToken = true;
-
-    _queue.Cancel();
+    {
+        std::lock_guard<std::mutex> lock(_sleepLock);
+        _cancelationToken = true;
+    }
+    _sleepCondition.notify_all();
 
     for (auto& thread : _workerThreads)
         thread.join();
+
+    _workerThreads.clear();
+    _workers.clear();
 }
 
 void MapUpdater::wait()
 {
-    std::unique_lock<std::mutex> lock(_lock);
-
+    // the calling thread helps until nothing is left to take, then sleeps until the last job finished
     while (pending_requests > 0)
-        _condition.wait(lock);
+    {
+        bool stolen;
+        if (Worker* worker = take(nullptr, stolen))
+        {
+            execute(worker);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(_lock);
+        if (pending_requests > 0 && _queuedJobs <= 0)
+            _condition.wait(lock);
+    }
+}
+
+void MapUpdater::wait(std::atomic<uint32>& counter)
+{
+    // a job of another map would nest its whole update into this one and stall it meanwhile
+    WorkerContext* context = t_updater == this ? _workers[t_workerIndex].get() : nullptr;
+    while (counter > 0)
+    {
+        bool stolen;
+        if (Worker* worker = take(context, stolen, &counter))
+        {
+            execute(worker);
+            if (context)
+            {
+                ++context->executed;
+                if (stolen)
+                    ++context->stolen;
+            }
+        }
+        else
+            std::this_thread::yield();
+    }
 }
 
 void MapUpdater::join()
@@ -63,38 +128,144 @@ bool MapUpdater::activated()
     return _workerThreads.size() > 0;
 }
 
-void MapUpdater::update_finished()
+void MapUpdater::schedule_update(Worker* worker)
 {
-    std::lock_guard<std::mutex> lock(_lock);
+    schedule_update(worker, pending_requests);
+}
 
-    --pending_requests;
-    _condition.notify_all();
+void MapUpdater::schedule_update(Worker* worker, std::atomic<uint32>& counter)
+{
+    worker->m_counter = &counter;
+    ++counter;
+    push(worker);
 }
 
-void MapUpdater::schedule_update(Worker* worker)
+std::vector<MapUpdaterWorkerStats> MapUpdater::ConsumeWorkerStats()
+{
+    std::vector<MapUpdaterWorkerStats> stats;
+    stats.reserve(_workers.size());
+    for (auto& context : _workers)
+        stats.push_back({ context->busyTime.exchange(0), context->idleTime.exchange(0), context->executed.exchange(0), context->stolen.exchange(0) });
+
+    return stats;
+}
+
+void MapUpdater::push(Worker* worker)
 {
-    std::lock_guard<std::mutex> lock(_lock);
+    bool queued;
+    if (t_updater == this)
+        queued = _workers[t_workerIndex]->queue.Push(worker);
+    else
+    {
+        std::lock_guard<std::mutex> lock(_injectLock);
+        queued = _injectQueue.Push(worker);
+    }
+
+    if (!queued)
+    {
+        // deque full, no point in queueing more work than the threads can steal
+        execute(worker);
+        return;
+    }
+
+    ++_queuedJobs;
+    if (_sleepingWorkers > 0)
+    {
+        std::lock_guard<std::mutex> lock(_sleepLock);
+        _sleepCondition.notify_one();
+    }
+}
+
+Worker* MapUpdater::take(WorkerContext* context, bool& stolen, std::atomic<uint32> const* counter)
+{
+    Worker* worker = nullptr;
+    stolen = false;
+
+    // a stale slot read by StealIf still points to a pooled worker, which is never freed during the update
+    auto matches = [counter](Worker* job) { return job && job->m_counter == counter; };
+
+    if (context)
+        worker = counter ? context->queue.PopIf(matches) : context->queue.Pop();
+
+    if (!worker)
+        worker = counter ? _injectQueue.StealIf(matches) : _injectQueue.Steal();
+
+    if (!worker && _queuedJobs > 0)
+    {
+        // start from the neighbour so that thieves spread over the victims
+        size_t const count = _workers.size();
+        size_t const first = context ? t_workerIndex + 1 : 0;
+        for (size_t i = 0; i < count && !worker; ++i)
+        {
+            WorkerContext* victim = _workers[(first + i) % count].get();
+            if (victim != context)
+                worker = counter ? victim->queue.StealIf(matches) : victim->queue.Steal();
+        }
+        stolen = worker != nullptr;
+    }
+
+    if (worker)
+        --_queuedJobs;
 
-    ++pending_requests;
-    _queue.Push(std::move(worker));
+    return worker;
 }
 
-void MapUpdater::WorkerThread()
+void MapUpdater::execute(Worker* worker)
 {
-    while (true)
+    std::atomic<uint32>* counter = worker->m_counter;
+
+    worker->execute();
+
+    // worker may be reused by its owner as soon as the counter drops
+    if (--(*counter) == 0 && counter == &pending_requests)
     {
-        Worker* request = nullptr;
+        std::lock_guard<std::mutex> lock(_lock);
+        _condition.notify_all();
+    }
+}
 
-        _queue.WaitAndPop(request);
+void MapUpdater::WorkerThread(size_t index)
+{
+    t_updater = this;
+    t_workerIndex = index;
 
-        if (_cancelationToken)
+    WorkerContext* context = _workers[index].get();
+    uint32 failedRounds = 0;
+    auto idleStart = std::chrono::steady_clock::now();
+
+    while (!_cancelationToken)
+    {
+        bool stolen;
+        if (Worker* worker = take(context, stolen))
         {
-            delete request;
-            return;
+            context->idleTime += ElapsedMicroseconds(idleStart);
+            failedRounds = 0;
+
+            auto busyStart = std::chrono::steady_clock::now();
+            execute(worker);
+            context->busyTime += ElapsedMicroseconds(busyStart);
+
+            ++context->executed;
+            if (stolen)
+                ++context->stolen;
+
+            idleStart = std::chrono::steady_clock::now();
+            continue;
         }
 
-        request->execute();
+        if (++failedRounds < SPIN_BEFORE_SLEEP)
+        {
+            std::this_thread::yield();
+            continue;
+        }
 
-        delete request;
+        std::unique_lock<std::mutex> lock(_sleepLock);
+        ++_sleepingWorkers;
+        while (_queuedJobs <= 0 && !_cancelationToken)
+            _sleepCondition.wait(lock);
+        --_sleepingWorkers;
+        failedRounds = 0;
     }
-}
\ No newline at end of file
+
+    t_updater = nullptr;
+}
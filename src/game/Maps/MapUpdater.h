@@ -20,42 +20,88 @@
 #define _MAP_UPDATER_H_INCLUDED
 
 #include "Platform/Define.h"
-#include "Util/ProducerConsumerQueue.h"
+#include "Multithreading/WorkStealingQueue.h"
 
 #include <mutex>
 #include <thread>
 #include <atomic>
+#include <memory>
 #include <vector>
 #include <condition_variable>
 
 class Worker;
 
+struct MapUpdaterWorkerStats
+{
+    uint64 busyTime;                                        // microseconds spent executing jobs
+    uint64 idleTime;                                        // microseconds spent looking for / waiting on jobs
+    uint64 executed;
+    uint64 stolen;
+};
+
+// Work stealing pool. Every worker thread owns a deque, jobs scheduled from inside a job go to the
+// local deque of the calling thread, jobs scheduled from outside go to a shared injection deque.
+// Idle threads steal from the injection deque first and from the other workers afterwards.
 class MapUpdater
 {
     public:
-        MapUpdater() : _cancelationToken(false), pending_requests(0) {}
+        MapUpdater() : _cancelationToken(false), pending_requests(0), _queuedJobs(0), _sleepingWorkers(0) {}
         MapUpdater(size_t num_threads);
         MapUpdater(const MapUpdater&) = delete;
-        
+        ~MapUpdater();
+
         void activate(size_t num_threads);
         void deactivate();
         void wait();
         void join();
         bool activated();
-        void update_finished();
+
+        // worker is not owned by the updater and must stay valid until the matching wait() returns
         void schedule_update(Worker* worker);
+        // sub tasks, counter is incremented here and decremented once the worker finished
+        void schedule_update(Worker* worker, std::atomic<uint32>& counter);
+        // helps executing the jobs scheduled with counter until it reaches zero, other jobs are left to the workers
+        void wait(std::atomic<uint32>& counter);
+
+        size_t GetWorkerCount() const { return _workers.size(); }
+        // returns statistics accumulated since the previous call
+        std::vector<MapUpdaterWorkerStats> ConsumeWorkerStats();
 
     private:
-        ProducerConsumerQueue<Worker *> _queue;
+        struct WorkerContext
+        {
+            WorkerContext() : busyTime(0), idleTime(0), executed(0), stolen(0) {}
+
+            WorkStealingQueue<Worker*> queue;
+            std::atomic<uint64> busyTime;
+            std::atomic<uint64> idleTime;
+            std::atomic<uint64> executed;
+            std::atomic<uint64> stolen;
+        };
 
+        std::vector<std::unique_ptr<WorkerContext>> _workers;
         std::vector<std::thread> _workerThreads;
         std::atomic<bool> _cancelationToken;
 
+        // jobs scheduled from non worker threads
+        WorkStealingQueue<Worker*> _injectQueue;
+        std::mutex _injectLock;
+
+        std::atomic<uint32> pending_requests;
         std::mutex _lock;
-        std::condition_variable _condition;
-        size_t pending_requests;
+        std::condition_variable _condition;                 // signaled when pending_requests drops to zero
+
+        std::atomic<int32> _queuedJobs;                    // may briefly go negative when a job is stolen before being counted
+        std::atomic<uint32> _sleepingWorkers;
+        std::mutex _sleepLock;
+        std::condition_variable _sleepCondition;
+
+        void push(Worker* worker);
+        // only jobs scheduled with counter are taken when it is set
+        Worker* take(WorkerContext* context, bool& stolen, std::atomic<uint32> const* counter = nullptr);
+        void execute(Worker* worker);
 
-        void WorkerThread();
+        void WorkerThread(size_t index);
 };
 
-#endif //_MAP_UPDATER_H_INCLUDED
\ No newline at end of file
+#endif //_MAP_UPDATER_H_INCLUDED
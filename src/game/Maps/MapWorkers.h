@@ -26,85 +26,111 @@
 #include "Entities/Object.h"
 #include "Platform/Define.h"
 
+#include <atomic>
+#include <memory>
+
 class Worker
 {
+        friend class MapUpdater;
+
     public:
-        Worker(MapUpdater& updater) : m_updater(updater) {}
+        Worker(MapUpdater& updater) : m_updater(&updater), m_counter(nullptr) {}
         virtual ~Worker() = default;
         virtual void execute() {};
 
     protected:
-        MapUpdater& GetWorker() { return m_updater; }
+        MapUpdater& GetWorker() { return *m_updater; }
+
+    private:
+        MapUpdater* m_updater;
+        std::atomic<uint32>* m_counter;                     // completion counter, set when scheduled
+};
+
+// Recycles workers between ticks so that scheduling does not allocate once warmed up.
+// Acquired workers stay valid until Reset(), which must only be called after they all finished.
+template <class T>
+class WorkerPool
+{
+    public:
+        WorkerPool() : m_used(0) {}
+
+        template <typename... Args>
+        T* Acquire(Args&&... args)
+        {
+            if (m_used == m_workers.size())
+                m_workers.push_back(std::make_unique<T>(std::forward<Args>(args)...));
+            else
+                *m_workers[m_used] = T(std::forward<Args>(args)...);
+
+            return m_workers[m_used++].get();
+        }
+
+        void Reset() { m_used = 0; }
 
     private:
-        MapUpdater& m_updater;
+        std::vector<std::unique_ptr<T>> m_workers;
+        size_t m_used;
 };
 
 class MapUpdateWorker : public Worker
 {
     public:
         MapUpdateWorker(Map& map, uint32 diff, MapUpdater& updater) :
-            Worker(updater), m_map(map), m_diff(diff)
+            Worker(updater), m_map(&map), m_diff(diff)
         {}
 
         void execute() override
         {
-            m_map.Update(m_diff);
-            GetWorker().update_finished();
+            m_map->Update(m_diff);
         }
 
     private:
-        Map& m_map;
+        Map* m_map;
         uint32 m_diff;
 };
 
+// Collects the objects of all cells of a region, read only on the grid containers
 class GridCrawler : public Worker
 {
     public:
-        GridCrawler(Map& map, std::vector<Cell> &cells, uint32 diff, MapUpdater& updater) :
-            Worker(updater), m_map(map), m_cells(cells), m_diff(diff)
+        GridCrawler(Map& map, MapCellRegion& region, uint32 diff, MapUpdater& updater) :
+            Worker(updater), m_map(&map), m_region(&region), m_diff(diff)
         {}
 
         void execute() override
         {
-            WorldObjectUnSet objToUpdate;
-            MaNGOS::ObjectUpdater obj_updater(objToUpdate, m_diff);
+            MaNGOS::ObjectUpdater obj_updater(m_region->objects, m_diff);
             TypeContainerVisitor<MaNGOS::ObjectUpdater, GridTypeMapContainer  > grid_object_update(obj_updater);    // For creature
             TypeContainerVisitor<MaNGOS::ObjectUpdater, WorldTypeMapContainer > world_object_update(obj_updater);   // For pets
 
-            for (auto &cell : m_cells)
+            for (auto& cell : m_region->cells)
             {
-                m_map.Visit(cell, grid_object_update);
-                m_map.Visit(cell, world_object_update);
+                m_map->Visit(cell, grid_object_update);
+                m_map->Visit(cell, world_object_update);
             }
-
-            GetWorker().update_finished();
         }
 
     private:
-        Map& m_map;
-        std::vector<Cell> &m_cells;
+        Map* m_map;
+        MapCellRegion* m_region;
         uint32 m_diff;
 };
 
-
 class ObjectUpdateWorker : public Worker
 {
     public:
         ObjectUpdateWorker(std::unordered_set<WorldObject*>& objects, uint32 diff, MapUpdater& updater) :
-            Worker(updater), m_objects(objects), m_diff(diff)
+            Worker(updater), m_objects(&objects), m_diff(diff)
         {}
 
         void execute() override
         {
-            for (WorldObject* const &object : m_objects)
+            for (WorldObject* const& object : *m_objects)
                 object->Update(m_diff);
-
-            GetWorker().update_finished();
         }
 
     private:
-        std::unordered_set<WorldObject*>& m_objects;
+        std::unordered_set<WorldObject*>* m_objects;
         uint32 m_diff;
 };
 
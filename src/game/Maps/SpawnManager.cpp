@@ -77,6 +77,13 @@ void SpawnManager::Initialize()
 
 void SpawnManager::AddCreature(uint32 dbguid)
 {
+    // the spawn list is map wide and respawns may land in any region
+    if (m_map.IsUpdatingRegions())
+    {
+        m_map.DeferRegionAction([dbguid](Map* map) { map->GetSpawnManager().AddCreature(dbguid); });
+        return;
+    }
+
     time_t respawnTime = m_map.GetPersistentState()->GetCreatureRespawnTime(dbguid);
     m_spawns.emplace_back(TimePoint(std::chrono::seconds(respawnTime)), dbguid, HIGHGUID_UNIT);
     std::sort(m_spawns.begin(), m_spawns.end());
@@ -84,6 +91,12 @@ void SpawnManager::AddCreature(uint32 dbguid)
 
 void SpawnManager::AddGameObject(uint32 dbguid)
 {
+    if (m_map.IsUpdatingRegions())
+    {
+        m_map.DeferRegionAction([dbguid](Map* map) { map->GetSpawnManager().AddGameObject(dbguid); });
+        return;
+    }
+
     time_t respawnTime = m_map.GetPersistentState()->GetGORespawnTime(dbguid);
     m_spawns.emplace_back(TimePoint(std::chrono::seconds(respawnTime)), dbguid, HIGHGUID_GAMEOBJECT);
     std::sort(m_spawns.begin(), m_spawns.end());
@@ -91,6 +104,12 @@ void SpawnManager::AddGameObject(uint32 dbguid)
 
 void SpawnManager::RespawnCreature(uint32 dbguid, uint32 respawnDelay)
 {
+    if (m_map.IsUpdatingRegions())
+    {
+        m_map.DeferRegionAction([dbguid, respawnDelay](Map* map) { map->GetSpawnManager().RespawnCreature(dbguid, respawnDelay); });
+        return;
+    }
+
     bool found = false;
     auto itr = m_spawns.begin();
     for (; itr != m_spawns.end(); )
@@ -119,6 +138,12 @@ void SpawnManager::RespawnCreature(uint32 dbguid, uint32 respawnDelay)
 
 void SpawnManager::RespawnGameObject(uint32 dbguid, uint32 respawnDelay)
 {
+    if (m_map.IsUpdatingRegions())
+    {
+        m_map.DeferRegionAction([dbguid, respawnDelay](Map* map) { map->GetSpawnManager().RespawnGameObject(dbguid, respawnDelay); });
+        return;
+    }
+
     bool found = false;
     auto itr = m_spawns.begin();
     for (; itr != m_spawns.end(); )
@@ -147,6 +172,12 @@ void SpawnManager::RespawnGameObject(uint32 dbguid, uint32 respawnDelay)
 
 void SpawnManager::RespawnAll()
 {
+    if (m_map.IsUpdatingRegions())
+    {
+        m_map.DeferRegionAction([](Map* map) { map->GetSpawnManager().RespawnAll(); });
+        return;
+    }
+
     for (auto itr = m_spawns.begin(); itr != m_spawns.end();)
     {
         auto& spawnInfo = *itr;
@@ -212,6 +243,12 @@ SpawnGroup* SpawnManager::GetSpawnGroup(uint32 Id)
 
 void SpawnManager::RespawnSpawnGroupsInVicinity(Position pos, float range)
 {
+    if (m_map.IsUpdatingRegions())
+    {
+        m_map.DeferRegionAction([pos, range](Map* map) { map->GetSpawnManager().RespawnSpawnGroupsInVicinity(pos, range); });
+        return;
+    }
+
     for (auto& data : m_spawnGroups)
         data.second->RespawnIfInVicinity(pos, range);
 }
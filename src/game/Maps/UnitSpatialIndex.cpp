@@ -0,0 +1,149 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "Maps/UnitSpatialIndex.h"
+#include "Entities/Unit.h"
+#include "Log.h"
+
+#include <cmath>
+
+uint32 UnitSpatialIndex::ComputeCellOf(Unit const* unit)
+{
+    return ComputeCell(unit->GetPositionX(), unit->GetPositionY());
+}
+
+void UnitSpatialIndex::Insert(Unit* unit)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_cells[ComputeCellOf(unit)].push_back({ unit, unit->GetCombatReach() });
+    AddCombatReach(unit->GetCombatReach());
+}
+
+void UnitSpatialIndex::Remove(Unit* unit)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    UnitEntry entry;
+    if (RemoveFromCell(unit, ComputeCellOf(unit), entry))
+        RemoveCombatReach(entry.combatReach);
+}
+
+void UnitSpatialIndex::Move(Unit* unit, uint32 oldCell, uint32 cell)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    UnitEntry entry;
+    if (RemoveFromCell(unit, oldCell, entry))
+        m_cells[cell].push_back(entry);
+}
+
+bool UnitSpatialIndex::RemoveFromCell(Unit* unit, uint32 cell, UnitEntry& entry)
+{
+    auto removeFrom = [unit, &entry](UnitCell& units)
+    {
+        auto itr = std::find_if(units.begin(), units.end(), [unit](UnitEntry const& listed) { return listed.unit == unit; });
+        if (itr == units.end())
+            return false;
+
+        // order within a cell does not matter, the cell vector is kept for the units walking in next
+        entry = *itr;
+        *itr = units.back();
+        units.pop_back();
+        return true;
+    };
+
+    auto itr = m_cells.find(cell);
+    if (itr != m_cells.end() && removeFrom(itr->second))
+        return true;
+
+    // a pointer left behind would dangle once the unit is deleted, so search the whole index before giving up
+    sLog.outError("UnitSpatialIndex: %s not found in its cell, searching all cells", unit->GetGuidStr().c_str());
+    for (auto& data : m_cells)
+        if (removeFrom(data.second))
+            return true;
+
+    return false;
+}
+
+void UnitSpatialIndex::RemoveCombatReach(float reach)
+{
+    auto itr = m_combatReaches.find(reach);
+    if (itr != m_combatReaches.end() && --itr->second == 0)
+        m_combatReaches.erase(itr);
+}
+
+void UnitSpatialIndex::UpdateCombatReach(Unit* unit)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    auto itr = m_cells.find(ComputeCellOf(unit));
+    if (itr == m_cells.end())
+        return;
+
+    for (UnitEntry& entry : itr->second)
+    {
+        if (entry.unit != unit)
+            continue;
+
+        RemoveCombatReach(entry.combatReach);
+        entry.combatReach = unit->GetCombatReach();
+        AddCombatReach(entry.combatReach);
+        return;
+    }
+}
+
+void UnitSpatialIndex::GetUnitsInSquare(float x, float y, float range, std::vector<Unit*>& units) const
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if (!m_combatReaches.empty())
+        range += m_combatReaches.rbegin()->first;
+
+    auto addUnits = [&](UnitCell const& cell)
+    {
+        for (UnitEntry const& entry : cell)
+            if (std::abs(entry.unit->GetPositionX() - x) <= range && std::abs(entry.unit->GetPositionY() - y) <= range)
+                units.push_back(entry.unit);
+    };
+
+    uint32 lowX = ComputeCellCoord(x - range);
+    uint32 highX = ComputeCellCoord(x + range);
+    uint32 lowY = ComputeCellCoord(y - range);
+    uint32 highY = ComputeCellCoord(y + range);
+
+    // squares larger than the populated part of the map are cheaper to answer by walking every cell
+    if (uint64(highX - lowX + 1) * (highY - lowY + 1) > m_cells.size())
+    {
+        for (auto& data : m_cells)
+            addUnits(data.second);
+        return;
+    }
+
+    for (uint32 cellX = lowX; cellX <= highX; ++cellX)
+    {
+        for (uint32 cellY = lowY; cellY <= highY; ++cellY)
+        {
+            auto itr = m_cells.find((cellX << 16) | cellY);
+            if (itr != m_cells.end())
+                addUnits(itr->second);
+        }
+    }
+}
+
+uint32 UnitSpatialIndex::GetCellCount() const
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return uint32(m_cells.size());
+}
@@ -0,0 +1,109 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_UNIT_SPATIAL_INDEX_H
+#define MANGOS_UNIT_SPATIAL_INDEX_H
+
+#include "Common.h"
+#include "Maps/GridDefines.h"
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class Unit;
+
+// edge of the index cells in yards, close to the radius of the common area spells
+#define UNIT_SPATIAL_INDEX_CELL_SIZE    10.0f
+#define UNIT_SPATIAL_INDEX_MAX_CELL     uint32(MAP_SIZE / UNIT_SPATIAL_INDEX_CELL_SIZE)
+
+/**
+ * Units in world of one map hashed by their position into square cells much smaller than the grid cells.
+ * Units are added and removed together with the world and moved between cells when they are relocated,
+ * so the index is always current. An area query only reads the few cells around its center instead of
+ * every object of the grid cells the radius touches. Regions updated in parallel may move their units
+ * while another region queries, the cell table is guarded by a lock for that.
+ */
+class UnitSpatialIndex
+{
+    public:
+        UnitSpatialIndex() {}
+
+        void Insert(Unit* unit);
+        void Remove(Unit* unit);
+        void Relocate(Unit* unit, float oldX, float oldY, float x, float y)
+        {
+            uint32 oldCell = ComputeCell(oldX, oldY);
+            uint32 cell = ComputeCell(x, y);
+            if (cell != oldCell)
+                Move(unit, oldCell, cell);
+        }
+        void UpdateCombatReach(Unit* unit);
+
+        // appends the units standing in the square of range around x, y, the caller checks the exact distance
+        // the square is widened by the largest combat reach in the index to find large units at the edge
+        void GetUnitsInSquare(float x, float y, float range, std::vector<Unit*>& units) const;
+
+        // the check of a grid searcher can be passed as visitor, it is called outside the lock and may change the index
+        template<class Visitor>
+        void VisitUnitsInSquare(float x, float y, float range, Visitor&& visitor) const
+        {
+            std::vector<Unit*> units;
+            GetUnitsInSquare(x, y, range, units);
+            for (Unit* unit : units)
+                visitor(unit);
+        }
+
+        uint32 GetCellCount() const;
+
+    private:
+        static uint32 ComputeCell(float x, float y)
+        {
+            return (ComputeCellCoord(x) << 16) | ComputeCellCoord(y);
+        }
+        static uint32 ComputeCellCoord(float coord)
+        {
+            // positions off the map end up in the border cells, the query clamps the same way
+            float cell = (coord + MAP_HALFSIZE) / UNIT_SPATIAL_INDEX_CELL_SIZE;
+            if (!(cell > 0.0f))
+                return 0;
+            return std::min(uint32(cell), UNIT_SPATIAL_INDEX_MAX_CELL);
+        }
+        static uint32 ComputeCellOf(Unit const* unit);
+
+        struct UnitEntry
+        {
+            Unit* unit;
+            float combatReach;                              // as counted in m_combatReaches
+        };
+        typedef std::vector<UnitEntry> UnitCell;
+
+        void Move(Unit* unit, uint32 oldCell, uint32 cell);
+        // returns false if the unit was not in the index
+        bool RemoveFromCell(Unit* unit, uint32 cell, UnitEntry& entry);
+        void AddCombatReach(float reach) { ++m_combatReaches[reach]; }
+        void RemoveCombatReach(float reach);
+
+        mutable std::mutex m_lock;
+        std::unordered_map<uint32 /*cell*/, UnitCell> m_cells;
+        std::map<float, uint32> m_combatReaches;            // units per combat reach, the largest one widens the queries
+};
+
+#endif
@@ -60,11 +60,11 @@ void MotionMaster::Initialize()
 {
 #ifdef BUILD_METRICS
     metric::duration<std::chrono::microseconds> meas("motionmaster.initialize", {
-        { "entry", std::to_string(m_owner->GetEntry()) },
-        { "guid", std::to_string(m_owner->GetGUIDLow()) },
-        { "unit_type", std::to_string(m_owner->GetGUIDHigh()) },
-        { "map_id", std::to_string(m_owner->GetMapId()) },
-        { "instance_id", std::to_string(m_owner->GetInstanceId()) }
+        { "entry", m_owner->GetEntry() },
+        { "guid", m_owner->GetGUIDLow() },
+        { "unit_type", m_owner->GetGUIDHigh() },
+        { "map_id", m_owner->GetMapId() },
+        { "instance_id", m_owner->GetInstanceId() }
     }, 1000);
 #endif
     // stop current move
@@ -118,11 +118,11 @@ void MotionMaster::UpdateMotion(uint32 diff)
         return;
 #ifdef BUILD_METRICS
     metric::duration<std::chrono::microseconds> meas("motionmaster.updatemotion", {
-        { "entry", std::to_string(m_owner->GetEntry()) },
-        { "guid", std::to_string(m_owner->GetGUIDLow()) },
-        { "unit_type", std::to_string(m_owner->GetGUIDHigh()) },
-        { "map_id", std::to_string(m_owner->GetMapId()) },
-        { "instance_id", std::to_string(m_owner->GetInstanceId()) }
+        { "entry", m_owner->GetEntry() },
+        { "guid", m_owner->GetGUIDLow() },
+        { "unit_type", m_owner->GetGUIDHigh() },
+        { "map_id", m_owner->GetMapId() },
+        { "instance_id", m_owner->GetInstanceId() }
     }, 1000);
 #endif
 
@@ -20,6 +20,7 @@
 #include "World/World.h"
 #include "Entities/Creature.h"
 #include "MotionGenerators/MoveMap.h"
+#include "MotionGenerators/PathCorridorCache.h"
 #include "MoveMapSharedDefines.h"
 
 namespace MMAP
@@ -199,30 +200,14 @@ namespace MMAP
         return false;
     }
 
-    bool MMapManager::loadMap(uint32 mapId, uint32 instanceId, int32 x, int32 y, uint32 number)
+    bool MMapManager::readTile(uint32 mapId, int32 x, int32 y, uint32 number, MMapTileData& tile)
     {
-        // make sure the mmap is loaded and ready to load tiles
-        if (!loadMapData(mapId, instanceId))
-            return false;
-
-        // get this mmap data
-        const auto& mmapData = m_loadedMMaps[packInstanceId(mapId, instanceId)];
-        MANGOS_ASSERT(mmapData->navMesh);
-
         char fileName[100];
         if (number == 0)
             sprintf(fileName, "%03u%02i%02i.mmtile", mapId, x, y);
         else
             sprintf(fileName, "%03u%02i%02i_%02i.mmtile", mapId, x, y, number);
 
-        // check if we already have this tile loaded
-        uint32 packedGridPos = packTileID(x, y);
-        if (mmapData->mmapLoadedTiles.find(packedGridPos) != mmapData->mmapLoadedTiles.end())
-        {
-            sLog.outError("MMAP:loadMap: Asked to load already loaded navmesh tile. ");
-            return false;
-        }
-
         std::string filePath = sWorld.GetDataPath() + std::string("mmaps/") + fileName;
         // load this tile
         FILE* file = fopen(filePath.c_str(), "rb");
@@ -259,26 +244,64 @@ namespace MMAP
         {
             sLog.outError("MMAP:loadMap: Bad header or data in mmap %s", fileName);
             fclose(file);
+            dtFree(data);
             return false;
         }
 
         fclose(file);
 
+        tile.data = data;
+        tile.size = fileHeader.size;
+        return true;
+    }
+
+    bool MMapManager::loadMap(uint32 mapId, uint32 instanceId, int32 x, int32 y, uint32 number, MMapTileData* preloaded /*= nullptr*/)
+    {
+        MMapTileData tile;
+        if (preloaded)
+            tile = std::move(*preloaded);
+
+        // make sure the mmap is loaded and ready to load tiles
+        if (!loadMapData(mapId, instanceId))
+            return false;
+
+        // get this mmap data
+        const auto& mmapData = m_loadedMMaps[packInstanceId(mapId, instanceId)];
+        MANGOS_ASSERT(mmapData->navMesh);
+
+        // check if we already have this tile loaded
+        uint32 packedGridPos = packTileID(x, y);
+        if (mmapData->mmapLoadedTiles.find(packedGridPos) != mmapData->mmapLoadedTiles.end())
+        {
+            sLog.outError("MMAP:loadMap: Asked to load already loaded navmesh tile. ");
+            return false;
+        }
+
+        // a tile read ahead by the grid prefetcher only needs to be added
+        if (!tile.data && !readTile(mapId, x, y, number, tile))
+            return false;
+
+        unsigned char* data = tile.data;
+        tile.data = nullptr;
+
         dtMeshHeader* header = (dtMeshHeader*)data;
         dtTileRef tileRef = 0;
 
         // memory allocated for data is now managed by detour, and will be deallocated when the tile is removed
-        dtStatus dtResult = mmapData->navMesh->addTile(data, fileHeader.size, DT_TILE_FREE_DATA, 0, &tileRef);
+        std::unique_lock<std::shared_mutex> lock(mmapData->navMeshLock);
+        dtStatus dtResult = mmapData->navMesh->addTile(data, tile.size, DT_TILE_FREE_DATA, 0, &tileRef);
+        lock.unlock();
+        sPathCorridorCache.Invalidate(mmapData->navMesh);
         if (dtStatusFailed(dtResult))
         {
-            sLog.outError("MMAP:loadMap: Could not load %s into navmesh", fileName);
+            sLog.outError("MMAP:loadMap: Could not load %03u%02i%02i into navmesh", mapId, x, y);
             dtFree(data);
             return false;
         }
 
         mmapData->mmapLoadedTiles.insert(std::pair<uint32, dtTileRef>(packedGridPos, tileRef));
         ++m_loadedTiles;
-        DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:loadMap: Loaded into %03i[%02i,%02i]", fileName, mapId, header->x, header->y);
+        DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:loadMap: Loaded %03u%02i%02i into %03i[%02i,%02i]", mapId, x, y, mapId, header->x, header->y);
         return true;
     }
 
@@ -379,7 +402,10 @@ namespace MMAP
         dtTileRef tileRef = mmapData->mmapLoadedTiles[packedGridPos];
 
         // unload, and mark as non loaded
+        std::unique_lock<std::shared_mutex> lock(mmapData->navMeshLock);
         dtStatus dtResult = mmapData->navMesh->removeTile(tileRef, nullptr, nullptr);
+        lock.unlock();
+        sPathCorridorCache.Invalidate(mmapData->navMesh);
         if (dtStatusFailed(dtResult))
         {
             // this is technically a memory leak
@@ -413,6 +439,7 @@ namespace MMAP
 
             // unload all tiles from given map
             const auto& mmapData = (*itr).second;
+            std::unique_lock<std::shared_mutex> lock(mmapData->navMeshLock);
             for (MMapTileSet::iterator i = mmapData->mmapLoadedTiles.begin(); i != mmapData->mmapLoadedTiles.end(); ++i)
             {
                 uint32 x = (i->first >> 16);
@@ -427,6 +454,8 @@ namespace MMAP
                 }
             }
 
+            lock.unlock();
+            sPathCorridorCache.Invalidate(mmapData->navMesh);
             itr = m_loadedMMaps.erase(itr);
             DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:unloadMap: Unloaded %03i.mmap", mapId);
             success = true;
@@ -475,6 +504,15 @@ namespace MMAP
         return (*itr).second->navMesh;
     }
 
+    std::shared_mutex* MMapManager::GetNavMeshLock(uint32 mapId, uint32 instanceId)
+    {
+        auto itr = m_loadedMMaps.find(packInstanceId(mapId, instanceId));
+        if (itr == m_loadedMMaps.end())
+            return nullptr;
+
+        return &(*itr).second->navMeshLock;
+    }
+
     dtNavMesh const* MMapManager::GetGONavMesh(uint32 mapId)
     {
         if (m_loadedModels.find(mapId) == m_loadedModels.end())
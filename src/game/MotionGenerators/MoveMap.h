@@ -26,6 +26,7 @@
 
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 
 class Unit;
 
@@ -65,6 +66,23 @@ namespace MMAP
         // we have to use single dtNavMeshQuery for every instance, since those are not thread safe
         NavMeshQuerySet navMeshQueries;     // instanceId to query
         MMapTileSet mmapLoadedTiles;        // maps [map grid coords] to [dtTile]
+
+        // held exclusively while tiles are added or removed, pathfinding threads query under the shared lock
+        std::shared_mutex navMeshLock;
+    };
+
+    // raw navmesh tile as read from its .mmtile file, owns the detour allocation until it is added
+    struct MMapTileData
+    {
+        MMapTileData() : data(nullptr), size(0) {}
+        MMapTileData(MMapTileData&& other) noexcept : data(other.data), size(other.size) { other.data = nullptr; }
+        MMapTileData& operator=(MMapTileData&& other) noexcept { std::swap(data, other.data); std::swap(size, other.size); return *this; }
+        MMapTileData(MMapTileData const&) = delete;
+        MMapTileData& operator=(MMapTileData const&) = delete;
+        ~MMapTileData() { if (data) dtFree(data); }
+
+        unsigned char* data;
+        uint32 size;
     };
 
     struct MMapGOData
@@ -94,7 +112,10 @@ namespace MMAP
             MMapManager() : m_loadedTiles(0) {}
             ~MMapManager();
 
-            bool loadMap(uint32 mapId, uint32 instanceId, int32 x, int32 y, uint32 number);
+            // a preloaded tile is consumed, the file is only read when none is given
+            bool loadMap(uint32 mapId, uint32 instanceId, int32 x, int32 y, uint32 number, MMapTileData* preloaded = nullptr);
+            // reads and validates a tile file without touching any navmesh, safe from any thread
+            static bool readTile(uint32 mapId, int32 x, int32 y, uint32 number, MMapTileData& tile);
             bool loadMapData(uint32 mapId, uint32 instanceId);
             void loadAllGameObjectModels(std::vector<uint32> const& displayIds);
             bool loadGameObject(uint32 displayId);
@@ -108,6 +129,7 @@ namespace MMAP
             dtNavMeshQuery const* GetModelNavMeshQuery(uint32 displayId);
             dtNavMesh const* GetNavMesh(uint32 mapId, uint32 instanceId);
             dtNavMesh const* GetGONavMesh(uint32 displayId);
+            std::shared_mutex* GetNavMeshLock(uint32 mapId, uint32 instanceId);
 
             uint32 getLoadedTilesCount() const { return m_loadedTiles; }
             uint32 getLoadedMapsCount() const { return m_loadedMMaps.size(); }
@@ -0,0 +1,145 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "MotionGenerators/PathCorridorCache.h"
+#include "World/World.h"
+#include "Util/Timer.h"
+
+INSTANTIATE_SINGLETON_1(PathCorridorCache);
+
+std::size_t PathCorridorCache::KeyHash::operator()(Key const& key) const
+{
+    uint64 hash = reinterpret_cast<uintptr_t>(key.navMesh);
+    hash = hash * 0x9E3779B97F4A7C15ULL ^ key.startPoly;
+    hash = hash * 0x9E3779B97F4A7C15ULL ^ key.endPoly;
+    hash = hash * 0x9E3779B97F4A7C15ULL ^ key.flags;
+    return std::size_t(hash ^ (hash >> 29));
+}
+
+bool PathCorridorCache::Find(dtNavMesh const* navMesh, dtPolyRef startPoly, dtPolyRef endPoly, uint16 includeFlags, uint16 excludeFlags,
+                             dtPolyRef* path, uint32& pathLength, uint32 maxPath)
+{
+    uint32 ttl = sWorld.getConfig(CONFIG_UINT32_PATH_FIND_CACHE_TTL);
+    if (!ttl)
+        return false;
+
+    m_lookups.fetch_add(1, std::memory_order_relaxed);
+
+    Key key = { navMesh, startPoly, endPoly, uint32(includeFlags) << 16 | excludeFlags };
+    Shard& shard = GetShard(key);
+    uint32 now = WorldTimer::getMSTime();
+
+    std::lock_guard<std::mutex> guard(shard.lock);
+    auto itr = shard.entries.find(key);
+    if (itr == shard.entries.end())
+        return false;
+
+    Entry const& entry = itr->second;
+    if (int32(entry.expireTime - now) <= 0)
+    {
+        shard.entries.erase(itr);
+        return false;
+    }
+
+    if (entry.path.size() > maxPath)
+        return false;
+
+    // a tile may have been replaced in between, its polygons got a new salt then
+    for (dtPolyRef poly : entry.path)
+    {
+        if (!navMesh->isValidPolyRef(poly))
+        {
+            shard.entries.erase(itr);
+            return false;
+        }
+    }
+
+    pathLength = uint32(entry.path.size());
+    std::copy(entry.path.begin(), entry.path.end(), path);
+    m_hits.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void PathCorridorCache::Store(dtNavMesh const* navMesh, dtPolyRef startPoly, dtPolyRef endPoly, uint16 includeFlags, uint16 excludeFlags,
+                              dtPolyRef const* path, uint32 pathLength)
+{
+    uint32 ttl = sWorld.getConfig(CONFIG_UINT32_PATH_FIND_CACHE_TTL);
+    if (!ttl || !pathLength)
+        return;
+
+    Key key = { navMesh, startPoly, endPoly, uint32(includeFlags) << 16 | excludeFlags };
+    Shard& shard = GetShard(key);
+    uint32 now = WorldTimer::getMSTime();
+
+    std::lock_guard<std::mutex> guard(shard.lock);
+    if (shard.entries.size() >= MAX_SHARD_ENTRIES)
+    {
+        for (auto itr = shard.entries.begin(); itr != shard.entries.end();)
+        {
+            if (int32(itr->second.expireTime - now) <= 0)
+                itr = shard.entries.erase(itr);
+            else
+                ++itr;
+        }
+
+        // everything is still fresh, the cache is too small for the load and starts over
+        if (shard.entries.size() >= MAX_SHARD_ENTRIES)
+            shard.entries.clear();
+    }
+
+    Entry& entry = shard.entries[key];
+    entry.path.assign(path, path + pathLength);
+    entry.expireTime = now + ttl;
+    m_stores.fetch_add(1, std::memory_order_relaxed);
+}
+
+void PathCorridorCache::Invalidate(dtNavMesh const* navMesh)
+{
+    for (Shard& shard : m_shards)
+    {
+        std::lock_guard<std::mutex> guard(shard.lock);
+        for (auto itr = shard.entries.begin(); itr != shard.entries.end();)
+        {
+            if (itr->first.navMesh == navMesh)
+                itr = shard.entries.erase(itr);
+            else
+                ++itr;
+        }
+    }
+}
+
+PathCorridorCacheStats PathCorridorCache::GetStats() const
+{
+    PathCorridorCacheStats stats;
+    stats.lookups = m_lookups.load(std::memory_order_relaxed);
+    stats.hits = m_hits.load(std::memory_order_relaxed);
+    stats.stores = m_stores.load(std::memory_order_relaxed);
+    stats.patches = m_patches.load(std::memory_order_relaxed);
+    return stats;
+}
+
+uint32 PathCorridorCache::GetSize()
+{
+    uint32 size = 0;
+    for (Shard& shard : m_shards)
+    {
+        std::lock_guard<std::mutex> guard(shard.lock);
+        size += uint32(shard.entries.size());
+    }
+    return size;
+}
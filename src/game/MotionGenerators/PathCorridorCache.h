@@ -0,0 +1,110 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_PATH_CORRIDOR_CACHE_H
+#define MANGOS_PATH_CORRIDOR_CACHE_H
+
+#include "Common.h"
+#include "Policies/Singleton.h"
+
+#include <Detour/Include/DetourNavMesh.h>
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+struct PathCorridorCacheStats
+{
+    uint64 lookups;
+    uint64 hits;
+    uint64 stores;
+    uint64 patches;                                         // corridors extended after a target move instead of replanned
+};
+
+/**
+ * Recently planned polygon corridors, shared by all units.
+ * Units chasing the same target mostly stand on a handful of polygons, so the corridor found by one
+ * of them is reused by the others for a short while. Entries are dropped when their navmesh changes.
+ */
+class PathCorridorCache
+{
+    public:
+        PathCorridorCache() : m_lookups(0), m_hits(0), m_stores(0), m_patches(0) {}
+
+        // copies the corridor into path, false if none is cached or it is longer than maxPath
+        bool Find(dtNavMesh const* navMesh, dtPolyRef startPoly, dtPolyRef endPoly, uint16 includeFlags, uint16 excludeFlags,
+                  dtPolyRef* path, uint32& pathLength, uint32 maxPath);
+        void Store(dtNavMesh const* navMesh, dtPolyRef startPoly, dtPolyRef endPoly, uint16 includeFlags, uint16 excludeFlags,
+                   dtPolyRef const* path, uint32 pathLength);
+        // tiles of the navmesh were added or removed
+        void Invalidate(dtNavMesh const* navMesh);
+
+        void AddPatch() { m_patches.fetch_add(1, std::memory_order_relaxed); }
+
+        PathCorridorCacheStats GetStats() const;
+        uint32 GetSize();
+
+    private:
+        struct Key
+        {
+            dtNavMesh const* navMesh;
+            dtPolyRef startPoly;
+            dtPolyRef endPoly;
+            uint32 flags;                                   // include flags << 16 | exclude flags
+
+            bool operator==(Key const& other) const
+            {
+                return navMesh == other.navMesh && startPoly == other.startPoly && endPoly == other.endPoly && flags == other.flags;
+            }
+        };
+
+        struct KeyHash
+        {
+            std::size_t operator()(Key const& key) const;
+        };
+
+        struct Entry
+        {
+            std::vector<dtPolyRef> path;
+            uint32 expireTime;
+        };
+
+        struct Shard
+        {
+            std::mutex lock;
+            std::unordered_map<Key, Entry, KeyHash> entries;
+        };
+
+        static uint32 const SHARD_COUNT = 16;
+        static uint32 const MAX_SHARD_ENTRIES = 512;
+
+        Shard& GetShard(Key const& key) { return m_shards[KeyHash()(key) % SHARD_COUNT]; }
+
+        std::array<Shard, SHARD_COUNT> m_shards;
+
+        std::atomic<uint64> m_lookups;
+        std::atomic<uint64> m_hits;
+        std::atomic<uint64> m_stores;
+        std::atomic<uint64> m_patches;
+};
+
+#define sPathCorridorCache MaNGOS::Singleton<PathCorridorCache>::Instance()
+
+#endif
@@ -23,6 +23,8 @@
 #include "Log.h"
 #include "World/World.h"
 #include "Entities/Transports.h"
+#include "MotionGenerators/PathRequestQueue.h"
+#include "MotionGenerators/PathCorridorCache.h"
 #include <Detour/Include/DetourCommon.h>
 #include <Detour/Include/DetourMath.h>
 
@@ -36,8 +38,10 @@ PathFinder::PathFinder(const Unit* owner, bool ignoreNormalization) :
     m_type(PATHFIND_BLANK), m_useStraightPath(false), m_forceDestination(false), m_straightLine(false),
     m_pointPathLimit(MAX_POINT_PATH_LENGTH), // TODO: Fix legitimate long paths
     m_cachedPoints(m_pointPathLimit * VERTEX_SIZE), m_pathPolyRefs(m_pointPathLimit), m_polyLength(0),
-    m_smoothPathPolyRefs(m_pointPathLimit), m_sourceUnit(owner), m_navMesh(nullptr), m_navMeshQuery(nullptr),
-    m_defaultMapId(m_sourceUnit->GetMapId()), m_ignoreNormalization(ignoreNormalization)
+    m_smoothPathPolyRefs(m_pointPathLimit), m_corridorPatches(0), m_sourceUnit(owner), m_navMesh(nullptr), m_navMeshQuery(nullptr),
+    m_defaultMapId(m_sourceUnit->GetMapId()), m_ignoreNormalization(ignoreNormalization), m_deferNormalization(false),
+    m_normalizePending(false), m_liquidResolved(false), m_startSwimmable(false), m_endSwimmable(false), m_startUnderWater(false),
+    m_endUnderWater(false), m_asyncPending(false), m_deliveredType(PATHFIND_BLANK)
 {
     DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::PathInfo for %u \n", m_sourceUnit->GetGUIDLow());
 
@@ -47,12 +51,53 @@ PathFinder::PathFinder(const Unit* owner, bool ignoreNormalization) :
         m_defaultNavMeshQuery = mmap->GetNavMeshQuery(m_sourceUnit->GetMapId(), m_sourceUnit->GetInstanceId());
     }
 
+    dtVset(m_corridorEnd, 0.0f, 0.0f, 0.0f);
+
+    CaptureOwnerState();
     createFilter();
 }
 
 PathFinder::~PathFinder()
 {
-    DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::~PathInfo() for %u \n", m_sourceUnit->GetGUIDLow());
+    // may be released by a pathfinding thread after the owner is gone
+    DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::~PathInfo() for %u \n", m_ownerGuidLow);
+}
+
+void PathFinder::CaptureOwnerState()
+{
+    m_ownerGuidLow = m_sourceUnit->GetGUIDLow();
+    m_ownerMapId = m_sourceUnit->GetMapId();
+    m_ownerTerrain = m_sourceUnit->GetTerrain();
+    m_ownerCollisionWidth = m_sourceUnit->GetCollisionWidth();
+    m_ownerIsPlayer = m_sourceUnit->GetTypeId() == TYPEID_PLAYER;
+    m_ownerCanSwim = m_sourceUnit->CanSwim();
+    m_ownerCanFly = m_sourceUnit->CanFly();
+    m_ownerOnTransport = m_sourceUnit->GetTransport() != nullptr;
+    m_ownerInDungeon = m_sourceUnit->GetMap() && m_sourceUnit->GetMap()->IsDungeon();
+    m_ownerIgnoresPathfinding = m_sourceUnit->hasUnitState(UNIT_STAT_IGNORE_PATHFINDING);
+}
+
+void PathFinder::ResolveLiquid(Vector3 const& start, Vector3 const& dest)
+{
+    m_startSwimmable = m_ownerTerrain->IsSwimmable(start.x, start.y, start.z);
+    m_endSwimmable = m_ownerTerrain->IsSwimmable(dest.x, dest.y, dest.z);
+    m_startUnderWater = m_ownerTerrain->IsUnderWater(start.x, start.y, start.z);
+    m_endUnderWater = m_ownerTerrain->IsUnderWater(dest.x, dest.y, dest.z);
+    m_liquidResolved = true;
+}
+
+bool PathFinder::IsSwimmable(Vector3 const& p, bool start) const
+{
+    if (m_liquidResolved)
+        return start ? m_startSwimmable : m_endSwimmable;
+    return m_ownerTerrain->IsSwimmable(p.x, p.y, p.z);
+}
+
+bool PathFinder::IsUnderWater(Vector3 const& p, bool start) const
+{
+    if (m_liquidResolved)
+        return start ? m_startUnderWater : m_endUnderWater;
+    return m_ownerTerrain->IsUnderWater(p.x, p.y, p.z);
 }
 
 void PathFinder::SetCurrentNavMesh()
@@ -87,52 +132,121 @@ bool PathFinder::calculate(float destX, float destY, float destZ, bool forceDest
 
 bool PathFinder::calculate(Vector3 const& start, Vector3 const& dest, bool forceDest/* = false*/, bool straightLine/* = false*/)
 {
-    if (!MaNGOS::IsValidMapCoord(dest.x, dest.y, dest.z))
-        return false;
-
-    if (!MaNGOS::IsValidMapCoord(start.x, start.y, start.z))
+    if (!PrepareCalculate(start, dest, forceDest, straightLine))
         return false;
 
 #ifdef BUILD_METRICS
     metric::duration<std::chrono::microseconds> meas("pathfinder.calculate", {
-        { "entry", std::to_string(m_sourceUnit->GetEntry()) },
-        { "guid", std::to_string(m_sourceUnit->GetGUIDLow()) },
-        { "unit_type", std::to_string(m_sourceUnit->GetGUIDHigh()) },
-        { "map_id", std::to_string(m_sourceUnit->GetMapId()) },
-        { "instance_id", std::to_string(m_sourceUnit->GetInstanceId()) }
+        { "entry", m_sourceUnit->GetEntry() },
+        { "guid", m_sourceUnit->GetGUIDLow() },
+        { "unit_type", m_sourceUnit->GetGUIDHigh() },
+        { "map_id", m_sourceUnit->GetMapId() },
+        { "instance_id", m_sourceUnit->GetInstanceId() }
     }, 1000);
 #endif
 
+    BuildPath(start, dest);
+    return true;
+}
+
+bool PathFinder::PrepareCalculate(Vector3 const& start, Vector3 const& dest, bool forceDest, bool straightLine)
+{
+    if (!MaNGOS::IsValidMapCoord(dest.x, dest.y, dest.z))
+        return false;
+
+    if (!MaNGOS::IsValidMapCoord(start.x, start.y, start.z))
+        return false;
+
     //if (GenericTransport* transport = m_sourceUnit->GetTransport())
     //    transport->CalculatePassengerOffset(dest.x, dest.y, dest.z, nullptr);
 
+    CaptureOwnerState();
+
     setStartPosition(start);
 
     setEndPosition(dest);
 
     m_forceDestination = forceDest;
     m_straightLine = straightLine;
+    m_normalizePending = false;
+    m_liquidResolved = false;
 
     SetCurrentNavMesh();
 
-    DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::calculate() for %u \n", m_sourceUnit->GetGUIDLow());
+    DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::calculate() for %u \n", m_ownerGuidLow);
+
+    if (m_navMesh && m_navMeshQuery && !m_ownerIgnoresPathfinding)
+        updateFilter();
 
+    return true;
+}
+
+void PathFinder::BuildPath(Vector3 const& start, Vector3 const& dest)
+{
     // make sure navMesh works - we can run on map w/o mmap
     // check if the start and end point have a .mmtile loaded (can we pass via not loaded tile on the way?)
-    if (!m_navMesh || !m_navMeshQuery || m_sourceUnit->hasUnitState(UNIT_STAT_IGNORE_PATHFINDING) ||
+    if (!m_navMesh || !m_navMeshQuery || m_ownerIgnoresPathfinding ||
         !HaveTile(start) || !HaveTile(dest))
     {
         BuildShortcut();
         m_type = PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH);
-        return true;
+        return;
     }
 
-    updateFilter();
-
     BuildPolyPath(start, dest);
+}
+
+bool PathFinder::calculateAsync(float destX, float destY, float destZ, PathRequestPriority priority, std::function<void(Unit&)> callback, bool forceDest/* = false*/, bool straightLine/* = false*/)
+{
+    // the model navmeshes of transports are shared between maps, those paths stay synchronous
+    if (m_asyncPending || !sPathRequestQueue.IsEnabled() || m_sourceUnit->GetTransport())
+        return false;
+
+    float x, y, z;
+    m_sourceUnit->GetPosition(x, y, z);
+    Vector3 start(x, y, z);
+    Vector3 dest(destX, destY, destZ);
+    if (!PrepareCalculate(start, dest, forceDest, straightLine))
+        return false;
+
+    // nothing to query, the shortcut is cheap enough to build right here
+    if (!m_navMesh || !m_navMeshQuery || m_ownerIgnoresPathfinding)
+        return false;
+
+    ResolveLiquid(start, dest);
+
+    m_deliveredPoints = m_pathPoints;
+    m_deliveredType = m_type;
+    m_asyncCallback = std::move(callback);
+    m_asyncPending = true;
+    sPathRequestQueue.Enqueue(*m_sourceUnit, shared_from_this(), start, dest, priority);
     return true;
 }
 
+void PathFinder::DeliverAsync(Unit* owner)
+{
+    m_asyncPending = false;
+    if (!m_asyncCallback)
+        return;
+
+    if (owner != m_sourceUnit)
+    {
+        m_asyncCallback = nullptr;
+        return;
+    }
+
+    if (m_normalizePending)
+    {
+        m_normalizePending = false;
+        NormalizePath();
+    }
+
+    // the callback may queue the next request and replace itself
+    std::function<void(Unit&)> callback = std::move(m_asyncCallback);
+    m_asyncCallback = nullptr;
+    callback(*owner);
+}
+
 dtPolyRef PathFinder::getPathPolyByPosition(const dtPolyRef* polyPath, uint32 polyPathSize, const float* point, float* distance, const float maxDist) const
 {
     if (!polyPath || !polyPathSize)
@@ -216,7 +330,7 @@ dtPolyRef PathFinder::getPolyByLocation(const float* point, float* distance)
 void PathFinder::BuildPolyPath(const Vector3& startPos, const Vector3& endPos)
 {
     // *** getting start/end poly logic ***
-    if (m_sourceUnit->GetMap()->IsDungeon())
+    if (m_ownerInDungeon)
     {
         float distance = sqrt((endPos.x - startPos.x) * (endPos.x - startPos.x) + (endPos.y - startPos.y) * (endPos.y - startPos.y) + (endPos.z - startPos.z) * (endPos.z - startPos.z));
         if (distance > 300.f)
@@ -246,13 +360,13 @@ void PathFinder::BuildPolyPath(const Vector3& startPos, const Vector3& endPos)
         BuildShortcut();
 
         // Check for swimming or flying shortcut
-        if ((startPoly == INVALID_POLYREF && m_sourceUnit->GetTerrain()->IsSwimmable(startPos.x, startPos.y, startPos.z)) ||
-            (endPoly == INVALID_POLYREF && m_sourceUnit->GetTerrain()->IsSwimmable(endPos.x, endPos.y, endPos.z)))
-            m_type = m_sourceUnit->CanSwim() ? PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH) : PATHFIND_NOPATH;
+        if ((startPoly == INVALID_POLYREF && IsSwimmable(startPos, true)) ||
+            (endPoly == INVALID_POLYREF && IsSwimmable(endPos, false)))
+            m_type = m_ownerCanSwim ? PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH) : PATHFIND_NOPATH;
         else
         {
-            if (m_sourceUnit->GetTypeId() != TYPEID_PLAYER)
-                m_type = m_sourceUnit->CanFly() ? PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH) : PATHFIND_NOPATH;
+            if (!m_ownerIsPlayer)
+                m_type = m_ownerCanFly ? PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH) : PATHFIND_NOPATH;
             else
                 m_type = PATHFIND_NOPATH;
         }
@@ -267,17 +381,17 @@ void PathFinder::BuildPolyPath(const Vector3& startPos, const Vector3& endPos)
         DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ BuildPolyPath :: farFromPoly distToStartPoly=%.3f distToEndPoly=%.3f\n", distToStartPoly, distToEndPoly);
 
         bool buildShotrcut = false;
-        Vector3 p = (distToStartPoly > 7.0f) ? startPos : endPos;
-        if (m_sourceUnit->GetTerrain()->IsUnderWater(p.x, p.y, p.z))
+        bool const fromStart = distToStartPoly > 7.0f;
+        if (IsUnderWater(fromStart ? startPos : endPos, fromStart))
         {
             DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ BuildPolyPath :: underWater case\n");
-            if (m_sourceUnit->CanSwim())
+            if (m_ownerCanSwim)
                 buildShotrcut = true;
         }
         else
         {
             DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ BuildPolyPath :: flying case\n");
-            if (m_sourceUnit->CanFly())
+            if (m_ownerCanFly)
                 buildShotrcut = true;
         }
 
@@ -333,7 +447,7 @@ void PathFinder::BuildPolyPath(const Vector3& startPos, const Vector3& endPos)
                 sLog.outError("Invalid poly ref in BuildPolyPath. polyLength: %u, pathStartIndex: %u,"
                               " startPos: %s, endPos: %s, mapId: %u",
                               m_polyLength, pathStartIndex, startPos.toString().c_str(), endPos.toString().c_str(),
-                              m_sourceUnit->GetMapId());
+                              m_ownerMapId);
                 break;
             }
 
@@ -365,97 +479,13 @@ void PathFinder::BuildPolyPath(const Vector3& startPos, const Vector3& endPos)
         m_polyLength = pathEndIndex - pathStartIndex + 1;
         memmove(m_pathPolyRefs.data(), m_pathPolyRefs.data() + pathStartIndex, m_polyLength * sizeof(dtPolyRef));
     }
-    //else if (startPolyFound && !endPolyFound)
-    //{
-    //    DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ BuildPolyPath :: (startPolyFound && !endPolyFound)\n");
-
-    //    // we are moving on the old path but target moved out
-    //    // so we have atleast part of poly-path ready
-
-    //    m_polyLength -= pathStartIndex;
-
-    //    // try to adjust the suffix of the path instead of recalculating entire length
-    //    // at given interval the target cannot get too far from its last location
-    //    // thus we have less poly to cover
-    //    // sub-path of optimal path is optimal
-
-    //    // take ~80% of the original length
-    //    // TODO : play with the values here
-    //    uint32 prefixPolyLength = uint32(m_polyLength * 0.8f + 0.5f);
-    //    memmove(m_pathPolyRefs.data(), m_pathPolyRefs.data() + pathStartIndex, prefixPolyLength * sizeof(dtPolyRef));
-
-    //    dtPolyRef suffixStartPoly = m_pathPolyRefs[prefixPolyLength - 1];
-
-    //    // we need any point on our suffix start poly to generate poly-path, so we need last poly in prefix data
-    //    float suffixEndPoint[VERTEX_SIZE];
-    //    if (dtStatusFailed(m_navMeshQuery->closestPointOnPoly(suffixStartPoly, endPoint, suffixEndPoint, nullptr)))
-    //    {
-    //        // we can hit offmesh connection as last poly - closestPointOnPoly() don't like that
-    //        // try to recover by using prev polyref
-    //        --prefixPolyLength;
-    //        suffixStartPoly = m_pathPolyRefs[prefixPolyLength - 1];
-    //        if (dtStatusFailed(m_navMeshQuery->closestPointOnPoly(suffixStartPoly, endPoint, suffixEndPoint, nullptr)))
-    //        {
-    //            // suffixStartPoly is still invalid, error state
-    //            BuildShortcut();
-    //            m_type = PATHFIND_NOPATH;
-    //            return;
-    //        }
-    //    }
-
-    //    // generate suffix
-    //    uint32 suffixPolyLength = 0;
-
-    //    if (!m_straightLine)
-    //    {
-    //        dtResult = m_navMeshQuery->findPath(
-    //                                suffixStartPoly,    // start polygon
-    //                                endPoly,            // end polygon
-    //                                suffixEndPoint,     // start position
-    //                                endPoint,           // end position
-    //                                &m_filter,            // polygon search filter
-    //                                m_pathPolyRefs.data() + prefixPolyLength - 1,    // [out] path
-    //                                (int*)&suffixPolyLength,
-    //                                m_pointPathLimit - prefixPolyLength);   // max number of polygons in output path
-    //    }
-    //    else
-    //    {
-    //        float hit = 0.0f;
-    //        float hitNormal[3] = {0.0f, 0.0f, 0.0f};
-
-    //        dtResult = m_navMeshQuery->raycast(
-    //                        suffixStartPoly,
-    //                        suffixEndPoint,
-    //                        endPoint,
-    //                        &m_filter,
-    //                        &hit,
-    //                        hitNormal,
-    //                        m_pathPolyRefs.data() + prefixPolyLength - 1,
-    //                        (int*)&suffixPolyLength,
-    //                        m_pointPathLimit - prefixPolyLength);
-
-    //        // raycast() sets hit to FLT_MAX if there is a ray between start and end
-    //        if (hit != FLT_MAX)
-    //        {
-    //            // the ray hit something, return no path instead of the incomplete one
-    //            m_type = PATHFIND_NOPATH;
-    //            return;
-    //        }
-    //    }
-
-    //    if (!suffixPolyLength || dtStatusFailed(dtResult))
-    //    {
-    //        // this is probably an error state, but we'll leave it
-    //        // and hopefully recover on the next Update
-    //        // we still need to copy our preffix
-    //        sLog.outError("%u's Path Build failed: 0 length path", m_sourceUnit->GetGUIDLow());
-    //    }
-
-    //    DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++  m_polyLength=%u prefixPolyLength=%u suffixPolyLength=%u \n", m_polyLength, prefixPolyLength, suffixPolyLength);
-
-    //    // new path = prefix + suffix - overlap
-    //    m_polyLength = prefixPolyLength + suffixPolyLength - 1;
-    //}
+    else if (startPolyFound && MoveCorridorEnd(pathStartIndex, endPoly, endPoint))
+    {
+        DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ BuildPolyPath :: (startPolyFound && !endPolyFound) corridor extended\n");
+
+        // we are moving on the old path and the target moved a bit
+        // the polygons it crossed were appended, no need to replan
+    }
     else
     {
         DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ BuildPolyPath :: (!startPolyFound && !endPolyFound)\n");
@@ -466,18 +496,31 @@ void PathFinder::BuildPolyPath(const Vector3& startPos, const Vector3& endPos)
 
         // free and invalidate old path data
         clear();
+        m_corridorPatches = 0;
 
         if (!m_straightLine)
         {
-            dtResult = m_navMeshQuery->findPath(
-                    startPoly,          // start polygon
-                    endPoly,            // end polygon
-                    startPoint,         // start position
-                    endPoint,           // end position
-                    &m_filter,          // polygon search filter
-                    m_pathPolyRefs.data(), // [out] path
-                    (int*)&m_polyLength,
-                    m_pointPathLimit);   // max number of polygons in output path
+            // units chasing the same target usually plan between the same polygons
+            if (sPathCorridorCache.Find(m_navMesh, startPoly, endPoly, m_filter.getIncludeFlags(), m_filter.getExcludeFlags(),
+                                        m_pathPolyRefs.data(), m_polyLength, m_pointPathLimit))
+                dtResult = DT_SUCCESS;
+            else
+            {
+                dtResult = m_navMeshQuery->findPath(
+                        startPoly,          // start polygon
+                        endPoly,            // end polygon
+                        startPoint,         // start position
+                        endPoint,           // end position
+                        &m_filter,          // polygon search filter
+                        m_pathPolyRefs.data(), // [out] path
+                        (int*)&m_polyLength,
+                        m_pointPathLimit);   // max number of polygons in output path
+
+                // partial corridors depend on where the search gave up, only complete ones are shared
+                if (dtStatusSucceed(dtResult) && m_polyLength && m_pathPolyRefs[m_polyLength - 1] == endPoly)
+                    sPathCorridorCache.Store(m_navMesh, startPoly, endPoly, m_filter.getIncludeFlags(), m_filter.getExcludeFlags(),
+                                             m_pathPolyRefs.data(), m_polyLength);
+            }
         }
         else
         {
@@ -502,7 +545,7 @@ void PathFinder::BuildPolyPath(const Vector3& startPos, const Vector3& endPos)
                 float hitPos[3];
                 float distanceToPoly;
 
-                hit = hit - m_sourceUnit->GetCollisionWidth();
+                hit = hit - m_ownerCollisionWidth;
                 if (hit < 0.1f)
                 {
                     m_type = PATHFIND_NOPATH;
@@ -542,7 +585,7 @@ void PathFinder::BuildPolyPath(const Vector3& startPos, const Vector3& endPos)
         if (!m_polyLength || dtStatusFailed(dtResult))
         {
             // only happens if we passed bad data to findPath(), or navmesh is messed up
-            sLog.outError("%u's Path Build failed: 0 length path", m_sourceUnit->GetGUIDLow());
+            sLog.outError("%u's Path Build failed: 0 length path", m_ownerGuidLow);
             BuildShortcut();
             m_type = PATHFIND_NOPATH;
             return;
@@ -555,10 +598,51 @@ void PathFinder::BuildPolyPath(const Vector3& startPos, const Vector3& endPos)
     else
         m_type = PATHFIND_INCOMPLETE;
 
+    dtVcopy(m_corridorEnd, endPoint);
+
     // generate the point-path out of our up-to-date poly-path
     BuildPointPath(startPoint, endPoint);
 }
 
+bool PathFinder::MoveCorridorEnd(uint32 pathStartIndex, dtPolyRef endPoly, const float* endPoint)
+{
+    // only complete corridors are worth extending, and they get worse with every extension
+    if (m_straightLine || !m_polyLength || (m_type & PATHFIND_INCOMPLETE) || m_corridorPatches >= CORRIDOR_PATCH_LIMIT)
+        return false;
+
+    if (dtVdistSqr(m_corridorEnd, endPoint) > CORRIDOR_PATCH_MAX_MOVE * CORRIDOR_PATCH_MAX_MOVE)
+        return false;
+
+    // walk from the old end to the new one along the surface, collecting the polygons crossed
+    dtPolyRef lastPoly = m_pathPolyRefs[m_polyLength - 1];
+    float lastPoint[VERTEX_SIZE];
+    if (dtStatusFailed(m_navMeshQuery->closestPointOnPoly(lastPoly, m_corridorEnd, lastPoint, nullptr)))
+        return false;
+
+    float resultPoint[VERTEX_SIZE];
+    dtPolyRef visited[CORRIDOR_PATCH_MAX_VISITED];
+    int visitedCount = 0;
+    dtStatus dtResult = m_navMeshQuery->moveAlongSurface(lastPoly, lastPoint, endPoint, &m_filter, resultPoint, visited, &visitedCount, CORRIDOR_PATCH_MAX_VISITED);
+    if (dtStatusFailed(dtResult) || !visitedCount || visited[visitedCount - 1] != endPoly)
+        return false;
+
+    uint32 length = m_polyLength - pathStartIndex;
+    memmove(m_pathPolyRefs.data(), m_pathPolyRefs.data() + pathStartIndex, length * sizeof(dtPolyRef));
+    length = mergeCorridorEndMoved(m_pathPolyRefs.data(), length, m_pointPathLimit, visited, visitedCount);
+
+    // the corridor was cut in front, the caller plans a new one anyway
+    if (m_pathPolyRefs[length - 1] != endPoly)
+    {
+        m_polyLength = 0;
+        return false;
+    }
+
+    m_polyLength = length;
+    ++m_corridorPatches;
+    sPathCorridorCache.AddPatch();
+    return true;
+}
+
 void PathFinder::BuildPointPath(const float* startPoint, const float* endPoint)
 {
     if (m_pointPathLimit * VERTEX_SIZE > m_cachedPoints.size())
@@ -757,13 +841,25 @@ void PathFinder::NormalizePath()
 
     GenericTransport* transport = m_sourceUnit->GetTransport();
 
-    for (auto& m_pathPoint : m_pathPoints)
+    // all points at once, the terrain heights are then looked up in batches
+    uint32 const count = uint32(m_pathPoints.size());
+    std::vector<float> x(count), y(count), z(count);
+    for (uint32 i = 0; i < count; ++i)
     {
+        x[i] = m_pathPoints[i].x;
+        y[i] = m_pathPoints[i].y;
+        z[i] = m_pathPoints[i].z;
         if (transport)
-            transport->CalculatePassengerPosition(m_pathPoint.x, m_pathPoint.y, m_pathPoint.z);
-        m_sourceUnit->UpdateAllowedPositionZ(m_pathPoint.x, m_pathPoint.y, m_pathPoint.z);
+            transport->CalculatePassengerPosition(x[i], y[i], z[i]);
+    }
+
+    m_sourceUnit->UpdateAllowedPositionZ(x.data(), y.data(), z.data(), count);
+
+    for (uint32 i = 0; i < count; ++i)
+    {
         if (transport)
-            transport->CalculatePassengerOffset(m_pathPoint.x, m_pathPoint.y, m_pathPoint.z);
+            transport->CalculatePassengerOffset(x[i], y[i], z[i]);
+        m_pathPoints[i] = Vector3(x[i], y[i], z[i]);
     }
 }
 
@@ -780,7 +876,11 @@ void PathFinder::BuildShortcut()
     m_pathPoints[0] = getStartPosition();
     m_pathPoints[1] = getActualEndPosition();
 
-    NormalizePath();
+    // the heights come from the map, which only the map thread may touch
+    if (m_deferNormalization)
+        m_normalizePending = true;
+    else
+        NormalizePath();
 
     m_type = PATHFIND_SHORTCUT;
 }
@@ -848,7 +948,7 @@ NavTerrainFlag PathFinder::getNavTerrain(float x, float y, float z) const
 
 bool PathFinder::HaveTile(const Vector3& p) const
 {
-    if (m_sourceUnit->GetTransport())
+    if (m_ownerOnTransport)
         return true;
 
     int tx = -1, ty = -1;
@@ -913,6 +1013,44 @@ uint32 PathFinder::fixupCorridor(dtPolyRef* path, uint32 npath, uint32 maxPath,
     return req + size;
 }
 
+uint32 PathFinder::mergeCorridorEndMoved(dtPolyRef* path, uint32 npath, uint32 maxPath, dtPolyRef const* visited, uint32 nvisited)
+{
+    int32 commonPath = -1;
+    int32 commonVisited = -1;
+
+    // Find the first polygon of the path the walk crossed, and where the walk crossed it first. Unlike
+    // dtMergeCorridorEndMoved, which keeps the path up to the furthest common polygon, this cuts off
+    // the part of the old corridor that a target walking back towards the owner left behind.
+    for (uint32 i = 0; i < npath; ++i)
+    {
+        bool found = false;
+        for (int32 j = nvisited - 1; j >= 0; --j)
+        {
+            if (path[i] == visited[j])
+            {
+                commonPath = i;
+                commonVisited = j;
+                found = true;
+            }
+        }
+        if (found)
+            break;
+    }
+
+    // If no intersection found just return current path.
+    if (commonPath == -1 || commonVisited == -1)
+        return npath;
+
+    // Concatenate paths, everything behind the common polygon is replaced by the visited ones.
+    uint32 pathPos = commonPath + 1;
+    uint32 visitedPos = commonVisited + 1;
+    uint32 count = std::min(nvisited - visitedPos, maxPath - pathPos);
+    if (count)
+        memcpy(path + pathPos, visited + visitedPos, count * sizeof(dtPolyRef));
+
+    return pathPos + count;
+}
+
 bool PathFinder::getSteerTarget(const float* startPos, const float* endPos,
                                 float minTargetDist, const dtPolyRef* path, uint32 pathSize,
                                 float* steerPos, unsigned char& steerPosFlag, dtPolyRef& steerPosRef) const
@@ -1083,6 +1221,9 @@ void PathFinder::ComputePathToRandomPoint(Vector3 const& startPoint, float maxRa
     // use only straight line
     m_straightLine = true;
     m_forceDestination = false;
+    m_normalizePending = false;
+
+    CaptureOwnerState();
 
     // update unit filter
     updateFilter();
@@ -26,10 +26,15 @@
 
 #include "Movement/MoveSplineInitArgs.h"
 
+#include <functional>
+#include <memory>
+
 using Movement::Vector3;
 using Movement::PointsArray;
 
 class Unit;
+class TerrainInfo;
+class PathRequestQueue;
 
 // 74*4.0f=296y  number_of_points*interval = max_path_len
 // this is way more than actual evade range
@@ -49,6 +54,12 @@ class Unit;
 #define VERTEX_SIZE             3
 #define INVALID_POLYREF         0
 
+// a corridor is extended when the target moved at most this far, replanned otherwise
+#define CORRIDOR_PATCH_MAX_MOVE     10.0f
+#define CORRIDOR_PATCH_MAX_VISITED  16
+// extended corridors drift from the shortest path, replan after this many extensions in a row
+#define CORRIDOR_PATCH_LIMIT        8
+
 // bound box of poly search area
 static float NearPolySearchBound[VERTEX_SIZE] = { 5.0f, 5.0f, 5.0f };
 static float FarPolySearchBound[VERTEX_SIZE] = { 10.0f, 10.0f, 10.0f };
@@ -64,7 +75,15 @@ enum PathType
     PATHFIND_SHORT          = 0x0020,   // path is longer or equal to its limited path length
 };
 
-class PathFinder
+// order in which queued asynchronous path requests are served
+enum PathRequestPriority
+{
+    PATH_PRIORITY_LOW       = 0,
+    PATH_PRIORITY_NORMAL    = 1,
+    PATH_PRIORITY_HIGH      = 2,        // chasing a player, delays are noticed
+};
+
+class PathFinder : public std::enable_shared_from_this<PathFinder>
 {
     public:
         PathFinder(Unit const* owner, bool ignoreNormalization = false);
@@ -78,6 +97,13 @@ class PathFinder
         // compute a straight path to some random point in max range
         void ComputePathToRandomPoint(Vector3 const& startPoint, float maxRange);
 
+        // Queue the path calculation to the pathfinding threads, the callback is called on the map thread with the result in place
+        // return: false if the path cannot be calculated asynchronously, the caller has to use calculate() then
+        bool calculateAsync(float destX, float destY, float destZ, PathRequestPriority priority, std::function<void(Unit&)> callback, bool forceDest = false, bool straightLine = false);
+        // the pending result is dropped when it arrives, the path keeps its previous content
+        void CancelAsync() { m_asyncCallback = nullptr; }
+        bool IsAsyncPending() const { return m_asyncPending; }
+
         // option setters - use optional
         void setUseStrightPath(bool useStraightPath) { m_useStraightPath = useStraightPath; };
         void setPathLengthLimit(float distance) { m_pointPathLimit = std::min<uint32>(uint32(distance / SMOOTH_PATH_STEP_SIZE * 1.25f), MAX_POINT_PATH_LENGTH); };
@@ -90,7 +116,12 @@ class PathFinder
         PointsArray& getPath() { return m_pathPoints; }
         PathType getPathType() const { return m_type; }
 
+        // while a request is pending a pathfinding thread writes the path, these return the last delivered result
+        PointsArray const& getDeliveredPath() const { return m_asyncPending ? m_deliveredPoints : m_pathPoints; }
+        PathType getDeliveredPathType() const { return m_asyncPending ? m_deliveredType : m_type; }
+
     private:
+        friend class PathRequestQueue;
 
         PointsArray    m_pathPoints;       // our actual (x,y,z) path to the target
         PathType       m_type;             // tells what kind of path this is
@@ -104,6 +135,8 @@ class PathFinder
         std::vector<dtPolyRef> m_pathPolyRefs;       // array of detour polygon references
         uint32         m_polyLength;                 // number of polygons in the path
         std::vector<dtPolyRef> m_smoothPathPolyRefs; // caching for findSmoothPath
+        float          m_corridorEnd[VERTEX_SIZE];   // end point the poly path was built for, [y, z, x]
+        uint32         m_corridorPatches;            // extensions since the corridor was last planned
 
         Vector3        m_startPosition;    // {x, y, z} of current location
         Vector3        m_endPosition;      // {x, y, z} of the destination
@@ -117,6 +150,33 @@ class PathFinder
         uint32                  m_defaultMapId;
 
         bool                    m_ignoreNormalization;
+        bool                    m_deferNormalization;   // set while building on a pathfinding thread
+        bool                    m_normalizePending;     // shortcut points still need NormalizePath on the map thread
+
+        // owner state used while building, captured on the map thread so the build itself does not touch the unit
+        uint32                  m_ownerGuidLow;
+        uint32                  m_ownerMapId;
+        TerrainInfo const*      m_ownerTerrain;
+        float                   m_ownerCollisionWidth;
+        bool                    m_ownerIsPlayer;
+        bool                    m_ownerCanSwim;
+        bool                    m_ownerCanFly;
+        bool                    m_ownerOnTransport;
+        bool                    m_ownerInDungeon;
+        bool                    m_ownerIgnoresPathfinding;
+
+        // liquid at the start and end point, resolved on the map thread for asynchronous requests since
+        // the terrain may load or unload grids
+        bool                    m_liquidResolved;
+        bool                    m_startSwimmable;
+        bool                    m_endSwimmable;
+        bool                    m_startUnderWater;
+        bool                    m_endUnderWater;
+
+        std::function<void(Unit&)> m_asyncCallback;
+        bool                    m_asyncPending;
+        PointsArray             m_deliveredPoints;  // copy of the path while a request is pending
+        PathType                m_deliveredType;
 
         dtQueryFilter m_filter;                     // use single filter for all movements, update it when needed
 
@@ -125,6 +185,17 @@ class PathFinder
         void setActualEndPosition(const Vector3& point) { m_actualEndPosition = point; }
         void NormalizePath();
         void SetCurrentNavMesh();
+        void CaptureOwnerState();
+        void ResolveLiquid(Vector3 const& start, Vector3 const& dest);
+        bool IsSwimmable(Vector3 const& p, bool start) const;
+        bool IsUnderWater(Vector3 const& p, bool start) const;
+
+        // map thread part of calculate(), false if there is nothing to build
+        bool PrepareCalculate(Vector3 const& start, Vector3 const& dest, bool forceDest, bool straightLine);
+        // may run on a pathfinding thread, uses only the captured owner state
+        void BuildPath(Vector3 const& start, Vector3 const& dest);
+        // owner is null if it left the map meanwhile
+        void DeliverAsync(Unit* owner);
 
         void clear()
         {
@@ -141,6 +212,7 @@ class PathFinder
         bool HaveTile(const Vector3& p) const;
 
         void BuildPolyPath(const Vector3& startPos, const Vector3& endPos);
+        bool MoveCorridorEnd(uint32 pathStartIndex, dtPolyRef endPoly, const float* endPoint);
         void BuildPointPath(const float* startPoint, const float* endPoint);
         void BuildShortcut();
 
@@ -151,6 +223,8 @@ class PathFinder
         // smooth path aux functions
         uint32 fixupCorridor(dtPolyRef* path, uint32 npath, uint32 maxPath,
                              const dtPolyRef* visited, uint32 nvisited);
+        uint32 mergeCorridorEndMoved(dtPolyRef* path, uint32 npath, uint32 maxPath,
+                                     const dtPolyRef* visited, uint32 nvisited);
         bool getSteerTarget(const float* startPos, const float* endPos, float minTargetDist,
                             const dtPolyRef* path, uint32 pathSize, float* steerPos,
                             unsigned char& steerPosFlag, dtPolyRef& steerPosRef) const;
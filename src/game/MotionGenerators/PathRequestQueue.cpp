@@ -0,0 +1,242 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "MotionGenerators/PathRequestQueue.h"
+#include "MotionGenerators/MoveMap.h"
+#include "Entities/Unit.h"
+#include "Maps/Map.h"
+#include "Log.h"
+
+#ifdef BUILD_METRICS
+ #include "Metric/Metric.h"
+#endif
+
+#include <algorithm>
+
+INSTANTIATE_SINGLETON_1(PathRequestQueue);
+
+PathRequestQueue::~PathRequestQueue()
+{
+    Stop();
+}
+
+void PathRequestQueue::Start(uint32 threadCount)
+{
+    if (!threadCount || IsEnabled())
+        return;
+
+    m_stopping = false;
+    for (uint32 i = 0; i < threadCount; ++i)
+    {
+        m_threads.push_back(std::make_unique<Worker>());
+        m_threads.back()->thread = std::thread(&PathRequestQueue::WorkerThread, this, m_threads.back().get());
+    }
+
+    m_enabled = true;
+    sLog.outString("Pathfinding: %u asynchronous path threads started", threadCount);
+}
+
+void PathRequestQueue::Stop()
+{
+    if (!IsEnabled())
+        return;
+
+    m_enabled = false;
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_stopping = true;
+        m_stats.cancelled += m_queue.size();
+        m_queue.clear();
+    }
+    m_queueCondition.notify_all();
+
+    for (auto& worker : m_threads)
+    {
+        worker->thread.join();
+        for (auto& query : worker->queries)
+            dtFreeNavMeshQuery(query.second);
+    }
+
+    m_threads.clear();
+}
+
+void PathRequestQueue::Enqueue(Unit const& owner, std::shared_ptr<PathFinder> path, Vector3 const& start, Vector3 const& dest, PathRequestPriority priority)
+{
+    Request request;
+    request.path = std::move(path);
+    request.map = owner.GetMap();
+    request.ownerGuid = owner.GetObjectGuid();
+    request.navMeshLock = MMAP::MMapFactory::createOrGetMMapManager()->GetNavMeshLock(owner.GetMapId(), owner.GetInstanceId());
+    request.start = start;
+    request.dest = dest;
+    request.priority = priority;
+    request.queueTime = Clock::now();
+
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        request.sequence = m_sequence++;
+        m_queue.push_back(std::move(request));
+        std::push_heap(m_queue.begin(), m_queue.end());
+
+        ++m_stats.requests;
+        m_stats.maxQueued = std::max(m_stats.maxQueued, uint32(m_queue.size()));
+    }
+    m_queueCondition.notify_one();
+}
+
+void PathRequestQueue::CancelRequests(Map const* map)
+{
+    if (!IsEnabled())
+        return;
+
+    dtNavMesh const* navMesh = MMAP::MMapFactory::createOrGetMMapManager()->GetNavMesh(map->GetId(), map->GetInstanceId());
+
+    std::unique_lock<std::mutex> lock(m_lock);
+    auto end = std::remove_if(m_queue.begin(), m_queue.end(), [map](Request const& request) { return request.map == map; });
+    m_stats.cancelled += std::distance(end, m_queue.end());
+    m_queue.erase(end, m_queue.end());
+    std::make_heap(m_queue.begin(), m_queue.end());
+
+    m_doneCondition.wait(lock, [this, map]()
+    {
+        return std::none_of(m_threads.begin(), m_threads.end(), [map](std::unique_ptr<Worker> const& worker) { return worker->currentMap == map; });
+    });
+
+    // the navmesh is freed with the map, a later one may get the same address
+    if (!navMesh)
+        return;
+
+    for (auto& worker : m_threads)
+    {
+        auto itr = worker->queries.find(navMesh);
+        if (itr != worker->queries.end())
+        {
+            dtFreeNavMeshQuery(itr->second);
+            worker->queries.erase(itr);
+        }
+    }
+}
+
+dtNavMeshQuery* PathRequestQueue::GetQuery(Worker& worker, dtNavMesh const* navMesh)
+{
+    auto itr = worker.queries.find(navMesh);
+    if (itr != worker.queries.end())
+        return itr->second;
+
+    dtNavMeshQuery* query = dtAllocNavMeshQuery();
+    MANGOS_ASSERT(query);
+    if (dtStatusFailed(query->init(navMesh, 1024)))
+    {
+        dtFreeNavMeshQuery(query);
+        sLog.outError("PathRequestQueue::GetQuery: Failed to initialize dtNavMeshQuery");
+        return nullptr;
+    }
+
+    worker.queries.emplace(navMesh, query);
+    return query;
+}
+
+void PathRequestQueue::WorkerThread(Worker* worker)
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    while (true)
+    {
+        m_queueCondition.wait(lock, [this]() { return m_stopping || !m_queue.empty(); });
+        if (m_stopping)
+            break;
+
+        std::pop_heap(m_queue.begin(), m_queue.end());
+        Request request = std::move(m_queue.back());
+        m_queue.pop_back();
+
+        worker->currentMap = request.map;
+        PathFinder& path = *request.path;
+        dtNavMeshQuery* query = GetQuery(*worker, path.m_navMesh);
+        lock.unlock();
+
+        Clock::time_point buildStart = Clock::now();
+
+        // without a query of our own the map thread builds it when the result is delivered
+        bool built = query && request.navMeshLock;
+        if (built)
+        {
+            std::shared_lock<std::shared_mutex> navMeshGuard(*request.navMeshLock);
+            dtNavMeshQuery const* mapQuery = path.m_navMeshQuery;
+            path.m_navMeshQuery = query;
+            path.m_deferNormalization = true;
+            path.BuildPath(request.start, request.dest);
+            path.m_deferNormalization = false;
+            path.m_navMeshQuery = mapQuery;
+        }
+
+        Clock::time_point buildEnd = Clock::now();
+
+        request.map->GetMessager().AddMessage([path = request.path, guid = request.ownerGuid, start = request.start, dest = request.dest, built](Map* map)
+        {
+            Unit* owner = map->GetUnit(guid);
+            if (owner && !built)
+                path->BuildPath(start, dest);
+            path->DeliverAsync(owner);
+        });
+        request.path.reset();
+
+        lock.lock();
+        ++m_stats.completed;
+        m_stats.waitTime += std::chrono::duration_cast<std::chrono::microseconds>(buildStart - request.queueTime).count();
+        m_stats.computeTime += std::chrono::duration_cast<std::chrono::microseconds>(buildEnd - buildStart).count();
+        worker->currentMap = nullptr;
+        m_doneCondition.notify_all();
+    }
+}
+
+void PathRequestQueue::ResetStats(PathRequestStats& stats)
+{
+    stats.requests = 0;
+    stats.completed = 0;
+    stats.cancelled = 0;
+    stats.waitTime = 0;
+    stats.computeTime = 0;
+    stats.maxQueued = 0;
+}
+
+PathRequestStats PathRequestQueue::ConsumeStats()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    PathRequestStats stats = m_stats;
+    ResetStats(m_stats);
+    m_stats.maxQueued = uint32(m_queue.size());
+    return stats;
+}
+
+#ifdef BUILD_METRICS
+void PathRequestQueue::ReportMetrics()
+{
+    if (!IsEnabled())
+        return;
+
+    PathRequestStats stats = ConsumeStats();
+
+    metric::measurement meas("pathfinder.queue");
+    meas.add_field("requests", static_cast<int64>(stats.requests));
+    meas.add_field("completed", static_cast<int64>(stats.completed));
+    meas.add_field("cancelled", static_cast<int64>(stats.cancelled));
+    meas.add_field("max_queued", static_cast<int64>(stats.maxQueued));
+    meas.add_field("wait_avg", static_cast<int64>(stats.completed ? stats.waitTime / stats.completed : 0));
+    meas.add_field("compute_avg", static_cast<int64>(stats.completed ? stats.computeTime / stats.completed : 0));
+}
+#endif
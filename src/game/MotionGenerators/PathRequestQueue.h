@@ -0,0 +1,131 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_PATH_REQUEST_QUEUE_H
+#define MANGOS_PATH_REQUEST_QUEUE_H
+
+#include "Common.h"
+#include "Policies/Singleton.h"
+#include "Entities/ObjectGuid.h"
+#include "MotionGenerators/PathFinder.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class Map;
+
+struct PathRequestStats
+{
+    uint64 requests;
+    uint64 completed;
+    uint64 cancelled;
+    uint64 waitTime;                                        // microseconds spent queued, summed over completed requests
+    uint64 computeTime;                                     // microseconds spent building, summed over completed requests
+    uint32 maxQueued;
+};
+
+/**
+ * Builds paths on its own threads.
+ * Every worker owns one dtNavMeshQuery per navmesh it has served, the navmesh itself is read under
+ * its shared lock so tiles may still be loaded by the map meanwhile. Results are handed back through
+ * the messager of the requesting map and applied there during its next update.
+ */
+class PathRequestQueue
+{
+    public:
+        PathRequestQueue() : m_enabled(false), m_stopping(false), m_sequence(0) { ResetStats(m_stats); }
+        ~PathRequestQueue();
+
+        void Start(uint32 threadCount);
+        void Stop();
+        bool IsEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+        // the path is kept alive by the request, the owner is looked up again by guid when the result arrives
+        void Enqueue(Unit const& owner, std::shared_ptr<PathFinder> path, Vector3 const& start, Vector3 const& dest, PathRequestPriority priority);
+        // drops the queued requests of the map and waits for the ones being built, the map is about to be deleted
+        void CancelRequests(Map const* map);
+
+        // returns statistics accumulated since the previous call
+        PathRequestStats ConsumeStats();
+
+#ifdef BUILD_METRICS
+        void ReportMetrics();
+#endif
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        struct Request
+        {
+            std::shared_ptr<PathFinder> path;
+            Map* map;
+            ObjectGuid ownerGuid;
+            std::shared_mutex* navMeshLock;
+            Vector3 start;
+            Vector3 dest;
+            PathRequestPriority priority;
+            uint64 sequence;
+            Clock::time_point queueTime;
+
+            // heap order, highest priority first and first come first served within one
+            bool operator<(Request const& other) const
+            {
+                if (priority != other.priority)
+                    return priority < other.priority;
+                return sequence > other.sequence;
+            }
+        };
+
+        typedef std::unordered_map<dtNavMesh const*, dtNavMeshQuery*> QueryPool;
+
+        struct Worker
+        {
+            Worker() : currentMap(nullptr) {}
+
+            std::thread thread;
+            QueryPool queries;                              // only touched under m_lock
+            Map const* currentMap;                          // map of the request being built
+        };
+
+        void WorkerThread(Worker* worker);
+        dtNavMeshQuery* GetQuery(Worker& worker, dtNavMesh const* navMesh);
+        static void ResetStats(PathRequestStats& stats);
+
+        std::vector<std::unique_ptr<Worker>> m_threads;
+        std::vector<Request> m_queue;                       // max heap
+        std::atomic<bool> m_enabled;
+        bool m_stopping;
+        uint64 m_sequence;
+
+        std::mutex m_lock;
+        std::condition_variable m_queueCondition;
+        std::condition_variable m_doneCondition;
+
+        PathRequestStats m_stats;                           // guarded by m_lock
+};
+
+#define sPathRequestQueue MaNGOS::Singleton<PathRequestQueue>::Instance()
+
+#endif
@@ -102,7 +102,7 @@ bool TargetedMovementGeneratorMedium<T, D>::Update(T& owner, const uint32& time_
 template<class T, typename D>
 bool TargetedMovementGeneratorMedium<T, D>::IsReachable() const
 {
-    return (i_path) ? (i_path->getPathType() & PATHFIND_NORMAL) : true;
+    return (i_path) ? (i_path->getDeliveredPathType() & PATHFIND_NORMAL) : true;
 }
 
 template<class T, typename D>
@@ -145,6 +145,8 @@ void ChaseMovementGenerator::Initialize(Unit& owner)
 
 void ChaseMovementGenerator::Finalize(Unit& owner)
 {
+    if (i_path)
+        i_path->CancelAsync();
     owner.clearUnitState(UNIT_STAT_CHASE | UNIT_STAT_CHASE_MOVE);
     if (m_currentMode == CHASE_MODE_DISTANCING) // cleanup in case fanning was removed
         owner.AI()->DistancingEnded();
@@ -152,6 +154,8 @@ void ChaseMovementGenerator::Finalize(Unit& owner)
 
 void ChaseMovementGenerator::Interrupt(Unit& owner)
 {
+    if (i_path)
+        i_path->CancelAsync();
     owner.InterruptMoving();
     owner.clearUnitState(UNIT_STAT_CHASE_MOVE);
     if (m_currentMode == CHASE_MODE_DISTANCING)
@@ -179,7 +183,10 @@ std::pair<std::string, std::string> ChaseMovementGenerator::GetPrintout() const
 {
     std::string output;
     std::string commandOutput;
-    auto& path = this->i_path->getPath();
+    if (!this->i_path)
+        return {output, commandOutput};
+
+    auto& path = this->i_path->getDeliveredPath();
     if (path.size() > 0)
     {
         output += "Start:" + std::to_string(path[0].x) + " " + std::to_string(path[0].y) + " " + std::to_string(path[0].z) + "\n";
@@ -248,6 +255,10 @@ void ChaseMovementGenerator::HandleTargetedMovement(Unit& owner, const uint32& t
 
         if ((this->i_speedChanged && !owner.movespline->Finalized()) || targetMoved)
         {
+            // keep following the current spline until the requested path arrives
+            if (this->i_path && this->i_path->IsAsyncPending())
+                return;
+
             float x, y, z;
 
             // i_path can be nullptr in case this is the first call for this MMGen (via Update)
@@ -267,7 +278,8 @@ void ChaseMovementGenerator::HandleTargetedMovement(Unit& owner, const uint32& t
 
             if (owner.GetDistance(x, y, z, DIST_CALC_NONE) > 0.3f)
             {
-                if (DispatchSplineToPosition(owner, x, y, z, EnableWalking(), true, true, true))
+                // a pending path launches from its callback, the chase counts as moving already
+                if (DispatchSplineToPosition(owner, x, y, z, EnableWalking(), true, true, true) != CHASE_SPLINE_FAILED)
                 {
                     this->i_targetReached = false;
                     this->i_speedChanged = false;
@@ -292,7 +304,7 @@ void ChaseMovementGenerator::HandleTargetedMovement(Unit& owner, const uint32& t
     {
         if (GenericTransport* transport = owner.GetTransport()) // dispatch spline position needs global coordinates
             transport->CalculatePassengerPosition(dest.x, dest.y, dest.z);
-        if (DispatchSplineToPosition(owner, dest.x, dest.y, dest.z, false, false, true))
+        if (DispatchSplineToPosition(owner, dest.x, dest.y, dest.z, false, false, true) == CHASE_SPLINE_LAUNCHED)
         {
             this->i_speedChanged = false;
             return;
@@ -379,7 +391,7 @@ void ChaseMovementGenerator::DistanceYourself(Unit& owner, float distance)
 {
     float x, y, z;
     i_target->GetNearPoint(&owner, x, y, z, owner.GetObjectBoundingRadius(), distance, i_target->GetAngle(&owner));
-    if (DispatchSplineToPosition(owner, x, y, z, false, false))
+    if (DispatchSplineToPosition(owner, x, y, z, false, false) == CHASE_SPLINE_LAUNCHED)
     {
         this->i_targetReached = false;
         m_currentMode = CHASE_MODE_DISTANCING;
@@ -411,7 +423,7 @@ void ChaseMovementGenerator::Backpedal(Unit& owner)
         return;
     }
 
-    if (DispatchSplineToPosition(owner, x, y, z, true, false))
+    if (DispatchSplineToPosition(owner, x, y, z, true, false) == CHASE_SPLINE_LAUNCHED)
     {
         this->i_targetReached = false;
         m_currentMode = CHASE_MODE_BACKPEDAL;
@@ -445,7 +457,7 @@ void ChaseMovementGenerator::FanOut(Unit& owner)
         float x, y, z;
         float targetDist = this->i_target->GetCombinedCombatReach(&owner, false);
         i_target->GetNearPoint(&owner, x, y, z, owner.GetObjectBoundingRadius(), targetDist, ori);
-        if (DispatchSplineToPosition(owner, x, y, z, true, false))
+        if (DispatchSplineToPosition(owner, x, y, z, true, false) == CHASE_SPLINE_LAUNCHED)
         {
             this->i_targetReached = false;
             m_currentMode = CHASE_MODE_FANNING;
@@ -457,7 +469,7 @@ void ChaseMovementGenerator::FanOut(Unit& owner)
         ori = MapManager::NormalizeOrientation(owner.GetOrientation() + M_PI_F + frand(fanAngleMin, fanAngleMax) * -direction);
         targetDist = this->i_target->GetCombinedCombatReach(&owner, false);
         i_target->GetNearPoint(&owner, x, y, z, owner.GetObjectBoundingRadius(), targetDist, ori);
-        if (DispatchSplineToPosition(owner, x, y, z, true, false))
+        if (DispatchSplineToPosition(owner, x, y, z, true, false) == CHASE_SPLINE_LAUNCHED)
         {
             this->i_targetReached = false;
             m_currentMode = CHASE_MODE_FANNING;
@@ -469,7 +481,7 @@ void ChaseMovementGenerator::FanOut(Unit& owner)
     }
 }
 
-bool ChaseMovementGenerator::DispatchSplineToPosition(Unit& owner, float x, float y, float z, bool walk, bool cutPath, bool target, bool checkReachable)
+ChaseSplineDispatch ChaseMovementGenerator::DispatchSplineToPosition(Unit& owner, float x, float y, float z, bool walk, bool cutPath, bool target, bool checkReachable)
 {
     if (owner.IsDebuggingMovement())
     {
@@ -490,8 +502,15 @@ bool ChaseMovementGenerator::DispatchSplineToPosition(Unit& owner, float x, floa
         }
     }
 
+    if (this->i_path && this->i_path->IsAsyncPending())
+    {
+        // superseded, the pathfinding thread keeps its own reference and the result is dropped
+        this->i_path->CancelAsync();
+        this->i_path = nullptr;
+    }
+
     if (!this->i_path)
-        this->i_path = new PathFinder(&owner);
+        this->i_path = std::make_shared<PathFinder>(&owner);
 
     bool gen = false;
     if (owner.IsWithinDist3d(x, y, z, 200.f) && std::abs(owner.GetPositionZ() - z) < 5.f && owner.IsWithinLOS(x, y, z + i_target->GetCollisionHeight()) && !owner.IsInWater() && !i_target->IsInWater())
@@ -532,11 +551,39 @@ bool ChaseMovementGenerator::DispatchSplineToPosition(Unit& owner, float x, floa
 
     if (!gen || (this->i_path->getPathType() & (PATHFIND_NOPATH | PATHFIND_INCOMPLETE)))
     {
+        // chasing the target is the bulk of the pathfinding, it is moved off the map thread when possible
+        if (target && cutPath)
+        {
+            PathRequestPriority priority = i_target->GetTypeId() == TYPEID_PLAYER ? PATH_PRIORITY_HIGH : PATH_PRIORITY_NORMAL;
+            auto onPath = [this, walk, cutPath, target, checkReachable](Unit& owner)
+            {
+                if (!this->i_target.isValid() || !this->i_target->IsInWorld() || _hasUnitStateNotMove(owner))
+                    return;
+
+                if (this->i_path->getPathType() & PATHFIND_NOPATH)
+                {
+                    if (!IsReachablePositionToTarget(owner, owner.GetPositionX(), owner.GetPositionY(), owner.GetPositionZ(), *this->i_target.getTarget()))
+                        m_reachable = false;
+                    return;
+                }
+
+                LaunchPath(owner, walk, cutPath, target, checkReachable);
+            };
+
+            if (this->i_path->calculateAsync(x, y, z, priority, onPath))
+                return CHASE_SPLINE_PENDING;
+        }
+
         this->i_path->calculate(x, y, z);
         if (this->i_path->getPathType() & PATHFIND_NOPATH)
-            return false;
+            return CHASE_SPLINE_FAILED;
     }
 
+    return LaunchPath(owner, walk, cutPath, target, checkReachable) ? CHASE_SPLINE_LAUNCHED : CHASE_SPLINE_FAILED;
+}
+
+bool ChaseMovementGenerator::LaunchPath(Unit& owner, bool walk, bool cutPath, bool target, bool checkReachable)
+{
     auto& path = this->i_path->getPath();
 
     if (cutPath)
@@ -657,7 +704,7 @@ void ChaseMovementGenerator::_setLocation(Unit& owner)
     Position pos = owner.GetPosition();
     if (RequiresNewPosition(owner, owner.GetPosition(owner.GetTransport())) && _getLocation(owner, pos.x, pos.y, pos.z))
     {
-        if (DispatchSplineToPosition(owner, pos.x, pos.y, pos.z, EnableWalking(), true, true))
+        if (DispatchSplineToPosition(owner, pos.x, pos.y, pos.z, EnableWalking(), true, true) != CHASE_SPLINE_FAILED)
             this->i_target->GetPosition(this->i_lastTargetPos.x, this->i_lastTargetPos.y, this->i_lastTargetPos.z, owner.GetTransport());
     }
     else
@@ -848,7 +895,7 @@ bool FollowMovementGenerator::Move(Unit& owner, float x, float y, float z)
         owner.UpdateSplinePosition(true);
 
     if (!i_path)
-        i_path = new PathFinder(&owner);
+        i_path = std::make_shared<PathFinder>(&owner);
 
     bool unstuck = false;
 
@@ -1146,7 +1193,7 @@ FormationMovementGenerator::FormationMovementGenerator(FormationSlotDataSPtr& sD
     m_slot(sData), m_lastAngle(0), m_headingToMaster(false)
 {
     if (!this->i_path)
-        this->i_path = new PathFinder(sData->GetOwner());
+        this->i_path = std::make_shared<PathFinder>(sData->GetOwner());
 
     m_tpDistance = std::max(sData->GetDistance() * 5.0f, 200.0f);
     m_moveToMasterDistance = std::min(sData->GetDistance() * 3.0f, 100.0f);
@@ -50,7 +50,7 @@ class TargetedMovementGeneratorMedium
             i_path(nullptr), i_faceTarget(true)
         {
         }
-        ~TargetedMovementGeneratorMedium() { delete i_path; }
+        ~TargetedMovementGeneratorMedium() { if (i_path) i_path->CancelAsync(); }
 
     public:
         bool Update(T&, const uint32&);
@@ -85,7 +85,7 @@ class TargetedMovementGeneratorMedium
         bool i_targetReached : 1;
         bool i_faceTarget : 1;
 
-        PathFinder* i_path;
+        std::shared_ptr<PathFinder> i_path;                 // shared with the pathfinding threads while a request is queued
 };
 
 /*
@@ -105,6 +105,13 @@ enum ChaseMovementMode
 
 extern const char* ChaseModes[];
 
+enum ChaseSplineDispatch
+{
+    CHASE_SPLINE_FAILED, // no spline, no path requested
+    CHASE_SPLINE_LAUNCHED, // spline is running
+    CHASE_SPLINE_PENDING, // path is calculated on the pathfinding thread, the spline launches when it arrives
+};
+
 class ChaseMovementGenerator : public TargetedMovementGeneratorMedium<Unit, ChaseMovementGenerator >
 {
     using TargetedMovementGeneratorMedium<Unit, ChaseMovementGenerator>::i_offset;
@@ -157,7 +164,10 @@ class ChaseMovementGenerator : public TargetedMovementGeneratorMedium<Unit, Chas
 
         bool IsReachablePositionToTarget(Unit& owner, float x, float y, float z, Unit& target);
 
-        bool DispatchSplineToPosition(Unit& owner, float x, float y, float z, bool walk, bool cutPath, bool target = false, bool checkReachable = false);
+        // only target with cutPath may end up pending
+        ChaseSplineDispatch DispatchSplineToPosition(Unit& owner, float x, float y, float z, bool walk, bool cutPath, bool target = false, bool checkReachable = false);
+        // launches the spline along the calculated i_path
+        bool LaunchPath(Unit& owner, bool walk, bool cutPath, bool target, bool checkReachable);
         void CutPath(Unit& owner, PointsArray& path);
         void Backpedal(Unit& owner);
 
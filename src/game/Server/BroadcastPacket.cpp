@@ -0,0 +1,36 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "Server/BroadcastPacket.h"
+#include "Server/WorldPacket.h"
+#include "Server/WorldSession.h"
+
+void BroadcastPacket::Send()
+{
+    if (m_receivers.empty())
+        return;
+
+    // a single receiver would copy the packet as well
+    if (!m_shared)
+        m_shared = std::make_shared<WorldPacket const>(m_packet);
+
+    for (WorldSession const* session : m_receivers)
+        session->SendPacket(m_shared);
+
+    m_receivers.clear();
+}
@@ -0,0 +1,62 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_BROADCASTPACKET_H
+#define MANGOS_BROADCASTPACKET_H
+
+#include "Common.h"
+
+#include <memory>
+#include <vector>
+
+class WorldPacket;
+class WorldSession;
+
+/**
+ * Sends one packet to many sessions.
+ * Receivers are collected first, then the packet is copied once into an immutable shared buffer
+ * which is queued on every receiving socket. Whatever was not sent yet is sent on destruction,
+ * so the referenced packet must outlive this object.
+ */
+class BroadcastPacket
+{
+    public:
+        explicit BroadcastPacket(WorldPacket const& packet) : m_packet(packet) {}
+        BroadcastPacket(BroadcastPacket const&) = delete;
+        BroadcastPacket& operator=(BroadcastPacket const&) = delete;
+        ~BroadcastPacket() { Send(); }
+
+        // receivers without a session are skipped
+        void AddReceiver(WorldSession const* session)
+        {
+            if (session)
+                m_receivers.push_back(session);
+        }
+
+        // queues the packet to all receivers added since the previous call
+        void Send();
+
+        WorldPacket const& GetPacket() const { return m_packet; }
+
+    private:
+        WorldPacket const& m_packet;
+        std::shared_ptr<WorldPacket const> m_shared;
+        std::vector<WorldSession const*> m_receivers;
+};
+
+#endif
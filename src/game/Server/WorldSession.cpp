@@ -41,6 +41,7 @@
 #include "GMTickets/GMTicketMgr.h"
 #include "Loot/LootMgr.h"
 #include "Anticheat/Anticheat.hpp"
+#include "World/TickProfiler.h"
 
 #include <boost/asio/ip/address_v4.hpp>
 
@@ -200,6 +201,24 @@ void WorldSession::SetExpansion(uint8 expansion)
 
 /// Send a packet to the client
 void WorldSession::SendPacket(WorldPacket const& packet) const
+{
+    if (PrepareSendPacket(packet))
+        m_Socket->SendPacket(packet);
+}
+
+void WorldSession::SendPacket(WorldPacket&& packet) const
+{
+    if (PrepareSendPacket(packet))
+        m_Socket->SendPacket(std::move(packet));
+}
+
+void WorldSession::SendPacket(std::shared_ptr<WorldPacket const> const& packet) const
+{
+    if (PrepareSendPacket(*packet))
+        m_Socket->SendPacket(packet);
+}
+
+bool WorldSession::PrepareSendPacket(WorldPacket const& packet) const
 {
 #ifdef BUILD_PLAYERBOT
     // Send packet to bot AI
@@ -213,7 +232,7 @@ void WorldSession::SendPacket(WorldPacket const& packet) const
 #endif
 
     if (!m_Socket || m_Socket->IsClosed())
-        return;
+        return false;
 
 #ifdef MANGOS_DEBUG
 
@@ -251,7 +270,7 @@ void WorldSession::SendPacket(WorldPacket const& packet) const
 
 #endif                                                  // !MANGOS_DEBUG
 
-    m_Socket->SendPacket(packet);
+    return true;
 }
 
 /// Add an incoming packet to the queue
@@ -1146,6 +1165,7 @@ void WorldSession::ExecuteOpcode(OpcodeHandler const& opHandle, WorldPacket& pac
 
     try
     {
+        TickOpcodeTimer opcodeTimer(packet.GetOpcode());
         (this->*opHandle.handler)(packet);
     }
     catch (const ByteBufferException&)
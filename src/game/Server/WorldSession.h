@@ -267,6 +267,10 @@ class WorldSession
         void SizeError(WorldPacket const& packet, uint32 size) const;
 
         void SendPacket(WorldPacket const& packet) const;
+        // takes over the buffer of a packet which is not used after the send
+        void SendPacket(WorldPacket&& packet) const;
+        // packet may be queued on several sessions at once without being copied
+        void SendPacket(std::shared_ptr<WorldPacket const> const& packet) const;
         void SendExpectedSpamRecords();
         void SendMotd();
         void SendOfflineNameQueryResponses();
@@ -1024,6 +1028,9 @@ class WorldSession
 
         void ExecuteOpcode(OpcodeHandler const& opHandle, WorldPacket& packet);
 
+        // bot hooks and statistics, returns false when there is no socket to send to
+        bool PrepareSendPacket(WorldPacket const& packet) const;
+
         // logging helper
         void LogUnexpectedOpcode(WorldPacket const& packet, const char* reason) const;
         void LogUnprocessedTail(WorldPacket& packet) const;
@@ -29,12 +29,14 @@
 #include "Database/DatabaseEnv.h"
 #include "Auth/CryptoHash.h"
 #include "Server/WorldSession.h"
+#include "Entities/UpdateData.h"
 #include "Log.h"
 #include "Server/DBCStores.h"
 #include "Util/CommonDefines.h"
 #include "Anticheat/Anticheat.hpp"
 
 #include <chrono>
+#include <cstring>
 #include <functional>
 #include <memory>
 #include "World/WorldState.h"
@@ -113,7 +115,8 @@ std::deque<uint32> WorldSocket::GetIncOpcodeHistory()
 }
 
 WorldSocket::WorldSocket(boost::asio::io_service& service, std::function<void (Socket*)> closeHandler) : Socket(service, std::move(closeHandler)), m_lastPingTime(std::chrono::system_clock::time_point::min()), m_overSpeedPings(0), m_existingHeader(),
-    m_useExistingHeader(false), m_session(nullptr), m_seed(urand()), m_loggingPackets(false)
+    m_useExistingHeader(false), m_session(nullptr), m_seed(urand()), m_service(service), m_outState(OUT_STATE_IDLE), m_outFlushNow(false), m_outFlushTimer(service),
+    m_outHeaders(MaxPacketsPerWrite), m_loggingPackets(false)
 {
 }
 
@@ -122,29 +125,143 @@ void WorldSocket::SendPacket(const WorldPacket& pct, bool immediate)
     if (IsClosed())
         return;
 
-    if (sPacketLog->CanLogPacket() && IsLoggingPackets())
-        sPacketLog->LogPacket(pct, SERVER_TO_CLIENT, GetRemoteIpAddress(), GetRemotePort());
+    SendPacket(std::make_shared<WorldPacket const>(pct), immediate);
+}
 
-    // Dump outgoing packet.
-    sLog.outWorldPacketDump(GetRemoteEndpoint().c_str(), pct.GetOpcode(), pct.GetOpcodeName(), pct, false);
+void WorldSocket::SendPacket(WorldPacket&& pct, bool immediate)
+{
+    if (IsClosed())
+        return;
 
-    // encrypt thread unsafe due to being executed from map contexts frequently - TODO: move to post service context in future
-    std::lock_guard<std::mutex> guard(m_worldSocketMutex);
+    SendPacket(std::make_shared<WorldPacket const>(std::move(pct)), immediate);
+}
 
-    ServerPktHeader header(pct.size() + 2, pct.GetOpcode());
-    m_crypt.EncryptSend((uint8*)header.header, header.getHeaderLength());
+void WorldSocket::SendPacket(std::shared_ptr<WorldPacket const> const& pct, bool immediate)
+{
+    if (IsClosed())
+        return;
 
-    if (!pct.empty())
-        Write(reinterpret_cast<const char*>(&header.header), header.getHeaderLength(), reinterpret_cast<const char*>(pct.contents()), pct.size());
-    else
-        Write(reinterpret_cast<const char*>(&header.header), header.getHeaderLength());
+    m_outQueue.Push(pct);
 
     if (immediate)
-        ForceFlushOut();
+        m_outFlushNow = true;
+
+    // header encryption and the timer belong to the network thread, hand over to it once per flush
+    uint8 state = OUT_STATE_IDLE;
+    if (m_outState.compare_exchange_strong(state, OUT_STATE_BUFFERING))
+    {
+        std::shared_ptr<WorldSocket> ptr = shared<WorldSocket>();
+        m_service.post([ptr] { ptr->StartOutFlushTimer(); });
+    }
+    else if (immediate && state == OUT_STATE_BUFFERING)
+    {
+        // cancelling the timer triggers the flush
+        std::shared_ptr<WorldSocket> ptr = shared<WorldSocket>();
+        m_service.post([ptr] { ptr->m_outFlushTimer.cancel(); });
+    }
+}
+
+void WorldSocket::StartOutFlushTimer()
+{
+    if (m_outFlushNow.exchange(false))
+    {
+        FlushOutQueue();
+        return;
+    }
+
+    std::shared_ptr<WorldSocket> ptr = shared<WorldSocket>();
+    m_outFlushTimer.expires_from_now(boost::posix_time::milliseconds(int(OutBufferTimeout)));
+    m_outFlushTimer.async_wait([ptr](const boost::system::error_code&) { ptr->FlushOutQueue(); });
+}
+
+void WorldSocket::FlushOutQueue()
+{
+    // a cancel posted by a late immediate send may fire after the flush already happened
+    if (m_outState != OUT_STATE_BUFFERING)
+        return;
+
+    m_outFlushNow = false;
+    m_outState = OUT_STATE_SENDING;
+    WriteOutQueue();
+}
+
+void WorldSocket::WriteOutQueue()
+{
+    if (IsClosed())
+    {
+        m_outState = OUT_STATE_IDLE;
+        return;
+    }
+
+    while (true)
+    {
+        OutgoingPacket packet;
+        while (m_outPackets.size() < MaxPacketsPerWrite && m_outQueue.Pop(packet))
+        {
+            // keeps deflate off the map threads, header size depends on the compressed size
+            if (UpdateData::NeedsCompression(*packet))
+                packet = UpdateData::CompressPacket(packet);
+
+            // logged as written, update packets after their compression
+            if (sPacketLog->CanLogPacket() && IsLoggingPackets())
+                sPacketLog->LogPacket(*packet, SERVER_TO_CLIENT, GetRemoteIpAddress(), GetRemotePort());
+
+            // Dump outgoing packet.
+            sLog.outWorldPacketDump(GetRemoteEndpoint().c_str(), packet->GetOpcode(), packet->GetOpcodeName(), *packet, false);
+
+            ServerPktHeader header(packet->size() + 2, packet->GetOpcode());
+            m_crypt.EncryptSend(header.header, header.getHeaderLength());
+
+            // m_outHeaders is sized once, the buffers keep pointing into it
+            std::array<uint8, 5>& headerBuffer = m_outHeaders[m_outPackets.size()];
+            memcpy(headerBuffer.data(), header.header, header.getHeaderLength());
+
+            m_outBuffers.push_back(boost::asio::buffer(headerBuffer.data(), header.getHeaderLength()));
+            if (!packet->empty())
+                m_outBuffers.push_back(boost::asio::buffer(packet->contents(), packet->size()));
+
+            m_outPackets.push_back(std::move(packet));
+        }
+
+        if (!m_outPackets.empty())
+            break;
+
+        m_outState = OUT_STATE_IDLE;
+
+        // a producer which saw OUT_STATE_SENDING relies on us to pick up its packet
+        uint8 state = OUT_STATE_IDLE;
+        if (m_outQueue.Empty() || !m_outState.compare_exchange_strong(state, OUT_STATE_SENDING))
+            return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(m_worldSocketMutex);
+        for (OutgoingPacket const& packet : m_outPackets)
+            m_opcodeHistoryOut.push_front(uint32(packet->GetOpcode()));
+        if (m_opcodeHistoryOut.size() > 50)
+            m_opcodeHistoryOut.resize(30);
+    }
+
+    std::shared_ptr<WorldSocket> ptr = shared<WorldSocket>();
+    boost::asio::async_write(GetAsioSocket(), m_outBuffers,
+        [ptr](const boost::system::error_code& error, size_t /*length*/) { ptr->OnOutWriteComplete(error); });
+}
+
+void WorldSocket::OnOutWriteComplete(const boost::system::error_code& error)
+{
+    // releases our references, broadcast packets are freed once the last socket wrote them
+    m_outPackets.clear();
+    m_outBuffers.clear();
+
+    if (error)
+    {
+        m_outState = OUT_STATE_IDLE;
+        OnError(error);
+        return;
+    }
 
-    m_opcodeHistoryOut.push_front(uint32(pct.GetOpcode()));
-    if (m_opcodeHistoryOut.size() > 50)
-        m_opcodeHistoryOut.resize(30);
+    // everything queued meanwhile is written right away
+    WriteOutQueue();
 }
 
 bool WorldSocket::Open()
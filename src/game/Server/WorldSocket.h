@@ -29,10 +29,15 @@
 #include "AuthCrypt.h"
 #include "Auth/BigNumber.h"
 #include "Network/Socket.hpp"
+#include "Multithreading/MPSCQueue.h"
 
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <functional>
 #include <deque>
+#include <memory>
+#include <vector>
 
 class WorldPacket;
 class WorldSession;
@@ -45,22 +50,17 @@ class WorldSession;
  * Most methods return -1 on failure.
  * The class uses reference counting.
  *
- * For output the class uses one buffer (64K usually) and
- * a queue where it stores packet if there is no place on
- * the queue. The reason this is done, is because the server
- * does really a lot of small-size writes to it, and it doesn't
- * scale well to allocate memory for every. When something is
- * written to the output buffer the socket is not immediately
- * activated for output (again for the same reason), there
- * is 10ms celling (thats why there is Update() override method).
+ * For output producer threads push reference counted packets
+ * into a lock free queue, the same packet may be queued on any
+ * number of sockets without being copied. The network thread
+ * encrypts the headers and writes headers and packet contents
+ * with one gather write. Output is not started immediately,
+ * packets are collected for up to OutBufferTimeout ms first.
  * This concept is similar to TCP_CORK, but TCP_CORK
  * uses 200ms celling. As result overhead generated by
  * sending packets from "producer" threads is minimal,
  * and doing a lot of writes with small size is tolerated.
  *
- * The calls to Update () method are managed by WorldSocketMgr
- * and ReactorRunnable.
- *
  * For input ,the class uses one 1024 bytes buffer on stack
  * to which it does recv() calls. And then received data is
  * distributed where its needed. 1024 matches pretty well the
@@ -123,6 +123,35 @@ class WorldSocket : public MaNGOS::Socket
 
         std::mutex m_worldSocketMutex;
 
+        /// Outgoing packets, written by any thread and consumed by the network thread
+        typedef std::shared_ptr<WorldPacket const> OutgoingPacket;
+
+        enum OutState
+        {
+            OUT_STATE_IDLE,                                 // nothing queued
+            OUT_STATE_BUFFERING,                            // packets queued, flush timer armed or about to be
+            OUT_STATE_SENDING                               // a write is underway
+        };
+
+        static const int OutBufferTimeout = 50;             // ms
+        static const size_t MaxPacketsPerWrite = 256;
+
+        boost::asio::io_service& m_service;
+        MPSCQueue<OutgoingPacket> m_outQueue;
+        std::atomic<uint8> m_outState;
+        std::atomic<bool> m_outFlushNow;
+        boost::asio::deadline_timer m_outFlushTimer;
+
+        // network thread only, packets of the write in progress and their encrypted headers
+        std::vector<OutgoingPacket> m_outPackets;
+        std::vector<std::array<uint8, 5>> m_outHeaders;
+        std::vector<boost::asio::const_buffer> m_outBuffers;
+
+        void StartOutFlushTimer();
+        void FlushOutQueue();
+        void WriteOutQueue();
+        void OnOutWriteComplete(const boost::system::error_code& error);
+
         std::deque<uint32> m_opcodeHistoryOut;
         std::deque<uint32> m_opcodeHistoryInc;
 
@@ -133,6 +162,10 @@ class WorldSocket : public MaNGOS::Socket
 
         // send a packet \o/
         void SendPacket(const WorldPacket& pct, bool immediate = false);
+        // same without the copy, for packets the caller drops after the send
+        void SendPacket(WorldPacket&& pct, bool immediate = false);
+        // send a packet which may be shared by other sockets, it must not be changed anymore
+        void SendPacket(std::shared_ptr<WorldPacket const> const& pct, bool immediate = false);
 
         void FinalizeSession() { m_session = nullptr; }
 
@@ -0,0 +1,90 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "Spells/AuraList.h"
+
+#include <algorithm>
+
+AuraSlotList::AuraSlotList(AuraSlotList const& other) : m_slots(nullptr), m_size(0), m_capacity(0), m_holes(0)
+{
+    *this = other;
+}
+
+AuraSlotList& AuraSlotList::operator=(AuraSlotList const& other)
+{
+    if (this == &other)
+        return *this;
+
+    clear();
+    for (Aura* aura : other)
+        push_back(aura);
+    return *this;
+}
+
+Aura* AuraSlotList::back() const
+{
+    for (uint32 i = m_size; i > 0; --i)
+        if (m_slots[i - 1])
+            return m_slots[i - 1];
+    return nullptr;
+}
+
+void AuraSlotList::push_back(Aura* aura)
+{
+    if (m_size == m_capacity)
+    {
+        // most lists hold one or two auras for their whole life
+        uint16 capacity = m_capacity ? m_capacity * 2 : 2;
+        Aura** slots = new Aura*[capacity];
+        std::copy(m_slots, m_slots + m_size, slots);
+        delete[] m_slots;
+        m_slots = slots;
+        m_capacity = capacity;
+    }
+
+    m_slots[m_size++] = aura;
+}
+
+bool AuraSlotList::remove(Aura* aura)
+{
+    bool found = false;
+    for (uint32 i = 0; i < m_size; ++i)
+    {
+        if (m_slots[i] == aura)
+        {
+            m_slots[i] = nullptr;
+            ++m_holes;
+            found = true;
+        }
+    }
+
+    // iterators behind the end compare equal to it, so an empty list can start over right away
+    if (m_holes == m_size)
+        clear();
+
+    return found;
+}
+
+void AuraSlotList::Compact()
+{
+    if (!m_holes)
+        return;
+
+    m_size = uint16(std::remove(m_slots, m_slots + m_size, nullptr) - m_slots);
+    m_holes = 0;
+}
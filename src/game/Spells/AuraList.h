@@ -0,0 +1,108 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_AURA_LIST_H
+#define MANGOS_AURA_LIST_H
+
+#include "Common.h"
+
+#include <iterator>
+
+class Aura;
+
+/**
+ * Auras in the order they were added, kept in one array instead of list nodes.
+ * Iterators hold the list and a position, they stay valid while auras are added or removed like list
+ * iterators did: a removed aura leaves an empty slot behind which iteration skips. The slots are
+ * closed by Compact, which the owner calls when nothing iterates the list, or right away once the
+ * list runs empty.
+ */
+class AuraSlotList
+{
+    public:
+        class const_iterator
+        {
+            public:
+                typedef std::forward_iterator_tag iterator_category;
+                typedef Aura* value_type;
+                typedef std::ptrdiff_t difference_type;
+                typedef Aura* const* pointer;
+                typedef Aura* const& reference;
+
+                const_iterator() : m_list(nullptr), m_index(0), m_aura(nullptr) {}
+                const_iterator(AuraSlotList const* list, uint32 index) : m_list(list), m_index(index), m_aura(nullptr) { SkipEmpty(); }
+
+                // a copy of the slot, references to it survive the array growing
+                Aura* const& operator*() const { return m_aura; }
+                const_iterator& operator++() { ++m_index; SkipEmpty(); return *this; }
+                const_iterator operator++(int) { const_iterator itr = *this; ++*this; return itr; }
+
+                // positions behind the last slot all are the end, the list may have shrunk meanwhile
+                bool operator==(const_iterator const& other) const { return Position() == other.Position(); }
+                bool operator!=(const_iterator const& other) const { return !(*this == other); }
+
+            private:
+                friend class AuraSlotList;
+
+                uint32 Position() const { return m_index < m_list->m_size ? m_index : m_list->m_size; }
+
+                void SkipEmpty()
+                {
+                    m_aura = nullptr;
+                    for (; m_index < m_list->m_size; ++m_index)
+                        if ((m_aura = m_list->m_slots[m_index]))
+                            break;
+                }
+
+                AuraSlotList const* m_list;
+                uint32 m_index;
+                Aura* m_aura;
+        };
+        typedef const_iterator iterator;
+
+        AuraSlotList() : m_slots(nullptr), m_size(0), m_capacity(0), m_holes(0) {}
+        AuraSlotList(AuraSlotList const& other);
+        AuraSlotList& operator=(AuraSlotList const& other);
+        ~AuraSlotList() { delete[] m_slots; }
+
+        const_iterator begin() const { return const_iterator(this, 0); }
+        const_iterator end() const { return const_iterator(this, m_size); }
+
+        bool empty() const { return m_size == m_holes; }
+        uint32 size() const { return m_size - m_holes; }
+        Aura* front() const { return *begin(); }
+        Aura* back() const;
+
+        void push_back(Aura* aura);
+        // returns false if the aura is not in the list
+        bool remove(Aura* aura);
+        void erase(const_iterator itr) { remove(*itr); }
+        void clear() { m_size = 0; m_holes = 0; }
+
+        bool HasHoles() const { return m_holes != 0; }
+        // closes empty slots, iterators of the list must not be in use
+        void Compact();
+
+    private:
+        Aura** m_slots;
+        uint16 m_size;                                      // used slots including empty ones
+        uint16 m_capacity;
+        uint16 m_holes;
+};
+
+#endif
@@ -442,6 +442,7 @@ Spell::Spell(WorldObject* caster, SpellEntry const* info, uint32 triggeredFlags,
     else
         m_spellInfo = info;
 
+    m_runtimeInfo = &sSpellMgr.GetSpellRuntimeInfo(m_spellInfo);
     m_triggeredBySpellInfo = triggeredBy;
     m_caster = dynamic_cast<Unit*>(caster);
     m_referencedFromCurrentSpell = false;
@@ -494,7 +495,7 @@ Spell::Spell(WorldObject* caster, SpellEntry const* info, uint32 triggeredFlags,
     m_spellAuraHolder = nullptr;
 
     // Auto Shot & Shoot (wand)
-    m_autoRepeat = IsAutoRepeatRangedSpell(m_spellInfo);
+    m_autoRepeat = m_runtimeInfo->HasFlag(SPELL_RUNTIME_AUTO_REPEAT);
 
     m_runesState = 0;
     m_runesStateAfterCast = 0;
@@ -522,7 +523,7 @@ Spell::Spell(WorldObject* caster, SpellEntry const* info, uint32 triggeredFlags,
     m_ignoreCooldowns = m_IsTriggeredSpell || ((triggeredFlags & TRIGGERED_IGNORE_COOLDOWNS) != 0);
     m_ignoreConcurrentCasts = m_IsTriggeredSpell || ((triggeredFlags & TRIGGERED_IGNORE_CURRENT_CASTED_SPELL) != 0) || m_spellInfo->HasAttribute(SPELL_ATTR_EX4_ALLOW_CAST_WHILE_CASTING);
     m_ignoreCasterAuraState = m_IsTriggeredSpell || ((triggeredFlags & TRIGGERED_IGNORE_CASTER_AURA_STATE) != 0 || m_spellInfo->HasAttribute(SPELL_ATTR_EX5_IGNORE_CASTER_REQUIREMENTS));
-    m_hideInCombatLog = (m_IsTriggeredSpell && !IsAutoRepeatRangedSpell(m_spellInfo)) || ((triggeredFlags & TRIGGERED_HIDE_CAST_IN_COMBAT_LOG) != 0);
+    m_hideInCombatLog = (m_IsTriggeredSpell && !m_runtimeInfo->HasFlag(SPELL_RUNTIME_AUTO_REPEAT)) || ((triggeredFlags & TRIGGERED_HIDE_CAST_IN_COMBAT_LOG) != 0);
     m_resetLeash = (triggeredFlags & TRIGGERED_DO_NOT_RESET_LEASH) == 0;
     m_channelOnly = (triggeredFlags & TRIGGERED_CHANNEL_ONLY) != 0;
 
@@ -818,6 +819,9 @@ bool Spell::FillUnitTargets(TempTargetingData& targetingData, SpellTargetingData
         SpellTargetImplicitType type = SpellTargetInfoTable[target].type;
         if (!unitTargetList.empty()) // Unit case
         {
+            if (!targetingData.magnet)
+                PrefetchTargetLineOfSight(unitTargetList, SpellEffectIndex(i), bool(rightTarget));
+
             for (auto itr = unitTargetList.begin(); itr != unitTargetList.end();)
             {
                 if (!CheckTarget(*itr, SpellEffectIndex(i), bool(rightTarget), CheckException(targetingData.magnet)))
@@ -825,6 +829,7 @@ bool Spell::FillUnitTargets(TempTargetingData& targetingData, SpellTargetingData
                 else
                     ++itr;
             }
+            m_prefetchedLineOfSight.clear();
 
             // Special target filter before adding targets to list
             FilterTargetMap(unitTargetList, scheme, targetingData.chainTargetCount[i]);
@@ -952,7 +957,7 @@ void Spell::PrepareMasksForProcSystem(uint8 effectMask, uint32& procAttacker, ui
     if (m_spellInfo->SpellFamilyName == SPELLFAMILY_HUNTER && m_spellInfo->IsFitToFamilyMask(uint64(0x000020000000001C), uint32(0x00040000)))
         procAttacker |= PROC_FLAG_ON_TRAP_ACTIVATION;
 
-    if (IsNextMeleeSwingSpell(m_spellInfo))
+    if (m_runtimeInfo->HasFlag(SPELL_RUNTIME_NEXT_MELEE_SWING))
     {
         procAttacker |= PROC_FLAG_DEAL_MELEE_SWING;
         procVictim |= PROC_FLAG_TAKE_MELEE_SWING;
@@ -1475,7 +1480,7 @@ void Spell::DoAllEffectOnTarget(TargetInfo* target)
     if (unit->IsCreature())
         // cast at creature (or GO) quest objectives update at successful cast finished (+channel finished)
         // ignore pets or autorepeat/melee casts for speed (not exist quest for spells (hm... )
-        if (affectiveCaster && !static_cast<Creature*>(unit)->IsPet() && !IsAutoRepeat() && !IsNextMeleeSwingSpell(m_spellInfo) && !IsChannelActive())
+        if (affectiveCaster && !static_cast<Creature*>(unit)->IsPet() && !IsAutoRepeat() && !m_runtimeInfo->HasFlag(SPELL_RUNTIME_NEXT_MELEE_SWING) && !IsChannelActive())
             if (Player* p = affectiveCaster->GetBeneficiaryPlayer())
                 p->RewardPlayerAndGroupAtCast(unit, m_spellInfo->Id);
 
@@ -1723,7 +1728,7 @@ void Spell::DoAllEffectOnTarget(GOTargetInfo* target)
 
     // cast at creature (or GO) quest objectives update at successful cast finished (+channel finished)
     // ignore autorepeat/melee casts for speed (not exist quest for spells (hm... )
-    if (!IsAutoRepeat() && !IsNextMeleeSwingSpell(m_spellInfo) && !IsChannelActive() && m_caster)
+    if (!IsAutoRepeat() && !m_runtimeInfo->HasFlag(SPELL_RUNTIME_NEXT_MELEE_SWING) && !IsChannelActive() && m_caster)
     {
         if (Player* p = m_caster->GetBeneficiaryPlayer())
             p->RewardPlayerAndGroupAtCast(go, m_spellInfo->Id);
@@ -2620,7 +2625,7 @@ void Spell::SetTargetMap(SpellEffectIndex effIndex, uint32 targetMode, bool targ
         }
         case TARGET_ENUM_UNITS_RAID_WITHIN_CASTER_RANGE:
         {
-            FillRaidOrPartyTargets(tempUnitList, m_caster, m_caster, radius, true, true, IsPositiveSpell(m_spellInfo->Id));
+            FillRaidOrPartyTargets(tempUnitList, m_caster, m_caster, radius, true, true, m_runtimeInfo->HasFlag(SPELL_RUNTIME_POSITIVE));
             break;
         }
         case TARGET_UNIT_FRIEND:
@@ -3400,7 +3405,7 @@ void Spell::Prepare()
         if (!m_trueCaster->IsGameObject())
         {
             // add to cast type slot
-            if ((!m_ignoreConcurrentCasts || IsChanneledSpell(m_spellInfo)) && !m_triggerAutorepeat)
+            if ((!m_ignoreConcurrentCasts || m_runtimeInfo->HasFlag(SPELL_RUNTIME_CHANNELED)) && !m_triggerAutorepeat)
                 m_caster->SetCurrentCastedSpell(this);
 
             // add gcd server side (client side is handled by client itself)
@@ -3411,14 +3416,14 @@ void Spell::Prepare()
         SendSpellStart();
 
         // Execute instant spells immediate
-        if (m_timer == 0 && !IsNextMeleeSwingSpell(m_spellInfo) && (!IsAutoRepeat() || m_triggerAutorepeat))
+        if (m_timer == 0 && !m_runtimeInfo->HasFlag(SPELL_RUNTIME_NEXT_MELEE_SWING) && (!IsAutoRepeat() || m_triggerAutorepeat))
             cast();
     }
     // execute triggered without cast time explicitly in call point
     else
     {
         // Channeled spell is always one per caster and needs to be tracked and removed on death
-        if (IsChanneledSpell(m_spellInfo)) // GO casters cant cast channeled spells
+        if (m_runtimeInfo->HasFlag(SPELL_RUNTIME_CHANNELED)) // GO casters cant cast channeled spells
             m_caster->SetCurrentCastedSpell(this);
 
         if (m_timer == 0)
@@ -3435,7 +3440,7 @@ void Spell::cancel()
         return;
 
     // channeled spells don't display interrupted message even if they are interrupted, possible other cases with no "Interrupted" message
-    bool sendInterrupt = !(IsChanneledSpell(m_spellInfo) || m_autoRepeat);
+    bool sendInterrupt = !(m_runtimeInfo->HasFlag(SPELL_RUNTIME_CHANNELED) || m_autoRepeat);
 
     if (Player* player = m_caster->GetSpellModOwner()) // reset casting time mods
         if (player->GetSpellModSpell() != this && !m_usedAuraCharges.empty())
@@ -3966,7 +3971,7 @@ void Spell::_handle_immediate_phase()
     ProcSpellAuraTriggers();
 
     // start channeling if applicable (after _handle_immediate_phase for get persistent effect dynamic object for channel target
-    if (IsChanneledSpell(m_spellInfo) && m_duration)
+    if (m_runtimeInfo->HasFlag(SPELL_RUNTIME_CHANNELED) && m_duration)
     {
         m_spellState = SPELL_STATE_CHANNELING;
         SendChannelStart(m_duration);
@@ -4096,7 +4101,7 @@ void Spell::update(uint32 difftime)
                 cancel();
         }            
         // don't cancel for melee, autorepeat, triggered and instant spells
-        else if (!IsNextMeleeSwingSpell(m_spellInfo) && !IsAutoRepeat() && !m_IsTriggeredSpell && (m_spellInfo->InterruptFlags & SPELL_INTERRUPT_FLAG_MOVEMENT))
+        else if (!m_runtimeInfo->HasFlag(SPELL_RUNTIME_NEXT_MELEE_SWING) && !IsAutoRepeat() && !m_IsTriggeredSpell && (m_spellInfo->InterruptFlags & SPELL_INTERRUPT_FLAG_MOVEMENT))
             cancel();
     }
 
@@ -4112,7 +4117,7 @@ void Spell::update(uint32 difftime)
                     m_timer -= difftime;
             }
 
-            if (m_timer == 0 && !IsNextMeleeSwingSpell(m_spellInfo) && !IsAutoRepeat())
+            if (m_timer == 0 && !m_runtimeInfo->HasFlag(SPELL_RUNTIME_NEXT_MELEE_SWING) && !IsAutoRepeat())
                 cast();
         } break;
         case SPELL_STATE_CHANNELING:
@@ -4213,7 +4218,7 @@ void Spell::update(uint32 difftime)
                 // channeled spell processed independently for quest targeting
                 // cast at creature (or GO) quest objectives update at successful cast channel finished
                 // ignore autorepeat/melee casts for speed (not exist quest for spells (hm... )
-                if (!IsAutoRepeat() && !IsNextMeleeSwingSpell(m_spellInfo))
+                if (!IsAutoRepeat() && !m_runtimeInfo->HasFlag(SPELL_RUNTIME_NEXT_MELEE_SWING))
                 {
                     if (Player* p = m_caster->GetBeneficiaryPlayer())
                     {
@@ -4322,11 +4327,11 @@ void Spell::finish(bool ok)
     OnSuccessfulFinish();
 
     // Clear combo at finish state
-    if (m_trueCaster->IsPlayer() && NeedsComboPoints(m_spellInfo))
+    if (m_trueCaster->IsPlayer() && m_runtimeInfo->HasFlag(SPELL_RUNTIME_COMBO_POINTS))
     {
         // Not drop combopoints if negative spell and if any miss on enemy exist
         bool needDrop = true;
-        if (!IsPositiveSpell(m_spellInfo->Id))
+        if (!m_runtimeInfo->HasFlag(SPELL_RUNTIME_POSITIVE))
         {
             for (TargetList::const_iterator ihit = m_UniqueTargetInfo.begin(); ihit != m_UniqueTargetInfo.end(); ++ihit)
             {
@@ -4805,7 +4810,7 @@ void Spell::WriteSpellGoTargets(WorldPacket& data)
         if (ihit.effectHitMask == 0 && ihit.effectMask != 0) // No effect apply - all immuned add state
         {
             // possibly SPELL_MISS_IMMUNE2 for this??
-            if (IsChanneledSpell(m_spellInfo) && ihit.targetGUID == m_targets.getUnitTargetGuid()) // can happen due to DR
+            if (m_runtimeInfo->HasFlag(SPELL_RUNTIME_CHANNELED) && ihit.targetGUID == m_targets.getUnitTargetGuid()) // can happen due to DR
             {
                 m_duration = 0;                              // cancel aura to avoid visual effect continue
                 ihit.effectDuration = 0;
@@ -4824,7 +4829,7 @@ void Spell::WriteSpellGoTargets(WorldPacket& data)
         }
         else
         {
-            if (IsChanneledSpell(m_spellInfo) && (ihit.missCondition == SPELL_MISS_RESIST || ihit.missCondition == SPELL_MISS_REFLECT))
+            if (m_runtimeInfo->HasFlag(SPELL_RUNTIME_CHANNELED) && (ihit.missCondition == SPELL_MISS_RESIST || ihit.missCondition == SPELL_MISS_REFLECT))
             {
                 m_duration = 0;                              // cancel aura to avoid visual effect continue
                 ihit.effectDuration = 0;
@@ -4858,7 +4863,7 @@ void Spell::WriteSpellGoTargets(WorldPacket& data)
         }
     }
     // Reset m_needAliveTargetMask for non channeled spell
-    if (!IsChanneledSpell(m_spellInfo))
+    if (!m_runtimeInfo->HasFlag(SPELL_RUNTIME_CHANNELED))
         m_needAliveTargetMask = 0;
 }
 
@@ -5622,7 +5627,7 @@ SpellCastResult Spell::CheckCast(bool strict)
                 return SPELL_FAILED_CASTER_AURASTATE;
         }
 
-        if (!m_IsTriggeredSpell && NeedsComboPoints(m_spellInfo) && !m_caster->IsIgnoreUnitState(m_spellInfo, IGNORE_UNIT_TARGET_STATE) &&
+        if (!m_IsTriggeredSpell && m_runtimeInfo->HasFlag(SPELL_RUNTIME_COMBO_POINTS) && !m_caster->IsIgnoreUnitState(m_spellInfo, IGNORE_UNIT_TARGET_STATE) &&
                 (!m_targets.getUnitTarget() || m_targets.getUnitTarget()->GetObjectGuid() != m_caster->GetComboTargetGuid()))
             // warrior not have real combo-points at client side but use this way for mark allow Overpower use
             return m_caster->getClass() == CLASS_WARRIOR ? SPELL_FAILED_CASTER_AURASTATE : SPELL_FAILED_NO_COMBO_POINTS;
@@ -5774,7 +5779,7 @@ SpellCastResult Spell::CheckCast(bool strict)
 
                     // Do not allow these spells to target creatures not tapped by us (Banish, Polymorph, many quest spells)
                     // Checked here, for single target spells, checked in CheckTarget to take care of AoE spells
-                    if (m_spellInfo->HasAttribute(SPELL_ATTR_EX2_CANNOT_CAST_ON_TAPPED) && !IsAreaOfEffectSpell(m_spellInfo))
+                    if (m_spellInfo->HasAttribute(SPELL_ATTR_EX2_CANNOT_CAST_ON_TAPPED) && !m_runtimeInfo->HasFlag(SPELL_RUNTIME_AREA_OF_EFFECT))
                         if (Creature const* targetCreature = dynamic_cast<Creature*>(target))
                             if ((!targetCreature->GetLootRecipientGuid().IsEmpty()) && !targetCreature->IsTappedBy(static_cast<Player*>(m_trueCaster)))
                                 return SPELL_FAILED_CANT_CAST_ON_TAPPED;
@@ -5784,13 +5789,13 @@ SpellCastResult Spell::CheckCast(bool strict)
                         return SPELL_FAILED_BAD_TARGETS;
                 }
 
-                if (strict && m_spellInfo->HasAttribute(SPELL_ATTR_EX3_ONLY_ON_PLAYER) && target->GetTypeId() != TYPEID_PLAYER && !IsAreaOfEffectSpell(m_spellInfo))
+                if (strict && m_spellInfo->HasAttribute(SPELL_ATTR_EX3_ONLY_ON_PLAYER) && target->GetTypeId() != TYPEID_PLAYER && !m_runtimeInfo->HasFlag(SPELL_RUNTIME_AREA_OF_EFFECT))
                     return SPELL_FAILED_BAD_TARGETS;
 
-                if (strict && m_spellInfo->HasAttribute(SPELL_ATTR_EX5_NOT_ON_PLAYER) && target->GetTypeId() == TYPEID_PLAYER && !IsAreaOfEffectSpell(m_spellInfo))
+                if (strict && m_spellInfo->HasAttribute(SPELL_ATTR_EX5_NOT_ON_PLAYER) && target->GetTypeId() == TYPEID_PLAYER && !m_runtimeInfo->HasFlag(SPELL_RUNTIME_AREA_OF_EFFECT))
                     return SPELL_FAILED_BAD_TARGETS;
 
-                if (strict && m_spellInfo->HasAttribute(SPELL_ATTR_EX5_NOT_ON_PLAYER_CONTROLLED_NPC) && target->IsPlayerControlled() && target->GetTypeId() != TYPEID_PLAYER && !IsAreaOfEffectSpell(m_spellInfo))
+                if (strict && m_spellInfo->HasAttribute(SPELL_ATTR_EX5_NOT_ON_PLAYER_CONTROLLED_NPC) && target->IsPlayerControlled() && target->GetTypeId() != TYPEID_PLAYER && !m_runtimeInfo->HasFlag(SPELL_RUNTIME_AREA_OF_EFFECT))
                     return SPELL_FAILED_BAD_TARGETS;
             }
             else if (m_caster == target)
@@ -5889,7 +5894,7 @@ SpellCastResult Spell::CheckCast(bool strict)
                 return SPELL_FAILED_BAD_TARGETS;
 
             // Check if more powerful spell applied on target (if spell only contains non-aoe auras)
-            if (IsAuraApplyEffects(m_spellInfo, SpellEffectIndexMask(affectedMask)) && !IsAreaOfEffectSpell(m_spellInfo) && !HasAreaAuraEffect(m_spellInfo) && !selfTargeting && !m_spellInfo->HasAttribute(SPELL_ATTR_EX4_AURA_NEVER_BOUNCES))
+            if (IsAuraApplyEffects(m_spellInfo, SpellEffectIndexMask(affectedMask)) && !m_runtimeInfo->HasFlag(SPELL_RUNTIME_AREA_OF_EFFECT) && !m_runtimeInfo->HasFlag(SPELL_RUNTIME_AREA_AURA) && !selfTargeting && !m_spellInfo->HasAttribute(SPELL_ATTR_EX4_AURA_NEVER_BOUNCES))
             {
                 bool computed = false; // optimization
                 int32 amounts[MAX_EFFECT_INDEX];
@@ -6016,7 +6021,7 @@ SpellCastResult Spell::CheckCast(bool strict)
 
     // not let players cast spells at mount (and let do it to creatures)
     if (m_trueCaster->IsPlayer() && m_caster->GetMountID() && !m_IsTriggeredSpell &&
-            !IsPassiveSpell(m_spellInfo) && !m_spellInfo->HasAttribute(SPELL_ATTR_ALLOW_WHILE_MOUNTED))
+            !m_runtimeInfo->HasFlag(SPELL_RUNTIME_PASSIVE) && !m_spellInfo->HasAttribute(SPELL_ATTR_ALLOW_WHILE_MOUNTED))
     {
         if (m_caster->IsTaxiFlying())
             return SPELL_FAILED_NOT_ON_TAXI;
@@ -6024,7 +6029,7 @@ SpellCastResult Spell::CheckCast(bool strict)
     }
 
     // always (except passive spells) check items
-    if (!IsPassiveSpell(m_spellInfo))
+    if (!m_runtimeInfo->HasFlag(SPELL_RUNTIME_PASSIVE))
     {
         SpellCastResult castResult = CheckItems();
         if (castResult != SPELL_CAST_OK)
@@ -7376,16 +7381,15 @@ std::pair<float, float> Spell::GetMinMaxRange(bool strict)
 {
     float minRange = 0.0f, maxRange = 0.0f, rangeMod = 0.0f;
 
-    if (strict && IsNextMeleeSwingSpell(m_spellInfo))
+    if (strict && m_runtimeInfo->HasFlag(SPELL_RUNTIME_NEXT_MELEE_SWING))
         return { 0.0f, 100.0f };
 
     Unit* caster = dynamic_cast<Unit*>(m_trueCaster); // preparation for GO casting
 
-    SpellRangeEntry const* spellRange = sSpellRangeStore.LookupEntry(m_spellInfo->rangeIndex);
-    if (spellRange)
+    if (m_runtimeInfo->HasFlag(SPELL_RUNTIME_HAS_RANGE))
     {
         Unit* target = m_targets.getUnitTarget();
-        if (spellRange->Flags & SPELL_RANGE_FLAG_MELEE)
+        if (m_runtimeInfo->rangeFlags & SPELL_RANGE_FLAG_MELEE)
         {
             if (caster)
                 rangeMod = caster->GetCombinedCombatReach(target ? target : caster, true, 0.f);
@@ -7393,27 +7397,27 @@ std::pair<float, float> Spell::GetMinMaxRange(bool strict)
         else
         {
             float meleeRange = 0.f;
-            if (spellRange->Flags & SPELL_RANGE_FLAG_RANGED)
+            if (m_runtimeInfo->rangeFlags & SPELL_RANGE_FLAG_RANGED)
             {
                 if (caster)
                     meleeRange = caster->GetCombinedCombatReach(target ? target : caster, true, 0.f);
             }
 
             bool friendly = target ? m_trueCaster->CanAssistSpell(target, m_spellInfo) : false;
-            minRange = GetSpellMinRange(spellRange, friendly) + meleeRange;
-            maxRange = GetSpellMaxRange(spellRange, friendly);
+            minRange = m_runtimeInfo->GetMinRange(friendly) + meleeRange;
+            maxRange = m_runtimeInfo->GetMaxRange(friendly);
 
             if (target || m_targets.getCorpseTarget())
             {
                 rangeMod = m_trueCaster->GetCombatReach() + (target ? target->GetCombatReach() : m_trueCaster->GetCombatReach());
 
-                if (minRange > 0.0f && !(spellRange->Flags & SPELL_RANGE_FLAG_RANGED))
+                if (minRange > 0.0f && !(m_runtimeInfo->rangeFlags & SPELL_RANGE_FLAG_RANGED))
                     minRange += rangeMod;
             }
         }
 
         if (target && caster && caster->IsMovingForward() && target->IsMovingForward() && !caster->IsWalking() && !target->IsWalking() &&
-            ((spellRange->Flags & SPELL_RANGE_FLAG_MELEE) || target->GetTypeId() == TYPEID_PLAYER))
+            ((m_runtimeInfo->rangeFlags & SPELL_RANGE_FLAG_MELEE) || target->GetTypeId() == TYPEID_PLAYER))
             rangeMod += MELEE_LEEWAY;
     }
 
@@ -7444,9 +7448,8 @@ SpellCastResult Spell::CheckRange(bool strict)
     std::tie(minRange, maxRange) = GetMinMaxRange(strict);
 
     // non strict spell tolerance
-    if (SpellRangeEntry const* spellRange = sSpellRangeStore.LookupEntry(m_spellInfo->rangeIndex))
-        if ((spellRange->Flags & SPELL_RANGE_FLAG_MELEE) == 0 && !strict)
-            maxRange += std::min(3.f, maxRange * 0.1f); // 10% but no more than MAX_SPELL_RANGE_TOLERANCE
+    if (m_runtimeInfo->HasFlag(SPELL_RUNTIME_HAS_RANGE) && (m_runtimeInfo->rangeFlags & SPELL_RANGE_FLAG_MELEE) == 0 && !strict)
+        maxRange += std::min(3.f, maxRange * 0.1f); // 10% but no more than MAX_SPELL_RANGE_TOLERANCE
 
     if (!target && m_clientCast && HasSpellTarget(m_spellInfo, TARGET_UNIT_CASTER_PET))
         target = m_caster->GetPet() ? m_caster->GetPet() : m_caster->GetCharm();
@@ -8282,11 +8285,11 @@ bool Spell::CheckTargetCreatureType(Unit* target, SpellEntry const* spellInfo)
 
 CurrentSpellTypes Spell::GetCurrentContainer() const
 {
-    if (IsNextMeleeSwingSpell(m_spellInfo))
+    if (m_runtimeInfo->HasFlag(SPELL_RUNTIME_NEXT_MELEE_SWING))
         return (CURRENT_MELEE_SPELL);
     if (IsAutoRepeat())
         return (CURRENT_AUTOREPEAT_SPELL);
-    if (IsChanneledSpell(m_spellInfo))
+    if (m_runtimeInfo->HasFlag(SPELL_RUNTIME_CHANNELED))
         return (CURRENT_CHANNELED_SPELL);
     return (CURRENT_GENERIC_SPELL);
 }
@@ -8378,12 +8381,12 @@ bool Spell::CheckTarget(Unit* target, SpellEffectIndex eff, bool targetB, CheckE
                     {
                         case TARGET_LOS_DEST:
                             m_targets.getDestination(x, y, z);
-                            if (!target->IsWithinLOS(x, y, z + target->GetCollisionHeight(), true))
+                            if (!IsTargetInLineOfSight(target, x, y, z + target->GetCollisionHeight()))
                                 return false;
                             break;
                         case TARGET_LOS_SRC:
                             m_targets.getSource(x, y, z);
-                            if (!target->IsWithinLOS(x, y, z + target->GetCollisionHeight(), true))
+                            if (!IsTargetInLineOfSight(target, x, y, z + target->GetCollisionHeight()))
                                 return false;
                             break;
                         case TARGET_LOS_CASTER:
@@ -8397,7 +8400,10 @@ bool Spell::CheckTarget(Unit* target, SpellEffectIndex eff, bool targetB, CheckE
                                 }
                                 else if (WorldObject* caster = GetCastingObject())
                                 {
-                                    if (!target->IsWithinLOSInMap(caster, true))
+                                    if (!target->IsInMap(caster))
+                                        return false;
+                                    caster->GetPosition(x, y, z);
+                                    if (!IsTargetInLineOfSight(target, x, y, z + caster->GetCollisionHeight()))
                                         return false;
                                 }
                             }
@@ -8466,7 +8472,7 @@ bool Spell::IsNeedSendToClient() const
     if (m_spellInfo->HasAttribute(SPELL_ATTR_EX7_ALWAYS_CAST_LOG))
         return true;
 
-    return m_spellInfo->SpellVisual[0] || m_spellInfo->SpellVisual[1] || IsChanneledSpell(m_spellInfo) ||
+    return m_spellInfo->SpellVisual[0] || m_spellInfo->SpellVisual[1] || m_runtimeInfo->HasFlag(SPELL_RUNTIME_CHANNELED) ||
            m_spellInfo->speed > 0.0f || (!m_triggeredByAuraSpell && !m_IsTriggeredSpell);
 }
 
@@ -8711,7 +8717,100 @@ SpellCastResult Spell::CanOpenLock(SpellEffectIndex effIndex, uint32 lockId, Ski
 void Spell::FillAreaTargets(UnitList& targetUnitMap, float radius, float cone, SpellNotifyPushType pushType, SpellTargets spellTargets, WorldObject* originalCaster /*=nullptr*/)
 {
     MaNGOS::SpellNotifierCreatureAndPlayer notifier(*this, targetUnitMap, radius, cone, pushType, spellTargets, originalCaster);
-    Cell::VisitAllObjects(notifier.GetCenterX(), notifier.GetCenterY(), m_trueCaster->GetMap(), notifier, radius);
+    // units count as in range with their combat reach, the index widens the searched square by the largest one
+    m_trueCaster->GetMap()->GetUnitSpatialIndex().VisitUnitsInSquare(notifier.GetCenterX(), notifier.GetCenterY(), radius, notifier);
+}
+
+void Spell::PrefetchTargetLineOfSight(UnitList const& targets, SpellEffectIndex eff, bool targetB)
+{
+    m_prefetchedLineOfSight.clear();
+
+    // a single target gains nothing from the batch, the special checks of CheckTarget stay scalar
+    if (targets.size() < 2 || IsIgnoreLosSpellEffect(m_spellInfo, eff, targetB))
+        return;
+    if (m_spellInfo->Effect[eff] == SPELL_EFFECT_SUMMON_PLAYER || m_spellInfo->Effect[eff] == SPELL_EFFECT_RESURRECT_NEW)
+        return;
+
+    SpellTargetInfo const& info = SpellTargetInfoTable[targetB ? m_spellInfo->EffectImplicitTargetB[eff] : m_spellInfo->EffectImplicitTargetA[eff]];
+    if (info.type == TARGET_TYPE_UNIT && info.filter == TARGET_SCRIPT)
+        return;
+
+    // same points as CheckTarget, the target collision height is added per target for dest and source
+    float x, y, z;
+    bool const addTargetHeight = info.los != TARGET_LOS_CASTER;
+    switch (info.los)
+    {
+        case TARGET_LOS_DEST:
+            m_targets.getDestination(x, y, z);
+            break;
+        case TARGET_LOS_SRC:
+            m_targets.getSource(x, y, z);
+            break;
+        case TARGET_LOS_CASTER:
+        {
+            if (info.enumerator == TARGET_ENUMERATOR_CHAIN || m_spellInfo->EffectImplicitTargetA[eff] == TARGET_LOCATION_CHANNEL_TARGET_DEST)
+                return;
+            WorldObject* caster = GetCastingObject();
+            if (!caster)
+                return;
+            caster->GetPosition(x, y, z);
+            z += caster->GetCollisionHeight();
+            break;
+        }
+        default:
+            return;
+    }
+
+    Map* map = m_trueCaster->GetMap();
+    uint32 const phaseMask = targets.front()->GetPhaseMask();
+    std::vector<VMAP::LineOfSightQuery> queries;
+    std::vector<Unit*> units;
+    queries.reserve(targets.size());
+    units.reserve(targets.size());
+    for (Unit* target : targets)
+    {
+        // the batch runs with one phase mask, the others are tested one by one
+        if (target->GetPhaseMask() != phaseMask || target->GetMap() != map)
+            continue;
+
+        VMAP::LineOfSightQuery query;
+        target->GetPosition(query.x1, query.y1, query.z1);
+        query.z1 += target->GetCollisionHeight();
+        query.x2 = x;
+        query.y2 = y;
+        query.z2 = addTargetHeight ? z + target->GetCollisionHeight() : z;
+        queries.push_back(query);
+        units.push_back(target);
+    }
+
+    if (queries.size() < 2)
+        return;
+
+    std::unique_ptr<bool[]> results(new bool[queries.size()]);
+    map->IsInLineOfSight(queries.data(), results.get(), uint32(queries.size()), phaseMask, true);
+    for (size_t i = 0; i < queries.size(); ++i)
+    {
+        VMAP::LineOfSightQuery const& query = queries[i];
+        m_prefetchedLineOfSight[units[i]] = { query.x1, query.y1, query.z1, query.x2, query.y2, query.z2, results[i] };
+    }
+}
+
+// WorldObject::IsWithinLOS with ignoreM2Model, answered from the batch when it tested the same points
+bool Spell::IsTargetInLineOfSight(Unit* target, float x, float y, float z) const
+{
+    auto itr = m_prefetchedLineOfSight.find(target);
+    if (itr != m_prefetchedLineOfSight.end())
+    {
+        PrefetchedLineOfSight const& prefetched = itr->second;
+        float srcX, srcY, srcZ;
+        target->GetPosition(srcX, srcY, srcZ);
+        srcZ += target->GetCollisionHeight();
+        if (prefetched.srcX == srcX && prefetched.srcY == srcY && prefetched.srcZ == srcZ &&
+            prefetched.destX == x && prefetched.destY == y && prefetched.destZ == z)
+            return prefetched.result;
+    }
+
+    return target->IsWithinLOS(x, y, z, true);
 }
 
 void Spell::FillRaidOrPartyTargets(UnitList& targetUnitMap, Unit* member, Unit* center, float radius, bool raid, bool withPets, bool withcaster) const
@@ -8801,7 +8900,7 @@ float Spell::GetSpellSpeed() const
 {
     if (m_trueCaster->IsGameObject()) // 4 spells in all of wotlk and doesnt seem like GO casting supports travelling delay from sniffs
         return 0.f;
-    if (IsChanneledSpell(m_spellInfo))
+    if (m_runtimeInfo->HasFlag(SPELL_RUNTIME_CHANNELED))
         return 0.f;
 
     if (m_overrideSpeed)
@@ -8812,7 +8911,7 @@ float Spell::GetSpellSpeed() const
 
 bool Spell::IsDelayedSpell() const
 {
-    return GetSpellSpeed() > 0.0f && !IsChanneledSpell(m_spellInfo);
+    return GetSpellSpeed() > 0.0f && !m_runtimeInfo->HasFlag(SPELL_RUNTIME_CHANNELED);
 }
 
 void Spell::ResetEffectDamageAndHeal()
@@ -40,6 +40,7 @@ struct SpellTargetEntry;
 struct SpellScript;
 struct AuraScript;
 struct SpellTargetingData;
+struct SpellRuntimeInfo;
 
 enum SpellCastFlags
 {
@@ -633,6 +634,7 @@ class Spell
         Item* GetCastItem() { return m_CastItem; }
 
         SpellEntry const* m_spellInfo;
+        SpellRuntimeInfo const* m_runtimeInfo;              // values precomputed from m_spellInfo
         SpellEntry const* m_triggeredBySpellInfo;
         int32 m_currentBasePoints[MAX_EFFECT_INDEX];        // cache SpellEntry::CalculateSimpleValue and use for set custom base points
         uint8 m_cast_count;
@@ -997,6 +999,9 @@ class Spell
         void FillFromTargetFlags(TempTargetingData& targetingData, SpellEffectIndex effIndex);
 
         void FillAreaTargets(UnitList& targetUnitMap, float radius, float cone, SpellNotifyPushType pushType, SpellTargets spellTargets, WorldObject* originalCaster = nullptr);
+        // tests the line of sight of all area targets of an effect in one batch, CheckTarget picks the results up
+        void PrefetchTargetLineOfSight(UnitList const& targets, SpellEffectIndex eff, bool targetB);
+        bool IsTargetInLineOfSight(Unit* target, float x, float y, float z) const;
         void FillRaidOrPartyTargets(UnitList& targetUnitMap, Unit* member, Unit* center, float radius, bool raid, bool withPets, bool withcaster) const;
         void FillRaidOrPartyManaPriorityTargets(UnitList& targetUnitMap, Unit* member, Unit* center, float radius, uint32 count, bool raid, bool withPets, bool withCaster);
         void FillRaidOrPartyHealthPriorityTargets(UnitList& targetUnitMap, Unit* member, Unit* center, float radius, uint32 count, bool raid, bool withPets, bool withCaster);
@@ -1069,6 +1074,14 @@ class Spell
         float m_jumpRadius;
         SpellTargetFilterScheme m_filteringScheme[MAX_EFFECT_INDEX][2];
 
+        struct PrefetchedLineOfSight
+        {
+            float srcX, srcY, srcZ;                         // target
+            float destX, destY, destZ;
+            bool result;
+        };
+        std::unordered_map<Unit const*, PrefetchedLineOfSight> m_prefetchedLineOfSight;
+
         std::set<Aura*> m_procOnceHolder;
 
         struct EffectSkillInfo
@@ -1207,98 +1220,98 @@ namespace MaNGOS
             }
         }
 
-        template<class T> inline void Visit(GridRefManager<T>& m)
+        // the cheap flag and distance checks run first, the faction checks last
+        void operator()(Unit* target)
         {
             if (!i_originalCaster || !i_castingObject)
                 return;
 
-            for (typename GridRefManager<T>::iterator itr = m.begin(); itr != m.end(); ++itr)
+            // there are still more spells which can be casted on dead, but
+            // they are no AOE and don't have such a nice SPELL_ATTR flag
+            // mostly phase check
+            if (i_spell.m_spellInfo->HasAttribute(SPELL_ATTR_EX6_IGNORE_PHASE_SHIFT))
             {
-                // there are still more spells which can be casted on dead, but
-                // they are no AOE and don't have such a nice SPELL_ATTR flag
-                // mostly phase check
-                if (i_spell.m_spellInfo->HasAttribute(SPELL_ATTR_EX6_IGNORE_PHASE_SHIFT))
-                {
-                    if (!itr->getSource()->IsInMapIgnorePhase(i_originalCaster))
-                        continue;
-                }
-                else if (!itr->getSource()->IsInMap(i_originalCaster))
-                    continue;
+                if (!target->IsInMapIgnorePhase(i_originalCaster))
+                    return;
+            }
+            else if (!target->IsInMap(i_originalCaster))
+                return;
 
-                if (itr->getSource()->IsTaxiFlying())
-                    continue;
+            if (target->IsTaxiFlying())
+                return;
 
-                switch (i_TargetType)
-                {
-                    case SPELL_TARGETS_CHAIN_ATTACKABLE:
-                        if (itr->getSource()->IsChainImmune())
-                            continue;
-                        break;
-                    case SPELL_TARGETS_AOE_ATTACKABLE:
-                        if (itr->getSource()->IsAOEImmune())
-                            continue;
-                        break;
-                }
+            switch (i_TargetType)
+            {
+                case SPELL_TARGETS_CHAIN_ATTACKABLE:
+                    if (target->IsChainImmune())
+                        return;
+                    break;
+                case SPELL_TARGETS_AOE_ATTACKABLE:
+                    if (target->IsAOEImmune())
+                        return;
+                    break;
+                case SPELL_TARGETS_ASSISTABLE:
+                case SPELL_TARGETS_ALL:
+                    break;
+                default: return;
+            }
 
-                switch (i_TargetType)
+            // we don't need to check InMap here, it's already done some lines above
+            switch (i_push_type)
+            {
+                case PUSH_CONE:
                 {
-                    case SPELL_TARGETS_ASSISTABLE:
-                        if (!i_originalCaster->CanAssistSpell(itr->getSource(), i_spell.m_spellInfo))
-                            continue;
-                        break;
-                    case SPELL_TARGETS_CHAIN_ATTACKABLE:
-                    case SPELL_TARGETS_AOE_ATTACKABLE:
-                    {
-                        if (!i_originalCaster->CanAttackSpell(itr->getSource(), i_spell.m_spellInfo, !i_spell.m_spellInfo->HasAttribute(SPELL_ATTR_EX5_IGNORE_AREA_EFFECT_PVP_CHECK)))
-                            continue;
-                        break;
-                    }
-                    case SPELL_TARGETS_ALL:
-                        break;
-                    default: continue;
+                    float maxHeight = i_radius / 2;
+                    float distance = std::min(sqrtf(target->GetDistance2d(i_centerX, i_centerY, DIST_CALC_NONE)), i_radius);
+                    float ratio = distance / i_radius;
+                    float conalMaxHeight = maxHeight * ratio; // pvp combat uses true cone from roughly model
+                    if (!i_playerControlled && target->IsControlledByPlayer())
+                        conalMaxHeight = maxHeight; // npcs just do a conal max Z aoe
+                    if (std::abs(target->GetPositionZ() - i_centerZ) - target->GetCombatReach() > conalMaxHeight)
+                        return;
+                    if (i_cone >= 0.f ? !i_castingObject->isInFront(target, i_radius, i_cone) : !i_castingObject->isInBack(target, i_radius, -i_cone))
+                        return;
+                    break;
                 }
-
-                // we don't need to check InMap here, it's already done some lines above
-                switch (i_push_type)
+                case PUSH_SELF_CENTER:
+                    if (target->GetDistance2d(i_centerX, i_centerY, DIST_CALC_COMBAT_REACH) > i_radius)
+                        return;
+                    break;
+                case PUSH_SRC_CENTER:
+                case PUSH_DEST_CENTER:
+                case PUSH_TARGET_CENTER:
                 {
-                    case PUSH_CONE:
-                    {
-                        float heightDifference = std::abs(itr->getSource()->GetPositionZ() - i_centerZ);
-                        float maxHeight = i_radius / 2;
-                        float distance = std::min(sqrtf(itr->getSource()->GetDistance2d(i_centerX, i_centerY, DIST_CALC_NONE)), i_radius);
-                        float ratio = distance / i_radius;
-                        float conalMaxHeight = maxHeight * ratio; // pvp combat uses true cone from roughly model
-                        if (!i_originalCaster->IsControlledByPlayer() && itr->getSource()->IsControlledByPlayer())
-                            conalMaxHeight = maxHeight; // npcs just do a conal max Z aoe
-                        if (i_cone >= 0.f)
-                        {
-                            if (i_castingObject->isInFront(itr->getSource(), i_radius, i_cone) &&
-                                std::abs(itr->getSource()->GetPositionZ() - i_centerZ) - itr->getSource()->GetCombatReach() <= conalMaxHeight)
-                                i_data.push_back(itr->getSource());
-                        }
-                        else
-                        {
-                            if (i_castingObject->isInBack(itr->getSource(), i_radius, -i_cone) &&
-                                std::abs(itr->getSource()->GetPositionZ() - i_centerZ) - itr->getSource()->GetCombatReach() <= conalMaxHeight)
-                                i_data.push_back(itr->getSource());
-                        }
-                        break;
-                    }
-                    case PUSH_SELF_CENTER:
-                        if (itr->getSource()->GetDistance2d(i_centerX, i_centerY, DIST_CALC_COMBAT_REACH) <= i_radius)
-                            i_data.push_back(itr->getSource());
-                        break;
-                    case PUSH_SRC_CENTER:
-                    case PUSH_DEST_CENTER:
-                    case PUSH_TARGET_CENTER:
-                        float radius = i_radius;
-                        if (i_originalCaster->IsControlledByPlayer() && !itr->getSource()->IsControlledByPlayer())
-                            radius += itr->getSource()->GetCombatReach();
-                        if (itr->getSource()->GetDistance(i_centerX, i_centerY, i_centerZ, DIST_CALC_NONE) <= radius * radius)
-                            i_data.push_back(itr->getSource());
-                        break;
+                    float radius = i_radius;
+                    if (i_playerControlled && !target->IsControlledByPlayer())
+                        radius += target->GetCombatReach();
+                    if (target->GetDistance(i_centerX, i_centerY, i_centerZ, DIST_CALC_NONE) > radius * radius)
+                        return;
+                    break;
                 }
             }
+
+            switch (i_TargetType)
+            {
+                case SPELL_TARGETS_ASSISTABLE:
+                    if (!i_originalCaster->CanAssistSpell(target, i_spell.m_spellInfo))
+                        return;
+                    break;
+                case SPELL_TARGETS_CHAIN_ATTACKABLE:
+                case SPELL_TARGETS_AOE_ATTACKABLE:
+                    if (!i_originalCaster->CanAttackSpell(target, i_spell.m_spellInfo, !i_spell.m_spellInfo->HasAttribute(SPELL_ATTR_EX5_IGNORE_AREA_EFFECT_PVP_CHECK)))
+                        return;
+                    break;
+                default:
+                    break;
+            }
+
+            i_data.push_back(target);
+        }
+
+        template<class T> inline void Visit(GridRefManager<T>& m)
+        {
+            for (typename GridRefManager<T>::iterator itr = m.begin(); itr != m.end(); ++itr)
+                (*this)(itr->getSource());
         }
 
 #ifdef _MSC_VER
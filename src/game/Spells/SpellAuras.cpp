@@ -6556,6 +6556,8 @@ void Aura::HandleAuraModStat(bool apply, bool /*Real*/)
             target->RemoveAurasTriggeredBySpell(GetId(), GetCasterGuid()); // just do it every time, lookup is too time consuming
     }
 
+    // all stats auras recompute the values depending on them once
+    UnitStatNodeBatch statBatch(target);
     for (int32 i = STAT_STRENGTH; i < MAX_STATS; ++i)
     {
         // -1 or -2 is all stats ( misc < -2 checked in function beginning )
@@ -6582,6 +6584,7 @@ void Aura::HandleModPercentStat(bool apply, bool /*Real*/)
     if (GetTarget()->GetTypeId() != TYPEID_PLAYER)
         return;
 
+    UnitStatNodeBatch statBatch(GetTarget());
     for (int32 i = STAT_STRENGTH; i < MAX_STATS; ++i)
     {
         if (m_modifier.m_miscvalue == i || m_modifier.m_miscvalue == -1)
@@ -6658,13 +6661,17 @@ void Aura::HandleModTotalPercentStat(bool apply, bool /*Real*/)
     uint32 curHPValue = target->GetHealth();
     uint32 maxHPValue = target->GetMaxHealth();
 
-    for (int32 i = STAT_STRENGTH; i < MAX_STATS; ++i)
     {
-        if (m_modifier.m_miscvalue == i || m_modifier.m_miscvalue == -1)
+        // the new max health is read below, after the batch ends
+        UnitStatNodeBatch statBatch(target);
+        for (int32 i = STAT_STRENGTH; i < MAX_STATS; ++i)
         {
-            target->HandleStatModifier(UnitMods(UNIT_MOD_STAT_START + i), TOTAL_PCT, float(m_modifier.m_amount), apply);
-            if (target->GetTypeId() == TYPEID_PLAYER || ((Creature*)target)->IsPet())
-                target->ApplyStatPercentBuffMod(Stats(i), float(m_modifier.m_amount), apply);
+            if (m_modifier.m_miscvalue == i || m_modifier.m_miscvalue == -1)
+            {
+                target->HandleStatModifier(UnitMods(UNIT_MOD_STAT_START + i), TOTAL_PCT, float(m_modifier.m_amount), apply);
+                if (target->GetTypeId() == TYPEID_PLAYER || ((Creature*)target)->IsPet())
+                    target->ApplyStatPercentBuffMod(Stats(i), float(m_modifier.m_amount), apply);
+            }
         }
     }
 
@@ -9851,18 +9858,9 @@ void SpellAuraHolder::_AddSpellAuraHolder()
     // Lookup free slot
     if (m_target->GetVisibleAurasCount() < MAX_AURAS)
     {
-        Unit::VisibleAuraMap const& visibleAuras = m_target->GetVisibleAuras();
-        for (uint8 i = 0; i < MAX_AURAS; ++i)
-        {
-            Unit::VisibleAuraMap::const_iterator itr = visibleAuras.find(i);
-            if (itr == visibleAuras.end())
-            {
-                slot = i;
-                // update for out of range group members (on 1 slot use)
-                m_target->UpdateAuraForGroup(slot);
-                break;
-            }
-        }
+        slot = m_target->GetFreeVisibleAuraSlot();
+        // update for out of range group members (on 1 slot use)
+        m_target->UpdateAuraForGroup(slot);
     }
 
     Unit* caster = GetCaster();
@@ -1828,7 +1828,8 @@ void Spell::EffectDummy(SpellEffectIndex eff_idx)
                         }
                         case 40250: // Improved Duration - Anzu spirits
                         {
-                            auto periodicAuraList = unitTarget->GetAurasByType(SPELL_AURA_PERIODIC_HEAL);
+                            Unit::AuraList const& periodicAuras = unitTarget->GetAurasByType(SPELL_AURA_PERIODIC_HEAL);
+                            std::vector<Aura*> periodicAuraList(periodicAuras.begin(), periodicAuras.end());
                             uint32 duration = 0;
                             for (auto itr = periodicAuraList.rbegin(); itr != periodicAuraList.rend(); ++itr)
                             {
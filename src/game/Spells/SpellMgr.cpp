@@ -42,7 +42,7 @@ bool IsPrimaryProfessionSkill(uint32 skill)
     return true;
 }
 
-SpellMgr::SpellMgr()
+SpellMgr::SpellMgr() : mSpellProcEventGeneration(0)
 {
 }
 
@@ -830,6 +830,7 @@ struct DoSpellProcEvent
 void SpellMgr::LoadSpellProcEvents()
 {
     mSpellProcEventMap.clear();                             // need for reload case
+    ++mSpellProcEventGeneration;
 
     //                                             0      1           2                3                  4                  5                  6                  7                  8                  9                  10                 11                 12         13      14       15            16
     auto queryResult = WorldDatabase.Query("SELECT entry, SchoolMask, SpellFamilyName, SpellFamilyMaskA0, SpellFamilyMaskA1, SpellFamilyMaskA2, SpellFamilyMaskB0, SpellFamilyMaskB1, SpellFamilyMaskB2, SpellFamilyMaskC0, SpellFamilyMaskC1, SpellFamilyMaskC2, procFlags, procEx, ppmRate, CustomChance, Cooldown FROM spell_proc_event");
@@ -876,10 +877,158 @@ void SpellMgr::LoadSpellProcEvents()
 
     rankHelper.FillHigherRanks();
 
+    // reload case, the runtime info is built after the first load
+    FillSpellRuntimeProcFlags();
+    MANGOS_ASSERT(!CheckSpellRuntimeInfo() || sWorld.getConfig(CONFIG_UINT32_SPELL_RUNTIME_INFO_CHECK) < 2);
+
     sLog.outString(">> Loaded %u extra spell proc event conditions +%u custom proc (inc. +%u custom ranks)",  rankHelper.worker.count, rankHelper.worker.customProc, rankHelper.customRank);
     sLog.outString();
 }
 
+void SpellMgr::LoadSpellRuntimeInfo()
+{
+    mSpellRuntimeInfo.assign(sSpellTemplate.GetMaxEntry(), SpellRuntimeInfo());
+
+    uint32 count = 0;
+    BarGoLink bar(sSpellTemplate.GetMaxEntry());
+    for (uint32 i = 1; i < sSpellTemplate.GetMaxEntry(); ++i)
+    {
+        bar.step();
+
+        SpellEntry const* spellInfo = sSpellTemplate.LookupEntry<SpellEntry>(i);
+        if (!spellInfo)
+            continue;
+
+        SpellRuntimeInfo& info = mSpellRuntimeInfo[i];
+        info.recoveryTime = GetSpellRecoveryTime(spellInfo);
+        info.schoolMask = uint8(spellInfo->SchoolMask);
+
+        if (SpellRangeEntry const* spellRange = sSpellRangeStore.LookupEntry(spellInfo->rangeIndex))
+        {
+            info.minRange = spellRange->minRange;
+            info.minRangeFriendly = spellRange->minRangeFriendly;
+            info.maxRange = spellRange->maxRange;
+            info.maxRangeFriendly = spellRange->maxRangeFriendly;
+            info.rangeFlags = uint8(spellRange->Flags);
+            info.flags |= SPELL_RUNTIME_HAS_RANGE;
+        }
+
+        for (uint32 j = 0; j < MAX_EFFECT_INDEX; ++j)
+        {
+            if (!spellInfo->Effect[j])
+                continue;
+
+            info.effectMask |= 1 << j;
+            if (IsAuraApplyEffect(spellInfo, SpellEffectIndex(j)))
+                info.auraEffectMask |= 1 << j;
+            if (IsPositiveEffect(spellInfo, SpellEffectIndex(j)))
+                info.positiveEffectMask |= 1 << j;
+        }
+
+        if (info.positiveEffectMask == info.effectMask)
+            info.flags |= SPELL_RUNTIME_POSITIVE;
+        if (IsAreaOfEffectSpell(spellInfo))
+            info.flags |= SPELL_RUNTIME_AREA_OF_EFFECT;
+        if (HasAreaAuraEffect(spellInfo))
+            info.flags |= SPELL_RUNTIME_AREA_AURA;
+        if (IsPassiveSpell(spellInfo))
+            info.flags |= SPELL_RUNTIME_PASSIVE;
+        if (IsChanneledSpell(spellInfo))
+            info.flags |= SPELL_RUNTIME_CHANNELED;
+        if (IsAutoRepeatRangedSpell(spellInfo))
+            info.flags |= SPELL_RUNTIME_AUTO_REPEAT;
+        if (IsNextMeleeSwingSpell(spellInfo))
+            info.flags |= SPELL_RUNTIME_NEXT_MELEE_SWING;
+        if (NeedsComboPoints(spellInfo))
+            info.flags |= SPELL_RUNTIME_COMBO_POINTS;
+
+        ++count;
+    }
+
+    FillSpellRuntimeProcFlags();
+
+    sLog.outString(">> Precomputed runtime info of %u spells, %u bytes", count, uint32(mSpellRuntimeInfo.size() * sizeof(SpellRuntimeInfo)));
+    sLog.outString();
+}
+
+void SpellMgr::FillSpellRuntimeProcFlags()
+{
+    for (uint32 i = 1; i < mSpellRuntimeInfo.size(); ++i)
+        if (SpellEntry const* spellInfo = sSpellTemplate.LookupEntry<SpellEntry>(i))
+            mSpellRuntimeInfo[i].procFlags = GetSpellProcFlags(spellInfo);
+}
+
+// Compares every precomputed value against the on-demand check its readers used before, returns the count of differing spells
+uint32 SpellMgr::CheckSpellRuntimeInfo() const
+{
+    if (!sWorld.getConfig(CONFIG_UINT32_SPELL_RUNTIME_INFO_CHECK) || mSpellRuntimeInfo.empty())
+        return 0;
+
+    uint32 mismatches = 0;
+    for (uint32 i = 1; i < sSpellTemplate.GetMaxEntry(); ++i)
+    {
+        SpellEntry const* spellInfo = sSpellTemplate.LookupEntry<SpellEntry>(i);
+        if (!spellInfo)
+            continue;
+
+        SpellRuntimeInfo const& info = GetSpellRuntimeInfo(spellInfo);
+        SpellRangeEntry const* srange = sSpellRangeStore.LookupEntry(spellInfo->rangeIndex);
+
+        char const* field = nullptr;
+        if (info.procFlags != GetSpellProcFlags(spellInfo))
+            field = "procFlags";
+        else if (info.recoveryTime != std::max(spellInfo->RecoveryTime, spellInfo->CategoryRecoveryTime))
+            field = "recoveryTime";
+        else if (SpellSchoolMask(info.schoolMask) != GetSpellSchoolMask(spellInfo))
+            field = "schoolMask";
+        else if (info.HasFlag(SPELL_RUNTIME_HAS_RANGE) != (srange != nullptr) || info.rangeFlags != (srange ? srange->Flags : 0))
+            field = "range flags";
+        else if (info.GetMinRange(false) != GetSpellMinRange(srange, false) || info.GetMinRange(true) != GetSpellMinRange(srange, true) ||
+                 info.GetMaxRange(false) != GetSpellMaxRange(srange, false) || info.GetMaxRange(true) != GetSpellMaxRange(srange, true))
+            field = "range";
+        else if (info.HasFlag(SPELL_RUNTIME_POSITIVE) != IsPositiveSpell(spellInfo->Id))
+            field = "positive";
+        else if (info.HasFlag(SPELL_RUNTIME_AREA_OF_EFFECT) != IsAreaOfEffectSpell(spellInfo))
+            field = "area of effect";
+        else if (info.HasFlag(SPELL_RUNTIME_AREA_AURA) != HasAreaAuraEffect(spellInfo))
+            field = "area aura";
+        else if (info.HasFlag(SPELL_RUNTIME_PASSIVE) != IsPassiveSpell(spellInfo->Id))
+            field = "passive";
+        else if (info.HasFlag(SPELL_RUNTIME_CHANNELED) != IsChanneledSpell(spellInfo))
+            field = "channeled";
+        else if (info.HasFlag(SPELL_RUNTIME_AUTO_REPEAT) != IsAutoRepeatRangedSpell(spellInfo))
+            field = "auto repeat";
+        else if (info.HasFlag(SPELL_RUNTIME_NEXT_MELEE_SWING) != IsNextMeleeSwingSpell(spellInfo))
+            field = "next melee swing";
+        else if (info.HasFlag(SPELL_RUNTIME_COMBO_POINTS) != NeedsComboPoints(spellInfo))
+            field = "combo points";
+        else
+        {
+            // one effect at a time, as the aura and positivity checks of single effects did
+            for (uint32 j = 0; j < MAX_EFFECT_INDEX && !field; ++j)
+            {
+                bool hasEffect = spellInfo->Effect[j] != 0;
+                if (((info.effectMask & (1 << j)) != 0) != hasEffect)
+                    field = "effect mask";
+                else if (((info.auraEffectMask & (1 << j)) != 0) != (hasEffect && IsAuraApplyEffect(spellInfo, SpellEffectIndex(j))))
+                    field = "aura effect mask";
+                else if (((info.positiveEffectMask & (1 << j)) != 0) != (hasEffect && IsPositiveEffect(spellInfo, SpellEffectIndex(j))))
+                    field = "positive effect mask";
+            }
+        }
+
+        if (field)
+        {
+            sLog.outError("SpellMgr::CheckSpellRuntimeInfo: precomputed %s of spell %u differs from the on-demand check", field, i);
+            ++mismatches;
+        }
+    }
+
+    if (mismatches)
+        sLog.outError("SpellMgr::CheckSpellRuntimeInfo: %u spells have precomputed runtime info differing from the spell template", mismatches);
+    return mismatches;
+}
+
 struct DoSpellProcItemEnchant
 {
     DoSpellProcItemEnchant(SpellProcItemEnchantMap& _procMap, float _ppm) : procMap(_procMap), ppm(_ppm) {}
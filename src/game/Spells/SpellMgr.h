@@ -2546,6 +2546,42 @@ struct SpellBonusEntry
 };
 
 typedef std::unordered_map<uint32, SpellProcEventEntry> SpellProcEventMap;
+
+enum SpellRuntimeFlags
+{
+    SPELL_RUNTIME_POSITIVE          = 0x0001,               // IsPositiveSpell without caster and target
+    SPELL_RUNTIME_AREA_OF_EFFECT    = 0x0002,               // IsAreaOfEffectSpell
+    SPELL_RUNTIME_AREA_AURA         = 0x0004,               // HasAreaAuraEffect
+    SPELL_RUNTIME_PASSIVE           = 0x0008,               // IsPassiveSpell
+    SPELL_RUNTIME_CHANNELED         = 0x0010,               // IsChanneledSpell
+    SPELL_RUNTIME_AUTO_REPEAT       = 0x0020,               // IsAutoRepeatRangedSpell
+    SPELL_RUNTIME_NEXT_MELEE_SWING  = 0x0040,               // IsNextMeleeSwingSpell
+    SPELL_RUNTIME_COMBO_POINTS      = 0x0080,               // NeedsComboPoints
+    SPELL_RUNTIME_HAS_RANGE         = 0x0100,               // the range index points to an existing SpellRange entry
+};
+
+// Values derived from one spell template, precomputed at load so casts and procs read them from one cache line
+struct alignas(32) SpellRuntimeInfo
+{
+    uint32 procFlags;                                       // GetSpellProcFlags, follows reloads of spell_proc_event
+    uint32 recoveryTime;                                    // GetSpellRecoveryTime
+    float minRange;                                         // SpellRange entry, 0 without one
+    float minRangeFriendly;
+    float maxRange;
+    float maxRangeFriendly;
+    uint8 schoolMask;
+    uint8 rangeFlags;                                       // SpellRangeFlags
+    uint8 effectMask;                                       // effects the spell has
+    uint8 auraEffectMask;                                   // effects applying an aura
+    uint8 positiveEffectMask;                               // IsPositiveEffect without caster and target
+    uint16 flags;                                           // SpellRuntimeFlags
+
+    bool HasFlag(SpellRuntimeFlags flag) const { return (flags & flag) != 0; }
+    float GetMinRange(bool friendly) const { return friendly ? minRangeFriendly : minRange; }
+    float GetMaxRange(bool friendly) const { return friendly ? maxRangeFriendly : maxRange; }
+};
+
+typedef std::vector<SpellRuntimeInfo> SpellRuntimeInfoTable;
 typedef std::unordered_map<uint32, SpellBonusEntry>     SpellBonusMap;
 
 #define ELIXIR_BATTLE_MASK    0x01
@@ -2999,6 +3035,25 @@ class SpellMgr
             return nullptr;
         }
 
+        // Proc flags an aura of the spell reacts to, custom spell_proc_event flags take precedence
+        uint32 GetSpellProcFlags(SpellEntry const* spellProto) const
+        {
+            SpellProcEventEntry const* spellProcEvent = GetSpellProcEvent(spellProto->Id);
+            if (spellProcEvent && spellProcEvent->procFlags)
+                return spellProcEvent->procFlags;
+            return spellProto->procFlags;
+        }
+
+        // Changes with every load of spell_proc_event, proc flags taken before are outdated then
+        uint32 GetSpellProcEventGeneration() const { return mSpellProcEventGeneration; }
+
+        // Precomputed values of the spell template, indexed by spell id
+        SpellRuntimeInfo const& GetSpellRuntimeInfo(SpellEntry const* spellProto) const
+        {
+            MANGOS_ASSERT(spellProto->Id < mSpellRuntimeInfo.size());
+            return mSpellRuntimeInfo[spellProto->Id];
+        }
+
         // Spell procs from item enchants
         float GetItemEnchantProcChance(uint32 spellid) const
         {
@@ -3330,6 +3385,7 @@ class SpellMgr
         void LoadSpellScriptTarget();
         void LoadSpellElixirs();
         void LoadSpellProcEvents();
+        void LoadSpellRuntimeInfo();                        // must be after LoadSpellProcEvents
         void LoadSpellProcItemEnchant();
         void LoadSpellBonuses();
         void LoadSpellTargetPositions();
@@ -3341,8 +3397,11 @@ class SpellMgr
         void LoadPetDefaultSpells();
         void LoadSpellAreas();
 
+        uint32 CheckSpellRuntimeInfo() const;               // after all spell loads, see SpellRuntimeInfo.Check
+
     private:
         bool LoadPetDefaultSpells_helper(CreatureInfo const* cInfo, PetDefaultSpellsEntry& petDefSpells);
+        void FillSpellRuntimeProcFlags();
 
         SpellChainMap      mSpellChains;
         SpellChainMapNext  mSpellChainsNext;
@@ -3352,6 +3411,8 @@ class SpellMgr
         SpellElixirMap     mSpellElixirs;
         SpellThreatMap     mSpellThreatMap;
         SpellProcEventMap  mSpellProcEventMap;
+        uint32             mSpellProcEventGeneration;
+        SpellRuntimeInfoTable mSpellRuntimeInfo;
         SpellProcItemEnchantMap mSpellProcItemEnchantMap;
         SpellBonusMap      mSpellBonusMap;
         SkillLineAbilityMap mSkillLineAbilityMapBySpellId;
@@ -29,6 +29,7 @@
 #include <algorithm>
 
 #define MAX_STACK_SIZE 64
+#define BIH_RAY_PACKET_SIZE 8
 
 using G3D::Vector3;
 using G3D::AABox;
@@ -121,35 +122,13 @@ class BIH
         template<typename RayCallback>
         void intersectRay(const Ray& r, RayCallback& intersectCallback, float& maxDist, bool stopAtFirst = false, bool ignoreM2Model = false) const
         {
-            float intervalMin = -1.f;
-            float intervalMax = -1.f;
+            float intervalMin;
+            float intervalMax;
             Vector3 org = r.origin();
             Vector3 dir = r.direction();
             Vector3 invDir;
-            for (int i = 0; i < 3; ++i)
-            {
-                invDir[i] = 1.f / dir[i];
-                if (G3D::fuzzyNe(dir[i], 0.0f))
-                {
-                    float t1 = (bounds.low()[i] - org[i]) * invDir[i];
-                    float t2 = (bounds.high()[i] - org[i]) * invDir[i];
-                    if (t1 > t2)
-                        std::swap(t1, t2);
-                    if (t1 > intervalMin)
-                        intervalMin = t1;
-                    if (t2 < intervalMax || intervalMax < 0.f)
-                        intervalMax = t2;
-                    // intervalMax can only become smaller for other axis,
-                    //  and intervalMin only larger respectively, so stop early
-                    if (intervalMax <= 0 || intervalMin >= maxDist)
-                        return;
-                }
-            }
-
-            if (intervalMin > intervalMax)
+            if (!clipToBounds(org, dir, invDir, maxDist, intervalMin, intervalMax))
                 return;
-            intervalMin = std::max(intervalMin, 0.f);
-            intervalMax = std::min(intervalMax, maxDist);
 
             uint32 offsetFront[3];
             uint32 offsetBack[3];
@@ -259,6 +238,19 @@ class BIH
             }
         }
 
+        /**
+        Intersects count rays with the tree, BIH_RAY_PACKET_SIZE of them at a time. The rays of a packet
+        walk the tree together so every node is fetched once per packet instead of once per ray, which
+        pays off for rays starting close to each other, like an area spell testing its targets.
+        The callback gets the index of the ray as first argument, maxDists are updated as in intersectRay.
+        */
+        template<typename RayPacketCallback>
+        void intersectRays(const Ray* rays, float* maxDists, uint32 count, RayPacketCallback& intersectCallback, bool stopAtFirst = false, bool ignoreM2Model = false) const
+        {
+            for (uint32 first = 0; first < count; first += BIH_RAY_PACKET_SIZE)
+                intersectRayPacket(rays, maxDists, first, std::min<uint32>(count - first, BIH_RAY_PACKET_SIZE), intersectCallback, stopAtFirst, ignoreM2Model);
+        }
+
         template<typename IsectCallback>
         void intersectPoint(const Vector3& p, IsectCallback& intersectCallback) const
         {
@@ -343,6 +335,220 @@ class BIH
         bool readFromFile(FILE* rf);
 
     protected:
+        // computes the part of the ray inside the tree bounds, false if it misses them
+        bool clipToBounds(const Vector3& org, const Vector3& dir, Vector3& invDir, float maxDist, float& intervalMin, float& intervalMax) const
+        {
+            intervalMin = -1.f;
+            intervalMax = -1.f;
+            for (int i = 0; i < 3; ++i)
+            {
+                invDir[i] = 1.f / dir[i];
+                if (G3D::fuzzyNe(dir[i], 0.0f))
+                {
+                    float t1 = (bounds.low()[i] - org[i]) * invDir[i];
+                    float t2 = (bounds.high()[i] - org[i]) * invDir[i];
+                    if (t1 > t2)
+                        std::swap(t1, t2);
+                    if (t1 > intervalMin)
+                        intervalMin = t1;
+                    if (t2 < intervalMax || intervalMax < 0.f)
+                        intervalMax = t2;
+                    // intervalMax can only become smaller for other axis,
+                    //  and intervalMin only larger respectively, so stop early
+                    if (intervalMax <= 0 || intervalMin >= maxDist)
+                        return false;
+                }
+            }
+
+            if (intervalMin > intervalMax)
+                return false;
+            intervalMin = std::max(intervalMin, 0.f);
+            intervalMax = std::min(intervalMax, maxDist);
+            return true;
+        }
+
+        template<typename RayPacketCallback>
+        void intersectRayPacket(const Ray* rays, float* maxDists, uint32 first, uint32 count, RayPacketCallback& intersectCallback, bool stopAtFirst, bool ignoreM2Model) const
+        {
+            Vector3 org[BIH_RAY_PACKET_SIZE];
+            Vector3 invDir[BIH_RAY_PACKET_SIZE];
+            uint32 offsetFront[BIH_RAY_PACKET_SIZE][3];
+            uint32 offsetBack[BIH_RAY_PACKET_SIZE][3];
+            bool positiveDir[BIH_RAY_PACKET_SIZE][3];
+            float intervalMin[BIH_RAY_PACKET_SIZE];
+            float intervalMax[BIH_RAY_PACKET_SIZE];
+
+            // one bit per ray still walking the tree, rays stopped at their first hit leave for good
+            uint32 active = 0;
+            uint32 finished = 0;
+            for (uint32 i = 0; i < count; ++i)
+            {
+                org[i] = rays[first + i].origin();
+                Vector3 dir = rays[first + i].direction();
+                if (!clipToBounds(org[i], dir, invDir[i], maxDists[first + i], intervalMin[i], intervalMax[i]))
+                    continue;
+
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    uint32 negative = floatToRawIntBits(dir[axis]) >> 31;
+                    positiveDir[i][axis] = negative == 0;
+                    offsetFront[i][axis] = negative + 1;
+                    offsetBack[i][axis] = (negative ^ 1) + 1;
+                }
+                active |= 1 << i;
+            }
+
+            PacketStackNode stack[MAX_STACK_SIZE];
+            int stackPos = 0;
+            int node = 0;
+
+            while (active)
+            {
+                while (true)
+                {
+                    uint32 tn = tree[node];
+                    uint32 axis = (tn & (3 << 30)) >> 30;
+                    const bool BVH2 = (tn & (1 << 29)) != 0;
+                    int offset = tn & ~(7 << 29);
+                    if (!BVH2)
+                    {
+                        if (axis < 3)
+                        {
+                            // "normal" interior node, split the packet into the rays passing the left and the right child
+                            uint32 leftMask = 0;
+                            uint32 rightMask = 0;
+                            float leftMin[BIH_RAY_PACKET_SIZE], leftMax[BIH_RAY_PACKET_SIZE];
+                            PacketStackNode& right = stack[stackPos];
+                            for (uint32 i = 0; i < count; ++i)
+                            {
+                                if (!(active & (1 << i)))
+                                    continue;
+
+                                float tf = (intBitsToFloat(tree[node + offsetFront[i][axis]]) - org[i][axis]) * invDir[i][axis];
+                                float tb = (intBitsToFloat(tree[node + offsetBack[i][axis]]) - org[i][axis]) * invDir[i][axis];
+                                bool front = !(tf < intervalMin[i]);
+                                bool back = !(tb > intervalMax[i]);
+                                // front is the left child for rays going up the axis
+                                bool goesLeft = positiveDir[i][axis] ? front : back;
+                                bool goesRight = positiveDir[i][axis] ? back : front;
+                                float frontMax = (tf <= intervalMax[i]) ? tf : intervalMax[i];
+                                float backMin = (tb >= intervalMin[i]) ? tb : intervalMin[i];
+                                if (goesLeft)
+                                {
+                                    leftMask |= 1 << i;
+                                    leftMin[i] = positiveDir[i][axis] ? intervalMin[i] : backMin;
+                                    leftMax[i] = positiveDir[i][axis] ? frontMax : intervalMax[i];
+                                }
+                                if (goesRight)
+                                {
+                                    rightMask |= 1 << i;
+                                    right.tnear[i] = positiveDir[i][axis] ? backMin : intervalMin[i];
+                                    right.tfar[i] = positiveDir[i][axis] ? intervalMax[i] : frontMax;
+                                }
+                            }
+
+                            if (leftMask)
+                            {
+                                // both children hit, push back the right one
+                                if (rightMask)
+                                {
+                                    right.node = offset + 3;
+                                    right.mask = rightMask;
+                                    ++stackPos;
+                                }
+                                active = leftMask;
+                                for (uint32 i = 0; i < count; ++i)
+                                {
+                                    if (leftMask & (1 << i))
+                                    {
+                                        intervalMin[i] = leftMin[i];
+                                        intervalMax[i] = leftMax[i];
+                                    }
+                                }
+                                node = offset;
+                                continue;
+                            }
+                            if (!rightMask)
+                                break;
+
+                            active = rightMask;
+                            for (uint32 i = 0; i < count; ++i)
+                            {
+                                if (rightMask & (1 << i))
+                                {
+                                    intervalMin[i] = right.tnear[i];
+                                    intervalMax[i] = right.tfar[i];
+                                }
+                            }
+                            node = offset + 3;
+                        }
+                        else
+                        {
+                            // leaf - test some objects
+                            int n = tree[node + 1];
+                            while (n > 0)
+                            {
+                                for (uint32 i = 0; i < count; ++i)
+                                {
+                                    if (!(active & (1 << i)))
+                                        continue;
+                                    bool hit = intersectCallback(first + i, rays[first + i], objects[offset], maxDists[first + i], stopAtFirst, ignoreM2Model);
+                                    if (stopAtFirst && hit)
+                                    {
+                                        finished |= 1 << i;
+                                        active &= ~(1 << i);
+                                    }
+                                }
+                                if (!active)
+                                    break;
+                                --n;
+                                ++offset;
+                            }
+                            break;
+                        }
+                    }
+                    else
+                    {
+                        if (axis > 2)
+                            return; // should not happen
+                        for (uint32 i = 0; i < count; ++i)
+                        {
+                            if (!(active & (1 << i)))
+                                continue;
+                            float tf = (intBitsToFloat(tree[node + offsetFront[i][axis]]) - org[i][axis]) * invDir[i][axis];
+                            float tb = (intBitsToFloat(tree[node + offsetBack[i][axis]]) - org[i][axis]) * invDir[i][axis];
+                            intervalMin[i] = (tf >= intervalMin[i]) ? tf : intervalMin[i];
+                            intervalMax[i] = (tb <= intervalMax[i]) ? tb : intervalMax[i];
+                            if (intervalMin[i] > intervalMax[i])
+                                active &= ~(1 << i);
+                        }
+                        node = offset;
+                        if (!active)
+                            break;
+                    }
+                } // traversal loop
+                do
+                {
+                    active = 0;
+                    // stack is empty?
+                    if (stackPos == 0)
+                        return;
+                    // move back up the stack
+                    --stackPos;
+                    uint32 mask = stack[stackPos].mask & ~finished;
+                    for (uint32 i = 0; i < count; ++i)
+                    {
+                        if (!(mask & (1 << i)) || maxDists[first + i] < stack[stackPos].tnear[i])
+                            continue;
+                        intervalMin[i] = stack[stackPos].tnear[i];
+                        intervalMax[i] = stack[stackPos].tfar[i];
+                        active |= 1 << i;
+                    }
+                    node = stack[stackPos].node;
+                } while (!active);
+            }
+        }
+
         std::vector<uint32> tree;
         std::vector<uint32> objects;
         AABox bounds;
@@ -360,6 +566,13 @@ class BIH
             float tnear;
             float tfar;
         };
+        struct PacketStackNode
+        {
+            uint32 node;
+            uint32 mask;                                    // rays that still have to visit the node
+            float tnear[BIH_RAY_PACKET_SIZE];
+            float tfar[BIH_RAY_PACKET_SIZE];
+        };
 
         class BuildStats
         {
@@ -26,6 +26,7 @@
 #include <sstream>
 #include <iomanip>
 #include <limits>
+#include <vector>
 
 using G3D::Vector3;
 
@@ -34,9 +35,11 @@ namespace VMAP
     class MapRayCallback
     {
         public:
-            MapRayCallback(ModelInstance* val): didHit(false), prims(val) {}
+            MapRayCallback(ModelInstance* val, std::atomic<bool> const* loaded): didHit(false), prims(val), primsLoaded(loaded) {}
             bool operator()(G3D::Ray const& ray, uint32 entry, float& distance, bool pStopAtFirstHit = true, bool ignoreM2Model = false)
             {
+                if (!primsLoaded[entry].load(std::memory_order_acquire))
+                    return false;
                 bool result = prims[entry].intersectRay(ray, distance, pStopAtFirstHit, ignoreM2Model);
                 if (result)
                     didHit = true;
@@ -46,14 +49,37 @@ namespace VMAP
 
         protected:
             ModelInstance* prims;
+            std::atomic<bool> const* primsLoaded;
+    };
+
+    class MapRayPacketCallback
+    {
+        public:
+            MapRayPacketCallback(ModelInstance* val, std::atomic<bool> const* loaded, bool* hits): prims(val), primsLoaded(loaded), didHit(hits) {}
+            bool operator()(uint32 rayIndex, G3D::Ray const& ray, uint32 entry, float& distance, bool pStopAtFirstHit, bool ignoreM2Model)
+            {
+                if (!primsLoaded[entry].load(std::memory_order_acquire))
+                    return false;
+                bool result = prims[entry].intersectRay(ray, distance, pStopAtFirstHit, ignoreM2Model);
+                if (result)
+                    didHit[rayIndex] = true;
+                return result;
+            }
+
+        protected:
+            ModelInstance* prims;
+            std::atomic<bool> const* primsLoaded;
+            bool* didHit;
     };
 
     class AreaInfoCallback
     {
         public:
-            AreaInfoCallback(ModelInstance* val): prims(val) {}
+            AreaInfoCallback(ModelInstance* val, std::atomic<bool> const* loaded): prims(val), primsLoaded(loaded) {}
             void operator()(Vector3 const& point, uint32 entry)
             {
+                if (!primsLoaded[entry].load(std::memory_order_acquire))
+                    return;
 #ifdef VMAP_DEBUG
                 DEBUG_LOG("trying to intersect '%s'", prims[entry].name.c_str());
 #endif
@@ -61,15 +87,18 @@ namespace VMAP
             }
 
             ModelInstance* prims;
+            std::atomic<bool> const* primsLoaded;
             AreaInfo aInfo;
     };
 
     class LocationInfoCallback
     {
         public:
-            LocationInfoCallback(ModelInstance* val, LocationInfo& info): prims(val), locInfo(info), result(false) {}
+            LocationInfoCallback(ModelInstance* val, std::atomic<bool> const* loaded, LocationInfo& info): prims(val), primsLoaded(loaded), locInfo(info), result(false) {}
             void operator()(Vector3 const& point, uint32 entry)
             {
+                if (!primsLoaded[entry].load(std::memory_order_acquire))
+                    return;
 #ifdef VMAP_DEBUG
                 DEBUG_LOG("trying to intersect '%s'", prims[entry].name.c_str());
 #endif
@@ -78,6 +107,7 @@ namespace VMAP
             }
 
             ModelInstance* prims;
+            std::atomic<bool> const* primsLoaded;
             LocationInfo& locInfo;
             bool result;
     };
@@ -96,7 +126,7 @@ namespace VMAP
 
     bool StaticMapTree::getAreaInfo(Vector3& pos, uint32& flags, int32& adtId, int32& rootId, int32& groupId) const
     {
-        AreaInfoCallback intersectionCallBack(iTreeValues);
+        AreaInfoCallback intersectionCallBack(iTreeValues, iTreeValuesLoaded);
         iTree.intersectPoint(pos, intersectionCallBack);
         if (intersectionCallBack.aInfo.result)
         {
@@ -112,13 +142,13 @@ namespace VMAP
 
     bool StaticMapTree::GetLocationInfo(Vector3 const& pos, LocationInfo& info) const
     {
-        LocationInfoCallback intersectionCallBack(iTreeValues, info);
+        LocationInfoCallback intersectionCallBack(iTreeValues, iTreeValuesLoaded, info);
         iTree.intersectPoint(pos, intersectionCallBack);
         return intersectionCallBack.result;
     }
 
     StaticMapTree::StaticMapTree(uint32 mapID, const std::string& basePath):
-        iMapID(mapID), iIsTiled(false), iTreeValues(nullptr), iNTreeValues(0), iBasePath(basePath)
+        iMapID(mapID), iIsTiled(false), iTreeValues(nullptr), iTreeValuesLoaded(nullptr), iNTreeValues(0), iBasePath(basePath)
     {
         if (iBasePath.length() > 0 && (iBasePath[iBasePath.length() - 1] != '/' && iBasePath[iBasePath.length() - 1] != '\\'))
             iBasePath.append("/");
@@ -129,6 +159,7 @@ namespace VMAP
     StaticMapTree::~StaticMapTree()
     {
         delete[] iTreeValues;
+        delete[] iTreeValuesLoaded;
     }
 
     //=========================================================
@@ -140,7 +171,7 @@ namespace VMAP
     bool StaticMapTree::getIntersectionTime(G3D::Ray const& pRay, float& pMaxDist, bool pStopAtFirstHit, bool ignoreM2Model) const
     {
         float distance = pMaxDist;
-        MapRayCallback intersectionCallBack(iTreeValues);
+        MapRayCallback intersectionCallBack(iTreeValues, iTreeValuesLoaded);
         iTree.intersectRay(pRay, intersectionCallBack, distance, pStopAtFirstHit, ignoreM2Model);
         if (intersectionCallBack.didHit)
         {
@@ -163,6 +194,40 @@ namespace VMAP
         G3D::Ray ray = G3D::Ray::fromOriginAndDirection(pos1, (pos2 - pos1) / maxDist);
         return !getIntersectionTime(ray, maxDist, true, ignoreM2Model);
     }
+
+    void StaticMapTree::isInLineOfSight(const Vector3* starts, const Vector3* ends, bool* results, uint32 count, bool ignoreM2Model) const
+    {
+        G3D::Ray rays[BIH_RAY_PACKET_SIZE];
+        float maxDists[BIH_RAY_PACKET_SIZE];
+        uint32 indices[BIH_RAY_PACKET_SIZE];
+        bool hits[BIH_RAY_PACKET_SIZE];
+
+        for (uint32 first = 0; first < count; first += BIH_RAY_PACKET_SIZE)
+        {
+            uint32 end = std::min<uint32>(count, first + BIH_RAY_PACKET_SIZE);
+            uint32 packetSize = 0;
+            for (uint32 i = first; i < end; ++i)
+            {
+                results[i] = true;
+                float maxDist = (ends[i] - starts[i]).magnitude();
+                MANGOS_ASSERT(maxDist < std::numeric_limits<float>::max());
+                // same as for a single ray, no NaN values in the BIH
+                if (maxDist < 1e-10f)
+                    continue;
+
+                rays[packetSize] = G3D::Ray::fromOriginAndDirection(starts[i], (ends[i] - starts[i]) / maxDist);
+                maxDists[packetSize] = maxDist;
+                indices[packetSize] = i;
+                hits[packetSize] = false;
+                ++packetSize;
+            }
+
+            MapRayPacketCallback intersectionCallBack(iTreeValues, iTreeValuesLoaded, hits);
+            iTree.intersectRays(rays, maxDists, packetSize, intersectionCallBack, true, ignoreM2Model);
+            for (uint32 i = 0; i < packetSize; ++i)
+                results[indices[i]] = !hits[i];
+        }
+    }
     //=========================================================
     /**
     When moving from pos1 to pos2 check if we hit an object. Return true and the position if we hit one
@@ -310,6 +375,9 @@ namespace VMAP
         {
             iNTreeValues = iTree.primCount();
             iTreeValues = new ModelInstance[iNTreeValues];
+            iTreeValuesLoaded = new std::atomic<bool>[iNTreeValues];
+            for (uint32 i = 0; i < iNTreeValues; ++i)
+                iTreeValuesLoaded[i].store(false, std::memory_order_relaxed);
         }
 
         // global model spawns
@@ -345,6 +413,7 @@ namespace VMAP
                         }
 
                         iTreeValues[referencedVal] = ModelInstance(spawn, model);
+                        iTreeValuesLoaded[referencedVal].store(true, std::memory_order_release);
                         iLoadedSpawns[referencedVal] = 1;
                     }
                     else
@@ -365,6 +434,8 @@ namespace VMAP
         {
             delete[] iTreeValues;
             iTreeValues = nullptr;
+            delete[] iTreeValuesLoaded;
+            iTreeValuesLoaded = nullptr;
         }
 
         fclose(rf);
@@ -373,10 +444,12 @@ namespace VMAP
 
     //=========================================================
 
+    //! The tree must not be reachable by queries anymore
     void StaticMapTree::UnloadMap(VMapManager2* vm)
     {
         for (auto& iLoadedSpawn : iLoadedSpawns)
         {
+            iTreeValuesLoaded[iLoadedSpawn.first].store(false, std::memory_order_relaxed);
             iTreeValues[iLoadedSpawn.first].setUnloaded();
             for (int32 refCount = 0; refCount < iLoadedSpawn.second; ++refCount)
                 vm->releaseModelInstance(iTreeValues[iLoadedSpawn.first].name);
@@ -444,6 +517,7 @@ namespace VMAP
                         }
 
                         iTreeValues[referencedVal] = ModelInstance(spawn, model);
+                        iTreeValuesLoaded[referencedVal].store(true, std::memory_order_release);
                         iLoadedSpawns[referencedVal] = 1;
                     }
                     else
@@ -483,6 +557,9 @@ namespace VMAP
             FILE* tf = fopen(tilefile.c_str(), "rb");
             if (tf)
             {
+                // queries running meanwhile may still use the spawns, they are only freed once these are done
+                std::vector<std::string> releasedModels;
+                std::vector<uint32> unloadedNodes;
                 bool result = true;
                 char chunk[8];
                 if (!readChunk(tf, chunk, VMAP_MAGIC, 8))
@@ -498,7 +575,7 @@ namespace VMAP
                     if (result)
                     {
                         // release model instance
-                        vm->releaseModelInstance(spawn.name);
+                        releasedModels.push_back(spawn.name);
 
                         // update tree
                         uint32 referencedNode;
@@ -510,12 +587,20 @@ namespace VMAP
                         }
                         else if (--iLoadedSpawns[referencedNode] <= 0)
                         {
-                            iTreeValues[referencedNode].setUnloaded();
+                            iTreeValuesLoaded[referencedNode].store(false, std::memory_order_release);
+                            unloadedNodes.push_back(referencedNode);
                             iLoadedSpawns.erase(referencedNode);
                         }
                     }
                 }
                 fclose(tf);
+
+                if (!releasedModels.empty())
+                    vm->synchronizeReaders();
+                for (uint32 node : unloadedNodes)
+                    iTreeValues[node].setUnloaded();
+                for (std::string const& name : releasedModels)
+                    vm->releaseModelInstance(name);
             }
         }
         iLoadedTiles.erase(tile);
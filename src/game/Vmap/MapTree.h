@@ -21,6 +21,7 @@
 
 #include "BIH.h"
 
+#include <atomic>
 #include <unordered_map>
 
 namespace VMAP
@@ -53,6 +54,9 @@ namespace VMAP
             bool iIsTiled;
             BIH iTree;
             ModelInstance* iTreeValues; // the tree entries
+            // queries only look at entries flagged here, an entry is written before its flag is set
+            // and is only reset after the readers that could still see the flag are done, see VMapManager2
+            std::atomic<bool>* iTreeValuesLoaded;
             uint32 iNTreeValues;
 
             // Store all the map tile idents that are loaded for that map
@@ -76,6 +80,8 @@ namespace VMAP
             ~StaticMapTree();
 
             bool isInLineOfSight(const G3D::Vector3& pos1, const G3D::Vector3& pos2, bool ignoreM2Model) const;
+            // tests count rays at once, results[i] tells whether ends[i] is visible from starts[i]
+            void isInLineOfSight(const G3D::Vector3* starts, const G3D::Vector3* ends, bool* results, uint32 count, bool ignoreM2Model) const;
             bool getObjectHitPos(const G3D::Vector3& pPos1, const G3D::Vector3& pPos2, G3D::Vector3& pResultHitPos, float pModifyDist) const;
             float getHeight(const G3D::Vector3& pPos, float maxSearchDist) const;
             bool getAreaInfo(G3D::Vector3& pos, uint32& flags, int32& adtId, int32& rootId, int32& groupId) const;
@@ -19,6 +19,9 @@
 #include <iomanip>
 #include <string>
 #include <sstream>
+#include <chrono>
+#include <memory>
+#include <thread>
 #include "VMapManager2.h"
 #include "MapTree.h"
 #include "ModelInstance.h"
@@ -29,9 +32,133 @@ using G3D::Vector3;
 
 namespace VMAP
 {
+    namespace
+    {
+        // Every thread that ever queried owns one slot, it holds the epoch its running query started in
+        struct ReaderSlot
+        {
+            ReaderSlot() : epoch(0), depth(0), inUse(true) {}
+
+            std::atomic<uint64> epoch;                      // 0 while no query runs
+            uint32 depth;                                   // nested queries, only touched by the owner
+            bool inUse;                                     // guarded by the registry lock
+        };
+
+        class ReaderRegistry
+        {
+            public:
+                ReaderRegistry() : m_epoch(1) {}
+
+                ReaderSlot* Acquire()
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    for (auto& slot : m_slots)
+                    {
+                        if (!slot->inUse)
+                        {
+                            slot->inUse = true;
+                            return slot.get();
+                        }
+                    }
+                    m_slots.push_back(std::make_unique<ReaderSlot>());
+                    return m_slots.back().get();
+                }
+
+                void Release(ReaderSlot* slot)
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    slot->inUse = false;
+                }
+
+                void Enter(ReaderSlot& slot)
+                {
+                    if (slot.depth++ == 0)
+                        slot.epoch.store(m_epoch.load());
+                }
+
+                void Leave(ReaderSlot& slot)
+                {
+                    if (--slot.depth == 0)
+                        slot.epoch.store(0, std::memory_order_release);
+                }
+
+                // a query either registered before the epoch moved on or it sees the state published before
+                void Synchronize()
+                {
+                    uint64 epoch = m_epoch.fetch_add(1) + 1;
+
+                    // slots are never freed, new threads may acquire one while we wait
+                    std::vector<ReaderSlot*> slots;
+                    {
+                        std::lock_guard<std::mutex> lock(m_lock);
+                        slots.reserve(m_slots.size());
+                        for (auto& slot : m_slots)
+                            slots.push_back(slot.get());
+                    }
+
+                    for (ReaderSlot* slot : slots)
+                    {
+                        // queries take microseconds, behind a long batch the waiting thread sleeps instead of spinning
+                        for (uint32 round = 0;; ++round)
+                        {
+                            uint64 readerEpoch = slot->epoch.load();
+                            if (!readerEpoch || readerEpoch >= epoch)
+                                break;
+                            if (round < 64)
+                                std::this_thread::yield();
+                            else
+                                std::this_thread::sleep_for(std::chrono::microseconds(50));
+                        }
+                    }
+                }
+
+            private:
+                std::mutex m_lock;
+                std::vector<std::unique_ptr<ReaderSlot>> m_slots;
+                std::atomic<uint64> m_epoch;
+        };
+
+        ReaderRegistry& GetReaderRegistry()
+        {
+            static ReaderRegistry registry;
+            return registry;
+        }
+
+        struct ThreadReader
+        {
+            ThreadReader() : slot(nullptr) {}
+            ~ThreadReader()
+            {
+                if (slot)
+                    GetReaderRegistry().Release(slot);
+            }
+
+            ReaderSlot* slot;
+        };
+
+        thread_local ThreadReader t_reader;
+
+        // keeps the published trees of the manager alive for the running query
+        class ReadGuard
+        {
+            public:
+                ReadGuard()
+                {
+                    if (!t_reader.slot)
+                        t_reader.slot = GetReaderRegistry().Acquire();
+                    m_slot = t_reader.slot;
+                    GetReaderRegistry().Enter(*m_slot);
+                }
+                ~ReadGuard() { GetReaderRegistry().Leave(*m_slot); }
+
+            private:
+                ReaderSlot* m_slot;
+        };
+    }
+
     //=========================================================
 
-    VMapManager2::VMapManager2()
+    VMapManager2::VMapManager2() : iPublishedTrees(new InstanceTreeMap()), iQueryLogRemaining(0)
     {
     }
 
@@ -39,6 +166,7 @@ namespace VMAP
 
     VMapManager2::~VMapManager2(void)
     {
+        delete iPublishedTrees.load();
         for (auto& iInstanceMapTree : iInstanceMapTrees)
         {
             delete iInstanceMapTree.second;
@@ -90,6 +218,7 @@ namespace VMAP
     // Check if specified map have tile loaded
     bool VMapManager2::IsTileLoaded(uint32 mapId, uint32 x, uint32 y) const
     {
+        std::lock_guard<std::mutex> lock(m_vmStaticMapMutex);
         InstanceTreeMap::const_iterator instanceTree = iInstanceMapTrees.find(mapId);
         if (instanceTree == iInstanceMapTrees.end())
             return false;
@@ -101,6 +230,7 @@ namespace VMAP
 
     bool VMapManager2::_loadMap(unsigned int pMapId, const std::string& basePath, uint32 tileX, uint32 tileY)
     {
+        std::lock_guard<std::mutex> lock(m_vmStaticMapMutex);
         InstanceTreeMap::iterator instanceTree = iInstanceMapTrees.find(pMapId);
         if (instanceTree == iInstanceMapTrees.end())
         {
@@ -113,11 +243,13 @@ namespace VMAP
             }
 
             // insert new data
-            {
-                std::lock_guard<std::mutex> lock(m_vmStaticMapMutex);
-                instanceTree = iInstanceMapTrees.insert(InstanceTreeMap::value_type(pMapId, newTree)).first;
-            }
+            instanceTree = iInstanceMapTrees.insert(InstanceTreeMap::value_type(pMapId, newTree)).first;
+            publishTrees();
         }
+        // another map of the same terrain may have been faster
+        else if (instanceTree->second->IsTileLoaded(tileX, tileY))
+            return true;
+
         return instanceTree->second->LoadMapTile(tileX, tileY, this);
     }
 
@@ -125,15 +257,16 @@ namespace VMAP
 
     void VMapManager2::unloadMap(unsigned int pMapId)
     {
+        std::lock_guard<std::mutex> lock(m_vmStaticMapMutex);
         InstanceTreeMap::iterator instanceTree = iInstanceMapTrees.find(pMapId);
         if (instanceTree != iInstanceMapTrees.end())
         {
-            instanceTree->second->UnloadMap(this);
-            if (instanceTree->second->numLoadedTiles() == 0)
-            {
-                delete instanceTree->second;
-                iInstanceMapTrees.erase(pMapId);
-            }
+            StaticMapTree* tree = instanceTree->second;
+            iInstanceMapTrees.erase(instanceTree);
+            publishTrees();
+
+            tree->UnloadMap(this);
+            delete tree;
         }
     }
 
@@ -141,36 +274,95 @@ namespace VMAP
 
     void VMapManager2::unloadMap(unsigned int  pMapId, int x, int y)
     {
+        std::lock_guard<std::mutex> lock(m_vmStaticMapMutex);
         InstanceTreeMap::iterator instanceTree = iInstanceMapTrees.find(pMapId);
         if (instanceTree != iInstanceMapTrees.end())
         {
             instanceTree->second->UnloadMapTile(x, y, this);
             if (instanceTree->second->numLoadedTiles() == 0)
             {
-                delete instanceTree->second;
-                iInstanceMapTrees.erase(pMapId);
+                StaticMapTree* tree = instanceTree->second;
+                iInstanceMapTrees.erase(instanceTree);
+                publishTrees();
+
+                tree->UnloadMap(this);
+                delete tree;
             }
         }
     }
 
+    //=========================================================
+    // swap in a copy of iInstanceMapTrees, waits for the queries still reading the previous one
+
+    void VMapManager2::publishTrees()
+    {
+        InstanceTreeMap const* previous = iPublishedTrees.exchange(new InstanceTreeMap(iInstanceMapTrees));
+        synchronizeReaders();
+        delete previous;
+    }
+
+    StaticMapTree const* VMapManager2::findPublishedTree(uint32 pMapId) const
+    {
+        InstanceTreeMap const* trees = iPublishedTrees.load();
+        InstanceTreeMap::const_iterator instanceTree = trees->find(pMapId);
+        return instanceTree != trees->end() ? instanceTree->second : nullptr;
+    }
+
+    void VMapManager2::synchronizeReaders()
+    {
+        GetReaderRegistry().Synchronize();
+    }
+
     //==========================================================
 
     bool VMapManager2::isInLineOfSight(unsigned int pMapId, float x1, float y1, float z1, float x2, float y2, float z2, bool ignoreM2Model)
     {
         if (!isLineOfSightCalcEnabled()) return true;
+        if (iQueryLogRemaining.load(std::memory_order_relaxed))
+            recordQuery(pMapId, { x1, y1, z1, x2, y2, z2 }, ignoreM2Model);
         bool result = true;
-        InstanceTreeMap::iterator instanceTree = iInstanceMapTrees.find(pMapId);
-        if (instanceTree != iInstanceMapTrees.end())
+        ReadGuard guard;
+        if (StaticMapTree const* instanceTree = findPublishedTree(pMapId))
         {
             Vector3 pos1 = convertPositionToInternalRep(x1, y1, z1);
             Vector3 pos2 = convertPositionToInternalRep(x2, y2, z2);
             if (pos1 != pos2)
             {
-                result = instanceTree->second->isInLineOfSight(pos1, pos2, ignoreM2Model);
+                result = instanceTree->isInLineOfSight(pos1, pos2, ignoreM2Model);
             }
         }
         return result;
     }
+
+    void VMapManager2::isInLineOfSight(unsigned int pMapId, LineOfSightQuery const* queries, bool* results, uint32 count, bool ignoreM2Model)
+    {
+        std::fill(results, results + count, true);
+        if (!isLineOfSightCalcEnabled())
+            return;
+        if (iQueryLogRemaining.load(std::memory_order_relaxed))
+            for (uint32 i = 0; i < count; ++i)
+                recordQuery(pMapId, queries[i], ignoreM2Model);
+
+        ReadGuard guard;
+        StaticMapTree const* instanceTree = findPublishedTree(pMapId);
+        if (!instanceTree)
+            return;
+
+        Vector3 starts[BIH_RAY_PACKET_SIZE];
+        Vector3 ends[BIH_RAY_PACKET_SIZE];
+        for (uint32 first = 0; first < count; first += BIH_RAY_PACKET_SIZE)
+        {
+            uint32 packetSize = std::min<uint32>(count - first, BIH_RAY_PACKET_SIZE);
+            for (uint32 i = 0; i < packetSize; ++i)
+            {
+                LineOfSightQuery const& query = queries[first + i];
+                starts[i] = convertPositionToInternalRep(query.x1, query.y1, query.z1);
+                ends[i] = convertPositionToInternalRep(query.x2, query.y2, query.z2);
+            }
+            instanceTree->isInLineOfSight(starts, ends, results + first, packetSize, ignoreM2Model);
+        }
+    }
+
     //=========================================================
     /**
     get the hit position and return true if we hit something
@@ -184,13 +376,13 @@ namespace VMAP
         rz = z2;
         if (isLineOfSightCalcEnabled())
         {
-            InstanceTreeMap::iterator instanceTree = iInstanceMapTrees.find(pMapId);
-            if (instanceTree != iInstanceMapTrees.end())
+            ReadGuard guard;
+            if (StaticMapTree const* instanceTree = findPublishedTree(pMapId))
             {
                 Vector3 pos1 = convertPositionToInternalRep(x1, y1, z1);
                 Vector3 pos2 = convertPositionToInternalRep(x2, y2, z2);
                 Vector3 resultPos;
-                result = instanceTree->second->getObjectHitPos(pos1, pos2, resultPos, pModifyDist);
+                result = instanceTree->getObjectHitPos(pos1, pos2, resultPos, pModifyDist);
                 resultPos = convertPositionToInternalRep(resultPos.x, resultPos.y, resultPos.z);
                 rx = resultPos.x;
                 ry = resultPos.y;
@@ -210,11 +402,11 @@ namespace VMAP
         float height = VMAP_INVALID_HEIGHT_VALUE;           // no height
         if (isHeightCalcEnabled())
         {
-            InstanceTreeMap::iterator instanceTree = iInstanceMapTrees.find(pMapId);
-            if (instanceTree != iInstanceMapTrees.end())
+            ReadGuard guard;
+            if (StaticMapTree const* instanceTree = findPublishedTree(pMapId))
             {
                 Vector3 pos = convertPositionToInternalRep(x, y, z);
-                height = instanceTree->second->getHeight(pos, maxSearchDist);
+                height = instanceTree->getHeight(pos, maxSearchDist);
                 if (!(height < G3D::inf()))
                 {
                     height = VMAP_INVALID_HEIGHT_VALUE;     // no height
@@ -229,11 +421,11 @@ namespace VMAP
     bool VMapManager2::getAreaInfo(unsigned int pMapId, float x, float y, float& z, uint32& flags, int32& adtId, int32& rootId, int32& groupId) const
     {
         bool result = false;
-        InstanceTreeMap::const_iterator instanceTree = iInstanceMapTrees.find(pMapId);
-        if (instanceTree != iInstanceMapTrees.end())
+        ReadGuard guard;
+        if (StaticMapTree const* instanceTree = findPublishedTree(pMapId))
         {
             Vector3 pos = convertPositionToInternalRep(x, y, z);
-            result = instanceTree->second->getAreaInfo(pos, flags, adtId, rootId, groupId);
+            result = instanceTree->getAreaInfo(pos, flags, adtId, rootId, groupId);
             // z is not touched by convertPositionToMangosRep(), so just copy
             z = pos.z;
         }
@@ -242,12 +434,12 @@ namespace VMAP
 
     bool VMapManager2::GetLiquidLevel(uint32 pMapId, float x, float y, float z, uint8 ReqLiquidType, float& level, float& floor, uint32& type) const
     {
-        InstanceTreeMap::const_iterator instanceTree = iInstanceMapTrees.find(pMapId);
-        if (instanceTree != iInstanceMapTrees.end())
+        ReadGuard guard;
+        if (StaticMapTree const* instanceTree = findPublishedTree(pMapId))
         {
             LocationInfo info;
             Vector3 pos = convertPositionToInternalRep(x, y, z);
-            if (instanceTree->second->GetLocationInfo(pos, info))
+            if (instanceTree->GetLocationInfo(pos, info))
             {
                 floor = info.ground_Z;
                 type = info.hitModel->GetLiquidType();
@@ -262,6 +454,32 @@ namespace VMAP
 
     //=========================================================
 
+    void VMapManager2::recordQuery(uint32 pMapId, LineOfSightQuery const& query, bool ignoreM2Model)
+    {
+        std::lock_guard<std::mutex> lock(m_vmQueryLogMutex);
+        // the last slot may have been taken meanwhile
+        if (!iQueryLogRemaining.load(std::memory_order_relaxed))
+            return;
+        iQueryLogRemaining.fetch_sub(1, std::memory_order_relaxed);
+        iQueryLog.push_back({ pMapId, ignoreM2Model, query });
+    }
+
+    void VMapManager2::startQueryLog(uint32 maxQueries)
+    {
+        std::lock_guard<std::mutex> lock(m_vmQueryLogMutex);
+        iQueryLog.clear();
+        iQueryLog.reserve(maxQueries);
+        iQueryLogRemaining.store(maxQueries, std::memory_order_relaxed);
+    }
+
+    void VMapManager2::getQueryLog(std::vector<RecordedLineOfSightQuery>& queries)
+    {
+        std::lock_guard<std::mutex> lock(m_vmQueryLogMutex);
+        queries = iQueryLog;
+    }
+
+    //=========================================================
+
     WorldModel* VMapManager2::acquireModelInstance(const std::string& basepath, const std::string& filename)
     {
         std::lock_guard<std::mutex> lock(m_vmModelMutex);
@@ -287,6 +505,7 @@ namespace VMAP
 
     void VMapManager2::releaseModelInstance(const std::string& filename)
     {
+        std::lock_guard<std::mutex> lock(m_vmModelMutex);
         ModelFileMap::iterator model = iLoadedModelFiles.find(filename);
         if (model == iLoadedModelFiles.end())
         {
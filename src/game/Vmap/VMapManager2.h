@@ -23,8 +23,10 @@
 
 #include <G3D/Vector3.h>
 
+#include <atomic>
 #include <unordered_map>
 #include <mutex>
+#include <vector>
 
 //===========================================================
 
@@ -63,19 +65,40 @@ namespace VMAP
     typedef std::unordered_map<uint32, StaticMapTree*> InstanceTreeMap;
     typedef std::unordered_map<std::string, ManagedModel> ModelFileMap;
 
+    struct RecordedLineOfSightQuery
+    {
+        uint32 mapId;
+        bool ignoreM2Model;
+        LineOfSightQuery query;
+    };
+
+    /**
+    Queries do not lock. Loading and unloading is serialized by m_vmStaticMapMutex and publishes a copy of
+    the tree map, the previous copy, unloaded tiles and removed trees are only freed after synchronizeReaders()
+    made sure that no query started before the change is still running.
+    */
     class VMapManager2 : public IVMapManager
     {
         private:
-            std::mutex m_vmStaticMapMutex;
+            mutable std::mutex m_vmStaticMapMutex;
             std::mutex m_vmModelMutex;
+            std::mutex m_vmQueryLogMutex;
 
         protected:
             // Tree to check collision
             ModelFileMap iLoadedModelFiles;
-            InstanceTreeMap iInstanceMapTrees;
+            InstanceTreeMap iInstanceMapTrees;              // only touched under m_vmStaticMapMutex
+            std::atomic<InstanceTreeMap const*> iPublishedTrees; // copy of iInstanceMapTrees read by the queries
+
+            // line of sight queries recorded for the benchmark
+            std::vector<RecordedLineOfSightQuery> iQueryLog;
+            std::atomic<uint32> iQueryLogRemaining;
 
             bool _loadMap(uint32 pMapId, const std::string& basePath, uint32 tileX, uint32 tileY);
             /* void _unloadMap(uint32 pMapId, uint32 x, uint32 y); */
+            void publishTrees();
+            StaticMapTree const* findPublishedTree(uint32 pMapId) const;
+            void recordQuery(uint32 pMapId, LineOfSightQuery const& query, bool ignoreM2Model);
 
         public:
             // public for debug
@@ -92,6 +115,7 @@ namespace VMAP
             void unloadMap(unsigned int pMapId) override;
 
             bool isInLineOfSight(unsigned int pMapId, float x1, float y1, float z1, float x2, float y2, float z2, bool ignoreM2Model) override;
+            void isInLineOfSight(unsigned int pMapId, LineOfSightQuery const* queries, bool* results, uint32 count, bool ignoreM2Model) override;
             /**
             fill the hit pos and return true, if an object was hit
             */
@@ -105,6 +129,12 @@ namespace VMAP
 
             WorldModel* acquireModelInstance(const std::string& basepath, const std::string& filename);
             void releaseModelInstance(const std::string& filename);
+            // waits until all queries running at the time of the call are finished
+            void synchronizeReaders();
+
+            // records the next maxQueries line of sight queries of all maps, 0 stops recording
+            void startQueryLog(uint32 maxQueries);
+            void getQueryLog(std::vector<RecordedLineOfSightQuery>& queries);
 
             // what's the use of this? o.O
             std::string getDirFileName(unsigned int pMapId, int /*x*/, int /*y*/) const override
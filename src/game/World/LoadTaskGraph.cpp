@@ -0,0 +1,166 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "World/LoadTaskGraph.h"
+#include "Database/DatabaseEnv.h"
+#include "Util/ProgressBar.h"
+#include "Util/Timer.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <thread>
+
+LoadTaskGraph::TaskId LoadTaskGraph::AddTask(char const* name, std::function<void()> function, std::initializer_list<TaskId> dependencies)
+{
+    TaskId id = TaskId(m_tasks.size());
+
+    Task task;
+    task.name = name;
+    task.function = std::move(function);
+    task.pendingDependencies = 0;
+    task.startTime = 0;
+    task.duration = 0;
+
+    for (TaskId dependency : dependencies)
+    {
+        MANGOS_ASSERT(dependency < id);
+        task.dependencies.push_back(dependency);
+        m_tasks[dependency].dependents.push_back(id);
+    }
+
+    m_tasks.push_back(std::move(task));
+    return id;
+}
+
+void LoadTaskGraph::Run(uint32 threadCount)
+{
+    threadCount = std::max(threadCount, uint32(1));
+
+    m_runStart = WorldTimer::getMSTime();
+    m_remaining = uint32(m_tasks.size());
+    m_ready.clear();
+    for (TaskId id = 0; id < m_tasks.size(); ++id)
+    {
+        m_tasks[id].pendingDependencies = uint32(m_tasks[id].dependencies.size());
+        if (!m_tasks[id].pendingDependencies)
+            m_ready.push_back(id);
+    }
+    std::make_heap(m_ready.begin(), m_ready.end(), std::greater<TaskId>());
+
+    if (threadCount == 1)
+        WorkerThread(0);
+    else
+    {
+        // interleaved bars are unreadable, the timings are logged per task instead
+        bool showBars = BarGoLink::GetOutputState();
+        BarGoLink::SetOutputState(false);
+
+        std::vector<std::thread> threads;
+        for (uint32 i = 1; i < threadCount; ++i)
+            threads.emplace_back(&LoadTaskGraph::WorkerThread, this, i);
+
+        WorkerThread(0);
+
+        for (auto& thread : threads)
+            thread.join();
+
+        BarGoLink::SetOutputState(showBars);
+    }
+
+    LogTimings(threadCount, WorldTimer::getMSTimeDiff(m_runStart, WorldTimer::getMSTime()));
+}
+
+void LoadTaskGraph::WorkerThread(uint32 index)
+{
+    // the calling thread is worker 0 and already set up
+    if (index)
+        WorldDatabase.ThreadStart();
+
+    // with enough connections configured every worker queries on its own one
+    Database::SetThreadQueryConnection(int32(index));
+
+    std::unique_lock<std::mutex> lock(m_lock);
+    while (true)
+    {
+        m_condition.wait(lock, [this] { return !m_ready.empty() || !m_remaining; });
+        if (!m_remaining)
+            break;
+
+        std::pop_heap(m_ready.begin(), m_ready.end(), std::greater<TaskId>());
+        TaskId id = m_ready.back();
+        m_ready.pop_back();
+        lock.unlock();
+
+        Task& task = m_tasks[id];
+        task.startTime = WorldTimer::getMSTimeDiff(m_runStart, WorldTimer::getMSTime());
+        task.function();
+        task.duration = WorldTimer::getMSTimeDiff(m_runStart, WorldTimer::getMSTime()) - task.startTime;
+
+        lock.lock();
+        --m_remaining;
+        for (TaskId dependent : task.dependents)
+        {
+            if (!--m_tasks[dependent].pendingDependencies)
+            {
+                m_ready.push_back(dependent);
+                std::push_heap(m_ready.begin(), m_ready.end(), std::greater<TaskId>());
+            }
+        }
+        m_condition.notify_all();
+    }
+    lock.unlock();
+
+    Database::SetThreadQueryConnection(-1);
+
+    if (index)
+        WorldDatabase.ThreadEnd();
+}
+
+void LoadTaskGraph::LogTimings(uint32 threadCount, uint32 wallTime) const
+{
+    // longest chain of dependent tasks, no thread count can load faster than that
+    std::vector<uint32> pathTime(m_tasks.size(), 0);
+    std::vector<TaskId> pathPrevious(m_tasks.size(), TaskId(-1));
+    TaskId last = 0;
+    uint32 workTime = 0;
+    for (TaskId id = 0; id < m_tasks.size(); ++id)
+    {
+        Task const& task = m_tasks[id];
+        for (TaskId dependency : task.dependencies)
+        {
+            if (pathPrevious[id] == TaskId(-1) || pathTime[dependency] > pathTime[pathPrevious[id]])
+                pathPrevious[id] = dependency;
+        }
+
+        pathTime[id] = task.duration + (pathPrevious[id] != TaskId(-1) ? pathTime[pathPrevious[id]] : 0);
+        if (pathTime[id] > pathTime[last])
+            last = id;
+        workTime += task.duration;
+    }
+
+    std::vector<bool> critical(m_tasks.size(), false);
+    for (TaskId id = last; id != TaskId(-1) && !m_tasks.empty(); id = pathPrevious[id])
+        critical[id] = true;
+
+    sLog.outString("Startup loading: %u tasks on %u threads in %u ms, %u ms of work, critical path %u ms",
+                   uint32(m_tasks.size()), threadCount, wallTime, workTime, m_tasks.empty() ? 0 : pathTime[last]);
+    sLog.outString("    start  duration  task (* on the critical path)");
+    for (TaskId id = 0; id < m_tasks.size(); ++id)
+        sLog.outString(" %8u %9u %c %s", m_tasks[id].startTime, m_tasks[id].duration, critical[id] ? '*' : ' ', m_tasks[id].name.c_str());
+    sLog.outString();
+}
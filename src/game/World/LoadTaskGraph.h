@@ -0,0 +1,71 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_LOADTASKGRAPH_H
+#define MANGOS_LOADTASKGRAPH_H
+
+#include "Common.h"
+
+#include <condition_variable>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Startup loading split in tasks with declared dependencies.
+ * A task may only depend on tasks added before it, so the order of declaration is always
+ * a valid sequential order. With one thread the tasks run exactly in that order, with more
+ * threads every task whose dependencies are done may run, the lowest id first.
+ */
+class LoadTaskGraph
+{
+    public:
+        typedef uint32 TaskId;
+
+        TaskId AddTask(char const* name, std::function<void()> function, std::initializer_list<TaskId> dependencies = {});
+
+        // blocks until all tasks are done, then logs the timings and the critical path
+        void Run(uint32 threadCount);
+
+    private:
+        struct Task
+        {
+            std::string name;
+            std::function<void()> function;
+            std::vector<TaskId> dependencies;
+            std::vector<TaskId> dependents;
+            uint32 pendingDependencies;
+            uint32 startTime;                               // ms since Run
+            uint32 duration;
+        };
+
+        void WorkerThread(uint32 index);
+        void LogTimings(uint32 threadCount, uint32 wallTime) const;
+
+        std::vector<Task> m_tasks;
+
+        std::mutex m_lock;
+        std::condition_variable m_condition;
+        std::vector<TaskId> m_ready;                        // min heap on task id
+        uint32 m_remaining;
+        uint32 m_runStart;
+};
+
+#endif
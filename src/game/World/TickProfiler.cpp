@@ -0,0 +1,277 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "World/TickProfiler.h"
+#include "Server/Opcodes.h"
+#include "Policies/Singleton.h"
+
+#ifdef BUILD_METRICS
+ #include "Metric/Metric.h"
+#endif
+
+INSTANTIATE_SINGLETON_1(TickProfiler);
+
+void TickHistogram::Reset()
+{
+    for (auto& bucket : m_buckets)
+        bucket.store(0, std::memory_order_relaxed);
+    m_count.store(0, std::memory_order_relaxed);
+    m_total.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+uint32 TickHistogram::BucketIndex(uint32 value)
+{
+    if (value < SUB_BUCKETS)
+        return value;
+
+    uint32 msb = 0;
+#if defined(__GNUC__)
+    msb = 31 - __builtin_clz(value);
+#else
+    for (uint32 v = value; v >>= 1;)
+        ++msb;
+#endif
+
+    uint32 shift = msb - SUB_BUCKET_BITS;
+    return ((shift + 1) << SUB_BUCKET_BITS) + ((value >> shift) & (SUB_BUCKETS - 1));
+}
+
+uint32 TickHistogram::BucketValue(uint32 index)
+{
+    if (index < SUB_BUCKETS)
+        return index;
+
+    uint32 shift = (index >> SUB_BUCKET_BITS) - 1;
+    uint64 lower = uint64(SUB_BUCKETS + (index & (SUB_BUCKETS - 1))) << shift;
+    return uint32(lower + (uint64(1) << shift) - 1);
+}
+
+void TickHistogramSnapshot::Merge(TickHistogram const& histogram)
+{
+    for (uint32 i = 0; i < TickHistogram::BUCKETS; ++i)
+        buckets[i] += histogram.m_buckets[i].load(std::memory_order_relaxed);
+
+    count += histogram.m_count.load(std::memory_order_relaxed);
+    total += histogram.m_total.load(std::memory_order_relaxed);
+    max = std::max(max, histogram.m_max.load(std::memory_order_relaxed));
+}
+
+void TickHistogramSnapshot::Subtract(TickHistogramSnapshot const& older)
+{
+    // counters may have been reset in between, never go below zero
+    for (uint32 i = 0; i < TickHistogram::BUCKETS; ++i)
+        buckets[i] = buckets[i] > older.buckets[i] ? buckets[i] - older.buckets[i] : 0;
+
+    count = count > older.count ? count - older.count : 0;
+    total = total > older.total ? total - older.total : 0;
+    max = BucketMax();
+}
+
+uint32 TickHistogramSnapshot::Percentile(double percentile) const
+{
+    uint64 sampleCount = 0;
+    for (uint64 bucket : buckets)
+        sampleCount += bucket;
+
+    if (!sampleCount)
+        return 0;
+
+    uint64 rank = uint64(percentile / 100.0 * double(sampleCount) + 0.5);
+    if (rank < 1)
+        rank = 1;
+
+    uint64 seen = 0;
+    for (uint32 i = 0; i < TickHistogram::BUCKETS; ++i)
+    {
+        seen += buckets[i];
+        if (seen >= rank)
+            return std::min(TickHistogram::BucketValue(i), max ? max : TickHistogram::BucketValue(i));
+    }
+
+    return max;
+}
+
+uint32 TickHistogramSnapshot::BucketMax() const
+{
+    for (uint32 i = TickHistogram::BUCKETS; i > 0; --i)
+        if (buckets[i - 1])
+            return TickHistogram::BucketValue(i - 1);
+
+    return 0;
+}
+
+TickProfiler::ThreadProfile::ThreadProfile() : opcodes(new std::atomic<TickHistogram*>[NUM_MSG_TYPES])
+{
+    for (uint32 i = 0; i < NUM_MSG_TYPES; ++i)
+        opcodes[i].store(nullptr, std::memory_order_relaxed);
+}
+
+TickProfiler::ThreadProfile& TickProfiler::GetThreadProfile()
+{
+    thread_local ThreadProfile* profile = nullptr;
+    if (!profile)
+    {
+        std::lock_guard<std::mutex> guard(m_threadsLock);
+        m_threads.push_back(std::make_unique<ThreadProfile>());
+        profile = m_threads.back().get();
+    }
+
+    return *profile;
+}
+
+void TickProfiler::RecordPhase(TickPhase phase, uint32 mapId, uint32 microseconds)
+{
+    ThreadProfile& profile = GetThreadProfile();
+
+    auto itr = profile.maps.find(mapId);
+    if (itr == profile.maps.end())
+    {
+        std::lock_guard<std::mutex> guard(profile.mapLock);
+        itr = profile.maps.emplace(mapId, std::make_unique<PhaseHistograms>()).first;
+    }
+
+    (*itr->second)[phase].Add(microseconds);
+}
+
+void TickProfiler::RecordOpcode(uint16 opcode, uint32 microseconds)
+{
+    if (opcode >= NUM_MSG_TYPES)
+        return;
+
+    ThreadProfile& profile = GetThreadProfile();
+
+    TickHistogram* histogram = profile.opcodes[opcode].load(std::memory_order_relaxed);
+    if (!histogram)
+    {
+        profile.opcodeStorage.push_back(std::make_unique<TickHistogram>());
+        histogram = profile.opcodeStorage.back().get();
+        profile.opcodes[opcode].store(histogram, std::memory_order_release);
+    }
+
+    histogram->Add(microseconds);
+}
+
+TickProfileSnapshot TickProfiler::GetSnapshot()
+{
+    TickProfileSnapshot snapshot;
+
+    std::lock_guard<std::mutex> guard(m_threadsLock);
+    for (auto& profile : m_threads)
+    {
+        {
+            std::lock_guard<std::mutex> mapGuard(profile->mapLock);
+            for (auto& map : profile->maps)
+            {
+                auto& phases = snapshot.phases[map.first];
+                for (uint32 i = 0; i < MAX_TICK_PHASES; ++i)
+                    phases[i].Merge((*map.second)[i]);
+            }
+        }
+
+        for (uint32 i = 0; i < NUM_MSG_TYPES; ++i)
+            if (TickHistogram const* histogram = profile->opcodes[i].load(std::memory_order_acquire))
+                snapshot.opcodes[i].Merge(*histogram);
+    }
+
+    return snapshot;
+}
+
+void TickProfiler::Reset()
+{
+    // races with the writers are harmless, a few samples may survive the reset
+    std::lock_guard<std::mutex> guard(m_threadsLock);
+    for (auto& profile : m_threads)
+    {
+        {
+            std::lock_guard<std::mutex> mapGuard(profile->mapLock);
+            for (auto& map : profile->maps)
+                for (auto& histogram : *map.second)
+                    histogram.Reset();
+        }
+
+        for (uint32 i = 0; i < NUM_MSG_TYPES; ++i)
+            if (TickHistogram* histogram = profile->opcodes[i].load(std::memory_order_acquire))
+                histogram->Reset();
+    }
+}
+
+char const* TickProfiler::GetPhaseName(TickPhase phase)
+{
+    switch (phase)
+    {
+        case TICK_PHASE_WORLD_UPDATE:           return "world";
+        case TICK_PHASE_MAP_UPDATE:             return "map";
+        case TICK_PHASE_SESSION_UPDATE:         return "session";
+        case TICK_PHASE_PLAYER_UPDATE:          return "player";
+        case TICK_PHASE_CELL_VISIT:             return "cellvisit";
+        case TICK_PHASE_OBJECT_UPDATE:          return "object";
+        case TICK_PHASE_SEND_OBJECT_UPDATES:    return "sendupdates";
+        case TICK_PHASE_GRID_UNLOAD:            return "gridunload";
+        default:                                return "unknown";
+    }
+}
+
+#ifdef BUILD_METRICS
+void TickProfiler::ReportMetrics()
+{
+    TickProfileSnapshot current = GetSnapshot();
+
+    for (auto& map : current.phases)
+    {
+        auto last = m_lastReported.phases.find(map.first);
+        for (uint32 i = 0; i < MAX_TICK_PHASES; ++i)
+        {
+            TickHistogramSnapshot delta = map.second[i];
+            if (last != m_lastReported.phases.end())
+                delta.Subtract(last->second[i]);
+
+            if (!delta.count)
+                continue;
+
+            metric::measurement meas("tick.phase", {
+                { "map_id", map.first == TICK_PROFILER_WORLD_ID ? metric::value("world") : metric::value(map.first) },
+                { "phase", GetPhaseName(TickPhase(i)) }
+            });
+            meas.add_field("count", static_cast<int64>(delta.count));
+            meas.add_field("p50", static_cast<int64>(delta.Percentile(50.0)));
+            meas.add_field("p99", static_cast<int64>(delta.Percentile(99.0)));
+            meas.add_field("max", static_cast<int64>(delta.max));
+        }
+    }
+
+    for (auto& opcode : current.opcodes)
+    {
+        TickHistogramSnapshot delta = opcode.second;
+        auto last = m_lastReported.opcodes.find(opcode.first);
+        if (last != m_lastReported.opcodes.end())
+            delta.Subtract(last->second);
+
+        if (!delta.count)
+            continue;
+
+        metric::measurement meas("tick.opcode", { { "opcode", LookupOpcodeName(opcode.first) } });
+        meas.add_field("count", static_cast<int64>(delta.count));
+        meas.add_field("p50", static_cast<int64>(delta.Percentile(50.0)));
+        meas.add_field("p99", static_cast<int64>(delta.Percentile(99.0)));
+        meas.add_field("max", static_cast<int64>(delta.max));
+    }
+
+    m_lastReported = std::move(current);
+}
+#endif
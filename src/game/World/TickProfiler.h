@@ -0,0 +1,224 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_TICKPROFILER_H
+#define MANGOS_TICKPROFILER_H
+
+#include "Common.h"
+#include "Policies/Singleton.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+enum TickPhase
+{
+    TICK_PHASE_WORLD_UPDATE         = 0,                    // whole World::Update
+    TICK_PHASE_MAP_UPDATE           = 1,                    // whole Map::Update
+    TICK_PHASE_SESSION_UPDATE       = 2,
+    TICK_PHASE_PLAYER_UPDATE        = 3,
+    TICK_PHASE_CELL_VISIT           = 4,
+    TICK_PHASE_OBJECT_UPDATE        = 5,
+    TICK_PHASE_SEND_OBJECT_UPDATES  = 6,
+    TICK_PHASE_GRID_UNLOAD          = 7,
+    MAX_TICK_PHASES
+};
+
+#define TICK_PROFILER_WORLD_ID      uint32(-1)              // map id used for phases not bound to a map
+
+/**
+ * Log-linear histogram of microsecond samples, HDR style.
+ * Values below 8 get an exact bucket, above that every power of two is split in 8 linear
+ * sub buckets so the relative error stays below 12.5% for the whole uint32 range.
+ */
+class TickHistogram
+{
+    public:
+        static uint32 const SUB_BUCKET_BITS = 3;
+        static uint32 const SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+        static uint32 const BUCKETS = SUB_BUCKETS * (32 - SUB_BUCKET_BITS + 1);
+
+        TickHistogram() { Reset(); }
+
+        // single writer, the owning thread
+        void Add(uint32 value)
+        {
+            Increment(m_buckets[BucketIndex(value)], 1);
+            Increment(m_count, 1);
+            Increment(m_total, value);
+            if (value > m_max.load(std::memory_order_relaxed))
+                m_max.store(value, std::memory_order_relaxed);
+        }
+
+        void Reset();
+
+        static uint32 BucketIndex(uint32 value);
+        // highest value which falls in the bucket
+        static uint32 BucketValue(uint32 index);
+
+        friend struct TickHistogramSnapshot;
+
+    private:
+        // not a read-modify-write, there is only one writer
+        template <typename T>
+        static void Increment(std::atomic<T>& counter, uint32 value) { counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed); }
+
+        std::array<std::atomic<uint32>, BUCKETS> m_buckets;
+        std::atomic<uint64> m_count;
+        std::atomic<uint64> m_total;
+        std::atomic<uint32> m_max;
+};
+
+// Plain merged copy of one or more histograms
+struct TickHistogramSnapshot
+{
+    TickHistogramSnapshot() : buckets(), count(0), total(0), max(0) {}
+
+    void Merge(TickHistogram const& histogram);
+    void Subtract(TickHistogramSnapshot const& older);
+    uint32 Percentile(double percentile) const;
+    // upper bound of the highest used bucket, still valid after Subtract
+    uint32 BucketMax() const;
+
+    std::array<uint64, TickHistogram::BUCKETS> buckets;
+    uint64 count;
+    uint64 total;
+    uint32 max;
+};
+
+struct TickProfileSnapshot
+{
+    std::map<uint32 /*map id*/, std::array<TickHistogramSnapshot, MAX_TICK_PHASES>> phases;
+    std::map<uint32 /*opcode*/, TickHistogramSnapshot> opcodes;
+};
+
+/**
+ * Always-on tick profiler.
+ * Each thread records into its own histograms without locking, readers merge all threads.
+ */
+class TickProfiler
+{
+    public:
+        TickProfiler() : m_enabled(true) {}
+
+        bool IsEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+        void SetEnabled(bool enabled) { m_enabled = enabled; }
+
+        void RecordPhase(TickPhase phase, uint32 mapId, uint32 microseconds);
+        void RecordOpcode(uint16 opcode, uint32 microseconds);
+
+        TickProfileSnapshot GetSnapshot();
+        void Reset();
+
+        static char const* GetPhaseName(TickPhase phase);
+
+#ifdef BUILD_METRICS
+        // reports percentiles of the samples gathered since the previous call
+        void ReportMetrics();
+#endif
+
+    private:
+        typedef std::array<TickHistogram, MAX_TICK_PHASES> PhaseHistograms;
+
+        struct ThreadProfile
+        {
+            ThreadProfile();
+
+            std::mutex mapLock;                             // taken by the owner only when adding a map
+            std::unordered_map<uint32, std::unique_ptr<PhaseHistograms>> maps;
+            std::unique_ptr<std::atomic<TickHistogram*>[]> opcodes;
+            std::vector<std::unique_ptr<TickHistogram>> opcodeStorage;
+        };
+
+        ThreadProfile& GetThreadProfile();
+
+        std::atomic<bool> m_enabled;
+
+        std::mutex m_threadsLock;
+        std::vector<std::unique_ptr<ThreadProfile>> m_threads;
+
+#ifdef BUILD_METRICS
+        TickProfileSnapshot m_lastReported;
+#endif
+};
+
+#define sTickProfiler MaNGOS::Singleton<TickProfiler>::Instance()
+
+// Records the lifetime of the scope into the given phase
+class TickPhaseTimer
+{
+    public:
+        TickPhaseTimer(TickPhase phase, uint32 mapId) : m_phase(phase), m_mapId(mapId), m_active(sTickProfiler.IsEnabled())
+        {
+            if (m_active)
+                m_start = std::chrono::steady_clock::now();
+        }
+
+        ~TickPhaseTimer() { Stop(); }
+
+        // records now instead of at scope exit
+        void Stop()
+        {
+            if (m_active)
+                sTickProfiler.RecordPhase(m_phase, m_mapId, Elapsed());
+            m_active = false;
+        }
+
+    private:
+        uint32 Elapsed() const
+        {
+            auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start).count();
+            return elapsed > int64(0xFFFFFFFF) ? 0xFFFFFFFF : uint32(elapsed);
+        }
+
+        TickPhase m_phase;
+        uint32 m_mapId;
+        bool m_active;
+        std::chrono::steady_clock::time_point m_start;
+};
+
+class TickOpcodeTimer
+{
+    public:
+        explicit TickOpcodeTimer(uint16 opcode) : m_opcode(opcode), m_active(sTickProfiler.IsEnabled())
+        {
+            if (m_active)
+                m_start = std::chrono::steady_clock::now();
+        }
+
+        ~TickOpcodeTimer()
+        {
+            if (m_active)
+            {
+                auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start).count();
+                sTickProfiler.RecordOpcode(m_opcode, elapsed > int64(0xFFFFFFFF) ? 0xFFFFFFFF : uint32(elapsed));
+            }
+        }
+
+    private:
+        uint16 m_opcode;
+        bool m_active;
+        std::chrono::steady_clock::time_point m_start;
+};
+
+#endif
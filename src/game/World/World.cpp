@@ -31,6 +31,7 @@
 #include "Server/WorldSession.h"
 #include "Server/WorldPacket.h"
 #include "Entities/Player.h"
+#include "Entities/UpdateData.h"
 #include "Skills/SkillExtraItems.h"
 #include "Skills/SkillDiscovery.h"
 #include "Accounts/AccountMgr.h"
@@ -73,6 +74,10 @@
 #include "Anticheat/Anticheat.hpp"
 #include "LFG/LFGMgr.h"
 #include "Vmap/GameObjectModel.h"
+#include "World/TickProfiler.h"
+#include "World/LoadTaskGraph.h"
+#include "MotionGenerators/PathRequestQueue.h"
+#include "Maps/GridPrefetcher.h"
 
 #ifdef BUILD_AHBOT
  #include "AuctionHouseBot/AuctionHouseBot.h"
@@ -97,6 +102,7 @@ float World::m_MaxVisibleDistanceInBGArenas   = DEFAULT_VISIBILITY_BGARENAS;
 
 float  World::m_relocation_lower_limit_sq = 10.f * 10.f;
 uint32 World::m_relocation_ai_notify_delay = 1000u;
+float  World::m_visibility_incremental_distance = 30.f;
 
 uint32 World::m_currentMSTime = 0;
 TimePoint World::m_currentTime = TimePoint();
@@ -109,6 +115,7 @@ World::World() : mail_timer(0), mail_timer_expires(0), m_NextDailyQuestReset(0),
     m_allowMovement = true;
     m_ShutdownMask = 0;
     m_ShutdownTimer = 0;
+    m_autosaveThrottled = false;
     m_gameTime = time(nullptr);
     m_startTime = m_gameTime;
     m_maxActiveSessionCount = 0;
@@ -158,6 +165,8 @@ void World::CleanupsBeforeStop()
     UpdateSessions(1);                               // real players unload required UpdateSessions call
     sBattleGroundMgr.DeleteAllBattleGrounds();       // unload battleground templates before different singletons destroyed
     sMapMgr.UnloadAll();                             // unload all grids (including locked in memory)
+    sPathRequestQueue.Stop();
+    sGridPrefetcher.Stop();
 }
 
 /// Find a session by its id
@@ -482,6 +491,7 @@ void World::LoadConfigSettings(bool reload)
 
     ///- Read other configuration items from the config file
     setConfigMinMax(CONFIG_UINT32_COMPRESSION, "Compression", 1, 1, 9);
+    UpdateData::SetCompressionLevel(getConfig(CONFIG_UINT32_COMPRESSION));
     setConfig(CONFIG_BOOL_ADDON_CHANNEL, "AddonChannel", true);
     setConfig(CONFIG_BOOL_CLEAN_CHARACTER_DB, "CleanCharacterDB", true);
     setConfig(CONFIG_BOOL_GRID_UNLOAD, "GridUnload", true);
@@ -500,6 +510,7 @@ void World::LoadConfigSettings(bool reload)
     setConfig(CONFIG_BOOL_AUTOLOAD_ACTIVE, "Autoload.Active", true);
 
     setConfig(CONFIG_UINT32_INTERVAL_SAVE, "PlayerSave.Interval", 15 * MINUTE * IN_MILLISECONDS);
+    setConfig(CONFIG_UINT32_SAVE_THROTTLE_QUEUE_SIZE, "PlayerSave.ThrottleQueueSize", 5000);
     setConfigMinMax(CONFIG_UINT32_MIN_LEVEL_STAT_SAVE, "PlayerSave.Stats.MinLevel", 0, 0, MAX_LEVEL);
     setConfig(CONFIG_BOOL_STATS_SAVE_ONLY_ON_LOGOUT, "PlayerSave.Stats.SaveOnlyOnLogout", true);
 
@@ -633,6 +644,10 @@ void World::LoadConfigSettings(bool reload)
     }
 
     setConfig(CONFIG_UINT32_NUM_MAP_THREADS, "MapUpdate.Threads", 3);
+    setConfigMinMax(CONFIG_UINT32_MAP_CELL_UPDATE_MODE, "MapUpdate.CellMode", 0, 0, 2);
+    if (getConfig(CONFIG_UINT32_MAP_CELL_UPDATE_MODE))
+        sLog.outError("MapUpdate.CellMode (%u) is experimental, groups, kill and loot credit and charmed players are not yet guarded between regions.", getConfig(CONFIG_UINT32_MAP_CELL_UPDATE_MODE));
+    setConfigMinMax(CONFIG_UINT32_STARTUP_LOAD_THREADS, "Startup.LoadThreads", 1, 1, 16);
     setConfig(CONFIG_UINT32_SKILL_CHANCE_ORANGE, "SkillChance.Orange", 100);
     setConfig(CONFIG_UINT32_SKILL_CHANCE_YELLOW, "SkillChance.Yellow", 75);
     setConfig(CONFIG_UINT32_SKILL_CHANCE_GREEN,  "SkillChance.Green",  25);
@@ -799,6 +814,7 @@ void World::LoadConfigSettings(bool reload)
 
     m_relocation_ai_notify_delay = sConfig.GetIntDefault("Visibility.AIRelocationNotifyDelay", 1000u);
     m_relocation_lower_limit_sq = pow(sConfig.GetFloatDefault("Visibility.RelocationLowerLimit", 10), 2);
+    m_visibility_incremental_distance = std::max(sConfig.GetFloatDefault("Visibility.IncrementalDistance", 30.0f), 0.0f);
 
     // Visibility on Continents
     m_MaxVisibleDistanceOnContinents      = sConfig.GetFloatDefault("Visibility.Distance.Continents",     DEFAULT_VISIBILITY_DISTANCE);
@@ -873,6 +889,8 @@ void World::LoadConfigSettings(bool reload)
     }
 
     setConfig(CONFIG_BOOL_VMAP_INDOOR_CHECK, "vmap.enableIndoorCheck", true);
+    setConfig(CONFIG_BOOL_VMAP_LOS_CACHE, "vmap.enableLOSCache", true);
+    setConfig(CONFIG_BOOL_VMAP_LOS_CACHE_VERIFY, "vmap.verifyLOSCache", false);
     bool enableLOS = sConfig.GetBoolDefault("vmap.enableLOS", false);
     bool enableHeight = sConfig.GetBoolDefault("vmap.enableHeight", false);
 
@@ -885,6 +903,9 @@ void World::LoadConfigSettings(bool reload)
                    enableLOS, enableHeight, getConfig(CONFIG_BOOL_VMAP_INDOOR_CHECK) ? 1 : 0);
     sLog.outString("WORLD: VMap data directory is: %svmaps", m_dataPath.c_str());
 
+    setConfig(CONFIG_BOOL_TERRAIN_MEMORY_MAPPED, "Terrain.MemoryMapped", true);
+    setConfigMinMax(CONFIG_UINT32_GRID_PREFETCH_LOOKAHEAD, "Terrain.PrefetchLookahead", 10000, 0, 60000);
+
     setConfig(CONFIG_BOOL_MMAP_ENABLED, "mmap.enabled", true);
     std::string ignoreMapIds = sConfig.GetStringDefault("mmap.ignoreMapIds");
     MMAP::MMapFactory::preventPathfindingOnMaps(ignoreMapIds.c_str());
@@ -892,6 +913,13 @@ void World::LoadConfigSettings(bool reload)
 
     setConfig(CONFIG_BOOL_PATH_FIND_OPTIMIZE, "PathFinder.OptimizePath", true);
     setConfig(CONFIG_BOOL_PATH_FIND_NORMALIZE_Z, "PathFinder.NormalizeZ", false);
+    setConfigMinMax(CONFIG_UINT32_PATH_FIND_ASYNC_THREADS, "PathFinder.AsyncThreads", 0, 0, 16);
+    setConfigMinMax(CONFIG_UINT32_PATH_FIND_CACHE_TTL, "PathFinder.CacheTTL", 1000, 0, 10000);
+
+    setConfig(CONFIG_BOOL_TICK_PROFILER, "TickProfiler.Enable", true);
+    sTickProfiler.SetEnabled(getConfig(CONFIG_BOOL_TICK_PROFILER));
+    setConfigMinMax(CONFIG_UINT32_STAT_SYSTEM_CHECK, "StatSystem.Check", 0, 0, 2);
+    setConfigMinMax(CONFIG_UINT32_SPELL_RUNTIME_INFO_CHECK, "SpellRuntimeInfo.Check", 2, 0, 2);
 
     setConfig(CONFIG_UINT32_MAX_RECRUIT_A_FRIEND_BONUS_PLAYER_LEVEL, "Raf.BonusLevel", 60);
     setConfig(CONFIG_UINT32_MAX_RECRUIT_A_FRIEND_BONUS_PLAYER_LEVEL_DIFFERENCE, "Raf.LevelDifference", 4);
@@ -954,456 +982,629 @@ void World::SetInitialWorldSettings()
     ///- Remove the bones (they should not exist in DB though) and old corpses after a restart
     CharacterDatabase.PExecute("DELETE FROM corpse WHERE corpse_type = '0' OR time < (UNIX_TIMESTAMP()-'%u')", 3 * DAY);
 
+    ///- Static and dynamic data, every task lists the tasks whose data it reads
+    LoadTaskGraph graph;
+    LootIdSet ids_set;
+
     // load SQL dbcs first, other DBCs need them
-    sObjectMgr.LoadSQLDBCs();
+    LoadTaskGraph::TaskId sqlDbcs = graph.AddTask("SQL DBC stores", []()
+    {
+        sObjectMgr.LoadSQLDBCs();
+    });
 
     // Load before npc_text, gossip_menu_option, script_texts
-    sLog.outString("Loading broadcast_text...");
-    sObjectMgr.LoadBroadcastText();
+    LoadTaskGraph::TaskId broadcastTexts = graph.AddTask("broadcast texts", []()
+    {
+        sLog.outString("Loading broadcast_text...");
+        sObjectMgr.LoadBroadcastText();
+    });
 
-    sLog.outString("Loading world safe locs ...");
-    LoadWorldSafeLocs();
+    LoadTaskGraph::TaskId dbcStores = graph.AddTask("DBC stores", [this]()
+    {
+        sLog.outString("Loading world safe locs ...");
+        LoadWorldSafeLocs();
 
-    ///- Load the DBC files
-    sLog.outString("Initialize DBC data stores...");
-    LoadDBCStores(m_dataPath);
-    DetectDBCLang();
-    sObjectMgr.SetDbc2StorageLocaleIndex(GetDefaultDbcLocale());    // Get once for all the locale index of DBC language (console/broadcasts)
+        ///- Load the DBC files
+        sLog.outString("Initialize DBC data stores...");
+        LoadDBCStores(m_dataPath);
+        DetectDBCLang();
+        sObjectMgr.SetDbc2StorageLocaleIndex(GetDefaultDbcLocale());    // Get once for all the locale index of DBC language (console/broadcasts)
+    }, { sqlDbcs });
 
-    // Loading cameras for characters creation cinematic
-    sLog.outString("Loading cinematic...");
-    LoadM2Cameras(m_dataPath);
+    graph.AddTask("M2 data", [this]()
+    {
+        // Loading cameras for characters creation cinematic
+        sLog.outString("Loading cinematic...");
+        LoadM2Cameras(m_dataPath);
 
-    sLog.outString("Loading Attachment Data...");
-    LoadM2Attachments(m_dataPath);
+        sLog.outString("Loading Attachment Data...");
+        LoadM2Attachments(m_dataPath);
+    }, { dbcStores });
 
-    sLog.outString("Loading Script Names...");
-    sScriptDevAIMgr.LoadScriptNames();
+    LoadTaskGraph::TaskId scriptNames = graph.AddTask("script names", []()
+    {
+        sLog.outString("Loading Script Names...");
+        sScriptDevAIMgr.LoadScriptNames();
+    });
 
-    sLog.outString("Loading WorldTemplate...");
-    sObjectMgr.LoadWorldTemplate();
+    LoadTaskGraph::TaskId mapTemplates = graph.AddTask("world and instance templates", []()
+    {
+        sLog.outString("Loading WorldTemplate...");
+        sObjectMgr.LoadWorldTemplate();
 
-    sLog.outString("Loading InstanceTemplate...");
-    sObjectMgr.LoadInstanceTemplate();
+        sLog.outString("Loading InstanceTemplate...");
+        sObjectMgr.LoadInstanceTemplate();
+    }, { dbcStores, scriptNames });
 
-    sLog.outString("Loading SkillLineAbilityMultiMaps Data...");
-    sSpellMgr.LoadSkillLineAbilityMaps();
+    LoadTaskGraph::TaskId skillMaps = graph.AddTask("skill line maps", []()
+    {
+        sLog.outString("Loading SkillLineAbilityMultiMaps Data...");
+        sSpellMgr.LoadSkillLineAbilityMaps();
 
-    sLog.outString("Loading SkillRaceClassInfoMultiMap Data...");
-    sSpellMgr.LoadSkillRaceClassInfoMap();
+        sLog.outString("Loading SkillRaceClassInfoMultiMap Data...");
+        sSpellMgr.LoadSkillRaceClassInfoMap();
+    }, { dbcStores });
 
-    ///- Clean up and pack instances
-    sLog.outString("Cleaning up instances...");
-    sMapPersistentStateMgr.CleanupInstances();              // must be called before `creature_respawn`/`gameobject_respawn` tables
+    LoadTaskGraph::TaskId instances = graph.AddTask("instance cleanup and guids", []()
+    {
+        ///- Clean up and pack instances
+        sLog.outString("Cleaning up instances...");
+        sMapPersistentStateMgr.CleanupInstances();              // must be called before `creature_respawn`/`gameobject_respawn` tables
 
-    sLog.outString("Packing instances...");
-    sMapPersistentStateMgr.PackInstances();
+        sLog.outString("Packing instances...");
+        sMapPersistentStateMgr.PackInstances();
 
-    sLog.outString("Packing groups...");
-    sObjectMgr.PackGroupIds();                              // must be after CleanupInstances
+        sLog.outString("Packing groups...");
+        sObjectMgr.PackGroupIds();                              // must be after CleanupInstances
 
-    ///- Init highest guids before any guid using table loading to prevent using not initialized guids in some code.
-    sObjectMgr.SetHighestGuids();                           // must be after PackInstances() and PackGroupIds()
-    sLog.outString();
+        ///- Init highest guids before any guid using table loading to prevent using not initialized guids in some code.
+        sObjectMgr.SetHighestGuids();                           // must be after PackInstances() and PackGroupIds()
+        sLog.outString();
+    }, { mapTemplates });
 
-    sLog.outString("Loading Page Texts...");
-    sObjectMgr.LoadPageTexts();
+    LoadTaskGraph::TaskId pageTexts = graph.AddTask("page texts", []()
+    {
+        sLog.outString("Loading Page Texts...");
+        sObjectMgr.LoadPageTexts();
+    });
 
-    sLog.outString("Loading Game Object Templates...");     // must be after LoadPageTexts
-    std::vector<uint32> transportDisplayIds = sObjectMgr.LoadGameobjectInfo();
-    MMAP::MMapFactory::createOrGetMMapManager()->loadAllGameObjectModels(transportDisplayIds);
+    LoadTaskGraph::TaskId gameObjectTemplates = graph.AddTask("gameobject templates", []()
+    {
+        sLog.outString("Loading Game Object Templates...");     // must be after LoadPageTexts
+        std::vector<uint32> transportDisplayIds = sObjectMgr.LoadGameobjectInfo();
+        MMAP::MMapFactory::createOrGetMMapManager()->loadAllGameObjectModels(transportDisplayIds);
 
-    sLog.outString("Loading GameObject models...");
-    GameObjectModel::LoadGOVmapModels();
-    sLog.outString();
+        sLog.outString("Loading GameObject models...");
+        GameObjectModel::LoadGOVmapModels();
+        sLog.outString();
 
-    // loads GO data
-    sTransportMgr.LoadTransportAnimationAndRotation();
+        // loads GO data
+        sTransportMgr.LoadTransportAnimationAndRotation();
+    }, { dbcStores, scriptNames, pageTexts });
 
-    sLog.outString("Loading Spell Chain Data...");
-    sSpellMgr.LoadSpellChains();
+    LoadTaskGraph::TaskId spellData = graph.AddTask("spell data", []()
+    {
+        sLog.outString("Loading Spell Chain Data...");
+        sSpellMgr.LoadSpellChains();
 
-    sLog.outString("Checking Spell Cone Data...");
-    sObjectMgr.CheckSpellCones();
+        sLog.outString("Checking Spell Cone Data...");
+        sObjectMgr.CheckSpellCones();
 
-    sLog.outString("Loading Spell Elixir types...");
-    sSpellMgr.LoadSpellElixirs();
+        sLog.outString("Loading Spell Elixir types...");
+        sSpellMgr.LoadSpellElixirs();
 
-    sLog.outString("Loading Spell Learn Skills...");
-    sSpellMgr.LoadSpellLearnSkills();                       // must be after LoadSpellChains
+        sLog.outString("Loading Spell Learn Skills...");
+        sSpellMgr.LoadSpellLearnSkills();                       // must be after LoadSpellChains
 
-    sLog.outString("Loading Spell Learn Spells...");
-    sSpellMgr.LoadSpellLearnSpells();
+        sLog.outString("Loading Spell Learn Spells...");
+        sSpellMgr.LoadSpellLearnSpells();
 
-    sLog.outString("Loading Spell Proc Event conditions...");
-    sSpellMgr.LoadSpellProcEvents();
+        sLog.outString("Loading Spell Proc Event conditions...");
+        sSpellMgr.LoadSpellProcEvents();
 
-    sLog.outString("Loading Spell Bonus Data...");
-    sSpellMgr.LoadSpellBonuses();                           // must be after LoadSpellChains
+        sLog.outString("Precomputing Spell Runtime Info...");
+        sSpellMgr.LoadSpellRuntimeInfo();                       // must be after LoadSpellProcEvents
 
-    sLog.outString("Loading Spell Proc Item Enchant...");
-    sSpellMgr.LoadSpellProcItemEnchant();                   // must be after LoadSpellChains
+        sLog.outString("Loading Spell Bonus Data...");
+        sSpellMgr.LoadSpellBonuses();                           // must be after LoadSpellChains
 
-    sLog.outString("Loading Aggro Spells Definitions...");
-    sSpellMgr.LoadSpellThreats();
+        sLog.outString("Loading Spell Proc Item Enchant...");
+        sSpellMgr.LoadSpellProcItemEnchant();                   // must be after LoadSpellChains
 
-    sLog.outString("Loading NPC Texts...");
-    sObjectMgr.LoadGossipText();
+        sLog.outString("Loading Aggro Spells Definitions...");
+        sSpellMgr.LoadSpellThreats();
+    }, { dbcStores, skillMaps });
 
-    sLog.outString("Loading Item Random Enchantments Table...");
-    LoadRandomEnchantmentsTable();
+    LoadTaskGraph::TaskId npcTexts = graph.AddTask("npc texts", []()
+    {
+        sLog.outString("Loading NPC Texts...");
+        sObjectMgr.LoadGossipText();
+    }, { broadcastTexts });
 
-    sLog.outString("Loading Item Templates...");            // must be after LoadRandomEnchantmentsTable and LoadPageTexts
-    sObjectMgr.LoadItemPrototypes();
+    LoadTaskGraph::TaskId itemTemplates = graph.AddTask("item templates", []()
+    {
+        sLog.outString("Loading Item Random Enchantments Table...");
+        LoadRandomEnchantmentsTable();
 
-    sLog.outString("Loading Item converts...");             // must be after LoadItemPrototypes
-    sObjectMgr.LoadItemConverts();
+        sLog.outString("Loading Item Templates...");            // must be after LoadRandomEnchantmentsTable and LoadPageTexts
+        sObjectMgr.LoadItemPrototypes();
 
-    sLog.outString("Loading Item expire converts...");      // must be after LoadItemPrototypes
-    sObjectMgr.LoadItemExpireConverts();
+        sLog.outString("Loading Item converts...");             // must be after LoadItemPrototypes
+        sObjectMgr.LoadItemConverts();
 
-    sLog.outString("Loading Creature Model Based Info Data...");
-    sObjectMgr.LoadCreatureModelInfo();
+        sLog.outString("Loading Item expire converts...");      // must be after LoadItemPrototypes
+        sObjectMgr.LoadItemExpireConverts();
+    }, { dbcStores, scriptNames, pageTexts });
 
-    sLog.outString("Loading Equipment templates...");
-    sObjectMgr.LoadEquipmentTemplates();
+    LoadTaskGraph::TaskId creatureTemplates = graph.AddTask("creature templates", []()
+    {
+        sLog.outString("Loading Creature Model Based Info Data...");
+        sObjectMgr.LoadCreatureModelInfo();
 
-    sLog.outString("Loading Creature Stats...");
-    sObjectMgr.LoadCreatureClassLvlStats();
+        sLog.outString("Loading Equipment templates...");
+        sObjectMgr.LoadEquipmentTemplates();
 
-    sLog.outString("Loading String Ids...");
-    sScriptMgr.LoadStringIds(); // must be before LoadCreatureSpawnDataTemplates
+        sLog.outString("Loading Creature Stats...");
+        sObjectMgr.LoadCreatureClassLvlStats();
 
-    sLog.outString("Loading Creature templates...");
-    sObjectMgr.LoadCreatureTemplates();
+        sLog.outString("Loading String Ids...");
+        sScriptMgr.LoadStringIds(); // must be before LoadCreatureSpawnDataTemplates
 
-    sLog.outString("Loading Creature immunities...");
-    sObjectMgr.LoadCreatureImmunities();
+        sLog.outString("Loading Creature templates...");
+        sObjectMgr.LoadCreatureTemplates();
 
-    sLog.outString("Loading Combat Conditions, Unit Conditions and Worldstate Expressions...");
-    sObjectMgr.LoadConditionsAndExpressions();
+        sLog.outString("Loading Creature immunities...");
+        sObjectMgr.LoadCreatureImmunities();
 
-    sLog.outString("Loading Creature spell lists...");
-    auto spellLists = sObjectMgr.LoadCreatureSpellLists();
+        sLog.outString("Loading Combat Conditions, Unit Conditions and Worldstate Expressions...");
+        sObjectMgr.LoadConditionsAndExpressions();
 
-    sLog.outString("Loading Creature cooldowns...");
-    sObjectMgr.LoadCreatureCooldowns();
+        sLog.outString("Loading Creature spell lists...");
+        auto spellLists = sObjectMgr.LoadCreatureSpellLists();
 
-    sLog.outString("Loading Creature template spells...");
-    sObjectMgr.LoadCreatureTemplateSpells(spellLists);
+        sLog.outString("Loading Creature cooldowns...");
+        sObjectMgr.LoadCreatureCooldowns();
 
-    sLog.outString("Loading Creature Model for race...");   // must be after creature templates
-    sObjectMgr.LoadCreatureModelRace();
+        sLog.outString("Loading Creature template spells...");
+        sObjectMgr.LoadCreatureTemplateSpells(spellLists);
 
-    sLog.outString("Loading Vehicle Accessory...");         // must be after LoadCreatureTemplates
-    sObjectMgr.LoadVehicleAccessory();
+        sLog.outString("Loading Creature Model for race...");   // must be after creature templates
+        sObjectMgr.LoadCreatureModelRace();
 
-    sLog.outString("Loading Vehicle Seat Parameters...");         // must be after dbc load
-    sObjectMgr.LoadVehicleSeatParameters();
+        sLog.outString("Loading Vehicle Accessory...");         // must be after LoadCreatureTemplates
+        sObjectMgr.LoadVehicleAccessory();
 
-    sLog.outString("Loading ItemRequiredTarget...");
-    sObjectMgr.LoadItemRequiredTarget();
+        sLog.outString("Loading Vehicle Seat Parameters...");         // must be after dbc load
+        sObjectMgr.LoadVehicleSeatParameters();
+    }, { dbcStores, scriptNames, itemTemplates, spellData });
 
-    sLog.outString("Loading Reputation Reward Rates...");
-    sObjectMgr.LoadReputationRewardRate();
+    LoadTaskGraph::TaskId reputation = graph.AddTask("reputation and points of interest", []()
+    {
+        sLog.outString("Loading ItemRequiredTarget...");
+        sObjectMgr.LoadItemRequiredTarget();
 
-    sLog.outString("Loading Creature Reputation OnKill Data...");
-    sObjectMgr.LoadReputationOnKill();
+        sLog.outString("Loading Reputation Reward Rates...");
+        sObjectMgr.LoadReputationRewardRate();
 
-    sLog.outString("Loading Reputation Spillover Data...");
-    sObjectMgr.LoadReputationSpilloverTemplate();
+        sLog.outString("Loading Creature Reputation OnKill Data...");
+        sObjectMgr.LoadReputationOnKill();
 
-    sLog.outString("Loading Points Of Interest Data...");
-    sObjectMgr.LoadPointsOfInterest();
+        sLog.outString("Loading Reputation Spillover Data...");
+        sObjectMgr.LoadReputationSpilloverTemplate();
 
-    sLog.outString("Loading Creature Conditional Spawn Data...");  // must be after LoadCreatureTemplates and before LoadCreatures
-    sObjectMgr.LoadCreatureConditionalSpawn();
+        sLog.outString("Loading Points Of Interest Data...");
+        sObjectMgr.LoadPointsOfInterest();
+    }, { creatureTemplates });
 
-    sLog.outString("Loading Creature Spawn Template Data..."); // must be before LoadCreatures
-    sObjectMgr.LoadCreatureSpawnDataTemplates();
+    LoadTaskGraph::TaskId spawns = graph.AddTask("creature and gameobject spawns", []()
+    {
+        sLog.outString("Loading Creature Conditional Spawn Data...");  // must be after LoadCreatureTemplates and before LoadCreatures
+        sObjectMgr.LoadCreatureConditionalSpawn();
 
-    sLog.outString("Loading Creature Spawn Entry Data..."); // must be before LoadCreatures
-    sObjectMgr.LoadCreatureSpawnEntry();
+        sLog.outString("Loading Creature Spawn Template Data..."); // must be before LoadCreatures
+        sObjectMgr.LoadCreatureSpawnDataTemplates();
 
-    sLog.outString("Loading Creature Data...");
-    sObjectMgr.LoadCreatures();
+        sLog.outString("Loading Creature Spawn Entry Data..."); // must be before LoadCreatures
+        sObjectMgr.LoadCreatureSpawnEntry();
 
-    sLog.outString("Loading Gameobject Spawn Entry Data..."); // must be before LoadGameObjects
-    sObjectMgr.LoadGameObjectSpawnEntry();
+        sLog.outString("Loading Creature Data...");
+        sObjectMgr.LoadCreatures();
 
-    sLog.outString("Loading Gameobject Data...");
-    sObjectMgr.LoadGameObjects();
+        sLog.outString("Loading Gameobject Spawn Entry Data..."); // must be before LoadGameObjects
+        sObjectMgr.LoadGameObjectSpawnEntry();
 
-    sLog.outString("Loading SpellsScriptTarget...");
-    sSpellMgr.LoadSpellScriptTarget();                      // must be after LoadCreatureTemplates, LoadCreatures and LoadGameobjectInfo
+        sLog.outString("Loading Gameobject Data...");
+        sObjectMgr.LoadGameObjects();
+    }, { instances, gameObjectTemplates, creatureTemplates });
 
-    sLog.outString("Generating SpellTargetMgr data...\n");
-    SpellTargetMgr::Initialize(); // must be after LoadSpellScriptTarget
+    graph.AddTask("spell script targets", []()
+    {
+        sLog.outString("Loading SpellsScriptTarget...");
+        sSpellMgr.LoadSpellScriptTarget();                      // must be after LoadCreatureTemplates, LoadCreatures and LoadGameobjectInfo
 
-    sLog.outString("Loading pet levelup spells...");
-    sSpellMgr.LoadPetLevelupSpellMap();
+        sLog.outString("Generating SpellTargetMgr data...\n");
+        SpellTargetMgr::Initialize(); // must be after LoadSpellScriptTarget
+    }, { spawns });
 
-    sLog.outString("Loading pet default spell additional to levelup spells...");
-    sSpellMgr.LoadPetDefaultSpells();
+    graph.AddTask("pet spells", []()
+    {
+        sLog.outString("Loading pet levelup spells...");
+        sSpellMgr.LoadPetLevelupSpellMap();
 
-    sLog.outString("Loading Creature Addon Data...");
-    sObjectMgr.LoadCreatureAddons();                        // must be after LoadCreatureTemplates() and LoadCreatures()
-    sLog.outString(">>> Creature Addon Data loaded");
-    sLog.outString();
+        sLog.outString("Loading pet default spell additional to levelup spells...");
+        sSpellMgr.LoadPetDefaultSpells();
+    }, { creatureTemplates });
 
-    sLog.outString("Loading Gameobject Template Addon Data...");
-    sObjectMgr.LoadGameObjectTemplateAddons();
+    LoadTaskGraph::TaskId spawnAddons = graph.AddTask("spawn addons and linking", []()
+    {
+        sLog.outString("Loading Creature Addon Data...");
+        sObjectMgr.LoadCreatureAddons();                        // must be after LoadCreatureTemplates() and LoadCreatures()
+        sLog.outString(">>> Creature Addon Data loaded");
+        sLog.outString();
 
-    sLog.outString("Loading CreatureLinking Data...");      // must be after Creatures
-    sCreatureLinkingMgr.LoadFromDB();
+        sLog.outString("Loading Gameobject Template Addon Data...");
+        sObjectMgr.LoadGameObjectTemplateAddons();
 
-    sLog.outString("Loading Objects Pooling Data...");
-    sPoolMgr.LoadFromDB();
+        sLog.outString("Loading CreatureLinking Data...");      // must be after Creatures
+        sCreatureLinkingMgr.LoadFromDB();
+    }, { spawns });
 
-    sLog.outString("Loading Weather Data...");
-    sWeatherMgr.LoadWeatherZoneChances();
+    LoadTaskGraph::TaskId pools = graph.AddTask("pools", []()
+    {
+        sLog.outString("Loading Objects Pooling Data...");
+        sPoolMgr.LoadFromDB();
+    }, { spawns });
 
-    sLog.outString("Loading Quests...");
-    sObjectMgr.LoadQuests();                                // must be loaded after DBCs, creature_template, item_template, gameobject tables
+    graph.AddTask("weather", []()
+    {
+        sLog.outString("Loading Weather Data...");
+        sWeatherMgr.LoadWeatherZoneChances();
+    }, { dbcStores });
 
-    sLog.outString("Loading Quest POI");
-    sObjectMgr.LoadQuestPOI();
+    LoadTaskGraph::TaskId quests = graph.AddTask("quests", []()
+    {
+        sLog.outString("Loading Quests...");
+        sObjectMgr.LoadQuests();                                // must be loaded after DBCs, creature_template, item_template, gameobject tables
 
-    sLog.outString("Loading Quests Relations...");
-    sObjectMgr.LoadQuestRelations();                        // must be after quest load
-    sLog.outString(">>> Quests Relations loaded");
-    sLog.outString();
+        sLog.outString("Loading Quest POI");
+        sObjectMgr.LoadQuestPOI();
 
-    sLog.outString("Loading Game Event Data...");           // must be after sPoolMgr.LoadFromDB and quests to properly load pool events and quests for events
-    sGameEventMgr.LoadFromDB();
-    sLog.outString(">>> Game Event Data loaded");
-    sLog.outString();
+        sLog.outString("Loading Quests Relations...");
+        sObjectMgr.LoadQuestRelations();                        // must be after quest load
+        sLog.outString(">>> Quests Relations loaded");
+        sLog.outString();
+    }, { spawns });
 
-    sLog.outString("Loading WorldState Names...");          // must be before conditions and dbscripts
-    sObjectMgr.LoadWorldStateNames();
+    LoadTaskGraph::TaskId gameEvents = graph.AddTask("game events", []()
+    {
+        sLog.outString("Loading Game Event Data...");           // must be after sPoolMgr.LoadFromDB and quests to properly load pool events and quests for events
+        sGameEventMgr.LoadFromDB();
+        sLog.outString(">>> Game Event Data loaded");
+        sLog.outString();
+    }, { pools, quests });
 
-    sLog.outString("Loading Conditions...");                // Load Conditions
-    sObjectMgr.LoadConditions();
+    LoadTaskGraph::TaskId conditions = graph.AddTask("conditions", []()
+    {
+        sLog.outString("Loading WorldState Names...");          // must be before conditions and dbscripts
+        sObjectMgr.LoadWorldStateNames();
 
-    sLog.outString("Loading Spawn Groups");                 // must be after creature and GO load
-    sObjectMgr.LoadSpawnGroups();
+        sLog.outString("Loading Conditions...");                // Load Conditions
+        sObjectMgr.LoadConditions();
+    }, { reputation, gameEvents });
 
-    // Not sure if this can be moved up in the sequence (with static data loading) as it uses MapManager
-    sLog.outString("Loading Transports...");
-    sMapMgr.LoadTransports();
+    LoadTaskGraph::TaskId spawnGroups = graph.AddTask("spawn groups", []()
+    {
+        sLog.outString("Loading Spawn Groups");                 // must be after creature and GO load
+        sObjectMgr.LoadSpawnGroups();
+    }, { spawnAddons, conditions });
 
-    sLog.outString("Creating map persistent states for non-instanceable maps...");     // must be after PackInstances(), LoadCreatures(), sPoolMgr.LoadFromDB(), sGameEventMgr.LoadFromDB();
-    sMapPersistentStateMgr.InitWorldMaps();
-    sLog.outString();
+    LoadTaskGraph::TaskId worldMaps = graph.AddTask("transports and world maps", []()
+    {
+        // Not sure if this can be moved up in the sequence (with static data loading) as it uses MapManager
+        sLog.outString("Loading Transports...");
+        sMapMgr.LoadTransports();
 
-    sLog.outString("Loading Creature Respawn Data...");     // must be after LoadCreatures(), and sMapPersistentStateMgr.InitWorldMaps()
-    sMapPersistentStateMgr.LoadCreatureRespawnTimes();
+        sLog.outString("Creating map persistent states for non-instanceable maps...");     // must be after PackInstances(), LoadCreatures(), sPoolMgr.LoadFromDB(), sGameEventMgr.LoadFromDB();
+        sMapPersistentStateMgr.InitWorldMaps();
+        sLog.outString();
 
-    sLog.outString("Loading Gameobject Respawn Data...");   // must be after LoadGameObjects(), and sMapPersistentStateMgr.InitWorldMaps()
-    sMapPersistentStateMgr.LoadGameobjectRespawnTimes();
+        sLog.outString("Loading Creature Respawn Data...");     // must be after LoadCreatures(), and sMapPersistentStateMgr.InitWorldMaps()
+        sMapPersistentStateMgr.LoadCreatureRespawnTimes();
 
-    sLog.outString("Loading UNIT_NPC_FLAG_SPELLCLICK Data...");
-    sObjectMgr.LoadNPCSpellClickSpells();
+        sLog.outString("Loading Gameobject Respawn Data...");   // must be after LoadGameObjects(), and sMapPersistentStateMgr.InitWorldMaps()
+        sMapPersistentStateMgr.LoadGameobjectRespawnTimes();
+    }, { spawnGroups });
 
-    sLog.outString("Loading SpellArea Data...");            // must be after quest load
-    sSpellMgr.LoadSpellAreas();
+    graph.AddTask("spell clicks and spell areas", []()
+    {
+        sLog.outString("Loading UNIT_NPC_FLAG_SPELLCLICK Data...");
+        sObjectMgr.LoadNPCSpellClickSpells();
 
-    sLog.outString("Loading AreaTrigger definitions...");
-    sObjectMgr.LoadAreaTriggerTeleports();                  // must be after item template load
+        sLog.outString("Loading SpellArea Data...");            // must be after quest load
+        sSpellMgr.LoadSpellAreas();
+    }, { conditions });
 
-    sLog.outString("Loading Quest Area Triggers...");
-    sObjectMgr.LoadQuestAreaTriggers();                     // must be after LoadQuests
+    graph.AddTask("area triggers", []()
+    {
+        sLog.outString("Loading AreaTrigger definitions...");
+        sObjectMgr.LoadAreaTriggerTeleports();                  // must be after item template load
 
-    sLog.outString("Loading Tavern Area Triggers...");
-    sObjectMgr.LoadTavernAreaTriggers();
+        sLog.outString("Loading Quest Area Triggers...");
+        sObjectMgr.LoadQuestAreaTriggers();                     // must be after LoadQuests
 
-    sLog.outString("Loading AreaTrigger script names...");
-    sScriptDevAIMgr.LoadAreaTriggerScripts();
+        sLog.outString("Loading Tavern Area Triggers...");
+        sObjectMgr.LoadTavernAreaTriggers();
 
-    sLog.outString("Loading LFG dungeons...");
-    sLFGMgr.LoadLFGDungeons();
+        sLog.outString("Loading AreaTrigger script names...");
+        sScriptDevAIMgr.LoadAreaTriggerScripts();
+    }, { quests });
 
-    sLog.outString("Loading LFG rewards...");
-    sLFGMgr.LoadRewards();
+    graph.AddTask("LFG", []()
+    {
+        sLog.outString("Loading LFG dungeons...");
+        sLFGMgr.LoadLFGDungeons();
 
-    sLog.outString("Loading event id script names...");
-    sScriptDevAIMgr.LoadEventIdScripts();
+        sLog.outString("Loading LFG rewards...");
+        sLFGMgr.LoadRewards();
+    }, { quests });
 
-    sLog.outString("Loading Graveyard-zone links...");
-    LoadGraveyardZones();
+    graph.AddTask("event id script names", []()
+    {
+        sLog.outString("Loading event id script names...");
+        sScriptDevAIMgr.LoadEventIdScripts();
+    }, { gameObjectTemplates, spellData });
 
-    sLog.outString("Loading taxi flight shortcuts...");
-    sObjectMgr.LoadTaxiShortcuts();
+    graph.AddTask("graveyards and taxi shortcuts", [this]()
+    {
+        sLog.outString("Loading Graveyard-zone links...");
+        LoadGraveyardZones();
 
-    sLog.outString("Loading spell target destination coordinates...");
-    sSpellMgr.LoadSpellTargetPositions();
+        sLog.outString("Loading taxi flight shortcuts...");
+        sObjectMgr.LoadTaxiShortcuts();
+    }, { dbcStores });
 
-    sLog.outString("Loading spell pet auras...");
-    sSpellMgr.LoadSpellPetAuras();
+    graph.AddTask("spell positions and pet auras", []()
+    {
+        sLog.outString("Loading spell target destination coordinates...");
+        sSpellMgr.LoadSpellTargetPositions();
 
-    sLog.outString("Loading Player Create Info & Level Stats...");
-    sObjectMgr.LoadPlayerInfo();
-    sLog.outString(">>> Player Create Info & Level Stats loaded");
-    sLog.outString();
+        sLog.outString("Loading spell pet auras...");
+        sSpellMgr.LoadSpellPetAuras();
+    }, { spellData });
 
-    sLog.outString("Loading Exploration BaseXP Data...");
-    sObjectMgr.LoadExplorationBaseXP();
+    graph.AddTask("player create info", []()
+    {
+        sLog.outString("Loading Player Create Info & Level Stats...");
+        sObjectMgr.LoadPlayerInfo();
+        sLog.outString(">>> Player Create Info & Level Stats loaded");
+        sLog.outString();
 
-    sLog.outString("Loading Pet Name Parts...");
-    sObjectMgr.LoadPetNames();
+        sLog.outString("Loading Exploration BaseXP Data...");
+        sObjectMgr.LoadExplorationBaseXP();
 
-    CharacterDatabaseCleaner::CleanDatabase();
-    sLog.outString();
+        sLog.outString("Loading Pet Name Parts...");
+        sObjectMgr.LoadPetNames();
+    }, { itemTemplates, spellData });
 
-    sLog.outString("Loading the max pet number...");
-    sObjectMgr.LoadPetNumber();
+    LoadTaskGraph::TaskId characterCleanup = graph.AddTask("character database cleanup", []()
+    {
+        CharacterDatabaseCleaner::CleanDatabase();
+        sLog.outString();
+    }, { spellData });
 
-    sLog.outString("Loading pet level stats...");
-    sObjectMgr.LoadPetLevelInfo();
+    graph.AddTask("pets, corpses and mail rewards", []()
+    {
+        sLog.outString("Loading the max pet number...");
+        sObjectMgr.LoadPetNumber();
 
-    sLog.outString("Loading Player Corpses...");
-    sObjectMgr.LoadCorpses();
+        sLog.outString("Loading pet level stats...");
+        sObjectMgr.LoadPetLevelInfo();
 
-    sLog.outString("Loading Player level dependent mail rewards...");
-    sObjectMgr.LoadMailLevelRewards();
+        sLog.outString("Loading Player Corpses...");
+        sObjectMgr.LoadCorpses();
 
-    sLog.outString("Loading Loot Tables...");
-    LootIdSet ids_set;
-    LoadLootTables(ids_set);
-    sLog.outString(">>> Loot Tables loaded");
-    sLog.outString();
+        sLog.outString("Loading Player level dependent mail rewards...");
+        sObjectMgr.LoadMailLevelRewards();
+    }, { worldMaps, characterCleanup });
+
+    LoadTaskGraph::TaskId lootTables = graph.AddTask("loot tables", [&ids_set]()
+    {
+        sLog.outString("Loading Loot Tables...");
+        LoadLootTables(ids_set);
+        sLog.outString(">>> Loot Tables loaded");
+        sLog.outString();
+    }, { conditions });
 
-    sLog.outString("Loading Skill Discovery Table...");
-    LoadSkillDiscoveryTable();
+    graph.AddTask("skill tables", []()
+    {
+        sLog.outString("Loading Skill Discovery Table...");
+        LoadSkillDiscoveryTable();
 
-    sLog.outString("Loading Skill Extra Item Table...");
-    LoadSkillExtraItemTable();
+        sLog.outString("Loading Skill Extra Item Table...");
+        LoadSkillExtraItemTable();
 
-    sLog.outString("Loading Skill Fishing base level requirements...");
-    sObjectMgr.LoadFishingBaseSkillLevel();
+        sLog.outString("Loading Skill Fishing base level requirements...");
+        sObjectMgr.LoadFishingBaseSkillLevel();
+    }, { itemTemplates, spellData });
 
-    sLog.outString("Loading Achievements...");
-    sAchievementMgr.LoadAchievementReferenceList();
-    sAchievementMgr.LoadAchievementCriteriaList();
-    sAchievementMgr.LoadAchievementCriteriaRequirements();
-    sAchievementMgr.LoadRewards();
-    sAchievementMgr.LoadRewardLocales();
-    sAchievementMgr.LoadCompletedAchievements();
-    sLog.outString(">>> Achievements loaded");
-    sLog.outString();
+    LoadTaskGraph::TaskId achievements = graph.AddTask("achievements", []()
+    {
+        sLog.outString("Loading Achievements...");
+        sAchievementMgr.LoadAchievementReferenceList();
+        sAchievementMgr.LoadAchievementCriteriaList();
+        sAchievementMgr.LoadAchievementCriteriaRequirements();
+        sAchievementMgr.LoadRewards();
+        sAchievementMgr.LoadRewardLocales();
+        sAchievementMgr.LoadCompletedAchievements();
+        sLog.outString(">>> Achievements loaded");
+        sLog.outString();
 
-    sLog.outString("Loading access requirements...");
-    sObjectMgr.LoadAccessRequirements();                    // must be after achievements
-
-    sLog.outString("Loading Instance encounters data...");  // must be after Creature loading
-    sObjectMgr.LoadInstanceEncounters();
-
-    sLog.outString("Loading Npc Text Id...");
-    sObjectMgr.LoadNpcGossips();                            // must be after load Creature and LoadGossipText
-
-    sLog.outString("Loading Scripts random templates...");  // must be before String calls
-    sScriptMgr.LoadDbScriptRandomTemplates();
-    ///- Load and initialize DBScripts Engine
-    sLog.outString("Loading DB-Scripts Engine...");
-    sScriptMgr.LoadScriptMap(SCRIPT_TYPE_RELAY);                // must be first in dbscripts loading
-    sScriptMgr.LoadScriptMap(SCRIPT_TYPE_GOSSIP);               // must be before gossip menu options
-    sScriptMgr.LoadScriptMap(SCRIPT_TYPE_QUEST_START);          // must be after load Creature/Gameobject(Template/Data) and QuestTemplate
-    sScriptMgr.LoadScriptMap(SCRIPT_TYPE_QUEST_END);            // must be after load Creature/Gameobject(Template/Data) and QuestTemplate
-    sScriptMgr.LoadScriptMap(SCRIPT_TYPE_SPELL);                // must be after load Creature/Gameobject(Template/Data)
-    sScriptMgr.LoadScriptMap(SCRIPT_TYPE_GAMEOBJECT);           // must be after load Creature/Gameobject(Template/Data)
-    sScriptMgr.LoadScriptMap(SCRIPT_TYPE_GAMEOBJECT_TEMPLATE);  // must be after load Creature/Gameobject(Template/Data)
-    sScriptMgr.LoadScriptMap(SCRIPT_TYPE_EVENT);                // must be after load Creature/Gameobject(Template/Data)
-    sScriptMgr.LoadScriptMap(SCRIPT_TYPE_CREATURE_DEATH);       // must be after load Creature/Gameobject(Template/Data)
-    sScriptMgr.LoadScriptMap(SCRIPT_TYPE_CREATURE_MOVEMENT);    // before loading from creature_movement 
-    sLog.outString(">>> Scripts loaded");
-    sLog.outString();
+        sLog.outString("Loading access requirements...");
+        sObjectMgr.LoadAccessRequirements();                    // must be after achievements
+    }, { quests, characterCleanup });
+
+    graph.AddTask("instance encounters", []()
+    {
+        sLog.outString("Loading Instance encounters data...");  // must be after Creature loading
+        sObjectMgr.LoadInstanceEncounters();
+    }, { spawns });
+
+    graph.AddTask("npc gossips", []()
+    {
+        sLog.outString("Loading Npc Text Id...");
+        sObjectMgr.LoadNpcGossips();                            // must be after load Creature and LoadGossipText
+    }, { spawns, npcTexts });
+
+    LoadTaskGraph::TaskId dbScripts = graph.AddTask("db scripts", []()
+    {
+        sLog.outString("Loading Scripts random templates...");  // must be before String calls
+        sScriptMgr.LoadDbScriptRandomTemplates();
+        ///- Load and initialize DBScripts Engine
+        sLog.outString("Loading DB-Scripts Engine...");
+        sScriptMgr.LoadScriptMap(SCRIPT_TYPE_RELAY);                // must be first in dbscripts loading
+        sScriptMgr.LoadScriptMap(SCRIPT_TYPE_GOSSIP);               // must be before gossip menu options
+        sScriptMgr.LoadScriptMap(SCRIPT_TYPE_QUEST_START);          // must be after load Creature/Gameobject(Template/Data) and QuestTemplate
+        sScriptMgr.LoadScriptMap(SCRIPT_TYPE_QUEST_END);            // must be after load Creature/Gameobject(Template/Data) and QuestTemplate
+        sScriptMgr.LoadScriptMap(SCRIPT_TYPE_SPELL);                // must be after load Creature/Gameobject(Template/Data)
+        sScriptMgr.LoadScriptMap(SCRIPT_TYPE_GAMEOBJECT);           // must be after load Creature/Gameobject(Template/Data)
+        sScriptMgr.LoadScriptMap(SCRIPT_TYPE_GAMEOBJECT_TEMPLATE);  // must be after load Creature/Gameobject(Template/Data)
+        sScriptMgr.LoadScriptMap(SCRIPT_TYPE_EVENT);                // must be after load Creature/Gameobject(Template/Data)
+        sScriptMgr.LoadScriptMap(SCRIPT_TYPE_CREATURE_DEATH);       // must be after load Creature/Gameobject(Template/Data)
+        sScriptMgr.LoadScriptMap(SCRIPT_TYPE_CREATURE_MOVEMENT);    // before loading from creature_movement
+        sLog.outString(">>> Scripts loaded");
+        sLog.outString();
 
-    sLog.outString("Loading Scripts text locales...");      // must be after Load*Scripts calls
-    sScriptMgr.LoadDbScriptStrings();
+        sLog.outString("Loading Scripts text locales...");      // must be after Load*Scripts calls
+        sScriptMgr.LoadDbScriptStrings();
+    }, { broadcastTexts, spawnGroups });
 
-    sLog.outString("Loading Gossip Menus...");
-    sObjectMgr.LoadGossipMenus();
+    LoadTaskGraph::TaskId gossipMenus = graph.AddTask("gossip menus", []()
+    {
+        sLog.outString("Loading Gossip Menus...");
+        sObjectMgr.LoadGossipMenus();
+    }, { npcTexts, dbScripts });
 
-    sLog.outString("Loading Vendors...");
-    sObjectMgr.LoadVendorTemplates();                       // must be after load ItemTemplate
-    sObjectMgr.LoadVendors();                               // must be after load CreatureTemplate, VendorTemplate, and ItemTemplate
+    graph.AddTask("vendors", []()
+    {
+        sLog.outString("Loading Vendors...");
+        sObjectMgr.LoadVendorTemplates();                       // must be after load ItemTemplate
+        sObjectMgr.LoadVendors();                               // must be after load CreatureTemplate, VendorTemplate, and ItemTemplate
+    }, { conditions });
 
-    sLog.outString("Loading Trainers...");
-    sObjectMgr.LoadTrainerTemplates();                      // must be after load CreatureTemplate
-    sObjectMgr.LoadTrainers();                              // must be after load CreatureTemplate, TrainerTemplate
+    graph.AddTask("trainers", []()
+    {
+        sLog.outString("Loading Trainers...");
+        sObjectMgr.LoadTrainerTemplates();                      // must be after load CreatureTemplate
+        sObjectMgr.LoadTrainers();                              // must be after load CreatureTemplate, TrainerTemplate
+    }, { conditions });
 
-    sLog.outString("Loading Waypoint scripts...");
+    graph.AddTask("waypoints", []()
+    {
+        sLog.outString("Loading Waypoint scripts...");
 
-    sLog.outString("Loading Waypoints...");
-    sWaypointMgr.Load();
+        sLog.outString("Loading Waypoints...");
+        sWaypointMgr.Load();
+    }, { dbScripts });
 
-    sLog.outString("Loading ReservedNames...");
-    sObjectMgr.LoadReservedPlayersNames();
+    graph.AddTask("reserved names", []()
+    {
+        sLog.outString("Loading ReservedNames...");
+        sObjectMgr.LoadReservedPlayersNames();
+    });
 
-    sLog.outString("Loading GameObjects for quests...");
-    sObjectMgr.LoadGameObjectForQuests();
+    graph.AddTask("gameobjects for quests", []()
+    {
+        sLog.outString("Loading GameObjects for quests...");
+        sObjectMgr.LoadGameObjectForQuests();
+    }, { lootTables });
 
-    sLog.outString("Loading BattleMasters...");
-    sBattleGroundMgr.LoadBattleMastersEntry();
+    graph.AddTask("battlemasters", []()
+    {
+        sLog.outString("Loading BattleMasters...");
+        sBattleGroundMgr.LoadBattleMastersEntry();
 
-    sLog.outString("Loading BattleGround event indexes...");
-    sBattleGroundMgr.LoadBattleEventIndexes();
+        sLog.outString("Loading BattleGround event indexes...");
+        sBattleGroundMgr.LoadBattleEventIndexes();
+    }, { spawns });
 
-    sLog.outString("Loading GameTeleports...");
-    sObjectMgr.LoadGameTele();
+    LoadTaskGraph::TaskId greetings = graph.AddTask("teleports and greetings", []()
+    {
+        sLog.outString("Loading GameTeleports...");
+        sObjectMgr.LoadGameTele();
 
-    sLog.outString("Loading Questgiver Greetings...");
-    sObjectMgr.LoadQuestgiverGreeting();
+        sLog.outString("Loading Questgiver Greetings...");
+        sObjectMgr.LoadQuestgiverGreeting();
 
-    sLog.outString("Loading Trainer Greetings...");
-    sObjectMgr.LoadTrainerGreetings();
+        sLog.outString("Loading Trainer Greetings...");
+        sObjectMgr.LoadTrainerGreetings();
+    }, { creatureTemplates, gameObjectTemplates });
 
-    ///- Loading localization data
-    sLog.outString("Loading Localization strings...");
-    sObjectMgr.LoadCreatureLocales();                       // must be after CreatureInfo loading
-    sObjectMgr.LoadGameObjectLocales();                     // must be after GameobjectInfo loading
-    sObjectMgr.LoadItemLocales();                           // must be after ItemPrototypes loading
-    sObjectMgr.LoadQuestLocales();                          // must be after QuestTemplates loading
-    sObjectMgr.LoadGossipTextLocales();                     // must be after LoadGossipText
-    sObjectMgr.LoadPageTextLocales();                       // must be after PageText loading
-    sObjectMgr.LoadGossipMenuItemsLocales();                // must be after gossip menu items loading
-    sObjectMgr.LoadPointOfInterestLocales();                // must be after POI loading
-    sObjectMgr.LoadQuestgiverGreetingLocales();
-    sObjectMgr.LoadTrainerGreetingLocales();                // must be after CreatureInfo loading
-    sObjectMgr.LoadBroadcastTextLocales();
-    sLog.outString(">>> Localization strings loaded");
-    sLog.outString();
+    graph.AddTask("localization strings", []()
+    {
+        ///- Loading localization data
+        sLog.outString("Loading Localization strings...");
+        sObjectMgr.LoadCreatureLocales();                       // must be after CreatureInfo loading
+        sObjectMgr.LoadGameObjectLocales();                     // must be after GameobjectInfo loading
+        sObjectMgr.LoadItemLocales();                           // must be after ItemPrototypes loading
+        sObjectMgr.LoadQuestLocales();                          // must be after QuestTemplates loading
+        sObjectMgr.LoadGossipTextLocales();                     // must be after LoadGossipText
+        sObjectMgr.LoadPageTextLocales();                       // must be after PageText loading
+        sObjectMgr.LoadGossipMenuItemsLocales();                // must be after gossip menu items loading
+        sObjectMgr.LoadPointOfInterestLocales();                // must be after POI loading
+        sObjectMgr.LoadQuestgiverGreetingLocales();
+        sObjectMgr.LoadTrainerGreetingLocales();                // must be after CreatureInfo loading
+        sObjectMgr.LoadBroadcastTextLocales();
+        sLog.outString(">>> Localization strings loaded");
+        sLog.outString();
+    }, { quests, gossipMenus, greetings });
 
     ///- Load dynamic data tables from the database
-    sLog.outString("Loading Auctions...");
-    sAuctionMgr.LoadAuctionItems();
-    sAuctionMgr.LoadAuctions();
-    sLog.outString(">>> Auctions loaded");
-    sLog.outString();
+    LoadTaskGraph::TaskId auctions = graph.AddTask("auctions", []()
+    {
+        sLog.outString("Loading Auctions...");
+        sAuctionMgr.LoadAuctionItems();
+        sAuctionMgr.LoadAuctions();
+        sLog.outString(">>> Auctions loaded");
+        sLog.outString();
+    }, { instances, itemTemplates });
 
-    sLog.outString("Loading Guilds...");
-    sGuildMgr.LoadGuilds();
+    graph.AddTask("guilds, arena teams and groups", []()
+    {
+        sLog.outString("Loading Guilds...");
+        sGuildMgr.LoadGuilds();
 
-    sLog.outString("Loading ArenaTeams...");
-    sObjectMgr.LoadArenaTeams();
+        sLog.outString("Loading ArenaTeams...");
+        sObjectMgr.LoadArenaTeams();
 
-    sLog.outString("Loading Groups...");
-    sObjectMgr.LoadGroups();
+        sLog.outString("Loading Groups...");
+        sObjectMgr.LoadGroups();
 
-    sCalendarMgr.LoadCalendarsFromDB();
+        sCalendarMgr.LoadCalendarsFromDB();
+    }, { worldMaps, achievements, auctions });
 
-    sLog.outString("Returning old mails...");
-    sObjectMgr.ReturnOrDeleteOldMails(false);
+    graph.AddTask("old mails", []()
+    {
+        sLog.outString("Returning old mails...");
+        sObjectMgr.ReturnOrDeleteOldMails(false);
+    }, { auctions });
 
-    sLog.outString("Loading GM tickets...");
-    sTicketMgr.LoadGMTickets();
+    graph.AddTask("GM tickets", []()
+    {
+        sLog.outString("Loading GM tickets...");
+        sTicketMgr.LoadGMTickets();
+    });
 
     ///- Load and initialize EventAI Scripts
-    sLog.outString("Loading CreatureEventAI Summons...");
-    sEventAIMgr.LoadCreatureEventAI_Summons(false);         // false, will checked in LoadCreatureEventAI_Scripts
+    graph.AddTask("creature EventAI", []()
+    {
+        sLog.outString("Loading CreatureEventAI Summons...");
+        sEventAIMgr.LoadCreatureEventAI_Summons(false);         // false, will checked in LoadCreatureEventAI_Scripts
+
+        sLog.outString("Loading CreatureEventAI Scripts...");
+        sEventAIMgr.LoadCreatureEventAI_Scripts();
+    }, { dbScripts });
 
-    sLog.outString("Loading CreatureEventAI Scripts...");
-    sEventAIMgr.LoadCreatureEventAI_Scripts();
+    graph.Run(getConfig(CONFIG_UINT32_STARTUP_LOAD_THREADS));
 
     ///- Load and initialize scripting library
     sLog.outString("Initializing Scripting Library...");
@@ -1465,6 +1666,9 @@ void World::SetInitialWorldSettings()
     ///- Initialize MapManager
     sLog.outString("Starting Map System");
     sMapMgr.Initialize();
+    sPathRequestQueue.Start(getConfig(CONFIG_UINT32_PATH_FIND_ASYNC_THREADS));
+    if (getConfig(CONFIG_UINT32_GRID_PREFETCH_LOOKAHEAD))
+        sGridPrefetcher.Start();
     sLog.outString();
 
     ///- Initialize Battlegrounds
@@ -1531,6 +1735,15 @@ void World::SetInitialWorldSettings()
 #ifdef BUILD_PLAYERBOT
     PlayerbotMgr::SetInitialWorldSettings();
 #endif
+
+    // all spell loads are done, the precomputed spell values must still match the checks they replace
+    if (sSpellMgr.CheckSpellRuntimeInfo() && getConfig(CONFIG_UINT32_SPELL_RUNTIME_INFO_CHECK) >= 2)
+    {
+        sLog.outError("Precomputed spell runtime info differs from the spell template, see the errors above (SpellRuntimeInfo.Check)");
+        Log::WaitBeforeContinueIfNeed();
+        exit(1);
+    }
+
     sLog.outString("---------------------------------------");
     sLog.outString("      CMANGOS: World initialized       ");
     sLog.outString("---------------------------------------");
@@ -1594,6 +1807,8 @@ void World::Update(uint32 diff)
     m_currentTime = std::chrono::time_point_cast<std::chrono::milliseconds>(Clock::now());
     m_currentDiff = diff;
 
+    TickPhaseTimer worldTimer(TICK_PHASE_WORLD_UPDATE, TICK_PROFILER_WORLD_ID);
+
     ///- Update the different timers
     for (auto& m_timer : m_timers)
     {
@@ -1657,7 +1872,10 @@ void World::Update(uint32 diff)
 #ifdef BUILD_METRICS
     auto preSessionTime = std::chrono::time_point_cast<std::chrono::milliseconds>(Clock::now());
 #endif
-    UpdateSessions(diff);
+    {
+        TickPhaseTimer sessionTimer(TICK_PHASE_SESSION_UPDATE, TICK_PROFILER_WORLD_ID);
+        UpdateSessions(diff);
+    }
 
     /// <li> Update uptime table
     if (m_timers[WUPDATE_UPTIME].Passed())
@@ -1669,6 +1887,10 @@ void World::Update(uint32 diff)
         LoginDatabase.PExecute("UPDATE uptime SET uptime = %u, maxplayers = %u WHERE realmid = %u AND starttime = " UI64FMTD, tmpDiff, maxClientsNum, realmID, uint64(m_startTime));
     }
 
+    ///- Hold back autosaves while the character database is behind, logout and manual saves still go through
+    uint32 saveThrottleQueueSize = getConfig(CONFIG_UINT32_SAVE_THROTTLE_QUEUE_SIZE);
+    m_autosaveThrottled = saveThrottleQueueSize && CharacterDatabase.GetAsyncQueueSize() > saveThrottleQueueSize;
+
     /// <li> Handle all other objects
     ///- Update objects (maps, transport, creatures,...)
 #ifdef BUILD_METRICS
@@ -1734,6 +1956,10 @@ void World::Update(uint32 diff)
     {
         m_timers[WUPDATE_METRICS].Reset();
         GeneratePacketMetrics();
+        GenerateDatabaseMetrics();
+        sTickProfiler.ReportMetrics();
+        sPathRequestQueue.ReportMetrics();
+        sGridPrefetcher.ReportMetrics();
     }
 #endif
 
@@ -2809,6 +3035,31 @@ void World::IncrementOpcodeCounter(uint32 opcodeId)
 }
 
 #ifdef BUILD_METRICS
+void World::GenerateDatabaseMetrics()
+{
+    std::pair<char const*, Database*> const databases[] =
+    {
+        { "world", &WorldDatabase }, { "character", &CharacterDatabase }, { "login", &LoginDatabase }, { "logs", &LogsDatabase }
+    };
+
+    for (auto const& database : databases)
+    {
+        std::vector<SqlDelayThreadStats> stats = database.second->ConsumeAsyncStats();
+        for (uint32 i = 0; i < stats.size(); ++i)
+        {
+            metric::measurement meas("world.metrics.database.async", { { "database", database.first }, { "connection", i } });
+            meas.add_field("queued", stats[i].queued);
+            meas.add_field("executed", stats[i].executed);
+            meas.add_field("batches", stats[i].batches);
+            meas.add_field("avg_wait", stats[i].executed ? stats[i].waitTime / stats[i].executed : uint64(0));
+            meas.add_field("max_wait", stats[i].maxWait);
+        }
+    }
+
+    metric::measurement meas_autosave("world.metrics.database.autosave");
+    meas_autosave.add_field("throttled", bool(m_autosaveThrottled));
+}
+
 void World::GeneratePacketMetrics()
 {
     for (uint32 i = 0; i < NUM_MSG_TYPES; ++i)
@@ -41,6 +41,7 @@
 #include <utility>
 #include <vector>
 #include <array>
+#include <atomic>
 #include <thread>
 
 class Object;
@@ -98,6 +99,7 @@ enum eConfigUInt32Values
 {
     CONFIG_UINT32_COMPRESSION = 0,
     CONFIG_UINT32_INTERVAL_SAVE,
+    CONFIG_UINT32_SAVE_THROTTLE_QUEUE_SIZE,
     CONFIG_UINT32_INTERVAL_GRIDCLEAN,
     CONFIG_UINT32_INTERVAL_MAPUPDATE,
     CONFIG_UINT32_INTERVAL_CHANGEWEATHER,
@@ -151,6 +153,13 @@ enum eConfigUInt32Values
     CONFIG_UINT32_MASS_MAILER_SEND_PER_TICK,
     CONFIG_UINT32_UPTIME_UPDATE,
     CONFIG_UINT32_NUM_MAP_THREADS,
+    CONFIG_UINT32_MAP_CELL_UPDATE_MODE,
+    CONFIG_UINT32_STARTUP_LOAD_THREADS,
+    CONFIG_UINT32_PATH_FIND_ASYNC_THREADS,
+    CONFIG_UINT32_PATH_FIND_CACHE_TTL,
+    CONFIG_UINT32_STAT_SYSTEM_CHECK,
+    CONFIG_UINT32_SPELL_RUNTIME_INFO_CHECK,
+    CONFIG_UINT32_GRID_PREFETCH_LOOKAHEAD,
     CONFIG_UINT32_AUCTION_DEPOSIT_MIN,
     CONFIG_UINT32_SKILL_CHANCE_ORANGE,
     CONFIG_UINT32_SKILL_CHANCE_YELLOW,
@@ -391,6 +400,9 @@ enum eConfigBoolValues
     CONFIG_BOOL_STATS_SAVE_ONLY_ON_LOGOUT,
     CONFIG_BOOL_CLEAN_CHARACTER_DB,
     CONFIG_BOOL_VMAP_INDOOR_CHECK,
+    CONFIG_BOOL_VMAP_LOS_CACHE,
+    CONFIG_BOOL_VMAP_LOS_CACHE_VERIFY,
+    CONFIG_BOOL_TERRAIN_MEMORY_MAPPED,
     CONFIG_BOOL_PET_UNSUMMON_AT_MOUNT,
     CONFIG_BOOL_PET_ATTACK_FROM_BEHIND,
     CONFIG_BOOL_AUTO_DOWNRANK,
@@ -401,6 +413,7 @@ enum eConfigBoolValues
     CONFIG_BOOL_PATH_FIND_NORMALIZE_Z,
     CONFIG_BOOL_ALWAYS_SHOW_QUEST_GREETING,
     CONFIG_BOOL_DISABLE_INSTANCE_RELOCATE,
+    CONFIG_BOOL_TICK_PROFILER,
     CONFIG_BOOL_VALUE_COUNT
 };
 
@@ -582,6 +595,9 @@ class World
         void SendDefenseMessage(uint32 zoneId, int32 textId);
         void SendDefenseMessageBroadcastText(uint32 zoneId, uint32 textId);
 
+        /// Character database async queue is too long, autosaves are postponed
+        bool IsAutosaveThrottled() const { return m_autosaveThrottled; }
+
         /// Are we in the middle of a shutdown?
         bool IsShutdowning() const { return m_ShutdownTimer > 0; }
         void ShutdownServ(uint32 time, uint32 options, uint8 exitcode);
@@ -636,6 +652,7 @@ class World
 
         static float GetRelocationLowerLimitSq() { return m_relocation_lower_limit_sq; }
         static uint32 GetRelocationAINotifyDelay() { return m_relocation_ai_notify_delay; }
+        static float GetVisibilityIncrementalDistance() { return m_visibility_incremental_distance; }
 
         void ProcessCliCommands();
         void QueueCliCommand(const CliCommandHolder* commandHolder) { std::lock_guard<std::mutex> guard(m_cliCommandQueueLock); m_cliCommandQueue.push_back(commandHolder); }
@@ -716,6 +733,7 @@ class World
 
 #ifdef BUILD_METRICS
         void GeneratePacketMetrics(); // thread safe due to atomics
+        void GenerateDatabaseMetrics();
         uint32 GetAverageLatency() const;
 #endif
 
@@ -741,6 +759,8 @@ class World
         uint32 m_ShutdownTimer;
         uint32 m_ShutdownMask;
 
+        std::atomic<bool> m_autosaveThrottled;              // read by the map threads
+
         time_t m_startTime;
         time_t m_gameTime;
         IntervalTimer m_timers[WUPDATE_COUNT];
@@ -774,6 +794,7 @@ class World
 
         static float  m_relocation_lower_limit_sq;
         static uint32 m_relocation_ai_notify_delay;
+        static float  m_visibility_incremental_distance;
 
         // CLI command holder to be thread safe
         std::mutex m_cliCommandQueueLock;
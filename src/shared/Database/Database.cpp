@@ -97,7 +97,7 @@ Database::~Database()
     StopServer();
 }
 
-bool Database::Initialize(const char* infoString, int nConns /*= 1*/)
+bool Database::Initialize(const char* infoString, int nConns /*= 1*/, int nAsyncConns /*= 1*/)
 {
     // Enable logging of SQL commands (usually only GM commands)
     // (See method: PExecuteLog)
@@ -110,6 +110,8 @@ bool Database::Initialize(const char* infoString, int nConns /*= 1*/)
     }
 
     m_pingIntervallms = sConfig.GetIntDefault("MaxPingTime", 30) * (MINUTE * 1000);
+    m_asyncBatchSize = std::max(sConfig.GetIntDefault("DatabaseAsyncBatchSize", 32), 1);
+    m_binaryResults = sConfig.GetBoolDefault("DatabaseBinaryResults", true);
 
     // create DB connections
 
@@ -134,10 +136,21 @@ bool Database::Initialize(const char* infoString, int nConns /*= 1*/)
         m_pQueryConnections.push_back(pConn);
     }
 
-    // create and initialize connection for async requests
-    m_pAsyncConn = CreateConnection();
-    if (!m_pAsyncConn->Initialize(infoString))
-        return false;
+    // create and initialize connections for async requests
+    nAsyncConns = std::min(std::max(nAsyncConns, MIN_CONNECTION_POOL_SIZE), MAX_ASYNC_CONNECTIONS);
+    for (int i = 0; i < nAsyncConns; ++i)
+    {
+        SqlConnection* pConn = CreateConnection();
+        if (!pConn->Initialize(infoString))
+        {
+            delete pConn;
+            return false;
+        }
+
+        m_pAsyncConnections.push_back(pConn);
+    }
+
+    m_pAsyncConn = m_pAsyncConnections.front();
 
     m_pResultQueue = new SqlResultQueue;
 
@@ -150,9 +163,12 @@ void Database::StopServer()
     HaltDelayThread();
 
     delete m_pResultQueue;
-    delete m_pAsyncConn;
-
     m_pResultQueue = nullptr;
+
+    for (auto& m_pAsyncConnection : m_pAsyncConnections)
+        delete m_pAsyncConnection;
+
+    m_pAsyncConnections.clear();
     m_pAsyncConn = nullptr;
 
     for (auto& m_pQueryConnection : m_pQueryConnections)
@@ -161,30 +177,20 @@ void Database::StopServer()
     m_pQueryConnections.clear();
 }
 
-SqlDelayThread* Database::CreateDelayThread()
-{
-    assert(m_pAsyncConn);
-    return new SqlDelayThread(this, m_pAsyncConn);
-}
-
 void Database::InitDelayThread()
 {
-    assert(!m_delayThread);
+    assert(!m_delayPool && !m_pAsyncConnections.empty());
 
-    // New delay thread for delay execute
-    m_threadBody = CreateDelayThread();              // will deleted at m_delayThread delete
-    m_delayThread = new MaNGOS::Thread(m_threadBody);
+    // New delay threads for delay execute, one per async connection
+    m_delayPool = new SqlDelayPool(this, m_pAsyncConnections, m_asyncBatchSize);
 }
 
 void Database::HaltDelayThread()
 {
-    if (!m_threadBody || !m_delayThread) return;
+    if (!m_delayPool) return;
 
-    m_threadBody->Stop();                                   // Stop event
-    m_delayThread->wait();                                  // Wait for flush to DB
-    delete m_delayThread;                                   // This also deletes m_threadBody
-    m_delayThread = nullptr;
-    m_threadBody = nullptr;
+    delete m_delayPool;                                     // Stops the threads once everything is flushed to DB
+    m_delayPool = nullptr;
 }
 
 void Database::ThreadStart()
@@ -213,8 +219,21 @@ void Database::escape_string(std::string& str)
     delete[] buf;
 }
 
+namespace
+{
+    thread_local int32 t_queryConnection = -1;
+}
+
+void Database::SetThreadQueryConnection(int32 index)
+{
+    t_queryConnection = index;
+}
+
 SqlConnection* Database::getQueryConnection()
 {
+    if (t_queryConnection >= 0)
+        return m_pQueryConnections[t_queryConnection % m_nQueryConnPoolSize];
+
     int nCount = 0;
 
     if (m_nQueryCounter == long(1 << 31))
@@ -229,8 +248,9 @@ void Database::Ping()
 {
     const char* sql = "SELECT 1";
 
+    for (auto& m_pAsyncConnection : m_pAsyncConnections)
     {
-        SqlConnection::Lock guard(m_pAsyncConn);
+        SqlConnection::Lock guard(m_pAsyncConnection);
         guard->Query(sql);
     }
 
@@ -303,6 +323,26 @@ std::unique_ptr<QueryResult> Database::PQuery(const char* format, ...)
     return Query(szQuery);
 }
 
+std::unique_ptr<QueryResult> Database::PQueryBinary(const char* format, ...)
+{
+    if (!format)
+        return {};
+
+    va_list ap;
+    char szQuery [MAX_QUERY_LEN];
+    va_start(ap, format);
+    int res = vsnprintf(szQuery, MAX_QUERY_LEN, format, ap);
+    va_end(ap);
+
+    if (res == -1)
+    {
+        sLog.outError("SQL Query truncated (and not execute) for format: %s", format);
+        return {};
+    }
+
+    return QueryBinary(szQuery);
+}
+
 QueryNamedResult* Database::PQueryNamed(const char* format, ...)
 {
     if (!format) return nullptr;
@@ -340,7 +380,7 @@ bool Database::Execute(const char* sql)
             return DirectExecute(sql);
 
         // Simple sql statement
-        m_threadBody->Delay(new SqlPlainRequest(sql));
+        m_delayPool->Delay(new SqlPlainRequest(sql));
     }
 
     return true;
@@ -409,7 +449,7 @@ bool Database::CommitTransaction()
         return CommitTransactionDirect();
 
     // add SqlTransaction to the async queue
-    m_threadBody->Delay(m_currentTransaction.release());
+    m_delayPool->Delay(m_currentTransaction.release());
     return true;
 }
 
@@ -563,7 +603,7 @@ bool Database::ExecuteStmt(const SqlStatementID& id, SqlStmtParameters* params)
             return DirectExecuteStmt(id, params);
 
         // Simple sql statement
-        m_threadBody->Delay(new SqlPreparedRequest(id.ID(), params));
+        m_delayPool->Delay(new SqlPreparedRequest(id.ID(), params));
     }
 
     return true;
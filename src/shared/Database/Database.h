@@ -49,6 +49,8 @@ class SqlConnection
         // public methods for making queries
         virtual std::unique_ptr<QueryResult> Query(const char* sql) = 0;
         virtual QueryNamedResult* QueryNamed(const char* sql) = 0;
+        // same result as Query, but numeric columns are transferred and kept as native values
+        virtual std::unique_ptr<QueryResult> QueryBinary(const char* sql) { return Query(sql); }
 
         // public methods for making requests
         virtual bool Execute(const char* sql) = 0;
@@ -105,10 +107,11 @@ class Database
     public:
         virtual ~Database();
 
-        virtual bool Initialize(const char* infoString, int nConns = 1);
-        // start worker thread for async DB request execution
+        // nConns connections serve sync queries, nAsyncConns connections each get a thread for async requests
+        virtual bool Initialize(const char* infoString, int nConns = 1, int nAsyncConns = 1);
+        // start worker threads for async DB request execution
         virtual void InitDelayThread();
-        // stop worker thread
+        // stop worker threads, waits until all queued requests are executed
         virtual void HaltDelayThread();
 
         /// Synchronous DB queries
@@ -125,6 +128,18 @@ class Database
         }
 
         std::unique_ptr<QueryResult> PQuery(const char* format, ...) ATTR_PRINTF(2, 3);
+
+        // for large loads, fields are read without parsing strings when the driver supports it
+        inline std::unique_ptr<QueryResult> QueryBinary(const char* sql)
+        {
+            SqlConnection::Lock guard(getQueryConnection());
+            return m_binaryResults ? guard->QueryBinary(sql) : guard->Query(sql);
+        }
+        std::unique_ptr<QueryResult> PQueryBinary(const char* format, ...) ATTR_PRINTF(2, 3);
+        bool IsBinaryResultsEnabled() const { return m_binaryResults; }
+
+        // query connection used by the calling thread for every database, -1 picks them in turn
+        static void SetThreadQueryConnection(int32 index);
         QueryNamedResult* PQueryNamed(const char* format, ...) ATTR_PRINTF(2, 3);
 
         bool DirectExecute(const char* sql) const
@@ -221,10 +236,15 @@ class Database
         // NO ASYNC TRANSACTIONS DURING SERVER STARTUP - ONLY DURING RUNTIME!!!
         void AllowAsyncTransactions() { m_allowAsyncTransactions = true; }
 
+        // async requests not executed yet, callers may use it to hold back optional work
+        uint32 GetAsyncQueueSize() const { return m_delayPool ? m_delayPool->GetQueueSize() : 0; }
+        // per async connection, accumulated since the previous call
+        std::vector<SqlDelayThreadStats> ConsumeAsyncStats() { return m_delayPool ? m_delayPool->ConsumeStats() : std::vector<SqlDelayThreadStats>(); }
+
     protected:
         Database() :
             m_nQueryConnPoolSize(1), m_pAsyncConn(nullptr), m_pResultQueue(nullptr),
-            m_threadBody(nullptr), m_delayThread(nullptr), m_allowAsyncTransactions(false),
+            m_delayPool(nullptr), m_asyncBatchSize(1), m_binaryResults(true), m_allowAsyncTransactions(false),
             m_iStmtIndex(-1), m_logSQL(false), m_pingIntervallms(0)
         {
             m_nQueryCounter = -1;
@@ -234,9 +254,6 @@ class Database
 
         // factory method to create SqlConnection objects
         virtual SqlConnection* CreateConnection() = 0;
-        // factory method to create SqlDelayThread objects
-        virtual SqlDelayThread* CreateDelayThread();
-
         // per-thread based storage for SqlTransaction object initialization - no locking is required
         boost::thread_specific_ptr<SqlTransaction> m_currentTransaction;
 
@@ -244,7 +261,7 @@ class Database
 
         // round-robin connection selection
         SqlConnection* getQueryConnection();
-        // for now return one single connection for async requests
+        // connection for direct execution of requests bypassing the delay threads
         SqlConnection* getAsyncConnection() const { return m_pAsyncConn; }
 
         friend class SqlStatement;
@@ -261,12 +278,14 @@ class Database
         typedef std::vector< SqlConnection* > SqlConnectionContainer;
         SqlConnectionContainer m_pQueryConnections;
 
-        // only one single DB connection for transactions
+        // connections of the delay threads, the first one is also used for direct execution
+        SqlConnectionContainer m_pAsyncConnections;
         SqlConnection* m_pAsyncConn;
 
         SqlResultQueue*     m_pResultQueue;                 ///< Transaction queues from diff. threads
-        SqlDelayThread*     m_threadBody;                   ///< Pointer to delay sql executer (owned by m_delayThread)
-        MaNGOS::Thread*     m_delayThread;                  ///< Pointer to executer thread
+        SqlDelayPool*       m_delayPool;                    ///< Delay sql executer threads
+        uint32              m_asyncBatchSize;               ///< single statements grouped in one transaction by the delay threads
+        bool                m_binaryResults;                ///< QueryBinary uses the prepared statement protocol
 
         std::atomic<bool> m_allowAsyncTransactions;         ///< flag which specifies if async transactions are enabled
 
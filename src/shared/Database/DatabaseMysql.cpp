@@ -220,6 +220,55 @@ std::unique_ptr<QueryResult> MySQLConnection::Query(const char* sql)
     return queryResult;
 }
 
+std::unique_ptr<QueryResult> MySQLConnection::QueryBinary(const char* sql)
+{
+    if (!mMysql)
+        return nullptr;
+
+    uint32 _s = WorldTimer::getMSTime();
+
+    MYSQL_STMT* stmt = mysql_stmt_init(mMysql);
+    if (!stmt)
+    {
+        sLog.outErrorDb("SQL: mysql_stmt_init() failed for '%s'", sql);
+        sLog.outErrorDb("SQL ERROR: %s", mysql_error(mMysql));
+        return nullptr;
+    }
+
+    // max_length is needed to size the text column buffers once for the whole result
+    decltype(MYSQL_BIND::is_null_value) updateMaxLength = 1;
+    MYSQL_RES* metadata = nullptr;
+    if (mysql_stmt_prepare(stmt, sql, strlen(sql)) || !(metadata = mysql_stmt_result_metadata(stmt)) ||
+            mysql_stmt_attr_set(stmt, STMT_ATTR_UPDATE_MAX_LENGTH, &updateMaxLength) ||
+            mysql_stmt_execute(stmt) || mysql_stmt_store_result(stmt))
+    {
+        sLog.outErrorDb("SQL: %s", sql);
+        sLog.outErrorDb("query ERROR: %s", metadata || mysql_stmt_errno(stmt) ? mysql_stmt_error(stmt) : "statement returns no result set");
+        if (metadata)
+            mysql_free_result(metadata);
+        mysql_stmt_close(stmt);
+        return nullptr;
+    }
+    DEBUG_FILTER_LOG(LOG_FILTER_SQL_TEXT, "[%u ms] SQL (binary): %s", WorldTimer::getMSTimeDiff(_s, WorldTimer::getMSTime()), sql);
+
+    uint64 rowCount = mysql_stmt_num_rows(stmt);
+    if (!rowCount)
+    {
+        mysql_free_result(metadata);
+        mysql_stmt_free_result(stmt);
+        mysql_stmt_close(stmt);
+        return nullptr;
+    }
+
+    // the result owns the statement from here on, it is closed again when binding or fetching fails
+    auto queryResult = std::make_unique<QueryResultMysql>(stmt, metadata, rowCount, mysql_num_fields(metadata));
+
+    if (!queryResult->NextRow())
+        return nullptr;
+
+    return queryResult;
+}
+
 QueryNamedResult* MySQLConnection::QueryNamed(const char* sql)
 {
     MYSQL_RES* result = nullptr;
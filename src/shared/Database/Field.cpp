@@ -19,6 +19,7 @@
 //#include "DatabaseEnv.h"
 #include "Field.h"
 
+#include <cstdio>
 #include <iomanip>
 
 time_t Field::GetTime() const
@@ -29,3 +30,21 @@ time_t Field::GetTime() const
     ss >> std::get_time(&tm, "%Y-%m-%d %H:%M:%S");
     return std::mktime(&tm);
 }
+
+const char* Field::FormatNumber() const
+{
+    // mValue of a native value is the writable buffer handed over by SetNumberNull
+    char* text = const_cast<char*>(mValue);
+    if (!text[0])
+    {
+        switch (mStorage)
+        {
+            case STORAGE_INT:    snprintf(text, NUMBER_TEXT_SIZE, "%" PRId64, mNumber.integer); break;
+            case STORAGE_UINT:   snprintf(text, NUMBER_TEXT_SIZE, UI64FMTD, static_cast<uint64>(mNumber.integer)); break;
+            case STORAGE_DOUBLE: snprintf(text, NUMBER_TEXT_SIZE, "%.17g", mNumber.real); break;
+            default:             break;
+        }
+    }
+
+    return text;
+}
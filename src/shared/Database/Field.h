@@ -34,8 +34,20 @@ class Field
             DB_TYPE_BOOL    = 0x04
         };
 
-        Field() : mValue(nullptr), mType(DB_TYPE_UNKNOWN) {}
-        Field(const char* value, enum DataTypes type) : mValue(value), mType(type) {}
+        // how the value is held, text as returned by the text protocol or a native value from a prepared statement
+        enum StorageModes
+        {
+            STORAGE_TEXT    = 0,
+            STORAGE_INT     = 1,
+            STORAGE_UINT    = 2,
+            STORAGE_DOUBLE  = 3
+        };
+
+        // room for the text of a native value, owned by the result so fields stay small
+        static size_t const NUMBER_TEXT_SIZE = 32;
+
+        Field() : mValue(nullptr), mNumber(), mType(DB_TYPE_UNKNOWN), mStorage(STORAGE_TEXT) {}
+        Field(const char* value, enum DataTypes type) : mValue(value), mNumber(), mType(type), mStorage(STORAGE_TEXT) {}
 
         ~Field() {}
 
@@ -44,23 +56,37 @@ class Field
 
         const char* GetString() const
         {
+            if (mStorage != STORAGE_TEXT && mValue)
+                return FormatNumber();
+
             return mValue ? mValue : ""; // We need this null check as we do not always null check what we get back from the database everywhere
         }
         std::string GetCppString() const
         {
-            return mValue ? mValue : "";                    // std::string s = 0 have undefine result in C++
+            return GetString();                             // std::string s = 0 have undefine result in C++
         }
-        float GetFloat() const { return mValue ? static_cast<float>(atof(mValue)) : 0.0f; }
-        bool GetBool() const { return mValue ? atoi(mValue) > 0 : false; }
-        int32 GetInt32() const { return mValue ? static_cast<int32>(atol(mValue)) : int32(0); }
-        uint8 GetUInt8() const { return mValue ? static_cast<uint8>(atol(mValue)) : uint8(0); }
-        uint16 GetUInt16() const { return mValue ? static_cast<uint16>(atol(mValue)) : uint16(0); }
-        int16 GetInt16() const { return mValue ? static_cast<int16>(atol(mValue)) : int16(0); }
-        uint32 GetUInt32() const { return mValue ? static_cast<uint32>(atoll(mValue)) : uint32(0); }
+        float GetFloat() const { return static_cast<float>(GetDouble()); }
+        bool GetBool() const { return GetInt64() > 0; }
+        int32 GetInt32() const { return static_cast<int32>(GetInt64()); }
+        uint8 GetUInt8() const { return static_cast<uint8>(GetInt64()); }
+        uint16 GetUInt16() const { return static_cast<uint16>(GetInt64()); }
+        int16 GetInt16() const { return static_cast<int16>(GetInt64()); }
+        uint32 GetUInt32() const { return static_cast<uint32>(GetInt64()); }
         uint64 GetUInt64() const
         {
+            if (!mValue)
+                return 0;
+
+            switch (mStorage)
+            {
+                case STORAGE_INT:
+                case STORAGE_UINT:   return static_cast<uint64>(mNumber.integer);
+                case STORAGE_DOUBLE: return static_cast<uint64>(mNumber.real);
+                default:             break;
+            }
+
             uint64 value = 0;
-            if (!mValue || sscanf(mValue, UI64FMTD, &value) == -1)
+            if (sscanf(mValue, UI64FMTD, &value) == -1)
                 return 0;
 
             return value;
@@ -72,11 +98,54 @@ class Field
         // all we need is to cache pointers returned by different DBMS APIs
         void SetValue(const char* value) { mValue = value; }
 
+        // native values are written by the DBMS API straight into the field, see QueryResultMysql
+        void SetStorage(StorageModes storage) { mStorage = storage; }
+        void* GetNumberBuffer() { return &mNumber; }
+        // text is a NUMBER_TEXT_SIZE buffer of the result which GetString formats the value into
+        void SetNumberNull(bool isNull, char* text) { text[0] = '\0'; mValue = isNull ? nullptr : text; }
+
     private:
         Field(Field const&);
         Field& operator=(Field const&);
 
+        int64 GetInt64() const
+        {
+            if (!mValue)
+                return 0;
+
+            switch (mStorage)
+            {
+                case STORAGE_INT:
+                case STORAGE_UINT:   return mNumber.integer;
+                case STORAGE_DOUBLE: return static_cast<int64>(mNumber.real);
+                default:             return atoll(mValue);
+            }
+        }
+
+        double GetDouble() const
+        {
+            if (!mValue)
+                return 0.0;
+
+            switch (mStorage)
+            {
+                case STORAGE_INT:    return static_cast<double>(mNumber.integer);
+                case STORAGE_UINT:   return static_cast<double>(static_cast<uint64>(mNumber.integer));
+                case STORAGE_DOUBLE: return mNumber.real;
+                default:             return atof(mValue);
+            }
+        }
+
+        // text of a native value, only built when asked for
+        const char* FormatNumber() const;
+
         const char* mValue;
+        union
+        {
+            int64 integer;
+            double real;
+        } mNumber;
         enum DataTypes mType;
+        StorageModes mStorage;
 };
 #endif
@@ -21,8 +21,11 @@
 #include "DatabaseEnv.h"
 #include "Util/Errors.h"
 
+#include <algorithm>
+#include <cstring>
+
 QueryResultMysql::QueryResultMysql(MYSQL_RES* result, MYSQL_FIELD* fields, uint64 rowCount, uint32 fieldCount) :
-    QueryResult(rowCount, fieldCount), mResult(result)
+    QueryResult(rowCount, fieldCount), mResult(result), mStmt(nullptr)
 {
     mCurrentRow = new Field[mFieldCount];
     MANGOS_ASSERT(mCurrentRow);
@@ -31,6 +34,66 @@ QueryResultMysql::QueryResultMysql(MYSQL_RES* result, MYSQL_FIELD* fields, uint6
         mCurrentRow[i].SetType(ConvertNativeType(fields[i].type));
 }
 
+QueryResultMysql::QueryResultMysql(MYSQL_STMT* stmt, MYSQL_RES* metadata, uint64 rowCount, uint32 fieldCount) :
+    QueryResult(rowCount, fieldCount), mResult(metadata), mStmt(stmt),
+    mBinds(new MYSQL_BIND[fieldCount]), mIsNull(new NullFlag[fieldCount]), mLengths(new unsigned long[fieldCount]), mStrings(fieldCount),
+    mNumberTexts(new char[fieldCount * Field::NUMBER_TEXT_SIZE])
+{
+    mCurrentRow = new Field[mFieldCount];
+    MANGOS_ASSERT(mCurrentRow);
+
+    memset(mBinds.get(), 0, sizeof(MYSQL_BIND) * mFieldCount);
+
+    MYSQL_FIELD* fields = mysql_fetch_fields(metadata);
+    for (uint32 i = 0; i < mFieldCount; ++i)
+    {
+        Field& field = mCurrentRow[i];
+        field.SetType(ConvertNativeType(fields[i].type));
+
+        MYSQL_BIND& bind = mBinds[i];
+        bind.is_null = &mIsNull[i];
+        bind.length = &mLengths[i];
+
+        switch (fields[i].type)
+        {
+            case FIELD_TYPE_TINY:
+            case FIELD_TYPE_SHORT:
+            case FIELD_TYPE_LONG:
+            case FIELD_TYPE_INT24:
+            case FIELD_TYPE_LONGLONG:
+                bind.buffer_type = MYSQL_TYPE_LONGLONG;
+                bind.is_unsigned = (fields[i].flags & UNSIGNED_FLAG) != 0;
+                bind.buffer = field.GetNumberBuffer();
+                field.SetStorage(bind.is_unsigned ? Field::STORAGE_UINT : Field::STORAGE_INT);
+                break;
+            case FIELD_TYPE_FLOAT:
+            case FIELD_TYPE_DOUBLE:
+                bind.buffer_type = MYSQL_TYPE_DOUBLE;
+                bind.buffer = field.GetNumberBuffer();
+                field.SetStorage(Field::STORAGE_DOUBLE);
+                break;
+            case FIELD_TYPE_TINY_BLOB:
+            case FIELD_TYPE_MEDIUM_BLOB:
+            case FIELD_TYPE_LONG_BLOB:
+            case FIELD_TYPE_BLOB:
+                // declared length is up to 4GB, max_length holds the longest value of the result
+                BindStringColumn(i, fields[i].max_length);
+                break;
+            default:
+                // everything else keeps the text representation, dates and decimals included
+                BindStringColumn(i, std::max(fields[i].max_length, fields[i].length));
+                break;
+        }
+    }
+
+    if (mysql_stmt_bind_result(mStmt, mBinds.get()))
+    {
+        sLog.outError("SQL ERROR: mysql_stmt_bind_result() failed");
+        sLog.outError("SQL ERROR: %s", mysql_stmt_error(mStmt));
+        EndQuery();
+    }
+}
+
 QueryResultMysql::~QueryResultMysql()
 {
     EndQuery();
@@ -38,6 +101,9 @@ QueryResultMysql::~QueryResultMysql()
 
 bool QueryResultMysql::NextRow()
 {
+    if (mStmt)
+        return NextStmtRow();
+
     if (!mResult)
         return false;
 
@@ -54,6 +120,58 @@ bool QueryResultMysql::NextRow()
     return true;
 }
 
+bool QueryResultMysql::NextStmtRow()
+{
+    int res = mysql_stmt_fetch(mStmt);
+    if (res == 1 || res == MYSQL_NO_DATA)
+    {
+        if (res == 1)
+            sLog.outError("SQL ERROR: %s", mysql_stmt_error(mStmt));
+
+        EndQuery();
+        return false;
+    }
+
+    for (uint32 i = 0; i < mFieldCount; ++i)
+    {
+        MYSQL_BIND& bind = mBinds[i];
+        if (bind.buffer_type != MYSQL_TYPE_STRING)
+        {
+            mCurrentRow[i].SetNumberNull(mIsNull[i], &mNumberTexts[i * Field::NUMBER_TEXT_SIZE]);
+            continue;
+        }
+
+        if (mIsNull[i])
+        {
+            mCurrentRow[i].SetValue(nullptr);
+            continue;
+        }
+
+        // should not happen as the buffers are sized by max_length, but a value can not be cut
+        if (mLengths[i] >= bind.buffer_length)
+        {
+            BindStringColumn(i, mLengths[i]);
+            mysql_stmt_fetch_column(mStmt, &bind, i, 0);
+            mysql_stmt_bind_result(mStmt, mBinds.get());
+        }
+
+        mStrings[i][mLengths[i]] = '\0';
+        mCurrentRow[i].SetValue(mStrings[i].data());
+    }
+
+    return true;
+}
+
+void QueryResultMysql::BindStringColumn(uint32 index, unsigned long size)
+{
+    mStrings[index].resize(size + 1);
+
+    MYSQL_BIND& bind = mBinds[index];
+    bind.buffer_type = MYSQL_TYPE_STRING;
+    bind.buffer = mStrings[index].data();
+    bind.buffer_length = size + 1;
+}
+
 void QueryResultMysql::EndQuery()
 {
     delete[] mCurrentRow;
@@ -64,6 +182,13 @@ void QueryResultMysql::EndQuery()
         mysql_free_result(mResult);
         mResult = nullptr;
     }
+
+    if (mStmt)
+    {
+        mysql_stmt_free_result(mStmt);
+        mysql_stmt_close(mStmt);
+        mStmt = nullptr;
+    }
 }
 
 enum Field::DataTypes QueryResultMysql::ConvertNativeType(enum_field_types mysqlType) const
@@ -29,20 +29,37 @@
 
 #include <mysql.h>
 
+#include <memory>
+#include <vector>
+
 class QueryResultMysql : public QueryResult
 {
     public:
         QueryResultMysql(MYSQL_RES* result, MYSQL_FIELD* fields, uint64 rowCount, uint32 fieldCount);
+        // result of an executed prepared statement, numeric columns are fetched as native values
+        QueryResultMysql(MYSQL_STMT* stmt, MYSQL_RES* metadata, uint64 rowCount, uint32 fieldCount);
 
         ~QueryResultMysql();
 
         bool NextRow() override;
 
     private:
+        typedef decltype(MYSQL_BIND::is_null_value) NullFlag;
+
         enum Field::DataTypes ConvertNativeType(enum_field_types mysqlType) const;
         void EndQuery();
 
-        MYSQL_RES* mResult;
+        bool NextStmtRow();
+        void BindStringColumn(uint32 index, unsigned long size);
+
+        MYSQL_RES* mResult;                                 // result set, metadata only for prepared statements
+
+        MYSQL_STMT* mStmt;
+        std::unique_ptr<MYSQL_BIND[]> mBinds;
+        std::unique_ptr<NullFlag[]> mIsNull;
+        std::unique_ptr<unsigned long[]> mLengths;
+        std::vector<std::vector<char>> mStrings;            // buffers of the columns fetched as text, numbers go into the fields
+        std::unique_ptr<char[]> mNumberTexts;               // text of the numeric columns, only written when asked for
 };
 #endif
 #endif
@@ -325,7 +325,7 @@ void SQLStorageLoaderBase<DerivedLoader, StorageClass>::Load(StorageClass& store
         recordCount = fields[0].GetUInt32();
     }
 
-    queryResult = WorldDatabase.PQuery("SELECT * FROM %s", store.GetTableName());
+    queryResult = WorldDatabase.PQueryBinary("SELECT * FROM %s", store.GetTableName());
 
     if (!queryResult)
     {
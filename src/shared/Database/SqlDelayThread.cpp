@@ -20,14 +20,33 @@
 #include "Database/SqlOperations.h"
 #include "DatabaseEnv.h"
 
-SqlDelayThread::SqlDelayThread(Database* db, SqlConnection* conn) : m_dbEngine(db), m_dbConnection(conn), m_running(true)
+namespace
+{
+    thread_local uint32 t_asyncKey = 0;
+}
+
+SqlAsyncKey::SqlAsyncKey(uint32 key) : m_previous(t_asyncKey)
+{
+    t_asyncKey = key;
+}
+
+SqlAsyncKey::~SqlAsyncKey()
+{
+    t_asyncKey = m_previous;
+}
+
+SqlDelayThread::SqlDelayThread(Database* db, SqlConnection* conn, SqlDelayPool& pool, uint32 index) :
+    m_pool(pool), m_index(index), m_dbEngine(db), m_dbConnection(conn), m_running(true), m_finished(false), m_sleeping(false),
+    m_enqueued(0), m_completed(0), m_executed(0), m_batches(0), m_waitTime(0), m_maxWait(0)
 {
 }
 
 SqlDelayThread::~SqlDelayThread()
 {
-    // process all requests which might have been queued while thread was stopping
-    ProcessRequests();
+    // process all requests which might have been queued while thread was stopping,
+    // the other threads of the pool are gone so there is nothing left to wait for
+    for (auto& op : m_sqlQueue)
+        op.operation->Execute(m_dbConnection);
 }
 
 void SqlDelayThread::run()
@@ -36,26 +55,44 @@ void SqlDelayThread::run()
     mysql_thread_init();
 #endif
 
-    const uint32 loopSleepms = 10;
+    const std::chrono::milliseconds loopSleep(10);
+    const std::chrono::milliseconds pingInterval(m_dbEngine->GetPingIntervall());
 
-    const uint32 pingEveryLoop = m_dbEngine->GetPingIntervall() / loopSleepms;
-
-    uint32 loopCounter = 0;
-    while (m_running)
+    auto lastPing = std::chrono::steady_clock::now();
+    std::deque<QueuedOperation> queue;
+    while (true)
     {
-        // if the running state gets turned off while sleeping
-        // empty the queue before exiting
-        MaNGOS::Thread::Sleep(loopSleepms);
+        {
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            if (m_sqlQueue.empty())
+            {
+                // if the running state gets turned off the queue is emptied before exiting
+                if (!m_running)
+                    break;
 
-        ProcessRequests();
+                m_sleeping = true;
+                m_queueCondition.wait_for(lock, loopSleep);
+                m_sleeping = false;
+            }
 
-        if ((loopCounter++) >= pingEveryLoop)
+            // executing with the lock in place could deadlock with the world thread calling Database::ProcessResultQueue()
+            queue.swap(m_sqlQueue);
+        }
+
+        ProcessRequests(queue);
+
+        // the first thread pings all connections of the database
+        if (m_index == 0 && std::chrono::steady_clock::now() - lastPing >= pingInterval)
         {
-            loopCounter = 0;
+            lastPing = std::chrono::steady_clock::now();
             m_dbEngine->Ping();
         }
     }
 
+    // nobody may wait for requests which arrive after this point
+    m_finished = true;
+    m_pool.OnProgress();
+
 #ifndef DO_POSTGRESQL
     mysql_thread_end();
 #endif
@@ -64,23 +101,219 @@ void SqlDelayThread::run()
 void SqlDelayThread::Stop()
 {
     m_running = false;
+
+    std::lock_guard<std::mutex> guard(m_queueMutex);
+    m_queueCondition.notify_one();
 }
 
-void SqlDelayThread::ProcessRequests()
+void SqlDelayThread::Push(QueuedOperation&& op)
 {
-    std::queue<std::unique_ptr<SqlOperation>> sqlQueue;
-
-    // we need to move the contents of the queue to a local copy because executing these statements with the
-    // lock in place can result in a deadlock with the world thread which calls Database::ProcessResultQueue()
+    bool sleeping;
     {
         std::lock_guard<std::mutex> guard(m_queueMutex);
-        sqlQueue = std::move(m_sqlQueue);
+        m_sqlQueue.push_back(std::move(op));
+        sleeping = m_sleeping;
+    }
+
+    if (sleeping)
+        m_queueCondition.notify_one();
+}
+
+void SqlDelayThread::ProcessRequests(std::deque<QueuedOperation>& queue)
+{
+    while (!queue.empty())
+    {
+        QueuedOperation& op = queue.front();
+        if (!m_pool.IsReady(op.waitFor))
+        {
+            // the other threads may be waiting for the statements of the batch
+            CommitBatch();
+            m_pool.WaitReady(op.waitFor);
+        }
+
+        Execute(op);
+        queue.pop_front();
+    }
+
+    CommitBatch();
+}
+
+void SqlDelayThread::Execute(QueuedOperation& op)
+{
+    uint64 wait = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - op.queueTime).count();
+    m_waitTime.fetch_add(wait, std::memory_order_relaxed);
+    if (wait > m_maxWait.load(std::memory_order_relaxed))
+        m_maxWait.store(wait, std::memory_order_relaxed);
+
+    if (m_pool.m_batchSize > 1 && op.operation->IsBatchable())
+    {
+        m_batch.push_back(std::move(op.operation));
+        if (m_batch.size() >= m_pool.m_batchSize)
+            CommitBatch();
+        return;
+    }
+
+    CommitBatch();
+    op.operation->Execute(m_dbConnection);
+    op.operation.reset();
+    Complete(1);
+}
+
+void SqlDelayThread::CommitBatch()
+{
+    if (m_batch.empty())
+        return;
+
+    if (m_batch.size() == 1)
+        m_batch.front()->Execute(m_dbConnection);
+    else
+    {
+        SqlConnection::Lock guard(m_dbConnection);
+
+        // nothing ran yet if the transaction could not be opened
+        size_t next = 0;
+        if (guard->BeginTransaction())
+        {
+            while (next < m_batch.size() && m_batch[next]->Execute(m_dbConnection))
+                ++next;
+
+            // the statements before a failing one are committed rather than rolled back and replayed,
+            // writes to non transactional tables survive a rollback and would be applied twice
+            // for the same reason a failed commit is not replayed
+            if (guard->CommitTransaction() && next == m_batch.size())
+                m_batches.fetch_add(1, std::memory_order_relaxed);
+
+            // the failing statement is not retried, the independent ones after it run on their own
+            if (next < m_batch.size())
+                ++next;
+        }
+
+        for (; next < m_batch.size(); ++next)
+            m_batch[next]->Execute(m_dbConnection);
     }
 
-    while (!sqlQueue.empty())
+    uint64 count = m_batch.size();
+    m_batch.clear();
+    Complete(count);
+}
+
+void SqlDelayThread::Complete(uint64 count)
+{
+    m_executed.fetch_add(count, std::memory_order_relaxed);
+    m_completed.fetch_add(count);
+    m_pool.OnProgress();
+}
+
+SqlDelayPool::SqlDelayPool(Database* db, std::vector<SqlConnection*> const& connections, uint32 batchSize) :
+    m_batchSize(batchSize), m_progressWaiters(0)
+{
+    MANGOS_ASSERT(!connections.empty() && connections.size() <= MAX_ASYNC_CONNECTIONS);
+
+    for (uint32 i = 0; i < connections.size(); ++i)
+        m_threadBodies.push_back(new SqlDelayThread(db, connections[i], *this, i));
+
+    // started only once all bodies exist, they look at each other
+    for (SqlDelayThread* body : m_threadBodies)
+        m_threads.push_back(new MaNGOS::Thread(body));
+}
+
+SqlDelayPool::~SqlDelayPool()
+{
+    for (SqlDelayThread* body : m_threadBodies)
+        body->Stop();                                       // Stop event
+
+    for (MaNGOS::Thread* thread : m_threads)
+        thread->wait();                                     // Wait for flush to DB
+
+    for (MaNGOS::Thread* thread : m_threads)
+        delete thread;                                      // This also deletes the thread bodies
+}
+
+bool SqlDelayPool::Delay(SqlOperation* sql)
+{
+    SqlDelayThread::QueuedOperation op;
+    op.operation.reset(sql);
+    op.queueTime = std::chrono::steady_clock::now();
+    op.waitFor.fill(0);
+
+    uint32 const count = m_threadBodies.size();
+    uint32 const key = t_asyncKey;
+    // the first thread is left to the operations without key
+    uint32 const target = key && count > 1 ? 1 + key % (count - 1) : 0;
+
+    std::lock_guard<std::mutex> guard(m_routeMutex);
+
+    // remember what was queued before, see SqlDelayPool
+    if (target == 0)
+    {
+        for (uint32 i = 1; i < count; ++i)
+            op.waitFor[i] = m_threadBodies[i]->m_enqueued.load(std::memory_order_relaxed);
+    }
+    else
+        op.waitFor[0] = m_threadBodies[0]->m_enqueued.load(std::memory_order_relaxed);
+
+    SqlDelayThread* thread = m_threadBodies[target];
+    thread->m_enqueued.store(thread->m_enqueued.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    thread->Push(std::move(op));
+    return true;
+}
+
+uint32 SqlDelayPool::GetQueueSize() const
+{
+    uint64 queued = 0;
+    for (SqlDelayThread const* body : m_threadBodies)
+        queued += body->m_enqueued.load(std::memory_order_relaxed) - body->m_completed.load(std::memory_order_relaxed);
+
+    return uint32(queued);
+}
+
+std::vector<SqlDelayThreadStats> SqlDelayPool::ConsumeStats()
+{
+    std::vector<SqlDelayThreadStats> stats;
+    for (SqlDelayThread* body : m_threadBodies)
     {
-        auto const s = std::move(sqlQueue.front());
-        sqlQueue.pop();
-        s->Execute(m_dbConnection);
+        SqlDelayThreadStats threadStats;
+        threadStats.queued = uint32(body->m_enqueued.load(std::memory_order_relaxed) - body->m_completed.load(std::memory_order_relaxed));
+        threadStats.executed = body->m_executed.exchange(0, std::memory_order_relaxed);
+        threadStats.batches = body->m_batches.exchange(0, std::memory_order_relaxed);
+        threadStats.waitTime = body->m_waitTime.exchange(0, std::memory_order_relaxed);
+        threadStats.maxWait = body->m_maxWait.exchange(0, std::memory_order_relaxed);
+        stats.push_back(threadStats);
     }
+
+    return stats;
+}
+
+uint32 SqlDelayPool::GetCurrentKey()
+{
+    return t_asyncKey;
+}
+
+bool SqlDelayPool::IsReady(std::array<uint64, MAX_ASYNC_CONNECTIONS> const& waitFor) const
+{
+    for (uint32 i = 0; i < m_threadBodies.size(); ++i)
+        if (m_threadBodies[i]->m_completed.load() < waitFor[i] && !m_threadBodies[i]->m_finished.load())
+            return false;
+
+    return true;
+}
+
+void SqlDelayPool::WaitReady(std::array<uint64, MAX_ASYNC_CONNECTIONS> const& waitFor)
+{
+    // never deadlocks, an operation only waits for operations queued before it
+    ++m_progressWaiters;
+    {
+        std::unique_lock<std::mutex> lock(m_progressMutex);
+        m_progressCondition.wait(lock, [&]() { return IsReady(waitFor); });
+    }
+    --m_progressWaiters;
+}
+
+void SqlDelayPool::OnProgress()
+{
+    if (!m_progressWaiters.load())
+        return;
+
+    std::lock_guard<std::mutex> guard(m_progressMutex);
+    m_progressCondition.notify_all();
 }
@@ -19,43 +19,152 @@
 #ifndef __SQLDELAYTHREAD_H
 #define __SQLDELAYTHREAD_H
 
+#include "Common.h"
 #include "Multithreading/Threading.h"
 #include "SqlOperations.h"
 
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <memory>
 #include <mutex>
-#include <queue>
+#include <vector>
 
 class Database;
 class SqlOperation;
 class SqlConnection;
+class SqlDelayPool;
 
+#define MAX_ASYNC_CONNECTIONS 16
+
+struct SqlDelayThreadStats
+{
+    uint32 queued;                                          // operations waiting right now
+    uint64 executed;
+    uint64 batches;                                         // transactions opened to group single statements
+    uint64 waitTime;                                        // microseconds operations spent in the queue
+    uint64 maxWait;                                         // microseconds, longest single wait
+};
+
+// Executes the async operations routed to one connection of the pool
 class SqlDelayThread : public MaNGOS::Runnable
 {
+        friend class SqlDelayPool;
+
     private:
-        std::mutex m_queueMutex;
-        std::queue<std::unique_ptr<SqlOperation>> m_sqlQueue;   ///< Queue of SQL statements
+        struct QueuedOperation
+        {
+            std::unique_ptr<SqlOperation> operation;
+            std::chrono::steady_clock::time_point queueTime;
+            std::array<uint64, MAX_ASYNC_CONNECTIONS> waitFor;   ///< operations of each thread which must be completed first
+        };
+
+        SqlDelayPool& m_pool;
+        uint32 m_index;
         Database* m_dbEngine;                                   ///< Pointer to used Database engine
         SqlConnection* m_dbConnection;                          ///< Pointer to DB connection
         std::atomic<bool> m_running;
+        std::atomic<bool> m_finished;                           ///< left the loop, later requests run in the destructor
+
+        std::mutex m_queueMutex;
+        std::condition_variable m_queueCondition;
+        std::deque<QueuedOperation> m_sqlQueue;                 ///< Queue of SQL statements
+        bool m_sleeping;                                        ///< guarded by m_queueMutex
+
+        std::atomic<uint64> m_enqueued;                         ///< only changed under SqlDelayPool::m_routeMutex
+        std::atomic<uint64> m_completed;
+
+        // consecutive single statements, executed in one transaction
+        std::vector<std::unique_ptr<SqlOperation>> m_batch;
+
+        std::atomic<uint64> m_executed;
+        std::atomic<uint64> m_batches;
+        std::atomic<uint64> m_waitTime;
+        std::atomic<uint64> m_maxWait;
+
+        void Push(QueuedOperation&& op);
 
         // process all enqueued requests
-        void ProcessRequests();
+        void ProcessRequests(std::deque<QueuedOperation>& queue);
+        void Execute(QueuedOperation& op);
+        void CommitBatch();
+        void Complete(uint64 count);
 
     public:
-        SqlDelayThread(Database* db, SqlConnection* conn);
+        SqlDelayThread(Database* db, SqlConnection* conn, SqlDelayPool& pool, uint32 index);
         ~SqlDelayThread();
 
-        ///< Put sql statement to delay queue
-        bool Delay(SqlOperation* sql)
-        {
-            std::lock_guard<std::mutex> guard(m_queueMutex);
-            m_sqlQueue.push(std::unique_ptr<SqlOperation>(sql));
-            return true;
-        }
-
         virtual void Stop();                                ///< Stop event
         virtual void run();                                 ///< Main Thread loop
 };
+
+/**
+ * Pool of async connections, each one drained by its own SqlDelayThread.
+ * Operations queued inside a SqlAsyncKey scope go to the thread picked by the key, everything else
+ * goes to the first thread.
+ *
+ * Ordering contract:
+ * - operations without key wait for everything queued before them and are waited for by everything
+ *   queued after them, so they are never reordered with any other operation
+ * - operations with the same key keep their order
+ * - operations with different keys may commit in any order, so they must never write the same rows
+ *
+ * Player::SaveToDB is the only keyed writer and only writes rows of its own character. Rows changing
+ * hands (traded, mailed, auctioned or guild bank items, returned mail) are written right away by the
+ * handler moving them, without key. That write is ordered after the previous save of the old owner
+ * and before the next save of the new one, which never see the same row at the same time.
+ * Keep new keyed writers to rows owned by the key.
+ */
+class SqlDelayPool
+{
+        friend class SqlDelayThread;
+
+    public:
+        SqlDelayPool(Database* db, std::vector<SqlConnection*> const& connections, uint32 batchSize);
+        SqlDelayPool(const SqlDelayPool&) = delete;
+        ~SqlDelayPool();                                    ///< Waits until everything queued is executed
+
+        ///< Put sql statement to delay queue
+        bool Delay(SqlOperation* sql);
+
+        uint32 GetThreadCount() const { return m_threads.size(); }
+        uint32 GetQueueSize() const;
+        // returns statistics accumulated since the previous call
+        std::vector<SqlDelayThreadStats> ConsumeStats();
+
+        static uint32 GetCurrentKey();
+
+    private:
+        bool IsReady(std::array<uint64, MAX_ASYNC_CONNECTIONS> const& waitFor) const;
+        void WaitReady(std::array<uint64, MAX_ASYNC_CONNECTIONS> const& waitFor);
+        void OnProgress();
+
+        uint32 m_batchSize;
+        std::vector<SqlDelayThread*> m_threadBodies;        ///< owned by m_threads
+        std::vector<MaNGOS::Thread*> m_threads;
+
+        std::mutex m_routeMutex;                            ///< gives all queued operations one global order
+
+        std::mutex m_progressMutex;
+        std::condition_variable m_progressCondition;
+        std::atomic<uint32> m_progressWaiters;
+};
+
+// Async operations queued by this thread while the scope is alive are routed by key,
+// operations with the same key keep their order. Only use it for work touching rows owned by the key.
+// A key of 0 queues without key again, for writes that must stay ordered with everything else.
+class SqlAsyncKey
+{
+    public:
+        explicit SqlAsyncKey(uint32 key);
+        ~SqlAsyncKey();
+
+        SqlAsyncKey(const SqlAsyncKey&) = delete;
+        SqlAsyncKey& operator=(const SqlAsyncKey&) = delete;
+
+    private:
+        uint32 m_previous;
+};
 #endif                                                      //__SQLDELAYTHREAD_H
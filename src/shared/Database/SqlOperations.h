@@ -31,7 +31,7 @@
 
 class Database;
 class SqlConnection;
-class SqlDelayThread;
+class SqlDelayPool;
 class SqlStmtParameters;
 
 class SqlOperation
@@ -39,6 +39,8 @@ class SqlOperation
     public:
         virtual void OnRemove() { delete this; }
         virtual bool Execute(SqlConnection* conn) = 0;
+        // single statements without result, the delay thread may group them in one transaction
+        virtual bool IsBatchable() const { return false; }
         virtual ~SqlOperation() {}
 };
 
@@ -52,6 +54,7 @@ class SqlPlainRequest : public SqlOperation
         SqlPlainRequest(const char* sql) : m_sql(mangos_strdup(sql)) {}
         ~SqlPlainRequest() { char* tofree = const_cast<char*>(m_sql); delete[] tofree; }
         bool Execute(SqlConnection* conn) override;
+        bool IsBatchable() const override { return true; }
 };
 
 class SqlTransaction : public SqlOperation
@@ -75,6 +78,7 @@ class SqlPreparedRequest : public SqlOperation
         ~SqlPreparedRequest();
 
         bool Execute(SqlConnection* conn) override;
+        bool IsBatchable() const override { return true; }
 
     private:
         const int m_nIndex;
@@ -130,7 +134,7 @@ class SqlQueryHolder
         void SetSize(size_t size);
         std::unique_ptr<QueryResult> GetResult(size_t index);
         void SetResult(size_t index, std::unique_ptr<QueryResult> queryResult);
-        bool Execute(MaNGOS::IQueryCallback* callback, SqlDelayThread* thread, SqlResultQueue* queue);
+        bool Execute(MaNGOS::IQueryCallback* callback, SqlDelayPool* pool, SqlResultQueue* queue);
 };
 
 class SqlQueryHolderEx : public SqlOperation
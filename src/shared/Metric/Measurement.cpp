@@ -16,58 +16,215 @@
 * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 */
 
-#include <chrono>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <mutex>
 
 #include "Measurement.h"
-#include "Util/Errors.h"
 
-Measurement::Measurement(std::string measurement, std::map<std::string, std::string> tags, std::map<std::string, boost::any> fields,uint64 timestamp)
-    : _measurement(measurement), _tags(tags), _fields(fields)
+namespace
 {
-    if (!timestamp)
+    uint32 const MAX_NAMES = 4096;
+    uint32 const NAME_SLOTS = MAX_NAMES * 2;                // power of two, keeps probing short
+
+    // Append only open addressing table, a slot holds name id + 1 once the name is fully stored
+    class name_table
+    {
+        public:
+            name_table() : m_slots(new std::atomic<uint16>[NAME_SLOTS]), m_names(new std::string[MAX_NAMES]),
+                m_escaped(new std::string[MAX_NAMES]), m_count(0)
+            {
+                for (uint32 i = 0; i < NAME_SLOTS; ++i)
+                    m_slots[i].store(0, std::memory_order_relaxed);
+            }
+
+            metric::name_id intern(std::string_view name)
+            {
+                uint32 const hash = uint32(std::hash<std::string_view>()(name));
+                if (uint16 found = find(name, hash))
+                    return found - 1;
+
+                std::lock_guard<std::mutex> guard(m_lock);
+                uint32 slot = hash & (NAME_SLOTS - 1);
+                for (uint16 id; (id = m_slots[slot].load(std::memory_order_relaxed)); slot = (slot + 1) & (NAME_SLOTS - 1))
+                    if (m_names[id - 1] == name)
+                        return id - 1;
+
+                if (m_count >= MAX_NAMES)
+                    return metric::INVALID_NAME_ID;
+
+                uint32 const index = m_count++;
+                m_names[index] = std::string(name);
+                m_escaped[index] = escape(name);
+                m_slots[slot].store(uint16(index + 1), std::memory_order_release);
+                return metric::name_id(index);
+            }
+
+            std::string const& get(metric::name_id id) const { return m_escaped[id]; }
+
+        private:
+            uint16 find(std::string_view name, uint32 hash) const
+            {
+                for (uint32 slot = hash & (NAME_SLOTS - 1);; slot = (slot + 1) & (NAME_SLOTS - 1))
+                {
+                    uint16 id = m_slots[slot].load(std::memory_order_acquire);
+                    if (!id || m_names[id - 1] == name)
+                        return id;
+                }
+            }
+
+            static std::string escape(std::string_view name)
+            {
+                std::string escaped;
+                for (char c : name)
+                {
+                    if (c == ',' || c == ' ' || c == '=')
+                        escaped += '\\';
+                    escaped += c;
+                }
+                return escaped;
+            }
+
+            std::unique_ptr<std::atomic<uint16>[]> m_slots;
+            std::unique_ptr<std::string[]> m_names;
+            std::unique_ptr<std::string[]> m_escaped;
+            uint32 m_count;
+            std::mutex m_lock;
+    };
+
+    name_table& get_name_table()
     {
-        auto now = std::chrono::system_clock::now();
-        _timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+        static name_table table;
+        return table;
+    }
+
+    void append_number(std::string& out, int64 number)
+    {
+        char buffer[24];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+        out.append(buffer, result.ptr);
+    }
+
+    void append_value(std::string& out, metric::record_entry const& entry, char const* text, bool isTag)
+    {
+        switch (entry.type)
+        {
+            case metric::VALUE_INT:
+                append_number(out, entry.number);
+                if (!isTag)
+                    out += 'i';
+                break;
+            case metric::VALUE_FLOAT:
+            {
+                char buffer[32];
+                int length = snprintf(buffer, sizeof(buffer), "%g", entry.real);
+                out.append(buffer, std::min<size_t>(length, sizeof(buffer) - 1));
+                break;
+            }
+            case metric::VALUE_BOOL:
+                out += entry.number ? 't' : 'f';
+                break;
+            case metric::VALUE_STRING:
+                // string fields are written as given, the caller quotes them
+                if (!isTag)
+                {
+                    out.append(text + entry.offset, entry.length);
+                    break;
+                }
+
+                for (char const* c = text + entry.offset; c != text + entry.offset + entry.length; ++c)
+                {
+                    if (*c == ',' || *c == ' ' || *c == '=')
+                        out += '\\';
+                    out += *c;
+                }
+                break;
+        }
     }
-    else
-        _timestamp = timestamp;
 }
 
-std::stringstream& operator<<(std::stringstream& out, const Measurement& measurement)
+metric::name_id metric::intern_name(std::string_view name)
 {
-    out << measurement._measurement;
+    return get_name_table().intern(name);
+}
 
-    for (const auto& tag : measurement._tags)
-        out << "," << tag.first << "=" << tag.second;
+std::string const& metric::get_name(name_id id)
+{
+    return get_name_table().get(id);
+}
 
-    out << " ";
+void metric::append_line(std::string& out, record_header const* record)
+{
+    record_entry const* tags = reinterpret_cast<record_entry const*>(record + 1);
+    record_entry const* fields = tags + record->tagCount;
+    char const* text = reinterpret_cast<char const*>(fields + record->fieldCount);
+
+    out += get_name(record->name);
+
+    for (uint8 i = 0; i < record->tagCount; ++i)
+    {
+        out += ',';
+        out += get_name(tags[i].key);
+        out += '=';
+        append_value(out, tags[i], text, true);
+    }
+
+    out += ' ';
+
+    for (uint8 i = 0; i < record->fieldCount; ++i)
+    {
+        if (i)
+            out += ',';
+        out += get_name(fields[i].key);
+        out += '=';
+        append_value(out, fields[i], text, false);
+    }
+
+    out += ' ';
+    append_number(out, int64(record->timestamp));
+    out += '\n';
+}
+
+metric::measurement_ring::measurement_ring(uint32 capacity) : m_head(0), m_tail(0), m_dropped(0), m_released(false), m_pending(0)
+{
+    uint64 size = sizeof(record_header);
+    while (size < capacity)
+        size <<= 1;
+
+    m_storage.reset(new uint64[size / sizeof(uint64)]);
+    m_buffer = reinterpret_cast<uint8*>(m_storage.get());
+    m_mask = size - 1;
+}
 
-    MANGOS_ASSERT(measurement._fields.size() > 0);
+uint8* metric::measurement_ring::begin_write(uint32 size)
+{
+    uint64 const tail = m_tail.load(std::memory_order_relaxed);
+    uint64 const head = m_head.load(std::memory_order_acquire);
+    uint64 const pos = tail & m_mask;
+    uint64 const contiguous = m_mask + 1 - pos;
 
-    const auto& last = measurement._fields.rbegin()->first;
-    for (const auto& field : measurement._fields)
+    // a record that does not fit before the end starts over at the beginning
+    uint64 const needed = size <= contiguous ? size : contiguous + size;
+    if (m_mask + 1 - (tail - head) < needed)
     {
+        m_dropped.store(m_dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
 
-        out << field.first << "=";
-
-        if (field.second.type() == typeid(int32))
-            out << boost::any_cast<int32>(field.second) << "i";
-        else if (field.second.type() == typeid(int64))
-            out << boost::any_cast<int64>(field.second) << "i";
-        else if (field.second.type() == typeid(float))
-            out << boost::any_cast<float>(field.second);
-        else if (field.second.type() == typeid(bool))
-            out << (boost::any_cast<bool>(field.second) ? "t" : "f");
-        else if (field.second.type() == typeid(std::string))
-            out << boost::any_cast<std::string>(field.second);
-        else
-            out << "undefined";
-
-        if (measurement._fields.size() > 1 && field.first != last)
-            out << ",";
+    m_pending = needed;
+    if (size > contiguous)
+    {
+        reinterpret_cast<record_header*>(&m_buffer[pos])->size = 0;
+        return m_buffer;
     }
 
-    out << " " << measurement._timestamp;
+    return &m_buffer[pos];
+}
 
-    return out;
+void metric::measurement_ring::end_write()
+{
+    m_tail.store(m_tail.load(std::memory_order_relaxed) + m_pending, std::memory_order_release);
+    m_pending = 0;
 }
@@ -19,22 +19,161 @@
 #ifndef MANGOSSERVER_MEASUREMENT_H
 #define MANGOSSERVER_MEASUREMENT_H
 
-#include <boost/any.hpp>
-#include <iostream>
-#include <map>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
 
 #include "Common.h"
 
-struct Measurement
+namespace metric
 {
-    Measurement(std::string measurement, std::map<std::string, std::string> tags, std::map<std::string, boost::any> fields, uint64 timestamp = 0);
+    // Measurement names, tag keys and field keys are interned once and then referenced by id
+    typedef uint16 name_id;
 
-    friend std::stringstream& operator<<(std::stringstream &out, const Measurement &measurement);
+    static name_id const INVALID_NAME_ID = 0xFFFF;
 
-    std::string _measurement;
-    std::map<std::string, std::string> _tags; // tags are used for selecting queries
-    std::map<std::string, boost::any> _fields; // fields are used for displaying data
-    uint64 _timestamp;
-};
+    // lock free for names already known, takes a lock only to add a new one
+    name_id intern_name(std::string_view name);
+    // line protocol escaped form of the name
+    std::string const& get_name(name_id id);
 
-#endif // MANGOSSERVER_MEASUREMENT_H
\ No newline at end of file
+    enum value_type : uint8
+    {
+        VALUE_INT       = 0,
+        VALUE_FLOAT     = 1,
+        VALUE_BOOL      = 2,
+        VALUE_STRING    = 3
+    };
+
+    // Typed tag or field value, strings are only referenced until the value is stored in a measurement
+    class value
+    {
+        public:
+            template <typename T, typename std::enable_if<(std::is_integral<T>::value || std::is_enum<T>::value) && !std::is_same<T, bool>::value, int>::type = 0>
+            value(T number) : m_type(VALUE_INT), m_int(static_cast<int64>(number)) {}
+
+            template <typename T, typename std::enable_if<std::is_floating_point<T>::value, int>::type = 0>
+            value(T number) : m_type(VALUE_FLOAT), m_float(static_cast<double>(number)) {}
+
+            // template so that pointers do not silently convert to bool
+            template <typename T, typename std::enable_if<std::is_same<T, bool>::value, int>::type = 0>
+            value(T flag) : m_type(VALUE_BOOL), m_int(flag ? 1 : 0) {}
+
+            value(std::string_view text) : m_type(VALUE_STRING), m_int(0), m_text(text) {}
+            value(char const* text) : value(std::string_view(text)) {}
+            value(std::string const& text) : value(std::string_view(text)) {}
+
+            value_type type() const { return m_type; }
+            int64 as_int() const { return m_int; }
+            double as_float() const { return m_float; }
+            std::string_view as_string() const { return m_text; }
+
+        private:
+            value_type m_type;
+            union
+            {
+                int64 m_int;
+                double m_float;
+            };
+            std::string_view m_text;
+    };
+
+    struct tag
+    {
+        std::string_view key;
+        value val;
+    };
+
+    // Binary layout shared by metric::measurement and the ring buffers:
+    // record_header, tag entries, field entries, then the text of all string values
+    struct record_entry
+    {
+        name_id key;
+        value_type type;
+        uint8 reserved;
+        uint32 length;                                      // text length for VALUE_STRING
+        union
+        {
+            int64 number;
+            double real;
+            uint64 offset;                                  // text offset for VALUE_STRING
+        };
+    };
+
+    struct record_header
+    {
+        uint32 size;                                        // whole record, 0 marks the unused end of the ring
+        name_id name;
+        uint8 tagCount;
+        uint8 fieldCount;
+        uint64 timestamp;                                   // nanoseconds since epoch
+    };
+
+    static_assert(sizeof(record_entry) == 16 && sizeof(record_header) == 16, "record layout must stay 8 byte aligned");
+
+    // appends the record in influx line protocol, terminated by a newline
+    void append_line(std::string& out, record_header const* record);
+
+    /**
+     * Single producer single consumer byte ring holding variable sized records.
+     * The producer is the thread reporting measurements, the consumer is the metric write thread.
+     * Records never wrap, the unused end of the buffer is skipped instead.
+     */
+    class measurement_ring
+    {
+        public:
+            explicit measurement_ring(uint32 capacity);
+            measurement_ring(const measurement_ring&) = delete;
+            measurement_ring& operator=(const measurement_ring&) = delete;
+
+            // producer, returns null and counts a drop when the ring is full
+            uint8* begin_write(uint32 size);
+            void end_write();
+
+            // consumer, calls handler for every record available
+            template <typename Handler>
+            uint32 read(Handler&& handler)
+            {
+                uint32 count = 0;
+                uint64 head = m_head.load(std::memory_order_relaxed);
+                uint64 const tail = m_tail.load(std::memory_order_acquire);
+                while (head < tail)
+                {
+                    uint64 const pos = head & m_mask;
+                    record_header const* record = reinterpret_cast<record_header const*>(&m_buffer[pos]);
+                    if (!record->size)
+                    {
+                        head += m_mask + 1 - pos;
+                        continue;
+                    }
+
+                    handler(record);
+                    head += record->size;
+                    ++count;
+                }
+
+                m_head.store(head, std::memory_order_release);
+                return count;
+            }
+
+            uint64 get_dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+            // producer, called once when its thread exits, the ring may be freed after the next read
+            void release() { m_released.store(true, std::memory_order_release); }
+            bool is_released() const { return m_released.load(std::memory_order_acquire); }
+
+        private:
+            alignas(64) std::atomic<uint64> m_head;
+            alignas(64) std::atomic<uint64> m_tail;
+            std::atomic<uint64> m_dropped;
+            std::atomic<bool> m_released;
+            uint64 m_pending;                               // producer only, size of the write in progress including skipped bytes
+            std::unique_ptr<uint64[]> m_storage;            // uint64 for alignment
+            uint8* m_buffer;
+            uint64 m_mask;
+    };
+}
+
+#endif // MANGOSSERVER_MEASUREMENT_H
@@ -17,64 +17,109 @@
  */
 
 #include <boost/date_time/posix_time/posix_time.hpp>
+#include <array>
+#include <cstring>
 #include <functional>
 
 #include "Config/Config.h"
 #include "Log.h"
 #include "Metric.h"
 
-metric::measurement::measurement(std::string name, std::function<bool()> condition)
-    : m_name(name), m_condition(std::move(condition))
+namespace
 {
+    // per thread ring size, drained every DRAIN_INTERVAL
+    uint32 const RING_SIZE = 256 * 1024;
+    uint32 const DRAIN_INTERVAL = 100;                      // ms
+    uint32 const DRAINS_PER_SEND = 10;
+
+    uint32 align_size(uint32 size)
+    {
+        return (size + 7) & ~uint32(7);
+    }
 }
 
-metric::measurement::measurement(std::string name, std::string key, boost::any value, std::function<bool()> condition)
-    : m_name(name), m_condition(std::move(condition))
+metric::measurement::measurement(std::string_view name)
+    : m_name(INVALID_NAME_ID), m_discarded(!metric::instance().is_enabled()), m_tagCount(0), m_fieldCount(0), m_textSize(0)
 {
-    add_field(key, value);
+    if (!m_discarded)
+    {
+        m_name = intern_name(name);
+        m_discarded = m_name == INVALID_NAME_ID;
+    }
 }
 
-metric::measurement::measurement(std::string name, std::string key, boost::any value, std::map<std::string, std::string> tags, std::function<bool()> condition)
-    : m_name(name), m_tags(tags), m_condition(std::move(condition))
+metric::measurement::measurement(std::string_view name, std::string_view key, value fieldValue)
+    : measurement(name)
 {
-    add_field(key, value);
+    add_field(key, fieldValue);
 }
 
-metric::measurement::measurement(std::string name, std::map<std::string, std::string> tags, std::function<bool()> condition)
-    : m_name(name), m_tags(tags), m_condition(std::move(condition))
+metric::measurement::measurement(std::string_view name, std::string_view key, value fieldValue, std::initializer_list<tag> tags)
+    : measurement(name, tags)
 {
+    add_field(key, fieldValue);
 }
 
-metric::measurement::~measurement()
+metric::measurement::measurement(std::string_view name, std::initializer_list<tag> tags)
+    : measurement(name)
 {
-    if(m_condition())
-        metric::instance().report(m_name, m_fields, m_tags);
+    for (auto const& itr : tags)
+        add_tag(itr.key, itr.val);
 }
 
-void metric::measurement::add_tag(std::string key, std::string value)
+metric::measurement::~measurement()
 {
-    m_tags.insert({key, value});
+    if (!m_discarded && m_fieldCount)
+        metric::instance().report(*this);
 }
 
-void metric::measurement::add_field(std::string key, boost::any value)
+void metric::measurement::add_tag(std::string_view key, value tagValue)
 {
-    m_fields.insert({key, value});
+    if (!m_discarded && m_tagCount < MAX_TAGS && store(m_tags[m_tagCount], key, tagValue))
+        ++m_tagCount;
 }
 
-const boost::any metric::measurement::get_field(std::string key)
+void metric::measurement::add_field(std::string_view key, value fieldValue)
 {
-    if (m_fields.find(key) != m_fields.end())
-        return m_fields[key];
-
-    return boost::any();
+    if (!m_discarded && m_fieldCount < MAX_FIELDS && store(m_fields[m_fieldCount], key, fieldValue))
+        ++m_fieldCount;
 }
 
-void metric::measurement::set_condition(std::function<bool()> condition)
+bool metric::measurement::store(record_entry& entry, std::string_view key, value const& val)
 {
-    m_condition = std::move(condition);
+    entry.key = intern_name(key);
+    if (entry.key == INVALID_NAME_ID)
+        return false;
+
+    entry.type = val.type();
+    entry.reserved = 0;
+    entry.length = 0;
+    switch (val.type())
+    {
+        case VALUE_FLOAT:
+            entry.real = val.as_float();
+            break;
+        case VALUE_STRING:
+        {
+            std::string_view text = val.as_string();
+            if (text.size() > MAX_TEXT - m_textSize)
+                return false;
+
+            memcpy(&m_text[m_textSize], text.data(), text.size());
+            entry.offset = m_textSize;
+            entry.length = uint32(text.size());
+            m_textSize += uint32(text.size());
+            break;
+        }
+        default:
+            entry.number = val.as_int();
+            break;
+    }
+
+    return true;
 }
 
-metric::metric::metric()
+metric::metric::metric() : m_enabled(false), m_releasedDropped(0), m_payloadCount(0), m_drainCount(0), m_dropped(0)
 {
     initialize();
 }
@@ -88,16 +133,14 @@ metric::metric::~metric()
         m_sendTimer->cancel();
     });
 
-    m_queueServiceWork.reset();
     m_writeServiceWork.reset();
 
-    m_queueServiceThread.join();
     m_writeServiceThread.join();
 }
 
 void metric::metric::initialize()
 {
-    if (!(m_enabled = sConfig.GetBoolDefault("Metric.Enable", false)))
+    if (!sConfig.GetBoolDefault("Metric.Enable", false))
         return;
 
     m_connectionInfo = {
@@ -109,19 +152,15 @@ void metric::metric::initialize()
     };
 
     m_sendTimer.reset(new boost::asio::deadline_timer(m_writeService));
-    m_queueServiceWork.reset(new boost::asio::io_service::work(m_queueService));
     m_writeServiceWork.reset(new boost::asio::io_service::work(m_writeService));
 
-    // Start up service thread that will process all queued tasks
-    m_queueServiceThread = std::thread([&] {
-        m_queueService.run();
-    });
-
     m_writeServiceThread = std::thread([&] {
         m_writeService.run();
     });
 
     schedule_timer();
+
+    m_enabled = true;
 }
 
 metric::metric& metric::metric::instance()
@@ -150,21 +189,61 @@ void metric::metric::reload_config()
     });
 }
 
-void metric::metric::report(std::string measurement, std::string key, boost::any value, std::map<std::string, std::string> tags)
+namespace
 {
-    report(measurement, { { key, value } }, tags);
+    // hands the ring of a thread back to the drain when the thread exits
+    struct ring_owner
+    {
+        metric::measurement_ring* ring = nullptr;
+        ~ring_owner()
+        {
+            if (ring)
+                ring->release();
+        }
+    };
 }
 
-void metric::metric::report(std::string measurement, std::map<std::string, boost::any> fields, std::map<std::string, std::string> tags)
+metric::measurement_ring* metric::metric::get_ring()
+{
+    thread_local ring_owner owner;
+    if (!owner.ring)
+    {
+        std::lock_guard<std::mutex> guard(m_ringsLock);
+        m_rings.push_back(std::make_unique<measurement_ring>(RING_SIZE));
+        owner.ring = m_rings.back().get();
+    }
+
+    return owner.ring;
+}
+
+void metric::metric::report(measurement const& meas)
 {
     if (!m_enabled)
         return;
 
-    m_queueService.post([&, measurement, fields, tags]
-    {
-        std::lock_guard<std::mutex> guard(m_queueWriteLock);
-        m_measurementQueue.push_back(std::make_unique<Measurement>(measurement, tags, fields));
-    });
+    uint32 const entriesSize = (meas.m_tagCount + meas.m_fieldCount) * sizeof(record_entry);
+    uint32 const size = align_size(sizeof(record_header) + entriesSize + meas.m_textSize);
+
+    measurement_ring* ring = get_ring();
+    uint8* data = ring->begin_write(size);
+    if (!data)
+        return;
+
+    record_header* record = reinterpret_cast<record_header*>(data);
+    record->size = size;
+    record->name = meas.m_name;
+    record->tagCount = meas.m_tagCount;
+    record->fieldCount = meas.m_fieldCount;
+    record->timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+    uint8* pos = data + sizeof(record_header);
+    memcpy(pos, meas.m_tags, meas.m_tagCount * sizeof(record_entry));
+    pos += meas.m_tagCount * sizeof(record_entry);
+    memcpy(pos, meas.m_fields, meas.m_fieldCount * sizeof(record_entry));
+    pos += meas.m_fieldCount * sizeof(record_entry);
+    memcpy(pos, meas.m_text, meas.m_textSize);
+
+    ring->end_write();
 }
 
 void metric::metric::schedule_timer()
@@ -174,7 +253,7 @@ void metric::metric::schedule_timer()
     if (!m_sendTimer)
         return;
 
-    m_sendTimer->expires_from_now(boost::posix_time::seconds(1));
+    m_sendTimer->expires_from_now(boost::posix_time::milliseconds(DRAIN_INTERVAL));
     m_sendTimer->async_wait(std::bind(&metric::metric::prepare_send, this, _1));
 }
 
@@ -188,22 +267,63 @@ void metric::metric::prepare_send(const boost::system::error_code& ec)
         return;
     }
 
-    send();
+    // rings are emptied often so that they can stay small, the batch is sent less often
+    drain();
+    if (++m_drainCount >= DRAINS_PER_SEND)
+    {
+        m_drainCount = 0;
+        send();
+    }
     schedule_timer();
 }
 
+void metric::metric::drain()
+{
+    std::lock_guard<std::mutex> guard(m_ringsLock);
+    for (auto itr = m_rings.begin(); itr != m_rings.end();)
+    {
+        // checked before reading, so the last records of a released ring are read before it is freed
+        bool released = (*itr)->is_released();
+        m_payloadCount += (*itr)->read([&](record_header const* record) { append_line(m_payload, record); });
+        if (released)
+        {
+            m_releasedDropped += (*itr)->get_dropped();
+            itr = m_rings.erase(itr);
+        }
+        else
+            ++itr;
+    }
+}
+
 void metric::metric::send()
 {
-    std::vector<std::unique_ptr<Measurement>> measurements;
+    uint64 dropped;
+    {
+        std::lock_guard<std::mutex> guard(m_ringsLock);
+        dropped = m_releasedDropped;
+        for (auto& ring : m_rings)
+            dropped += ring->get_dropped();
+    }
 
-    // Scope swapping
+    if (dropped != m_dropped)
     {
-        std::lock_guard<std::mutex> guard(m_queueWriteLock);
-        std::swap(measurements, m_measurementQueue);
+        sLog.outError("metric::metric::send " UI64FMTD " measurements dropped, ring buffers full", dropped - m_dropped);
+        m_dropped = dropped;
     }
 
-    sLog.outDetail("Sending %zu measurements!", measurements.size());
+    if (m_payload.empty())
+        return;
+
+    sLog.outDetail("Sending %u measurements!", m_payloadCount);
+
+    // whatever the outcome the batch is not sent twice, clear() keeps the capacity for the next one
+    write_payload(m_payload);
+    m_payload.clear();
+    m_payloadCount = 0;
+}
 
+void metric::metric::write_payload(std::string const& payload)
+{
     using boost::asio::ip::tcp;
 
     boost::system::error_code error;
@@ -236,24 +356,14 @@ void metric::metric::send()
         return;
     }
 
-    std::stringstream payload;
-    for (auto const& measurement : measurements)
-    {
-        if (&measurement != &measurements.front())
-            payload << "\n";
-
-        payload << *measurement;
-    }
-
-    boost::asio::streambuf request;
-    std::ostream request_stream(&request);
+    std::string requestHeader;
+    requestHeader += "POST /write?db=" + m_connectionInfo.database + "&u=" + m_connectionInfo.username + "&p=" + m_connectionInfo.password + " HTTP/1.1\r\n";
+    requestHeader += "Host: " + m_connectionInfo.hostname + "\r\n";
+    requestHeader += "Content-Length:" + std::to_string(payload.size()) + "\r\n";
+    requestHeader += "Connection: close\r\n\r\n";
 
-    // Write request
-    request_stream << "POST " << "/write?db=" << m_connectionInfo.database << "&u=" << m_connectionInfo.username << "&p=" << m_connectionInfo.password << " HTTP/1.1\r\n";
-    request_stream << "Host: " << m_connectionInfo.hostname << "\r\n";
-    request_stream << "Content-Length:" << std::to_string(payload.tellp()) << "\r\n";
-    request_stream << "Connection: close\r\n\r\n";
-    request_stream << payload.rdbuf();
+    // header and batch are written straight from their buffers
+    std::array<boost::asio::const_buffer, 2> request = { { boost::asio::buffer(requestHeader), boost::asio::buffer(payload) } };
 
     // Send the request.
     boost::asio::write(socket, request, error);
@@ -19,12 +19,13 @@
 #ifndef MANGOSSERVER_METRIC_H
 #define MANGOSSERVER_METRIC_H
 
-#include <boost/any.hpp>
 #include <boost/asio.hpp>
+#include <atomic>
 #include <chrono>
-#include <functional>
+#include <initializer_list>
 #include <iostream>
 #include <map>
+#include <mutex>
 #include <thread>
 #include <vector>
 
@@ -42,66 +43,80 @@ struct MetricConnectionInfo
 
 namespace metric
 {
+    /**
+     * A measurement is reported when it goes out of scope. Everything is kept inside the object,
+     * reporting copies it into the ring buffer of the calling thread, nothing is allocated.
+     * Tags, fields or string text above the limits below are dropped.
+     */
     class measurement
     {
         public:
-            measurement(std::string name, std::function<bool()> condition = [] { return true; });
-            measurement(std::string name, std::string key, boost::any value, std::function<bool()> condition = [] { return true; });
-            measurement(std::string name, std::string key, boost::any value, std::map<std::string, std::string> tags, std::function<bool()> condition = [] { return true; });
-            measurement(std::string name, std::map<std::string, std::string> tags, std::function<bool()> condition = [] { return true; });
+            static uint32 const MAX_TAGS = 8;
+            static uint32 const MAX_FIELDS = 32;
+            static uint32 const MAX_TEXT = 512;
+
+            measurement(std::string_view name);
+            measurement(std::string_view name, std::string_view key, value fieldValue);
+            measurement(std::string_view name, std::string_view key, value fieldValue, std::initializer_list<tag> tags);
+            measurement(std::string_view name, std::initializer_list<tag> tags);
             virtual ~measurement();
 
-            void add_tag(std::string key, std::string value);
-            void add_field(std::string key, boost::any value);
-            const boost::any get_field(std::string key);
+            void add_tag(std::string_view key, value tagValue);
+            void add_field(std::string_view key, value fieldValue);
 
         protected:
-            void set_condition(std::function<bool()> condition);
+            // the measurement will not be reported
+            void discard() { m_discarded = true; }
+            bool is_discarded() const { return m_discarded; }
 
         private:
-            std::string m_name;
-            std::map<std::string, std::string> m_tags;
-            std::map<std::string, boost::any> m_fields;
-            std::chrono::system_clock::time_point m_timestamp;
-            std::function<bool()> m_condition;
+            friend class metric;
+
+            bool store(record_entry& entry, std::string_view key, value const& val);
+
+            name_id m_name;
+            bool m_discarded;
+            uint8 m_tagCount;
+            uint8 m_fieldCount;
+            uint32 m_textSize;
+            record_entry m_tags[MAX_TAGS];
+            record_entry m_fields[MAX_FIELDS];
+            char m_text[MAX_TEXT];
     };
 
     template <class precision>
     class duration : public measurement
     {
         public:
-            duration(std::string name)
-                : measurement(name), m_startTime(std::chrono::high_resolution_clock::now())
+            duration(std::string_view name)
+                : measurement(name), m_threshold(0), m_startTime(std::chrono::high_resolution_clock::now())
             {}
 
-            duration(std::string name, std::map<std::string, std::string> tags)
-                : measurement(name, tags), m_startTime(std::chrono::high_resolution_clock::now())
+            duration(std::string_view name, std::initializer_list<tag> tags)
+                : measurement(name, tags), m_threshold(0), m_startTime(std::chrono::high_resolution_clock::now())
             {}
 
-            duration(std::string name, std::map<std::string, std::string> tags, int64 threshold)
-                : measurement(name, tags), m_startTime(std::chrono::high_resolution_clock::now())
-            {
-                auto condition = [&, threshold] {
-                    auto value = get_field("duration");
-                    if (value.empty())
-                        return false;
-
-                    auto duration = boost::any_cast<int64>(value);
-                    return duration >= threshold;
-                };
-
-                set_condition(std::move(condition));
-            }
+            // only reported when the duration reaches threshold
+            duration(std::string_view name, std::initializer_list<tag> tags, int64 threshold)
+                : measurement(name, tags), m_threshold(threshold), m_startTime(std::chrono::high_resolution_clock::now())
+            {}
 
             ~duration()
             {
+                if (is_discarded())
+                    return;
+
                 auto endTime = std::chrono::high_resolution_clock::now();
                 auto duration = std::chrono::duration_cast<precision>(endTime - m_startTime).count();
 
-                add_field("duration", static_cast<int64>(duration));
+                if (duration < m_threshold)
+                    discard();
+                else
+                    add_field("duration", static_cast<int64>(duration));
             }
 
         private:
+            int64 m_threshold;
             std::chrono::high_resolution_clock::time_point m_startTime;
     };
 
@@ -116,28 +131,38 @@ namespace metric
 
             void reload_config();
 
-            void report(std::string measurement, std::string key, boost::any value, std::map<std::string, std::string> tags = {});
-            void report(std::string measurement, std::map<std::string, boost::any> fields, std::map<std::string, std::string> tags = {});
+            bool is_enabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+            void report(measurement const& meas);
 
         private:
-            boost::asio::io_service m_queueService;
             boost::asio::io_service m_writeService;
 
             std::unique_ptr<boost::asio::deadline_timer> m_sendTimer;
-            std::unique_ptr<boost::asio::io_service::work> m_queueServiceWork;
             std::unique_ptr<boost::asio::io_service::work> m_writeServiceWork;
-            std::thread m_queueServiceThread;
             std::thread m_writeServiceThread;
 
-            bool m_enabled;
+            std::atomic<bool> m_enabled;
             MetricConnectionInfo m_connectionInfo;
 
-            std::mutex m_queueWriteLock;
-            std::vector<std::unique_ptr<Measurement>> m_measurementQueue;
+            // one ring per reporting thread, freed by the drain after the thread exited
+            std::mutex m_ringsLock;
+            std::vector<std::unique_ptr<measurement_ring>> m_rings;
+            uint64 m_releasedDropped;                       // drops counted by freed rings
+
+            // write thread only
+            std::string m_payload;
+            uint32 m_payloadCount;
+            uint32 m_drainCount;
+            uint64 m_dropped;
+
+            measurement_ring* get_ring();
 
             void schedule_timer();
             void prepare_send(const boost::system::error_code& ec);
+            void drain();
             void send();
+            void write_payload(std::string const& payload);
     };
 }
 
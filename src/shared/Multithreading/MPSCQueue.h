@@ -0,0 +1,90 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_MPSC_QUEUE_H
+#define MANGOS_MPSC_QUEUE_H
+
+#include <atomic>
+#include <utility>
+
+/**
+ * Unbounded multiple producer single consumer queue (Vyukov).
+ *
+ * Push is wait free and may be called from any thread, Pop must only be called
+ * by the single consumer. The consumer always keeps one node, the value of
+ * which has already been taken, so T must be default constructible.
+ */
+template <typename T>
+class MPSCQueue
+{
+    public:
+        MPSCQueue() : m_head(new Node()), m_tail(m_head.load(std::memory_order_relaxed)) {}
+
+        MPSCQueue(const MPSCQueue&) = delete;
+        MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+        ~MPSCQueue()
+        {
+            T value;
+            while (Pop(value));
+            delete m_tail;
+        }
+
+        // any thread
+        void Push(T value)
+        {
+            Node* node = new Node(std::move(value));
+            Node* prev = m_head.exchange(node);                  // seq_cst, pairs with Empty()
+            prev->next.store(node, std::memory_order_release);
+        }
+
+        // consumer only
+        bool Pop(T& value)
+        {
+            Node* tail = m_tail;
+            Node* next = tail->next.load(std::memory_order_acquire);
+            if (!next)
+                return false;
+
+            value = std::move(next->value);
+            m_tail = next;
+            delete tail;
+            return true;
+        }
+
+        // consumer only, a push still in progress already counts as not empty
+        bool Empty() const
+        {
+            return m_head.load(std::memory_order_seq_cst) == m_tail;
+        }
+
+    private:
+        struct Node
+        {
+            Node() : next(nullptr) {}
+            explicit Node(T&& nodeValue) : value(std::move(nodeValue)), next(nullptr) {}
+
+            T value;
+            std::atomic<Node*> next;
+        };
+
+        alignas(64) std::atomic<Node*> m_head;              // last pushed, producers
+        alignas(64) Node* m_tail;                           // already consumed, consumer
+};
+
+#endif
@@ -0,0 +1,163 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_WORK_STEALING_QUEUE_H
+#define MANGOS_WORK_STEALING_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+/**
+ * Bounded Chase-Lev deque.
+ *
+ * The owning thread pushes and pops at the bottom, any other thread may steal
+ * from the top without taking a lock. Only pointers are stored, the queue never
+ * owns the pointed objects.
+ */
+template <typename T>
+class WorkStealingQueue
+{
+        static_assert(std::is_pointer<T>::value, "WorkStealingQueue only stores pointers");
+
+    public:
+        explicit WorkStealingQueue(size_t capacity = 4096) : m_top(0), m_bottom(0)
+        {
+            size_t size = 1;
+            while (size < capacity)
+                size <<= 1;
+
+            m_mask = size - 1;
+            m_buffer.reset(new std::atomic<T>[size]);
+            for (size_t i = 0; i < size; ++i)
+                m_buffer[i].store(nullptr, std::memory_order_relaxed);
+        }
+
+        WorkStealingQueue(const WorkStealingQueue&) = delete;
+        WorkStealingQueue& operator=(const WorkStealingQueue&) = delete;
+
+        // owner only, returns false when the queue is full
+        bool Push(T value)
+        {
+            int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+            int64_t top = m_top.load(std::memory_order_acquire);
+            if (bottom - top > int64_t(m_mask))
+                return false;
+
+            m_buffer[bottom & m_mask].store(value, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+        // owner only
+        T Pop()
+        {
+            int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+            m_bottom.store(bottom, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t top = m_top.load(std::memory_order_relaxed);
+
+            if (top > bottom)
+            {
+                // queue was empty
+                m_bottom.store(bottom + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            T value = m_buffer[bottom & m_mask].load(std::memory_order_relaxed);
+            if (top == bottom)
+            {
+                // last element, race against thieves
+                if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                    value = nullptr;
+                m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            }
+            return value;
+        }
+
+        // any thread
+        T Steal()
+        {
+            int64_t top = m_top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t bottom = m_bottom.load(std::memory_order_acquire);
+
+            if (top >= bottom)
+                return nullptr;
+
+            T value = m_buffer[top & m_mask].load(std::memory_order_relaxed);
+            if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return nullptr;
+
+            return value;
+        }
+
+        // owner only, pops the bottom element only if it matches
+        template <typename Pred>
+        T PopIf(Pred pred)
+        {
+            int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+            if (m_top.load(std::memory_order_acquire) > bottom)
+                return nullptr;
+
+            // only the owner writes the bottom slot, a thief may still take it before the pop
+            if (!pred(m_buffer[bottom & m_mask].load(std::memory_order_relaxed)))
+                return nullptr;
+
+            return Pop();
+        }
+
+        // any thread, steals the top element only if it matches
+        template <typename Pred>
+        T StealIf(Pred pred)
+        {
+            int64_t top = m_top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t bottom = m_bottom.load(std::memory_order_acquire);
+
+            if (top >= bottom)
+                return nullptr;
+
+            // a stale value is harmless, the exchange fails if the slot was taken meanwhile
+            T value = m_buffer[top & m_mask].load(std::memory_order_relaxed);
+            if (!pred(value))
+                return nullptr;
+
+            if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return nullptr;
+
+            return value;
+        }
+
+        bool Empty() const
+        {
+            return m_top.load(std::memory_order_relaxed) >= m_bottom.load(std::memory_order_relaxed);
+        }
+
+    private:
+        // keep the indexes on separate cache lines, thieves hammer m_top
+        alignas(64) std::atomic<int64_t> m_top;
+        alignas(64) std::atomic<int64_t> m_bottom;
+        alignas(64) std::unique_ptr<std::atomic<T>[]> m_buffer;
+        size_t m_mask;
+};
+
+#endif
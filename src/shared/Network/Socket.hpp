@@ -74,9 +74,9 @@ namespace MaNGOS
             void OnWriteComplete(const boost::system::error_code &error, size_t length);
             void FlushOut();
 
+        protected:
             void OnError(const boost::system::error_code &error);
 
-        protected:
             std::string m_address;
             std::string m_remoteEndpoint;
             boost::asio::ip::address m_remoteAddress;